@@ -28,6 +28,73 @@
 #include "Engine/Engine.h"
 #include "StaticMeshResources.h"
 #include "DrawDebugHelpers.h"
+#include "SceneView.h"
+#include "Engine/GameInstance.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Misc/ScopeLock.h"
+#include "Conics/ConicTessellation.h"
+#include "Conics/ConicBezier.h"
+#include "Conics/TessellateConicLines.h"
+#include <atomic>
+
+
+// A segment's points on the unit conic (see GetSegmentTessellation), and
+// where its vertices and indices go in the output
+struct FConicSegmentTessellation
+{
+    int32 Conic = 0;
+    int32 Segment = 0;
+    std::vector<float> Params;
+    std::vector<double> X;
+    std::vector<double> Y;
+    int32 FirstVertex = 0;
+    int32 FirstIndex = 0;
+};
+
+// Buffers reused from one segment to the next, one for each worker
+struct FConicTessellationScratch
+{
+    ConicLineVertices<double> Lines;
+};
+
+// Everything Tessellate works in, kept by its caller from one frame to the
+// next, so the buffers keep their allocations.  (std::vector, since TArray
+// relocates its elements bitwise.)
+struct FConicTessellationWorkspace
+{
+    std::vector<FConicSegmentTessellation> Segments;    // <- Only the first SegmentCount are this frame's
+    std::vector<FConicTessellationScratch> Scratches;   // <- One for each worker
+};
+
+// Late latch mode: one view's geometry for a frame.  It's tessellated the
+// first time the view's drawn, and its other passes draw the same buffers.
+struct FConicViewGeometry
+{
+    FConicViewGeometry(ERHIFeatureLevel::Type FeatureLevel)
+        : VertexFactory(FeatureLevel, "FConicViewGeometry")
+    {
+    }
+
+    ~FConicViewGeometry()
+    {
+        VertexBuffers.PositionVertexBuffer.ReleaseResource();
+        VertexBuffers.StaticMeshVertexBuffer.ReleaseResource();
+        VertexBuffers.ColorVertexBuffer.ReleaseResource();
+        IndexBuffer.ReleaseResource();
+        VertexFactory.ReleaseResource();
+    }
+
+    FStaticMeshVertexBuffers VertexBuffers;
+    FDynamicMeshIndexBuffer32 IndexBuffer;
+    FLocalVertexFactory VertexFactory;
+    TArray<FDynamicMeshVertex> Vertices;
+    FConicTessellationWorkspace Workspace;
+
+    // Which view, and frame, it's for
+    const FSceneView* View = nullptr;
+    uint32 FrameNumber = 0;
+};
 
 
 // -----------------------------------------------------------------------------
@@ -47,13 +114,14 @@ public:
         return reinterpret_cast<size_t>(&UniquePointer);
     }
 
-    FConicRendererSceneProxy(UConicRendererComponent* Component, uint32 maxOrbits, uint32 LinesPerConicSegment, float lineThickness)
+    FConicRendererSceneProxy(UConicRendererComponent* Component, uint32 maxOrbits, uint32 LinesPerConicSegment, float lineThickness, const FConicLod& lod)
         : FPrimitiveSceneProxy(Component)
         , VertexFactory(GetScene().GetFeatureLevel(), "FConicRendererSceneProxy")
         , MaterialRelevance(Component->GetMaterialRelevance(GetScene().GetFeatureLevel()))
         , MaxOrbits(maxOrbits)
         , LinesPerSegment(LinesPerConicSegment)
         , LineThickness(lineThickness)
+        , Lod(lod)
     {
         TArray<FDynamicMeshVertex> Vertices;
         TArray<uint32> Indices;
@@ -115,40 +183,28 @@ public:
             MaterialProxy = Material->GetRenderProxy();
         }
 
-        int nNumPrimitives = IndexBuffer.Indices.Num() / 3;
-        if (!nNumPrimitives) return;
+        if (bLateLatch)
+        {
+            GetLateLatchedMeshElements(Views, ViewFamily, VisibilityMap, MaterialProxy, bWireframe, Collector);
+        }
+        else if (IndexBuffer.Indices.Num())
+        {
+            for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ViewIndex++)
+            {
+                if (VisibilityMap & (1 << ViewIndex))
+                {
+                    AddMesh(ViewIndex, VertexBuffers, IndexBuffer, VertexFactory, MaterialProxy, bWireframe, Collector);
+                }
+            }
+        }
+
+        // Measure how stale the game thread's camera is by the time it's drawn
         for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ViewIndex++)
         {
-            if (VisibilityMap & (1 << ViewIndex) && IndexBuffer.Indices.Num() )
+            if (VisibilityMap & (1 << ViewIndex))
             {
-                const FSceneView* View = Views[ViewIndex];
-                // Draw the mesh.
-                FMeshBatch& Mesh = Collector.AllocateMesh();
-                FMeshBatchElement& BatchElement = Mesh.Elements[0];
-                BatchElement.IndexBuffer = &IndexBuffer;
-                Mesh.bWireframe = bWireframe;
-                Mesh.VertexFactory = &VertexFactory;
-                Mesh.MaterialRenderProxy = MaterialProxy;
-
-                bool bHasPrecomputedVolumetricLightmap;
-                FMatrix PreviousLocalToWorld;
-                int32 SingleCaptureIndex;
-                bool bOutputVelocity;
-                GetScene().GetPrimitiveUniformShaderParameters_RenderThread(GetPrimitiveSceneInfo(), bHasPrecomputedVolumetricLightmap, PreviousLocalToWorld, SingleCaptureIndex, bOutputVelocity);
-
-                FDynamicPrimitiveUniformBuffer& DynamicPrimitiveUniformBuffer = Collector.AllocateOneFrameResource<FDynamicPrimitiveUniformBuffer>();
-                DynamicPrimitiveUniformBuffer.Set(GetLocalToWorld(), PreviousLocalToWorld, GetBounds(), GetLocalBounds(), true, bHasPrecomputedVolumetricLightmap, DrawsVelocity(), false);
-                BatchElement.PrimitiveUniformBufferResource = &DynamicPrimitiveUniformBuffer.UniformBuffer;
-
-                BatchElement.FirstIndex = 0;
-                BatchElement.NumPrimitives = nNumPrimitives;
-                BatchElement.MinVertexIndex = 0;
-                BatchElement.MaxVertexIndex = VertexBuffers.PositionVertexBuffer.GetNumVertices() - 1;
-                Mesh.ReverseCulling = IsLocalToWorldDeterminantNegative();
-                Mesh.Type = PT_TriangleList;
-                Mesh.DepthPriorityGroup = SDPG_World;
-                Mesh.bCanApplyViewModeOverrides = false;
-                Collector.AddMesh(ViewIndex, Mesh);
+                RecordCameraLatency(*Views[ViewIndex]);
+                break;
             }
         }
     }
@@ -182,35 +238,271 @@ public:
         const FVector& CameraPosition,
         const FVector& CameraDirection,
         const TArray<FConicSection>& Conics,
-        const FMatrix& Transform /* Technically, Position and Direction can be obtained by decomposing this, but... */
+        const FMatrix& Transform, /* Technically, Position and Direction can be obtained by decomposing this, but... */
+        uint64 CameraSampleCycles
     )
     {
         check(IsInRenderingThread());
 
-        TArray<FDynamicMeshVertex> Vertices;
-        TArray<uint32> Indices;
+        bLateLatch = false;
+        Orbits.Empty();
+        SampleCycles = CameraSampleCycles;
+        LatchCycles.store(CameraSampleCycles, std::memory_order_relaxed);
+        SampledEye = CameraPosition;
 
-        UConicRendererComponent::Tessellate(Transform, CameraPosition, CameraDirection, Conics, LineThickness, LinesPerSegment, Vertices, Indices, MaxOrbits);
+        // (Straight into the index buffer's indices, and the vertices keep
+        // their allocation from one frame to the next)
+        UConicRendererComponent::Tessellate(Transform, CameraPosition, CameraDirection, Conics, LineThickness, LinesPerSegment, Lod, Workspace, LineVertices, IndexBuffer.Indices, MaxOrbits);
 
         // It's probably against the laws of UE rendering to update these vertices in this manner, but
         // the point here is to illustrate the concept over illustration of ue particulars.
-        VertexBuffers.InitFromDynamicVertex(&VertexFactory, Vertices, 2);
-        IndexBuffer.Indices = Indices;
+        VertexBuffers.InitFromDynamicVertex(&VertexFactory, LineVertices, 2);
         IndexBuffer.UpdateRHI();
     }
 
+    // Late latch mode: just the orbits come over, everything that depends on
+    // the camera happens in GetDynamicMeshElements with the view being drawn.
+    void SetOrbits_RenderThread(const FOrbitProjectionView& View, const TArray<FOrbitItem>& InOrbits, const TSharedPtr<const FOrbitBoundingVolumes, ESPMode::ThreadSafe>& InOrbitBounds, const TSharedPtr<const FOrbitPlaneFamilies, ESPMode::ThreadSafe>& InOrbitFamilies, const FVector& CameraPosition, uint64 CameraSampleCycles)
+    {
+        check(IsInRenderingThread());
+
+        bLateLatch = true;
+        SampleCycles = CameraSampleCycles;
+        LatchCycles.store(CameraSampleCycles, std::memory_order_relaxed);
+        SampledEye = CameraPosition;
+        ProjectionView = View;
+        Orbits = InOrbits;
+        OrbitBounds = InOrbitBounds;
+        OrbitFamilies = InOrbitFamilies;
+    }
+
+    void GetCameraLatency(float& LatencyMs, float& LatchedMs, float& EyeError) const
+    {
+        LatencyMs = CameraLatencyMs.load(std::memory_order_relaxed);
+        LatchedMs = LateLatchSavedMs.load(std::memory_order_relaxed);
+        EyeError = CameraEyeError.load(std::memory_order_relaxed);
+    }
+
 private:
 
+    // Replace the game thread's camera with the scene view's.  The frame
+    // mapping and projection plane distance come from the game thread.
+    static bool LatchSceneView(const FSceneView& SceneView, FOrbitProjectionView& View)
+    {
+        // UE's projection matrices are horizontal FOV based, as is the frustum.
+        // Orthographic ones are 1 / the half width, which goes to the fov that
+        // frames it on the projection plane (see FOrbitProjectionView.)
+        const FMatrix& ProjectionMatrix = SceneView.ViewMatrices.GetProjectionMatrix();
+        View.bOrthographic = !SceneView.IsPerspectiveProjection();
+        if (View.bOrthographic)
+        {
+            const double HalfWidth = 1. / (ProjectionMatrix.M[0][0] * View.SceneScale);
+            View.Frustum.fov = 2. * atan(HalfWidth / View.Frustum.z);
+        }
+        else
+        {
+            View.Frustum.fov = 2. * atan(1. / ProjectionMatrix.M[0][0]);
+        }
+        View.Frustum.aspectRatio = ProjectionMatrix.M[1][1] / ProjectionMatrix.M[0][0];
+        View.ViewportWidth = FMath::Max(SceneView.UnscaledViewRect.Width(), 1);
+
+        // Off axis (each eye of a stereo pair, usually) the clip space x is
+        // offset by M[2][0] (perspective, times the depth) or M[3][0]
+        // (orthographic), y by M[2][1] or M[3][1].  The rectangle's center
+        // is the other way by as much, in half widths.
+        const int32 OffsetRow = View.bOrthographic ? 3 : 2;
+        View.ProjectionOffset = FVector2D(-ProjectionMatrix.M[OffsetRow][0], -ProjectionMatrix.M[OffsetRow][1]);
+
+        // With the view's roll (a head mounted display's, say)
+        View.EyePoint = View.ToFramePosition(SceneView.ViewMatrices.GetViewOrigin());
+        View.EyeDirection = View.ToFrameVector(SceneView.GetViewDirection());
+        View.EyeUp = View.ToFrameVector(SceneView.GetViewUp());
+
+        return true;
+    }
+
+    // One mesh batch drawing all of a vertex and index buffer
+    void AddMesh(int32 ViewIndex, const FStaticMeshVertexBuffers& MeshVertexBuffers, const FDynamicMeshIndexBuffer32& MeshIndexBuffer, const FLocalVertexFactory& MeshVertexFactory, FMaterialRenderProxy* MaterialProxy, bool bWireframe, FMeshElementCollector& Collector) const
+    {
+        FMeshBatch& Mesh = Collector.AllocateMesh();
+        FMeshBatchElement& BatchElement = Mesh.Elements[0];
+        BatchElement.IndexBuffer = &MeshIndexBuffer;
+        Mesh.bWireframe = bWireframe;
+        Mesh.VertexFactory = &MeshVertexFactory;
+        Mesh.MaterialRenderProxy = MaterialProxy;
+
+        bool bHasPrecomputedVolumetricLightmap;
+        FMatrix PreviousLocalToWorld;
+        int32 SingleCaptureIndex;
+        bool bOutputVelocity;
+        GetScene().GetPrimitiveUniformShaderParameters_RenderThread(GetPrimitiveSceneInfo(), bHasPrecomputedVolumetricLightmap, PreviousLocalToWorld, SingleCaptureIndex, bOutputVelocity);
+
+        FDynamicPrimitiveUniformBuffer& DynamicPrimitiveUniformBuffer = Collector.AllocateOneFrameResource<FDynamicPrimitiveUniformBuffer>();
+        DynamicPrimitiveUniformBuffer.Set(GetLocalToWorld(), PreviousLocalToWorld, GetBounds(), GetLocalBounds(), true, bHasPrecomputedVolumetricLightmap, DrawsVelocity(), false);
+        BatchElement.PrimitiveUniformBufferResource = &DynamicPrimitiveUniformBuffer.UniformBuffer;
+
+        BatchElement.FirstIndex = 0;
+        BatchElement.NumPrimitives = MeshIndexBuffer.Indices.Num() / 3;
+        BatchElement.MinVertexIndex = 0;
+        BatchElement.MaxVertexIndex = MeshVertexBuffers.PositionVertexBuffer.GetNumVertices() - 1;
+        Mesh.ReverseCulling = IsLocalToWorldDeterminantNegative();
+        Mesh.Type = PT_TriangleList;
+        Mesh.DepthPriorityGroup = SDPG_World;
+        Mesh.bCanApplyViewModeOverrides = false;
+        Collector.AddMesh(ViewIndex, Mesh);
+    }
+
+    // This frame's geometry for a view, or one to tessellate it into (the
+    // first that isn't this frame's.)  bCurrent says which.
+    FConicViewGeometry& FindViewGeometry(const FSceneView* View, uint32 FrameNumber, bool& bCurrent) const
+    {
+        FConicViewGeometry* Stale = nullptr;
+        for (const TUniquePtr<FConicViewGeometry>& Geometry : ViewGeometries)
+        {
+            if (Geometry->FrameNumber == FrameNumber && Geometry->View == View)
+            {
+                bCurrent = true;
+                return *Geometry;
+            }
+            if (!Stale && Geometry->FrameNumber != FrameNumber)
+            {
+                Stale = Geometry.Get();
+            }
+        }
+
+        if (!Stale)
+        {
+            Stale = ViewGeometries.Add_GetRef(MakeUnique<FConicViewGeometry>(GetScene().GetFeatureLevel())).Get();
+        }
+
+        bCurrent = false;
+        Stale->View = View;
+        Stale->FrameNumber = FrameNumber;
+        return *Stale;
+    }
+
+    // Each visible view gets its own projection and tessellation (split screen,
+    // stereo), in parallel, once a frame.  GetDynamicMeshElements is called
+    // again for the frame's other passes, and they draw what the first one
+    // tessellated.
+    void GetLateLatchedMeshElements(const TArray<const FSceneView*>& Views, const FSceneViewFamily& ViewFamily, uint32 VisibilityMap, FMaterialRenderProxy* MaterialProxy, bool bWireframe, FMeshElementCollector& Collector) const
+    {
+        QUICK_SCOPE_CYCLE_COUNTER(STAT_ConicRendererSceneProxy_LateLatch);
+
+        if (!Orbits.Num())
+        {
+            return;
+        }
+
+        FScopeLock Lock(&ViewGeometryLock);
+
+        // Every visible view is drawn, the ones that haven't been tessellated
+        // yet this frame are latched first
+        TArray<TPair<int32, FConicViewGeometry*>> Drawn;
+        TArray<FConicViewGeometry*> Latched;
+        TArray<FOrbitProjectionView> ProjectionViews;
+        for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ViewIndex++)
+        {
+            if (!(VisibilityMap & (1 << ViewIndex))) continue;
+
+            bool bCurrent;
+            FConicViewGeometry& Geometry = FindViewGeometry(Views[ViewIndex], ViewFamily.FrameNumber, bCurrent);
+            Drawn.Add(TPair<int32, FConicViewGeometry*>(ViewIndex, &Geometry));
+
+            if (!bCurrent)
+            {
+                FOrbitProjectionView View = ProjectionView;
+                LatchSceneView(*Views[ViewIndex], View);
+                Latched.Add(&Geometry);
+                ProjectionViews.Add(View);
+            }
+        }
+
+        if (Latched.Num())
+        {
+            // When the camera the conics are projected with was sampled
+            LatchCycles.store(FPlatformTime::Cycles64(), std::memory_order_relaxed);
+
+            TArray<TArray<FConicSection>> Conics;
+            UOrbitProjectorComponent::TransformOrbitsForViews(ProjectionViews, Orbits, Conics, OrbitBounds.Get(), OrbitFamilies.Get());
+
+            // Per frame geometry, so there's no vertex buffer to outgrow
+            ParallelFor(Latched.Num(), [&](int32 i)
+                {
+                    const FOrbitProjectionView& View = ProjectionViews[i];
+                    FConicViewGeometry& Geometry = *Latched[i];
+                    UConicRendererComponent::Tessellate(GetLocalToWorld(), View.ToScenePosition(View.EyePoint), View.ToSceneVector(View.EyeDirection), Conics[i], LineThickness, LinesPerSegment, Lod, Geometry.Workspace, Geometry.Vertices, Geometry.IndexBuffer.Indices, MAX_int32);
+                });
+
+            for (FConicViewGeometry* Geometry : Latched)
+            {
+                if (!Geometry->IndexBuffer.Indices.Num()) continue;
+
+                Geometry->VertexBuffers.InitFromDynamicVertex(&Geometry->VertexFactory, Geometry->Vertices, 2);
+                if (Geometry->IndexBuffer.IsInitialized())
+                {
+                    Geometry->IndexBuffer.UpdateRHI();
+                }
+                else
+                {
+                    Geometry->IndexBuffer.InitResource();
+                }
+            }
+        }
+
+        for (const TPair<int32, FConicViewGeometry*>& View : Drawn)
+        {
+            if (View.Value->IndexBuffer.Indices.Num())
+            {
+                AddMesh(View.Key, View.Value->VertexBuffers, View.Value->IndexBuffer, View.Value->VertexFactory, MaterialProxy, bWireframe, Collector);
+            }
+        }
+    }
+
+    // The game thread's camera sample against the view actually drawn, with or
+    // without late latching.  Without, that's how far off the conics are; with,
+    // it's how far off they'd have been.  The time from the sample to the
+    // latch is what latching saves.
+    void RecordCameraLatency(const FSceneView& DrawnView) const
+    {
+        CameraLatencyMs.store((float)FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - SampleCycles), std::memory_order_relaxed);
+        LateLatchSavedMs.store((float)FPlatformTime::ToMilliseconds64(LatchCycles.load(std::memory_order_relaxed) - SampleCycles), std::memory_order_relaxed);
+        CameraEyeError.store((float)FVector::Dist(SampledEye, DrawnView.ViewMatrices.GetViewOrigin()), std::memory_order_relaxed);
+    }
+
     UMaterialInterface* Material;
 
     FStaticMeshVertexBuffers VertexBuffers;
     FDynamicMeshIndexBuffer32 IndexBuffer;
+    TArray<FDynamicMeshVertex> LineVertices;
+    FConicTessellationWorkspace Workspace;
     FLocalVertexFactory VertexFactory;
 
     FMaterialRelevance MaterialRelevance;
     uint32 MaxOrbits;
     uint32 LinesPerSegment;
     float LineThickness;
+    FConicLod Lod;
+
+    // Late latch mode state
+    bool bLateLatch = false;
+    FOrbitProjectionView ProjectionView;
+    TArray<FOrbitItem> Orbits;
+    TSharedPtr<const FOrbitBoundingVolumes, ESPMode::ThreadSafe> OrbitBounds;
+    TSharedPtr<const FOrbitPlaneFamilies, ESPMode::ThreadSafe> OrbitFamilies;
+    mutable TArray<TUniquePtr<FConicViewGeometry>> ViewGeometries;
+    mutable FCriticalSection ViewGeometryLock;
+
+    // When and where the game thread sampled the camera, and when the render
+    // thread latched the view (the same, without late latching)
+    uint64 SampleCycles = 0;
+    mutable std::atomic<uint64> LatchCycles { 0 };
+    FVector SampledEye = FVector::ZeroVector;
+
+    // Read by the component on the game thread
+    mutable std::atomic<float> CameraLatencyMs { 0.f };
+    mutable std::atomic<float> LateLatchSavedMs { 0.f };
+    mutable std::atomic<float> CameraEyeError { 0.f };
 };
 
  
@@ -252,8 +544,40 @@ void UConicRendererComponent::TickComponent(float DeltaTime, ELevelTick TickType
 {
     Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
+    // Each view needs its own projection, and only the render thread knows them
+    if (bLateLatchProjection || IsMultiView())
+    {
+        if (SceneProxy)
+        {
+            FConicRendererSceneProxy* ConicRendererSceneProxy = (FConicRendererSceneProxy*)SceneProxy;
+            ConicRendererSceneProxy->GetCameraLatency(CameraLatencyMs, LateLatchSavedMs, CameraEyeError);
+
+            // Frame mapping and plane distance, the camera itself is replaced on the render thread
+            FOrbitProjectionView View;
+            Projector->GetProjectionView(View);
+            TArray<FOrbitItem> Orbits = Projector->OrbitArray;
+            TSharedPtr<const FOrbitBoundingVolumes, ESPMode::ThreadSafe> OrbitBounds = Projector->GetOrbitBounds();
+            TSharedPtr<const FOrbitPlaneFamilies, ESPMode::ThreadSafe> OrbitFamilies = Projector->GetOrbitFamilies();
+
+            // The same camera sample the other path projects with, for the latency
+            FVector CameraLocation = OrbitCamera->GetComponentLocation();
+            uint64 CameraSampleCycles = FPlatformTime::Cycles64();
+
+            ENQUEUE_RENDER_COMMAND(FConicRendererSceneProxy)(
+                [ConicRendererSceneProxy, View, Orbits, OrbitBounds, OrbitFamilies, CameraLocation, CameraSampleCycles](FRHICommandListImmediate& RHICmdList)
+                {
+                    ConicRendererSceneProxy->SetOrbits_RenderThread(View, Orbits, OrbitBounds, OrbitFamilies, CameraLocation, CameraSampleCycles);
+                });
+        }
+        return;
+    }
+
+    // (And the camera they're for, which async projection leaves a frame behind)
     TArray<FConicSection> Conics;
-    Projector->GetConics(Conics);
+    FVector CameraLocation;
+    FVector CameraDirection;
+    uint64 CameraSampleCycles;
+    Projector->GetConics(Conics, CameraLocation, CameraDirection, CameraSampleCycles);
 
 #if defined(RENDER_DEBUG_LINES) && RENDER_DEBUG_LINES==1
     for (auto Conic : Conics)
@@ -271,15 +595,14 @@ void UConicRendererComponent::TickComponent(float DeltaTime, ELevelTick TickType
         // The Render proxy is recreated when PIE is running and a value is changed in the editor, though,
         // so tuning points like Line Thicknesses, etc, can be set in the Proxy's constructor instead
         // of passed in the render thread command here.
-        FVector CameraLocation = OrbitCamera->GetComponentLocation();
-        FVector CameraDirection = OrbitCamera->GetForwardVector();
         FMatrix Transform = GetComponentTransform().ToMatrixWithScale();
         FConicRendererSceneProxy* ConicRendererSceneProxy = (FConicRendererSceneProxy*)SceneProxy;
+        ConicRendererSceneProxy->GetCameraLatency(CameraLatencyMs, LateLatchSavedMs, CameraEyeError);
 
         ENQUEUE_RENDER_COMMAND(FConicRendererSceneProxy)(
-            [ConicRendererSceneProxy, CameraLocation, CameraDirection, Conics, Transform](FRHICommandListImmediate& RHICmdList)
+            [ConicRendererSceneProxy, CameraLocation, CameraDirection, Conics, Transform, CameraSampleCycles](FRHICommandListImmediate& RHICmdList)
             {
-                ConicRendererSceneProxy->TesselateConics_RenderThread(CameraLocation, CameraDirection, Conics, Transform);
+                ConicRendererSceneProxy->TesselateConics_RenderThread(CameraLocation, CameraDirection, Conics, Transform, CameraSampleCycles);
             });
     }
 }
@@ -287,12 +610,184 @@ void UConicRendererComponent::TickComponent(float DeltaTime, ELevelTick TickType
 // What do we want?  SCENE PROXIES!
 // When do we want them?  NOW!
 // [Repeat until fullfillment]
+bool UConicRendererComponent::IsMultiView() const
+{
+    if (GEngine && GEngine->IsStereoscopic3D())
+    {
+        return true;
+    }
+
+    const UWorld* World = GetWorld();
+    const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+    return GameInstance && GameInstance->GetNumLocalPlayers() > 1;
+}
+
+
 FPrimitiveSceneProxy* UConicRendererComponent::CreateSceneProxy()
 {
-    FPrimitiveSceneProxy* Proxy = new FConicRendererSceneProxy(this, MaxOrbits, LinesPerConicSegment, LineThickness);
+    FPrimitiveSceneProxy* Proxy = new FConicRendererSceneProxy(this, MaxOrbits, LinesPerConicSegment, LineThickness, GetLod());
     return Proxy;
 }
 
+
+FConicLod UConicRendererComponent::GetLod() const
+{
+    FConicLod Lod;
+    Lod.bEnabled = bScreenSizeLod;
+    Lod.MinPixels = LodMinPixels;
+    Lod.LoopPixels = LodLoopPixels;
+    Lod.LoopLines = FMath::Max(LodLoopLines, 3u);
+    Lod.TolerancePixels = FMath::Max(LodTolerancePixels, 0.01f);
+    Lod.bAdaptive = bAdaptiveTessellation;
+    Lod.bBezier = bBezierTessellation;
+    return Lod;
+}
+
+
+// Screen size LOD.
+// Stepping an ellipse's parameter by d strays from it by at most a * d^2 / 8
+// (a = the semi-major axis), so a whole ellipse needs pi * sqrt(a / 2 tol)
+// lines to stay within tol of it.  Everything here's in pixels.
+// Hyperbolas go off screen, and are always drawn with LinesPerSegment.
+uint32 UConicRendererComponent::GetLinesPerSegment(const FConicSection& Conic, float SegmentLength, uint32 LinesPerSegment, const FConicLod& Lod)
+{
+    if (!Lod.bEnabled || Conic.ConicType != ES_ConicType::Ellipse)
+    {
+        return LinesPerSegment;
+    }
+
+    const float Across = 2.f * Conic.ScreenRadius;
+
+    if (Across < Lod.MinPixels)
+    {
+        return 0;
+    }
+
+    const float LinesPerEllipse = Across < Lod.LoopPixels
+        ? (float)Lod.LoopLines
+        : pi<float> * FMath::Sqrt(Conic.ScreenRadius / (2.f * Lod.TolerancePixels));
+
+    const float Lines = FMath::CeilToFloat(LinesPerEllipse * FMath::Abs(SegmentLength) / twopi<float>);
+
+    return (uint32)FMath::Clamp(Lines, 1.f, (float)LinesPerSegment);
+}
+
+
+static Vector3<double> ToVector3(const FVector& V)
+{
+    return Vector3<double>{ V.X, V.Y, V.Z };
+}
+
+
+// The unit conic to step along, NotVisible if it isn't one
+static ProjectionType GetProjectionType(ES_ConicType ConicType)
+{
+    switch (ConicType)
+    {
+    case ES_ConicType::Ellipse: return ProjectionType::Ellipse;
+    case ES_ConicType::PositiveHyperbola: return ProjectionType::PositiveHyperbola;
+    case ES_ConicType::NegativeHyperbola: return ProjectionType::NegativeHyperbola;
+    default: return ProjectionType::NotVisible;
+    }
+}
+
+
+// Adaptive LOD spaces the vertices by the conic's curvature instead (see
+// ConicTessellation.h), for the same tolerance, up to LinesPerSegment.  It
+// needs fewer lines than evenly spaced ones do, and it handles hyperbolas.
+// Ellipses too small to draw, or just drawn as loops, are left to
+// GetLinesPerSegment.
+// Evenly spaced lines are stepped along the conic's rational Bezier pieces
+// (see ConicBezier.h), or with the angle addition formulas (see
+// TessellateConicLines.h), rather than calling sin/cos for every vertex.
+void UConicRendererComponent::GetSegmentTessellation(const FConicSection& Conic, float SegmentStart, float SegmentLength, uint32 LinesPerSegment, const FConicLod& Lod, std::vector<float>& Params, std::vector<double>& X, std::vector<double>& Y)
+{
+    // 'Conic' defines the 2D shape of our conic section.
+    // The possibilities of 'Circle' and 'Parabola' are not supported.  These are singular special cases
+    // which are possible to contrive but do not happen in general useage.
+    const ProjectionType Type = GetProjectionType(Conic.ConicType);
+
+    const uint32 Lines = Type != ProjectionType::NotVisible ? GetLinesPerSegment(Conic, SegmentLength, LinesPerSegment, Lod) : 0;
+
+    if (!Lines)
+    {
+        Params.clear();
+        X.clear();
+        Y.clear();
+        return;
+    }
+
+    const bool bHyperbola = Type != ProjectionType::Ellipse;
+    const bool bLoop = !bHyperbola && 2.f * Conic.ScreenRadius < Lod.LoopPixels;
+
+    if (Lod.bEnabled && Lod.bAdaptive && !bLoop && Conic.PixelsPerUnit > 0.f)
+    {
+        GetConicTessellation<float>(
+            bHyperbola,
+            Conic.Axis1.Size(),
+            Conic.Axis2.Size(),
+            SegmentStart,
+            SegmentLength,
+            Lod.TolerancePixels / Conic.PixelsPerUnit,
+            (int)LinesPerSegment,
+            Params);
+
+        X.resize(Params.size());
+        Y.resize(Params.size());
+        EvaluateUnitConic(Type, Params.data(), (int)Params.size(), X.data(), Y.data());
+    }
+    else if (Lod.bBezier)
+    {
+        // The unit conic, (cos t, sin t) or +-(cosh t, sinh t): the axes scale it
+        ConicProjection<double> UnitConic;
+        UnitConic.k = Vector<2, double>{ 0., 0. };
+        UnitConic.u = Vector<2, double>{ 1., 0. };
+        UnitConic.v = Vector<2, double>{ 0., 1. };
+        UnitConic.a = 1.;
+        UnitConic.b = 1.;
+        const double Sign = Type == ProjectionType::NegativeHyperbola ? -1. : 1.;
+
+        ConicBezier<double> Pieces[ConicBezierMaxPieces];
+        const int PieceCount = GetConicBeziers(UnitConic, bHyperbola, Sign, (double)SegmentStart, (double)SegmentLength, Pieces);
+
+        // The lines shared out between the (equal) pieces.  Each piece starts
+        // where the last one ended, on top of its last point.
+        const uint32 TotalLines = FMath::Max(Lines, (uint32)PieceCount);
+        Params.resize(TotalLines + 1);
+        X.resize(TotalLines + 1);
+        Y.resize(TotalLines + 1);
+
+        uint32 First = 0;
+        for (int i = 0; i < PieceCount; ++i)
+        {
+            const uint32 Next = (uint32)(i + 1) * TotalLines / (uint32)PieceCount;
+            const uint32 PieceLines = Next - First;
+
+            TessellateConicBezier(Pieces[i], (int)PieceLines, &X[First], &Y[First]);
+
+            // (Evenly spaced s is within 1% of the piece of evenly spaced t,
+            // plenty for the advancement)
+            for (uint32 j = 0; j <= PieceLines; ++j)
+            {
+                Params[First + j] = (float)(Pieces[i].start + Pieces[i].length * (double)j / (double)PieceLines);
+            }
+
+            First = Next;
+        }
+    }
+    else
+    {
+        Params.resize(Lines + 1);
+        X.resize(Lines + 1);
+        Y.resize(Lines + 1);
+        for (uint32 i = 0; i <= Lines; ++i)
+        {
+            Params[i] = SegmentStart + SegmentLength * (float)i / (float)Lines;
+        }
+        EvaluateUnitConicEvenly(Type, (double)SegmentStart, (double)SegmentLength, (int)Lines, X.data(), Y.data());
+    }
+}
+
 int32 UConicRendererComponent::GetNumMaterials() const
 {
     return 1;
@@ -327,63 +822,138 @@ void UConicRendererComponent::Tessellate(
     const TArray <FConicSection>& Conics,
     float LineThickness,
     uint32 LinesPerSegment,
+    const FConicLod& Lod,
+    FConicTessellationWorkspace& Workspace,
     TArray<FDynamicMeshVertex>& LineVertices,
     TArray<uint32>& LineIndices,
     int MaxOrbits
 )
 {
-    LineVertices.Empty();
-    LineIndices.Empty();
-
-    int nCountOfOrbits = Conics.Num();
-    
-    // We don't handle more than a static number of orbits, but the least we can do is
-    // log an error for the case and not crash.
-    // There are innumerable alternatives.  Please feel free to spend your own time implementing
-    // the one of your choice :-D.
-    if (nCountOfOrbits > MaxOrbits)
-    {
-        static bool AlreadyLoggedMaxOrbitError = false;
-        if (!AlreadyLoggedMaxOrbitError)
+    LineVertices.Reset();
+    LineIndices.Reset();
+
+    // Once, rather than for every vertex
+    const FMatrix WorldToLocal = LocalToWorld.Inverse();
+
+    // The segments to draw, in order.  Whether a segment's drawn at all only
+    // takes GetLinesPerSegment, so MaxOrbits is settled before any real work.
+    std::vector<FConicSegmentTessellation>& Segments = Workspace.Segments;
+    int32 SegmentCount = 0;
+
+    // Only the orbits that are big enough to draw count against MaxOrbits
+    int nCountOfOrbits = 0;
+
+    for (int i = 0; i < Conics.Num(); ++i)
+    {
+        // We don't handle more than a static number of orbits, but the least we can do is
+        // log an error for the case and not crash.
+        // There are innumerable alternatives.  Please feel free to spend your own time implementing
+        // the one of your choice :-D.
+        if (nCountOfOrbits >= MaxOrbits)
         {
-            UE_LOG(LogTemp, Error, TEXT("MaxOrbits = %d, but there are %d orbits rendering.  Increase MaxOrbits on Pawn's ConicRendererComponent to fix this."), MaxOrbits, Conics.Num());
-            AlreadyLoggedMaxOrbitError = true;
+            static bool AlreadyLoggedMaxOrbitError = false;
+            if (!AlreadyLoggedMaxOrbitError)
+            {
+                UE_LOG(LogTemp, Error, TEXT("MaxOrbits = %d, but there are more orbits rendering.  Increase MaxOrbits on Pawn's ConicRendererComponent to fix this."), MaxOrbits);
+                AlreadyLoggedMaxOrbitError = true;
+            }
+            break;
+        }
+
+        const FConicSection& Conic = Conics[i];
+        if (GetProjectionType(Conic.ConicType) == ProjectionType::NotVisible) continue;
+
+        bool bDrawn = false;
+        for (int32 j = 0; j < Conic.Segments.Num(); ++j)
+        {
+            if (!GetLinesPerSegment(Conic, Conic.Segments[j].Y, LinesPerSegment, Lod)) continue;
+
+            if (Segments.size() <= (size_t)SegmentCount)
+            {
+                Segments.emplace_back();
+            }
+
+            Segments[SegmentCount].Conic = i;
+            Segments[SegmentCount].Segment = j;
+            ++SegmentCount;
+            bDrawn = true;
+        }
+
+        if (bDrawn)
+        {
+            ++nCountOfOrbits;
         }
-        nCountOfOrbits = MaxOrbits;
     }
 
-    for (int i = 0; i < nCountOfOrbits; ++i)
+    // Where each segment's vertices go, which is how many it takes, too
+    ParallelFor(SegmentCount, [&](int32 s)
+        {
+            FConicSegmentTessellation& Segment = Segments[s];
+            const FConicSection& Conic = Conics[Segment.Conic];
+            const FVector2D& Range = Conic.Segments[Segment.Segment];
+            GetSegmentTessellation(Conic, Range.X, Range.Y, LinesPerSegment, Lod, Segment.Params, Segment.X, Segment.Y);
+        });
+
+    // Each segment gets its own slice of the output, by a running sum of
+    // their vertices and indices, in order
+    int32 VertexCount = 0;
+    int32 IndexCount = 0;
+
+    for (int32 s = 0; s < SegmentCount; ++s)
     {
-        Tessellate(LocalToWorld, CameraPosition, CameraDirection, Conics[i], LineThickness, LinesPerSegment, LineVertices, LineIndices);
+        FConicSegmentTessellation& Segment = Segments[s];
+        const int32 Count = (int32)Segment.X.size();
+
+        Segment.FirstVertex = VertexCount;
+        Segment.FirstIndex = IndexCount;
+
+        if (Count > 1)
+        {
+            VertexCount += 2 * Count;
+            IndexCount += 6 * (Count - 1);
+        }
     }
-}
 
+    LineVertices.SetNumUninitialized(VertexCount);
+    LineIndices.SetNumUninitialized(IndexCount);
 
-void UConicRendererComponent::Tessellate(
-    const FMatrix& LocalToWorld,
-    const FVector& CameraPosition,
-    const FVector& CameraDirection,
-    const FConicSection& Conic,
-    float LineThickness,
-    uint32 LinesPerSegment,
-    TArray<FDynamicMeshVertex>& LineVertices,
-    TArray<uint32>& LineIndices
-)
-{
-    const int segmentCount = Conic.Segments.Num();
-    
-    for (int i = 0; i < segmentCount; ++i)
+    if (!SegmentCount)
+    {
+        return;
+    }
+
+    // Then they're filled in in parallel, each worker taking every Workers'th
+    // segment with its own scratch
+    const int32 Workers = FMath::Clamp(FTaskGraphInterface::Get().GetNumWorkerThreads() + 1, 1, SegmentCount);
+
+    if (Workspace.Scratches.size() < (size_t)Workers)
     {
-        Tessellate(Conic.AdvancementState, LocalToWorld, CameraPosition, CameraDirection, Conic.ConicType, Conic.Color, Conic.Center, Conic.Axis1, Conic.Axis2, Conic.OrbitalPlaneCenter, Conic.OrbitalPlaneNormal, LineThickness, LinesPerSegment, Conic.Segments[i].X, Conic.Segments[i].Y, Conic.TrueAnomalies[i].X, Conic.TrueAnomalies[i].Y, LineVertices, LineIndices);
+        Workspace.Scratches.resize(Workers);
     }
+
+    ParallelFor(Workers, [&](int32 Worker)
+        {
+            FConicTessellationScratch& Scratch = Workspace.Scratches[Worker];
+
+            for (int32 s = Worker; s < SegmentCount; s += Workers)
+            {
+                const FConicSegmentTessellation& Segment = Segments[s];
+
+                if (Segment.X.size() > 1)
+                {
+                    const FConicSection& Conic = Conics[Segment.Conic];
+                    const int32 j = Segment.Segment;
+                    Tessellate(Conic.AdvancementState, WorldToLocal, CameraPosition, CameraDirection, Conic.Color, Conic.Center, Conic.Axis1, Conic.Axis2, Conic.OrbitalPlaneCenter, Conic.OrbitalPlaneNormal, LineThickness, Segment, Scratch, Conic.Segments[j].X, Conic.Segments[j].Y, Conic.TrueAnomalies[j].X, Conic.TrueAnomalies[j].Y, LineVertices.GetData(), LineIndices.GetData());
+                }
+            }
+        });
 }
 
 void UConicRendererComponent::Tessellate(
     const float AdvancementState,
-    const FMatrix& LocalToWorld,
+    const FMatrix& WorldToLocal,
     const FVector& CameraPosition,
     const FVector& CameraDirection,
-    ES_ConicType ConicType,
     const FColor& Color,
     const FVector& Center,
     const FVector& Axis1,
@@ -391,114 +961,102 @@ void UConicRendererComponent::Tessellate(
     const FVector& OrbitPlaneCenter,
     const FVector& OrbitPlaneNormal,
     float LineThickness,
-    uint32 LinesPerSegment,
+    const FConicSegmentTessellation& Segment,
+    FConicTessellationScratch& Scratch,
     float SegmentStart,
     float SegmentLength,
     float TrueAnomalyStart,
     float TrueAnomalyLength,
-    TArray<FDynamicMeshVertex>& LineVertices,
-    TArray<uint32>& LineIndices
+    FDynamicMeshVertex* LineVertices,
+    uint32* LineIndices
 )
 {
+    // Segment.X, Y are on the unit conic (see GetSegmentTessellation), the
+    // axes scale them.  The vertices and indices go in the segment's own
+    // slices of LineVertices and LineIndices.
+    const int Count = (int)Segment.X.size();
 
-    // 'Conic' defines the 2D shape of our conic section.
-    // The possibilities of 'Circle' and 'Parabola' are not supported.  These are singular special cases
-    // which are possible to contrive but do not happen in general useage.
-    FVector2D(*Conic)(float theta) = nullptr;
-
-
-    switch (ConicType)
-    {
-    case ES_ConicType::Ellipse:
-        Conic = UConicRendererComponent::Ellipse;
-        break;
-    case ES_ConicType::NegativeHyperbola:
-        Conic = UConicRendererComponent::NegativeHyperbola;
-        break;
-    case ES_ConicType::PositiveHyperbola:
-        Conic = UConicRendererComponent::PositiveHyperbola;
-        break;
-    }
-
-    if (Conic != nullptr)
+    if (Count > 1)
     {
         // The is not the greatest line tessellator in the world.   (It's just a tribute.)
         // There's a tradeoff between feeding the processor excessive computational gymnastics,
         // conceptual clarity, and tessellation perfection with many possible solutions each
         // optimized differently.
-        float cumulativeDistance = 0;
+
+        // So, like...  The vertices are treated as if they're in local space to the renderer...
+        // which, we've attached to the camera and we're moving it all around.
+        // But, we've computed them in world space... So, we need to handle this one way or another.
+        // Moving them from the local space of the (moving) renderer to world space is fine for now.
+        // Otherwise, we'd have to guarantee the local to world transform for it is identity, or
+        // handle this in a vertex shader, or .... bleh.
+
+        // It's kinda rediculous because in a way we're going from world space to clip space to world space to clip space
+        // TODO: Fix that.
+
+        // Both are affine, so they're composed once here rather than for
+        // every vertex (see TessellateConicLines.h)
+        const FVector TangentZ = CameraDirection.GetSafeNormal();
+        const FVector Across1 = Axis1 ^ TangentZ;
+        const FVector Across2 = Axis2 ^ TangentZ;
+
+        ConicLineFrame<double> Frame;
+        Frame.Axis1 = ToVector3(Axis1);
+        Frame.Axis2 = ToVector3(Axis2);
+        Frame.Across1 = ToVector3(Across1);
+        Frame.Across2 = ToVector3(Across2);
+        Frame.LocalCenter = ToVector3(WorldToLocal.TransformPosition(Center));
+        Frame.LocalAxis1 = ToVector3(WorldToLocal.TransformVector(Axis1));
+        Frame.LocalAxis2 = ToVector3(WorldToLocal.TransformVector(Axis2));
+        Frame.LocalAcross1 = ToVector3(WorldToLocal.TransformVector(Across1));
+        Frame.LocalAcross2 = ToVector3(WorldToLocal.TransformVector(Across2));
+        Frame.HalfThickness = LineThickness * 0.5;
+
+        ConicLineVertices<double>& Lines = Scratch.Lines;
+        TessellateConicLines(Frame, Segment.X.data(), Segment.Y.data(), Count, Lines);
+
+        // The vertices needn't be evenly spaced (see GetSegmentTessellation.)
+        // The true anomaly's interpolated between the segment's ends, same as
+        // it always was.
+        const float anomalyPerTheta = SegmentLength != 0.f ? TrueAnomalyLength / SegmentLength : 0.f;
+
         FDynamicMeshVertex Vertex;
         Vertex.Color = Color;
 
-        float thetaA = SegmentStart;
-        float advancementAngle = TrueAnomalyStart;
-        FVector2D c0 = Conic(thetaA);
-        FVector A = Center + c0.X * Axis1 + c0.Y * Axis2;
-        float segmentLength = SegmentLength / (float)LinesPerSegment;
-        float anomalyLength = TrueAnomalyLength / (float)LinesPerSegment;
+        FDynamicMeshVertex* OutVertex = LineVertices + Segment.FirstVertex;
+        uint32* OutIndex = LineIndices + Segment.FirstIndex;
 
-        for (uint32 i = 0; i <= LinesPerSegment; ++i)
+        for (int i = 0; i < Count; ++i)
         {
-            int baseIndex = LineVertices.Num();
-
-            float thetaB = thetaA + segmentLength;
-            FVector2D c1 = Conic(thetaB);
-
-            FVector B = Center + c1.X * Axis1 + c1.Y * Axis2;
-
-            FVector AtoB = B - A;
+            int baseIndex = Segment.FirstVertex + 2 * i;
 
-            const FVector TangentX = AtoB.GetSafeNormal();
-            const FVector TangentZ = CameraDirection.GetSafeNormal();
-            const FVector TangentY = (TangentX ^ TangentZ).GetSafeNormal();
-
-            Vertex.SetTangents((FVector3f)TangentX, (FVector3f)TangentY, (FVector3f)TangentZ);
-
-            FVector Perp = TangentY;
-            Perp *= LineThickness * 0.5f;
+            Vertex.SetTangents(
+                FVector3f((float)Lines.TangentX[0][i], (float)Lines.TangentX[1][i], (float)Lines.TangentX[2][i]),
+                FVector3f((float)Lines.TangentY[0][i], (float)Lines.TangentY[1][i], (float)Lines.TangentY[2][i]),
+                (FVector3f)TangentZ);
 
+            const float advancementAngle = TrueAnomalyStart + (Segment.Params[i] - SegmentStart) * anomalyPerTheta;
             float AdvancementCoordinate = FMath::Clamp(advancementAngle / twopi<float>, 0.1f, 1.f);
+            const float cumulativeDistance = (float)Lines.Distance[i];
 
-            // So, like...  The vertices are treated as if they're in local space to the renderer...
-            // which, we've attached to the camera and we're moving it all around.
-            // But, we've computed them in world space... So, we need to handle this one way or another.
-            // Moving them from the local space of the (moving) renderer to world space is fine for now.
-            // Otherwise, we'd have to guarantee the local to world transform for it is identity, or
-            // handle this in a vertex shader, or .... bleh.
-
-            // It's kinda rediculous because in a way we're going from world space to clip space to world space to clip space
-            // TODO: Fix that.
-
-            // For clarity:
-            const FVector WorldProjectionPlanePositionA1 = A + Perp;
-            const FVector LocalPositionA1 = LocalToWorld.InverseTransformPosition(WorldProjectionPlanePositionA1);
-            Vertex.Position = (FVector3f)LocalPositionA1;
+            Vertex.Position = FVector3f((float)Lines.Left[0][i], (float)Lines.Left[1][i], (float)Lines.Left[2][i]);
             Vertex.TextureCoordinate[0] = FVector2f(cumulativeDistance, 1);
             Vertex.TextureCoordinate[1] = FVector2f(AdvancementCoordinate, 1);
-            LineVertices.Add(Vertex);
+            *OutVertex++ = Vertex;
 
-            const FVector WorldProjectionPlanePositionA2 = A - Perp;
-            const FVector LocalPositionA2 = LocalToWorld.InverseTransformPosition(WorldProjectionPlanePositionA2);
-            Vertex.Position = (FVector3f)LocalPositionA2;
+            Vertex.Position = FVector3f((float)Lines.Right[0][i], (float)Lines.Right[1][i], (float)Lines.Right[2][i]);
             Vertex.TextureCoordinate[0] = FVector2f(cumulativeDistance, 0);
             Vertex.TextureCoordinate[1] = FVector2f(AdvancementCoordinate, 0);
-            LineVertices.Add(Vertex);
-
-            cumulativeDistance += AtoB.Size();
+            *OutVertex++ = Vertex;
 
             if (i > 0)
             {
-                LineIndices.Add(baseIndex + 1 - 2);
-                LineIndices.Add(baseIndex + 2 - 2);
-                LineIndices.Add(baseIndex + 0 - 2);
-                LineIndices.Add(baseIndex + 3 - 2);
-                LineIndices.Add(baseIndex + 1 - 2);
-                LineIndices.Add(baseIndex + 2 - 2);
+                *OutIndex++ = baseIndex + 1 - 2;
+                *OutIndex++ = baseIndex + 2 - 2;
+                *OutIndex++ = baseIndex + 0 - 2;
+                *OutIndex++ = baseIndex + 3 - 2;
+                *OutIndex++ = baseIndex + 1 - 2;
+                *OutIndex++ = baseIndex + 2 - 2;
             }
-
-            A = B;
-            thetaA += segmentLength;
-            advancementAngle += anomalyLength;
         }
     }
 }
@@ -517,21 +1075,6 @@ FVector UConicRendererComponent::ProjectToOrbitalPlane(const FVector& P1, const
 }
 
 
-FVector2D UConicRendererComponent::Ellipse(float theta)
-{
-    return FVector2D(cos(theta), sin(theta));
-}
-
-FVector2D UConicRendererComponent::PositiveHyperbola(float theta)
-{
-    return FVector2D(cosh(theta), sinh(theta));
-}
-
-FVector2D UConicRendererComponent::NegativeHyperbola(float theta)
-{
-    return FVector2D(-cosh(theta), -sinh(theta));
-}
-
 void UConicRendererComponent::DrawDebug(const FConicSection& conic)
 {
 #if defined(RENDER_DEBUG_LINES) && RENDER_DEBUG_LINES==1
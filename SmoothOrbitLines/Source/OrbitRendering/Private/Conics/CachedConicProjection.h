@@ -0,0 +1,114 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+
+//-----------------------------------------------------------------------------
+// CachedConicProjection
+// Reusing an orbit's image conic, and its clipping, from an earlier view.
+// Turning (or rolling) the camera doesn't move the image (it's on the same
+// rays from the eye), it only moves the frustum's edges across it, by at most
+// the angle turned; the clipping was to a guard band (see GuardBandFrustum),
+// so that's good until the band's edges come into view.
+// Moving the eye does move the image.  The cached plane is carried along with
+// the eye, so the image is off by the orbit's own parallax, at most the
+// distance moved over the distance to the orbit's nearest point.
+// See ReadMe.txt for more information.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "GTE/Mathematics/Vector3.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace gte;
+
+#include "Conics.h"
+#include "ProjectEllipseToPlaneClosedForm.h"
+
+
+// The plane of cached, carried along with the eye to eye
+template<class T>
+EllipseProjectionView<T> CarryProjectionView(const EllipseProjectionView<T>& cached, const Vector3<T>& eye)
+{
+    EllipseProjectionView<T> view;
+    view.E = eye;
+    view.Cp = cached.Cp + (eye - cached.E);
+    view.Np = cached.Np;
+    view.Up = cached.Up;
+    view.Vp = cached.Vp;
+    return view;
+}
+
+
+// How far (radians) the camera turned, rolling included: the angle of the
+// rotation from one (direction, up) frame to the other.  No ray through the
+// frustum turns further.
+template<class T>
+T GetCameraRotation(const Vector3<T>& fromDirection, const Vector3<T>& fromUp, const Vector3<T>& toDirection, const Vector3<T>& toUp)
+{
+    Vector3<T> from[3], to[3];
+    from[0] = fromDirection;
+    to[0] = toDirection;
+    Normalize(from[0]);
+    Normalize(to[0]);
+    from[1] = UnitCross(from[0], fromUp);
+    to[1] = UnitCross(to[0], toUp);
+    from[2] = Cross(from[1], from[0]);
+    to[2] = Cross(to[1], to[0]);
+
+    // The rotation's trace is 1 + 2 cos(angle), its skew part sin(angle)
+    Vector3<T> skew = Vector3<T>::Zero();
+    T trace = (T)0;
+    for (int i = 0; i < 3; ++i)
+    {
+        skew += Cross(from[i], to[i]);
+        trace += Dot(from[i], to[i]);
+    }
+
+    return std::atan2((T)0.5 * Length(skew), (T)0.5 * (trace - (T)1));
+}
+
+
+// Is an orbit's image, projected looking along cachedDirection (cachedUp up)
+// from cachedEye, within tolerance (radians) of what looking along direction
+// from eye would give?  The camera can turn guardBandRadians further before
+// the frustum leaves what was clipped.  The orbit is its focus, center, first
+// (semi-major) axis and normal.
+template<class T>
+bool IsCachedProjectionCurrent(
+    const Vector3<T>& cachedEye,
+    const Vector3<T>& cachedDirection,
+    const Vector3<T>& cachedUp,
+    const Vector3<T>& eye,
+    const Vector3<T>& direction,
+    const Vector3<T>& up,
+    const Vector3<T>& focus,
+    const Vector3<T>& center,
+    const Vector3<T>& axis1,
+    const Vector3<T>& normal,
+    T tolerance,
+    T guardBandRadians
+)
+{
+    const T rotation = GetCameraRotation(cachedDirection, cachedUp, direction, up);
+
+    const Vector3<T> translation = eye - cachedEye;
+    T parallax = (T)0;
+
+    if (translation != Vector3<T>::Zero())
+    {
+        const Vector3<T> fromFocus = eye - focus;
+        const T apoapsis = Length(center - focus) + Length(axis1);
+        const T nearest = std::max(Length(fromFocus) - apoapsis, std::abs(Dot(fromFocus, normal)));
+
+        if (nearest <= (T)0)
+        {
+            return false;
+        }
+
+        parallax = Length(translation) / nearest;
+    }
+
+    // Parallax distorts the image, turning only moves the edges
+    return parallax <= tolerance && rotation + parallax <= tolerance + guardBandRadians;
+}
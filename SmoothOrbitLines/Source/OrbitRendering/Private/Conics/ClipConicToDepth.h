@@ -0,0 +1,150 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+
+//-----------------------------------------------------------------------------
+// ClipConicToDepth
+// Near and far clipping, for the image conic of an orbit (C, N) that comes
+// close to the eye (or passes behind it, where the image is a hyperbola whose
+// ends run off to infinity.)
+// The near (or far) plane meets the orbit's plane in a line, and the image of
+// that line is a line on the projection plane too.  Looking along the eye's
+// ray through the plane's point Cp + p, the orbit point's depth is
+//      z (W.N) / (D.N - z (Np.N)),   W = C - E,   D = p.x Up.N + p.y Vp.N
+// which is past near where D.N is, so near and far are just two more sides
+// of a ClipPolygon (see ClipEllipseToPolygon / ClipHyperbolaToPolygon.)
+// Orthographic views are the same, along -Np from the plane.
+// Only orbits that actually reach nearer than near (or further than far) need
+// it, see OrbitCrossesDepthRange, everything else clips to the rectangle.
+// See ReadMe.txt for more information.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "GTE/Mathematics/Vector2.h"
+#include "GTE/Mathematics/Vector3.h"
+#include <cmath>
+
+using namespace gte;
+
+#include "Conics.h"
+#include "ProjectEllipseToPlaneClosedForm.h"
+
+
+// Does the orbit C + A cos(t) U + B sin(t) V get any nearer than nearDepth,
+// or further than farDepth?  (Depth along -Np from the eye.  No far, if it's
+// not positive.)
+template<class T>
+bool OrbitCrossesDepthRange(
+    const EllipseProjectionView<T>& view,
+    const Vector3<T>& C,
+    const Vector3<T>& U,
+    const Vector3<T>& V,
+    T A, T B,
+    T nearDepth,
+    T farDepth
+)
+{
+    const T depth = Dot(view.Np, view.E - C);
+    const T alpha = A * Dot(view.Np, U);
+    const T beta = B * Dot(view.Np, V);
+    const T swing = std::sqrt(alpha * alpha + beta * beta);
+
+    return depth - swing < nearDepth || (farDepth > (T)0 && depth + swing > farDepth);
+}
+
+
+// Add the images of the near and far planes, on the orbit's plane (C, N), to
+// polygon as sides.  False if there isn't room, or the orbit's edge on (its
+// image is a line, and there's nothing to clip.)
+template<class T>
+bool AddDepthClipSides(
+    const EllipseProjectionView<T>& view,
+    bool orthographic,
+    const Vector3<T>& C,
+    const Vector3<T>& N,
+    T nearDepth,
+    T farDepth,
+    ClipPolygon<T>& polygon
+)
+{
+    if (polygon.SideCount + 2 > ClipPolygon<T>::MaxSides)
+    {
+        return false;
+    }
+
+    const bool bFar = farDepth > (T)0;
+    const T z = Dot(view.Np, view.E - view.Cp);
+    const T gx = Dot(N, view.Up);
+    const T gy = Dot(N, view.Vp);
+    const T w = Dot(N, view.Np);
+
+    if (orthographic)
+    {
+        // depth = z - (h - g.p) / w, h = N.(C - Cp)
+        if (w == (T)0) return false;
+
+        const T sign = w > (T)0 ? (T)1 : (T)-1;
+        const T h = Dot(N, C - view.Cp);
+
+        if (nearDepth > (T)0)
+        {
+            polygon.AddSide(-sign * gx, -sign * gy, std::abs(w) * (z - nearDepth) - sign * h);
+        }
+        if (bFar)
+        {
+            polygon.AddSide(sign * gx, sign * gy, sign * h - std::abs(w) * (z - farDepth));
+        }
+    }
+    else
+    {
+        // depth = z c / (g.p - z w), c = N.(C - E)
+        const T c = Dot(N, C - view.E);
+        if (c == (T)0) return false;
+
+        const T sign = c > (T)0 ? (T)1 : (T)-1;
+
+        if (nearDepth > (T)0)
+        {
+            polygon.AddSide(sign * gx, sign * gy, z * (std::abs(c) / nearDepth + sign * w));
+        }
+        if (bFar)
+        {
+            polygon.AddSide(-sign * gx, -sign * gy, -z * (std::abs(c) / farDepth + sign * w));
+        }
+    }
+
+    return true;
+}
+
+
+// What to clip an orbit's image to, if the orbit crosses the near or far
+// plane: region (or, without one, the frustum's rectangle) with the depth
+// sides added.  False if it doesn't need them (or they can't be added), and
+// whatever it'd be clipped to anyway will do.
+template<class T>
+bool GetDepthClipRegion(
+    const EllipseProjectionInputs<T>& inputs,
+    const FrustumParameters<T>& frustum,
+    bool orthographic,
+    const ClipPolygon<T>* region,
+    T nearDepth,
+    T farDepth,
+    ClipPolygon<T>& depthRegion
+)
+{
+    if (nearDepth <= (T)0 && farDepth <= (T)0)
+    {
+        return false;
+    }
+
+    const EllipseProjectionView<T> view{ inputs.E, inputs.Cp, inputs.Np, inputs.Up, inputs.Vp };
+
+    if (!OrbitCrossesDepthRange(view, inputs.Ce, inputs.Ue, inputs.Ve, inputs.A, inputs.B, nearDepth, farDepth))
+    {
+        return false;
+    }
+
+    depthRegion = region ? *region : ClipPolygon<T>(ClipRectangle<T>(frustum));
+
+    return AddDepthClipSides(view, orthographic, inputs.Ce, inputs.Ne, nearDepth, farDepth, depthRegion);
+}
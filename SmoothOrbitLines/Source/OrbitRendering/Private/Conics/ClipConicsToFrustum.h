@@ -0,0 +1,126 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+
+//-----------------------------------------------------------------------------
+// ClipConicsToFrustum
+// Batched ClipEllipseToFrustum / ClipHyperbolaToFrustum, for the projections
+// ProjectEllipsesToPlane leaves: the frustum's rectangle is worked out once,
+// and each lane is clipped into a ConicClip (fixed size, so the output can be
+// allocated once up front and nothing's allocated per conic.)  Lanes that
+// aren't ellipses or hyperbolas aren't visible.  Or against a ClipPolygon,
+// for views that only show part of the rectangle.  ClipConicToFrustum is one
+// lane's worth, for conics that aren't in a batch.
+// Ranges of lanes can be clipped in parallel, into the same output.
+// See ReadMe.txt for more information.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <vector>
+
+#include "Conics.h"
+#include "ClipEllipseToFrustum.h"
+#include "ClipHyperbolaToFrustum.h"
+#include "ProjectEllipsesToPlane.h"
+
+
+// One conic into clip.  Not an ellipse or a hyperbola, not visible.
+template<class T>
+void ClipConicToFrustum(
+    const ClipRectangle<T>& rectangle,
+    const ConicProjection<T>& projection,
+    ProjectionType projectionType,
+    ConicClip<T>& clip
+)
+{
+    if (projectionType == ProjectionType::Ellipse)
+    {
+        ClipEllipseToRectangle(rectangle, projection, clip);
+    }
+    else if (projectionType == ProjectionType::PositiveHyperbola || projectionType == ProjectionType::NegativeHyperbola)
+    {
+        ClipHyperbolaToRectangle(rectangle, projection, projectionType == ProjectionType::PositiveHyperbola, clip);
+    }
+    else
+    {
+        clip.SegmentCount = 0;
+        clip.Visible = false;
+    }
+}
+
+
+// One conic, against a convex region instead of the whole rectangle
+template<class T>
+void ClipConicToFrustum(
+    const ClipPolygon<T>& polygon,
+    const ConicProjection<T>& projection,
+    ProjectionType projectionType,
+    ConicClip<T>& clip
+)
+{
+    if (projectionType == ProjectionType::Ellipse)
+    {
+        ClipEllipseToPolygon(polygon, projection, clip);
+    }
+    else if (projectionType == ProjectionType::PositiveHyperbola || projectionType == ProjectionType::NegativeHyperbola)
+    {
+        ClipHyperbolaToPolygon(polygon, projection, projectionType == ProjectionType::PositiveHyperbola, clip);
+    }
+    else
+    {
+        clip.SegmentCount = 0;
+        clip.Visible = false;
+    }
+}
+
+
+// Lanes [first, last) into clips[first, last).  clips is the batch's size.
+template<class T>
+void ClipConicsToFrustum(
+    const ClipRectangle<T>& rectangle,
+    const ConicProjectionBatch<T>& projections,
+    int first,
+    int last,
+    std::vector<ConicClip<T>>& clips
+)
+{
+    for (int i = first; i < last; ++i)
+    {
+        ConicProjection<T> projection;
+        projections.getProjection(i, projection);
+        ClipConicToFrustum(rectangle, projection, projections.projectionType[i], clips[i]);
+    }
+}
+
+
+// Lanes [first, last) into clips[first, last), against a convex region
+// instead of the whole rectangle.
+template<class T>
+void ClipConicsToFrustum(
+    const ClipPolygon<T>& polygon,
+    const ConicProjectionBatch<T>& projections,
+    int first,
+    int last,
+    std::vector<ConicClip<T>>& clips
+)
+{
+    for (int i = first; i < last; ++i)
+    {
+        ConicProjection<T> projection;
+        projections.getProjection(i, projection);
+        ClipConicToFrustum(polygon, projection, projections.projectionType[i], clips[i]);
+    }
+}
+
+
+// All of them
+template<class T>
+void ClipConicsToFrustum(
+    const FrustumParameters<T>& frustum,
+    const ConicProjectionBatch<T>& projections,
+    std::vector<ConicClip<T>>& clips
+)
+{
+    clips.resize(projections.size());
+    ClipConicsToFrustum(ClipRectangle<T>(frustum), projections, 0, (int)projections.size(), clips);
+}
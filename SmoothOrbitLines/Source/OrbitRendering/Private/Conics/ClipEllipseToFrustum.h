@@ -4,11 +4,12 @@
 //-----------------------------------------------------------------------------
 // ClipEllipseToFrustum
 // Implmenentation of algoritm that clips an ellipse to a rectangle.
-// Although it is defined as a template, it is unlikley to compile for types
-// that are not used in this project (exclusively double types).
-// The implementation is not designed to be robust, is intended for
-// demonstration purposes only - not intended to be used in production.
-// This algorithm has not been optimized (performance, memory, readability, etc)
+// Works in float as well as double: everything here is in projection plane
+// coordinates, so it doesn't care whether the projection was camera-relative.
+// Nothing's allocated: the crossings are kept and sorted on the stack (see
+// ClipEvents), and ClipEllipseToRectangle takes the rectangle ready made, for
+// clipping many ellipses to one frustum (see ClipConicsToFrustum.)
+// ClipEllipseToPolygon clips to any convex region of the plane instead.
 // See ReadMe.txt for more information.
 //-----------------------------------------------------------------------------
 
@@ -29,6 +30,8 @@ using std::vector;
 
 using namespace gte;
 
+#include "ClipEvents.h"
+
 
 /*
 *   Clip a screen-space projected ellipse to the viewable area
@@ -49,9 +52,9 @@ bool ClipEllipse(T a, T b, T c, T d, bool& interceptsFustumLine, T& theta1, T& d
         // Yes, there's an intercept!  Two, in fact!
 
         // Compute the phase shift
-        T alpha = (T)atan2((double)b, (double)a);
+        T alpha = atan2(b, a);
 
-        T arcos = (T)acos(act);
+        T arcos = acos(act);
         theta1 = alpha + arcos;
         theta2 = alpha - arcos;
 
@@ -70,216 +73,174 @@ bool ClipEllipse(T a, T b, T c, T d, bool& interceptsFustumLine, T& theta1, T& d
 }
 
 
-// SegmentList - X < Y for non-wrap around segments
-//               X > Y if the segment wraps around 0   
+// An angle from alpha +/- acos (so, in [-2pi, 2pi]) into [0, 2pi)
 template<class T>
-bool ClipEllipseToFrustum(
-    const FrustumParameters<T>& frustum,
+inline T WrapClipAngle(T theta)
+{
+    if (theta < (T)0) theta += twopi<T>;
+    if (theta >= twopi<T>) theta -= twopi<T>;
+    return theta;
+}
+
+
+// The segments of the ellipse k + a cos(t) u + b sin(t) v inside the
+// rectangle, by t.  A segment that wraps around t = 0 runs past 2pi.  False if
+// none of it is visible.  (Visible, with no segments: visible all the way
+// round.)
+template<class T>
+bool ClipEllipseToRectangle(
+    const ClipRectangle<T>& rectangle,
     const ConicProjection<T>& projection,
-    vector<ConicSegment<T>>& SegmentList
+    ConicClip<T>& clip
 )
 {
-    // Inputs, unpack...
-    T z = frustum.z;
-    T fov = frustum.fov;
-    T aspectRatio = frustum.aspectRatio;
-    Vector<2, T> k = projection.k;
-    Vector<2, T> v1 = projection.u;
-    Vector<2, T> v2 = projection.v;
-    T a1 = projection.a;
-    T a2 = projection.b;
-#if defined(REDUCE_FOV)
-    fov *= 0.75f;
-#endif
-
-    struct ClipChange
-    {
-        int     Whom;
-        bool    HiddenChange;
-        T       When;
-        int     HiddenState;
-        ClipChange(int whom, bool hidden, T when)
-        {
-            Whom = whom;
-            HiddenChange = hidden;
-            When = normalizeRadians0toTwoPi(when);
-            HiddenState = 0;
-        }
-    };
+    clip.SegmentCount = 0;
+    clip.Visible = false;
 
-    vector<ClipChange> clipPoints;
-    SegmentList.clear();
+    const Vector<2, T>& k = projection.k;
+    const Vector<2, T>& u = projection.u;
+    const Vector<2, T>& v = projection.v;
 
-    T maxX = z * tan(fov / 2);
-    T maxY = maxX / aspectRatio;
-    T a, b, c;
-    T theta1, dt1;
-    T theta2, dt2;
-    bool interceptFound;
+    // x(t) and y(t) are each k + R cos(t - alpha) (see ClipEllipse)
+    const T ax = projection.a * u[0], bx = projection.b * v[0];
+    const T ay = projection.a * u[1], by = projection.b * v[1];
+    const T Rx = std::sqrt(ax * ax + bx * bx);
+    const T Ry = std::sqrt(ay * ay + by * by);
 
-    // Right
-    a = a1 * v1[0]; b = a2 * v2[0]; c = k[0];
-    if (ClipEllipse(a, b, c, (T)+maxX, interceptFound, theta1, dt1, theta2, dt2))
-    {
-        if (interceptFound)
-        {
-            //        UE_LOG(LogTemp, Warning, TEXT("X+ Clip at th = %f (%f)/ %f (%f)"), theta1, dt1, theta2, dt2);
-            bool hidden = dt1 >= 0;
-            clipPoints.push_back(ClipChange(0, hidden, theta1));
-            clipPoints.push_back(ClipChange(0, !hidden, theta2));
-        }
-    }
-    else
+    // Entirely beyond a side?  (Not written as !(... < ...), a NaN culls.)
+    if (!(k[0] - Rx < rectangle.maxX && k[0] + Rx > -rectangle.maxX && k[1] - Ry < rectangle.maxY && k[1] + Ry > -rectangle.maxY))
     {
-        // Outside of frustum... early out!
         return false;
     }
 
-    // Bottom
-    a = a1 * v1[1]; b = a2 * v2[1]; c = k[1];
-    if (ClipEllipse(a, b, c, (T)-maxY, interceptFound, theta2, dt2, theta1, dt1))
-    {
-        if (interceptFound)
-        {
-            //        UE_LOG(LogTemp, Warning, TEXT("Y+ Clip at th = %f (%f)/ %f (%f)"), theta1, dt1, theta2, dt2);
-            bool hidden = dt2 >= 0;
+    ClipEvents<T> events;
 
-            clipPoints.push_back(ClipChange(1, hidden, theta1));
-            clipPoints.push_back(ClipChange(1, !hidden, theta2));
-        }
-    }
-    else
-    {
-        // Outside of frustum... early out!
-        return false;
-    }
+    // Bits of the sides the ellipse is beyond at t = 0
+    int state = 0;
 
-    // Left
-    a = a1 * v1[0]; b = a2 * v2[0]; c = k[0];
-    if (ClipEllipse(a, b, c, (T)-maxX, interceptFound, theta2, dt2, theta1, dt1))
+    // One side, at d: hidden above d if d > 0, below d if d < 0.  The
+    // coordinate crosses d rising at alpha - acos and falling at alpha + acos.
+    auto Side = [&events, &state](T R, T alpha, T c, T d, int bit)
     {
-        if (interceptFound)
+        const T act = (d - c) / R;
+        if (!(act < (T)1 && act > (T)-1))
         {
-            //        UE_LOG(LogTemp, Warning, TEXT("X- Clip at th = %f (%f)/ %f (%f)"), theta1, dt1, theta2, dt2);
-            bool hidden = dt2 >= 0;
-
-            clipPoints.push_back(ClipChange(2, hidden, theta1));
-            clipPoints.push_back(ClipChange(2, !hidden, theta2));
+            // Doesn't cross (or just touches)
+            return;
         }
+
+        const T arcos = std::acos(act);
+        const T rising = WrapClipAngle(alpha - arcos);
+        const T falling = WrapClipAngle(alpha + arcos);
+
+        const T hides = d > 0 ? rising : falling;
+        const T shows = d > 0 ? falling : rising;
+
+        events.Add(hides, bit);
+        events.Add(shows, bit);
+        state |= shows < hides ? bit : 0;
+    };
+
+    // Right and left, then bottom and top, with one atan2 for each pair
+    if (std::abs(k[0]) + Rx > rectangle.maxX)
+    {
+        const T alpha = std::atan2(bx, ax);
+        Side(Rx, alpha, k[0], +rectangle.maxX, 1);
+        Side(Rx, alpha, k[0], -rectangle.maxX, 4);
     }
-    else
+    if (std::abs(k[1]) + Ry > rectangle.maxY)
     {
-        // Outside of frustum... early out!
-        return false;
+        const T alpha = std::atan2(by, ay);
+        Side(Ry, alpha, k[1], -rectangle.maxY, 2);
+        Side(Ry, alpha, k[1], +rectangle.maxY, 8);
     }
 
-    // Top
-    a = a1 * v1[1]; b = a2 * v2[1]; c = k[1];
-    if (ClipEllipse(a, b, c, (T)+maxY, interceptFound, theta1, dt1, theta2, dt2))
+    // Never crosses a side, so it's all on screen
+    if (events.Count == 0)
     {
-        if (interceptFound)
-        {
-            //        UE_LOG(LogTemp, Warning, TEXT("Y- Clip at th = %f (%f)/ %f (%f)"), theta1, dt1, theta2, dt2);
-            bool hidden = dt1 >= 0;
-
-            clipPoints.push_back(ClipChange(3, hidden, theta1));
-            clipPoints.push_back(ClipChange(3, !hidden, theta2));
-        }
+        clip.Visible = true;
+        return true;
     }
-    else
+
+    events.Sort();
+    events.GetSegments(state, true, clip);
+
+    // It can cross the sides and still miss the rectangle (around a corner)
+    clip.Visible = clip.SegmentCount > 0;
+    return clip.Visible;
+}
+
+
+// ClipEllipseToRectangle, for a convex polygon.  Each side's n . p(t) is
+// n . k + R cos(t - alpha), like x(t) and y(t) above, and the ellipse is on
+// the side's hidden side where that's past d.
+template<class T>
+bool ClipEllipseToPolygon(
+    const ClipPolygon<T>& polygon,
+    const ConicProjection<T>& projection,
+    ConicClip<T>& clip
+)
+{
+    clip.SegmentCount = 0;
+    clip.Visible = false;
+
+    const Vector<2, T>& k = projection.k;
+    const Vector<2, T> au = projection.a * projection.u;
+    const Vector<2, T> bv = projection.b * projection.v;
+
+    ClipEvents<T, 2 * ClipPolygon<T>::MaxSides> events;
+    int state = 0;
+
+    for (int i = 0; i < polygon.SideCount; ++i)
     {
-        // Outside of frustum... early out!
-        return false;
+        const Vector<2, T>& n = polygon.Normals[i];
+        const T c = Dot(n, k);
+        const T A = Dot(n, au);
+        const T B = Dot(n, bv);
+        const T R = std::sqrt(A * A + B * B);
+        const T d = polygon.Distances[i];
+
+        // Entirely beyond it (a NaN culls, as above), or never reaching it
+        if (!(c - R < d)) return false;
+        if (c + R <= d) continue;
+
+        const T arcos = std::acos((d - c) / R);
+        const T alpha = std::atan2(B, A);
+        const T hides = WrapClipAngle(alpha - arcos);
+        const T shows = WrapClipAngle(alpha + arcos);
+
+        events.Add(hides, 1 << i);
+        events.Add(shows, 1 << i);
+        state |= shows < hides ? 1 << i : 0;
     }
 
-    // If we survived here, the ellipse is visible in at least one place...
-    // No clip points means it never crosses a frustum line/plane, so it must be fully visible
-    bool allVisible = clipPoints.empty();
-
-    if (allVisible)
+    if (events.Count == 0)
     {
+        clip.Visible = true;
         return true;
     }
-    else
-    {
-        // The ellipse is hidden in at least one place...
-        // It will hidden anytime it's crossed 1 or more clip line.
-        // So, for each clip line noted, remove all states (via removing associated state
-        // changes) where that clip segment becomes hidden.
-
-        // We're effectively ref counting the segment 'hides'.
-        // Segments are visible anywhere there's zero hidden segments on the ref count.
-
-        // Start, by sorting the state changes by time...
-        std::sort(
-            clipPoints.begin(), clipPoints.end(),
-            [](const ClipChange& a, const ClipChange& b)
-            {
-                return a.When < b.When;
-            });
-
-        // Loop twice through the list to wrap around the states...
-        int state = 0;
-        for (int _rawindex = 0; _rawindex < 2 * clipPoints.size(); ++_rawindex)
-        {
-            int index = _rawindex % clipPoints.size();
-
-            // We can't early out if the state is non-zero, because there may be
-            // outstanding ref's to tally...
-
-            // If this is the start of a segment, clear the hidden flag
-            bool segmentIsHidden = clipPoints[index].HiddenChange;
-            int whom = clipPoints[index].Whom;
-            int bitFlag = 1 << whom;
-
-            if (segmentIsHidden)
-            {
-                state |= bitFlag;
-            }
-            else
-            {
-                state &= (-1) ^ bitFlag;
-            }
-
-            clipPoints[index].HiddenState = state;
-        }
 
-        // loop through twice again
-        // It would be moar elegant, logically, if these loops were combined.
-        // ... but its still only O(n) and this isn't an inner loop.
-        bool wasVisible = false;
-        T segmentStart = 0;
-        for (int _rawindex = 0; _rawindex < 2 * clipPoints.size(); ++_rawindex)
-        {
-            int index = _rawindex % clipPoints.size();
-            int hiddenState = clipPoints[index].HiddenState;
-
-            // We can early out if this one's already been done...
-            if (hiddenState == -1) break;
-
-            bool visible = hiddenState == 0;
-            if (!wasVisible && visible)
-            {
-                segmentStart = clipPoints[index].When;
-            }
-            else if (wasVisible && !visible)
-            {
-                T segmentEnd = clipPoints[index].When;
-                T segmentLength = segmentEnd - segmentStart;
-                if (segmentLength < 0) segmentLength += twopi<T>;
-                if (segmentStart < 0) segmentStart += twopi<T>;
-                SegmentList.push_back(ConicSegment<T>(normalizeRadians0toTwoPi<T>(segmentStart), segmentLength));
-            }
-
-            // Mark the state so we don't reconsider it... If, it was segmentized
-            if (visible)
-            {
-                clipPoints[index].HiddenState = -1;
-            }
-
-            wasVisible = visible;
-        }
+    events.Sort();
+    events.GetSegments(state, true, clip);
 
-        return clipPoints.size() > 0;
-    }
+    clip.Visible = clip.SegmentCount > 0;
+    return clip.Visible;
+}
+
+
+// SegmentList - X < Y for non-wrap around segments
+//               X > Y if the segment wraps around 0   
+template<class T>
+bool ClipEllipseToFrustum(
+    const FrustumParameters<T>& frustum,
+    const ConicProjection<T>& projection,
+    vector<ConicSegment<T>>& SegmentList
+)
+{
+    ConicClip<T> clip;
+    const bool visible = ClipEllipseToRectangle(ClipRectangle<T>(frustum), projection, clip);
+
+    SegmentList.assign(clip.Segments, clip.Segments + clip.SegmentCount);
+
+    return visible;
 }
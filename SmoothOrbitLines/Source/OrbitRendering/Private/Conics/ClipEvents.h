@@ -0,0 +1,136 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+
+//-----------------------------------------------------------------------------
+// ClipEvents
+// The bookkeeping shared by ClipEllipseToFrustum and ClipHyperbolaToFrustum.
+// A conic crosses each of the frustum rectangle's four sides at most twice,
+// so there are never more than eight crossings.  They're kept on the stack,
+// sorted by a fixed sorting network, and walked once with a bit per side
+// (set while the conic is on the side's hidden side.)  The conic is visible
+// wherever no bits are set.  Polygons (see ClipPolygon) have more sides, and
+// more crossings, which are insertion sorted instead.
+// See ReadMe.txt for more information.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <limits>
+#include <utility>
+
+#include "Conics.h"
+
+
+// A crossing: where it is (the conic's parameter), and the side's bit, which
+// it toggles.
+template<class T>
+struct ClipEvent
+{
+    T When;
+    int Bit;
+};
+
+
+template<class T, int Capacity = 8>
+struct ClipEvents
+{
+    static constexpr int MaxEvents = Capacity;
+
+    ClipEvent<T> Events[MaxEvents];
+    int Count = 0;
+
+    void Add(T when, int bit)
+    {
+        Events[Count++] = ClipEvent<T>{ when, bit };
+    }
+
+    // By When.  Eight: the unused slots are padded out past the end (toggling
+    // nothing), so it's always the same 19 compare-exchanges, in an order
+    // that doesn't depend on the data.  More than that, by insertion.
+    void Sort()
+    {
+        if (Count < 2) return;
+
+        if constexpr (MaxEvents == 8)
+        {
+            for (int i = Count; i < MaxEvents; ++i)
+            {
+                Events[i] = ClipEvent<T>{ std::numeric_limits<T>::max(), 0 };
+            }
+
+            static constexpr int Network[19][2] =
+            {
+                { 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },
+                { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 },
+                { 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },
+                { 2, 4 }, { 3, 5 },
+                { 1, 4 }, { 3, 6 },
+                { 1, 2 }, { 3, 4 }, { 5, 6 }
+            };
+
+            for (const auto& c : Network)
+            {
+                ClipEvent<T>& lo = Events[c[0]];
+                ClipEvent<T>& hi = Events[c[1]];
+                if (hi.When < lo.When) std::swap(lo, hi);
+            }
+        }
+        else
+        {
+            for (int i = 1; i < Count; ++i)
+            {
+                const ClipEvent<T> event = Events[i];
+                int j = i;
+                for (; j > 0 && event.When < Events[j - 1].When; --j)
+                {
+                    Events[j] = Events[j - 1];
+                }
+                Events[j] = event;
+            }
+        }
+    }
+
+    // Walk the (sorted) crossings, starting with the hidden bits in state,
+    // and add a segment for each stretch where nothing's hidden.  Periodic
+    // (ellipses): the stretch that's open at the end runs round to the first
+    // crossing.  Otherwise (hyperbolas) both ends are off screen.
+    void GetSegments(int state, bool periodic, ConicClip<T>& clip) const
+    {
+        clip.SegmentCount = 0;
+
+        // A stretch that was open before the first crossing, and where it ended
+        bool leading = state == 0;
+        T leadingEnd = (T)0;
+        T start = (T)0;
+
+        for (int i = 0; i < Count; ++i)
+        {
+            const T when = Events[i].When;
+            const int next = state ^ Events[i].Bit;
+
+            if (next == 0)
+            {
+                start = when;
+            }
+            else if (state == 0)
+            {
+                if (leading)
+                {
+                    leadingEnd = when;
+                    leading = false;
+                }
+                else
+                {
+                    clip.Segments[clip.SegmentCount++] = ConicSegment<T>(start, when - start);
+                }
+            }
+
+            state = next;
+        }
+
+        if (periodic && state == 0 && Count > 0)
+        {
+            clip.Segments[clip.SegmentCount++] = ConicSegment<T>(start, leadingEnd + twopi<T> - start);
+        }
+    }
+};
@@ -7,11 +7,9 @@
 // This is necessary not only for hyperbolic orbits, but for elliptical orbits
 // as the perspective projection of an ellipse turns hyperbolic when the
 // ellipse intercepts the eye plane.
-// Although it is defined as a template, it is unlikley to compile for types
-// that are not used in this project (exclusively double types).
-// The implementation is not designed to be robust, is intended for
-// demonstration purposes only - not intended to be used in production.
-// This algorithm has not been optimized (performance, memory, readability, etc)
+// Works in float as well as double (see ClipEllipseToFrustum.)  Nothing's
+// allocated, and ClipHyperbolaToRectangle takes the rectangle ready made (see
+// ClipEllipseToFrustum.)  ClipHyperbolaToPolygon clips to any convex region.
 // See ReadMe.txt for more information.
 //-----------------------------------------------------------------------------
 
@@ -27,9 +25,12 @@ using namespace gte;
 #include <cmath>
 #include <vector>
 #include <algorithm>
+#include <utility>
+using std::pair;
 using std::vector;
 
 #include "ProjectEllipseToPlane.h"
+#include "ClipEvents.h"
 
 
 
@@ -43,15 +44,15 @@ using std::vector;
 template<class T>
 int BisectHyperbola(T A, T B, T C, bool positiveOrientation, T a, T b, bool& initiallyHidden, T(&points)[2])
 {
-    double sign = positiveOrientation ? +1. : -1;
+    T sign = positiveOrientation ? (T)+1. : (T)-1.;
 
     // The intersection is solved by a simple quadratic equation....
     // (Easily derived by substititing the line equation into the hyperbola eq)
     T A_quad = sqr(B) - sqr(a * A / b);
-    T B_quad = 2 * B * C;
+    T B_quad = (T)2. * B * C;
     T C_quad = sqr(C) - sqr(a * A);
 
-    T d = sqr(B_quad) - 4. * A_quad * C_quad;
+    T d = sqr(B_quad) - (T)4. * A_quad * C_quad;
 
     int n = 0;
 
@@ -73,11 +74,15 @@ int BisectHyperbola(T A, T B, T C, bool positiveOrientation, T a, T b, bool& ini
         T x, y;
 
         // (Wash)
-        // Solve the quatratic, using the '-' discriminant
-        T q = (-B_quad - sqrt(d)) / (2. * A_quad);
+        // Solve the quatratic...  Not with the textbook formula, though: one of
+        // its two roots subtracts nearly equal numbers whenever 4*A*C is small
+        // next to B^2, which is fine in double but not in float.  The roots are
+        // q / A_quad and C_quad / q instead.
+        T sqrtD = sqrt(d);
+        T q = (T)-0.5 * (B_quad + (B_quad < 0 ? -sqrtD : sqrtD));
 
         // what does the quadratic yield?  the point intersection point (x(y), y).
-        y = q;
+        y = q / A_quad;
         // knowing y, we can resolve z...
         x = (-B * y - C) / A;
 
@@ -85,18 +90,21 @@ int BisectHyperbola(T A, T B, T C, bool positiveOrientation, T a, T b, bool& ini
         // We only care about the hyperbola in the same side as (x,y)...
         // Any -sign*x < 0 intersections are on the mirrored hyperbola, which is of no interest
         // to us in this use case.
-        if (sign * x >= 0)
+        // (A_quad == 0 when the line is parallel to an asymptote, and then
+        // there's only the one root.)
+        // The hyperbolic angle is asinh(y/b) rather than atanh((y/b)/(x/a)):
+        // out along the asymptotes x/a and y/b are nearly equal, and atanh
+        // of their ratio is hopeless in float.
+        if (A_quad != 0 && sign * x >= 0)
             // Intersetction at: {x, y}
-            points[n++] = atanh(y / x * a / b);
+            points[n++] = asinh(sign * y / b);
 
         // (Repeat.)
-        // using the '+' discriminant
-        q = (-B_quad + sqrt(d)) / (2. * A_quad);
-        y = q;
+        y = C_quad / q;
         x = (-B * y - C) / A;
 
         if (sign * x >= 0)
-            points[n++] = atanh(y / x * a / b);
+            points[n++] = asinh(sign * y / b);
     }
     // vvv -------------------
     // Included for clarity.
@@ -138,14 +146,17 @@ void ClipHyperbolaToLine(
     const Vector<2, T >& direction = init.first;
     const Vector<2, T >& center = init.second * screenDimentions;
 
-    const Vector<2, T> direction_prime = R * direction;
+    // (The normal's found before transforming: u, v may be either way round,
+    // and turning the direction afterwards would flip it when they aren't.)
+    const Vector<2, T> normal{ -direction[1], direction[0] };
+    const Vector<2, T> normal_prime = R * normal;
     const Vector<2, T> center_prime = R * (center - k);
 
     // Get linear coefficients of the line in the form:
     // Ax + By + C = 0
-    double A, B, C;
-    A = -direction_prime[1];
-    B = direction_prime[0];
+    T A, B, C;
+    A = normal_prime[0];
+    B = normal_prime[1];
     C = -A * center_prime[0] - B * center_prime[1];
 
     // Now the line is position in they hyperbola's space, so the intersection can be solved
@@ -156,43 +167,25 @@ void ClipHyperbolaToLine(
 
 
 
+// The segments of the hyperbola k +/- (a cosh(t) u + b sinh(t) v) inside the
+// rectangle, by t.  False if none of it is visible.
 template<class T>
-void ClipHyperbolaToFrustum(
-    const FrustumParameters<T>& frustum,
+bool ClipHyperbolaToRectangle(
+    const ClipRectangle<T>& rectangle,
     const ConicProjection<T>& projection,
     bool positiveOrientation,
-    vector<ConicSegment<T>>& SegmentList
+    ConicClip<T>& clip
 )
 {
-    // Inputs, unpack...
-    T z = frustum.z;
-    T fov = frustum.fov;
-    T aspectRatio = frustum.aspectRatio;
-    Vector<2, T> k = projection.k;
-    Vector<2, T> v1 = projection.u;
-    Vector<2, T> v2 = projection.v;
-    T a = projection.a;
-    T b = projection.b;
-
-#if defined(REDUCE_FOV)
-    fov *= 0.75f;
-#endif
-
-    T maxX = z * tan(fov / 2);
-    T maxY = maxX / aspectRatio;
-    const Vector<2, T> screenDimentions({ maxX, maxY });
-
-    // { {direction}, {center} }
-    static const pair<Vector<2, T>, Vector<2, T>> clipLines[4] =
+    const Vector<2, T> screenDimentions({ rectangle.maxX, rectangle.maxY });
+
+    // { direction, center }: top, right, bottom, left
+    static constexpr T clipLines[4][4] =
     {
-        // Top Line
-        {{ +1,  0 }, { 0, +1 }},
-        // Right Light
-        {{  0, -1 }, { +1, 0 }},
-        // Bottom
-        {{ -1,  0 }, { 0, -1 }},
-        // Left
-        {{  0, +1 }, { -1, 0 }}
+        { +1,  0,  0, +1 },
+        {  0, -1, +1,  0 },
+        { -1,  0,  0, -1 },
+        {  0, +1, -1,  0 }
     };
 
     // rotate line's coordinate system coordinate system so:
@@ -200,90 +193,110 @@ void ClipHyperbolaToFrustum(
     // x -> -v2
     // (we do this for convenience in intercepting the hyperbolic equation, in its standard form)
     Matrix<2, 2, T> R;
-    R.SetRow(0, v1);
-    R.SetRow(1, v2);
+    R.SetRow(0, projection.u);
+    R.SetRow(1, projection.v);
 
-    SegmentList.clear();
+    ClipEvents<T> events;
 
-    // bit field of hidden/showing states....
+    // bit field of hidden/showing states, as t -> -infinity
     int states = 0;
-    vector<pair <int, T>> stateChangeList;
 
-    const bool hidden = true;
-    const bool showing = false;
+    clip.SegmentCount = 0;
+    clip.Visible = false;
 
     for (int i = 0; i < 4; ++i)
     {
-        const pair<Vector<2, T>, Vector<2, T>>& line = clipLines[i];
+        const pair<Vector<2, T>, Vector<2, T>> line{ { clipLines[i][0], clipLines[i][1] }, { clipLines[i][2], clipLines[i][3] } };
 
-        bool initialState;
+        bool initiallyHidden;
         T stateChanges[2];
         int n;
 
-        ClipHyperbolaToLine(line, screenDimentions, R, positiveOrientation, k, a, b, initialState, stateChanges, n);
+        ClipHyperbolaToLine(line, screenDimentions, R, positiveOrientation, projection.k, projection.a, projection.b, initiallyHidden, stateChanges, n);
 
-        if (initialState == hidden && n == 0)
+        if (initiallyHidden && n == 0)
         {
             // The hyperbola is never on the visible side of this line...
             /// We can bail right now...
-            return;
+            return false;
         }
-        
-        int stateFlag = initialState ? hidden : showing;
 
-        // Remember if this line initially was hidden or showing
-        states |= stateFlag << i;
+        states |= (int)initiallyHidden << i;
 
-        // Add all state changes...
-        if (n > 0)
+        for (int j = 0; j < n; ++j)
         {
-            stateChangeList.push_back({ i, stateChanges[0] });
-            if (n > 1)
-            {
-                stateChangeList.push_back({ i, stateChanges[1] });
-            }
+            events.Add(stateChanges[j], 1 << i);
         }
     }
 
-    if (stateChangeList.size() > 0)
-    {
-        std::sort(
-            stateChangeList.begin(), stateChangeList.end(),
-            [](const  pair <int, T>& a, const  pair <int, T>& b)
-            {
-                return a.second < b.second;
-            });
-
-        // Ignore any cases where the line is visible to infinity (initially showing)
-        int lastState = states;
-        T segmentBegin {};
-
-        // Loop through the state changes looking for transitions from
-        // one or more hidden clip line bisections.
-        for (int i = 0; i < stateChangeList.size(); ++i)
-        {
-            const pair <int, T>& change = stateChangeList[i];
+    // Loop through the state changes looking for transitions from
+    // one or more hidden clip line bisections.
+    events.Sort();
+    events.GetSegments(states, false, clip);
+
+    clip.Visible = clip.SegmentCount > 0;
+    return clip.Visible;
+}
 
-            int who = change.first;
-            T when = change.second;
 
-            int bitMask = (1 << who);
+// ClipHyperbolaToRectangle, for a convex polygon.  Each side n . p = d is
+// A x + B y + C = 0 in the hyperbola's axes (x along u, y along v, from k.)
+template<class T>
+bool ClipHyperbolaToPolygon(
+    const ClipPolygon<T>& polygon,
+    const ConicProjection<T>& projection,
+    bool positiveOrientation,
+    ConicClip<T>& clip
+)
+{
+    ClipEvents<T, 2 * ClipPolygon<T>::MaxSides> events;
+    int states = 0;
+
+    clip.SegmentCount = 0;
+    clip.Visible = false;
+
+    for (int i = 0; i < polygon.SideCount; ++i)
+    {
+        const Vector<2, T>& n = polygon.Normals[i];
+        const T A = Dot(n, projection.u);
+        const T B = Dot(n, projection.v);
+        const T C = Dot(n, projection.k) - polygon.Distances[i];
 
-            // Flip the state...
-            states ^= bitMask;
+        bool initiallyHidden;
+        T stateChanges[2];
+        const int count = BisectHyperbola(A, B, C, positiveOrientation, projection.a, projection.b, initiallyHidden, stateChanges);
 
-            bool visible = !states;
+        if (initiallyHidden && count == 0)
+        {
+            return false;
+        }
 
-            if (!states && lastState)
-            {
-                segmentBegin = when;
-            }
-            else if (states && !lastState)
-            {
-                SegmentList.push_back({ segmentBegin, when-segmentBegin });
-            }
+        states |= (int)initiallyHidden << i;
 
-            lastState = states;
+        for (int j = 0; j < count; ++j)
+        {
+            events.Add(stateChanges[j], 1 << i);
         }
     }
+
+    events.Sort();
+    events.GetSegments(states, false, clip);
+
+    clip.Visible = clip.SegmentCount > 0;
+    return clip.Visible;
+}
+
+
+template<class T>
+void ClipHyperbolaToFrustum(
+    const FrustumParameters<T>& frustum,
+    const ConicProjection<T>& projection,
+    bool positiveOrientation,
+    vector<ConicSegment<T>>& SegmentList
+)
+{
+    ConicClip<T> clip;
+    ClipHyperbolaToRectangle(ClipRectangle<T>(frustum), projection, positiveOrientation, clip);
+
+    SegmentList.assign(clip.Segments, clip.Segments + clip.SegmentCount);
 }
@@ -0,0 +1,179 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+
+//-----------------------------------------------------------------------------
+// ConicBezier
+// A clipped segment of an image conic as rational quadratic Bezier pieces,
+//      p(s) = (P0 (1-s)^2 + 2 w P1 s (1-s) + P2 s^2) / ((1-s)^2 + 2 w s (1-s) + s^2)
+// which are exactly the conic, not an approximation of it.  (GTE's
+// NURBSCircle.h builds circles the same way.)  P0 and P2 are the piece's
+// ends, P1 is where the tangents at the ends cross, and for a piece of
+// half-width h around m it's
+//      ellipse:   w = cos h,    P1 = k + (a cos m u + b sin m v) / cos h
+//      hyperbola: w = cosh h,   P1 = k +- (a cosh m u + b sinh m v) / cosh h
+// Numerator and denominator are quadratics in s, so evenly spaced s can be
+// stepped through by forward differencing: three adds a coordinate and a
+// divide per point, and no sin/cos/cosh/sinh.
+// s isn't t, but they're close: tan((t - m) / 2) = tan(h / 2) (2s - 1) (tanh,
+// for hyperbolas.)  Ellipse pieces are kept to a quarter turn, and hyperbola
+// pieces to a unit of t, so evenly spaced s is within 1% of a piece of evenly
+// spaced t.
+// See ReadMe.txt for more information.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "GTE/Mathematics/Vector.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace gte;
+
+
+template<class T>
+struct ConicBezier
+{
+    Vector<2, T> P0;
+    Vector<2, T> P1;
+    Vector<2, T> P2;
+    T w;
+    T start;    // <- The conic parameters it covers
+    T length;
+
+    ConicBezier() : P0(), P1(), P2(), w(T()), start(T()), length(T()) {}
+};
+
+
+// The most pieces a segment's split into.  (A whole ellipse takes four.  Past
+// that, hyperbola pieces get longer than a unit.)
+constexpr int ConicBezierMaxPieces = 16;
+
+
+// How many pieces a segment of the conic is split into
+template<class T>
+inline int GetConicBezierPieceCount(bool hyperbola, T length)
+{
+    const T span = std::abs(length);
+    const T maxSpan = hyperbola ? (T)1 : (T)0.5 * pi<T>;
+    const int count = (int)std::ceil(span / maxSpan - (T)1e-6);
+    return std::min(std::max(count, 1), ConicBezierMaxPieces);
+}
+
+
+// The one piece covering [start, start + length].  (For a hyperbola, sign is
+// -1 for a NegativeHyperbola.)  Ellipse pieces have to be less than a half
+// turn, since the end tangents are parallel at a half turn.
+template<class T>
+void GetConicBezier(const ConicProjection<T>& p, bool hyperbola, T sign, T start, T length, ConicBezier<T>& piece)
+{
+    const T m = start + (T)0.5 * length;
+    const T h = (T)0.5 * length;
+    const T t1 = start + length;
+
+    piece.start = start;
+    piece.length = length;
+
+    if (hyperbola)
+    {
+        const T au = sign * p.a;
+        const T bv = sign * p.b;
+        piece.w = std::cosh(h);
+        piece.P0 = p.k + au * std::cosh(start) * p.u + bv * std::sinh(start) * p.v;
+        piece.P1 = p.k + (au * std::cosh(m) * p.u + bv * std::sinh(m) * p.v) / piece.w;
+        piece.P2 = p.k + au * std::cosh(t1) * p.u + bv * std::sinh(t1) * p.v;
+    }
+    else
+    {
+        piece.w = std::cos(h);
+        piece.P0 = p.k + p.a * std::cos(start) * p.u + p.b * std::sin(start) * p.v;
+        piece.P1 = p.k + (p.a * std::cos(m) * p.u + p.b * std::sin(m) * p.v) / piece.w;
+        piece.P2 = p.k + p.a * std::cos(t1) * p.u + p.b * std::sin(t1) * p.v;
+    }
+}
+
+
+// A segment of the conic as GetConicBezierPieceCount equal pieces, in order.
+// Returns how many.
+template<class T>
+int GetConicBeziers(const ConicProjection<T>& p, bool hyperbola, T sign, T start, T length, ConicBezier<T>* pieces)
+{
+    const int count = GetConicBezierPieceCount(hyperbola, length);
+    const T pieceLength = length / (T)count;
+
+    for (int i = 0; i < count; ++i)
+    {
+        // (The last piece ends exactly where the segment does)
+        const T pieceStart = start + (T)i * pieceLength;
+        const T pieceEnd = i + 1 < count ? pieceStart + pieceLength : start + length;
+        GetConicBezier(p, hyperbola, sign, pieceStart, pieceEnd - pieceStart, pieces[i]);
+    }
+
+    return count;
+}
+
+
+// p(s), directly
+template<class T>
+inline Vector<2, T> EvaluateConicBezier(const ConicBezier<T>& piece, T s)
+{
+    const T r = (T)1 - s;
+    const T b0 = r * r;
+    const T b1 = (T)2 * piece.w * s * r;
+    const T b2 = s * s;
+    return (b0 * piece.P0 + b1 * piece.P1 + b2 * piece.P2) / (b0 + b1 + b2);
+}
+
+
+// The conic parameter at s (see above.)  Not needed to tessellate, but it's
+// what s = i / lines lands on.
+template<class T>
+inline T GetConicBezierParameter(const ConicBezier<T>& piece, bool hyperbola, T s)
+{
+    const T h = (T)0.5 * piece.length;
+    const T x = (T)2 * s - (T)1;
+    const T m = piece.start + h;
+
+    return hyperbola
+        ? m + (T)2 * std::atanh(std::tanh((T)0.5 * h) * x)
+        : m + (T)2 * std::atan(std::tan((T)0.5 * h) * x);
+}
+
+
+// lines + 1 points, at s = 0, 1 / lines, ... 1, by forward differencing.
+// The numerator and denominator are
+//      N(s) = P0 + 2 (w P1 - P0) s + (P0 - 2 w P1 + P2) s^2
+//      D(s) = 1 + 2 (w - 1) s + 2 (1 - w) s^2
+// and their second differences are constant.  The sums are kept in double
+// whatever T is, since in float they drift several times further than
+// evaluating each point would, over 64 steps.  The last point's P2 exactly, so the pieces join up
+// without a crack.
+template<class T>
+void TessellateConicBezier(const ConicBezier<T>& piece, int lines, T* x, T* y)
+{
+    const double ds = 1. / (double)lines;
+    const double w = (double)piece.w;
+
+    const double p0x = (double)piece.P0[0], p0y = (double)piece.P0[1];
+    const double wp1x = w * (double)piece.P1[0], wp1y = w * (double)piece.P1[1];
+    const double n1x = 2. * (wp1x - p0x), n1y = 2. * (wp1y - p0y);
+    const double n2x = p0x - 2. * wp1x + (double)piece.P2[0], n2y = p0y - 2. * wp1y + (double)piece.P2[1];
+    const double d1 = 2. * (w - 1.);
+    const double d2 = -d1;
+
+    double nx = p0x, ny = p0y, d = 1.;
+    double dnx = (n1x + n2x * ds) * ds, dny = (n1y + n2y * ds) * ds, dd = (d1 + d2 * ds) * ds;
+    const double ddnx = 2. * n2x * ds * ds, ddny = 2. * n2y * ds * ds, ddd = 2. * d2 * ds * ds;
+
+    for (int i = 0; i < lines; ++i)
+    {
+        const double invD = 1. / d;
+        x[i] = (T)(nx * invD);
+        y[i] = (T)(ny * invD);
+
+        nx += dnx; ny += dny; d += dd;
+        dnx += ddnx; dny += ddny; dd += ddd;
+    }
+
+    x[lines] = piece.P2[0];
+    y[lines] = piece.P2[1];
+}
@@ -0,0 +1,190 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+
+//-----------------------------------------------------------------------------
+// ConicPlaneFamilies
+// Conics that share a plane (and a focus): moons in their planet's equatorial
+// plane, ring particles and the like.  Projecting a conic is mostly setting up
+// its plane (see ConicPlaneView), so each family's plane is set up once per
+// view and its conics only pay for their own 36 multiply-adds.
+// Families are found by sorting on the focus and the plane's normal (up to
+// sign, binned to the coplanar tolerance), so each family's members end up
+// next to each other.  Near a bin's edge a family may be split in two, which
+// costs a little time but nothing else.  A member that's off its family's
+// plane by up to the tolerance is projected as if it were in it.
+// The projections come out as lanes of a ConicProjectionBatch, and the lanes
+// that aren't in a family are left for ProjectEllipsesToPlaneLanes.
+// See ReadMe.txt for more information.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "GTE/Mathematics/Vector3.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+using namespace gte;
+
+#include "Conics.h"
+#include "ProjectConicMatrixToPlane.h"
+#include "ProjectEllipsesToPlane.h"
+
+
+// A conic in its own plane: the focus O, the plane's normal N, its axes U and
+// V (unit), and its dual conic C* on them (see PerifocalDualConic.)
+template<class T>
+struct ConicPlaneMember
+{
+    Vector3<T> O, N, U, V;
+    ConicMatrix<T> DualConic;
+};
+
+
+template<class T>
+struct ConicPlaneFamilies
+{
+    // Normals closer than this (radians) are the same plane, by default.
+    // Normals of orbits in one plane, worked out in double from the same
+    // plane, differ by 1e-15 or so; ones rounded through float, by 1e-7.
+    static constexpr double DefaultCoplanarTolerance = 1e-6;
+
+    // What it was built with
+    T CoplanarTolerance = (T)DefaultCoplanarTolerance;
+
+    // The plane (O; P, Q), and the length its conics are divided by
+    struct Plane
+    {
+        Vector3<T> O, P, Q;
+        T L;
+    };
+    std::vector<Plane> Planes;
+
+    // Per conic: its family (-1 for none), and its C* and adj(C*) in the
+    // family's plane, scaled by the family's L
+    std::vector<int> Family;
+    std::vector<ConicMatrix<T>> DualConics;
+    std::vector<ConicMatrix<T>> AdjDualConics;
+
+    // How many conics it was built for
+    size_t size() const { return Family.size(); }
+
+    void build(const std::vector<ConicPlaneMember<T>>& members, T coplanarTolerance = (T)DefaultCoplanarTolerance)
+    {
+        const int count = (int)members.size();
+        CoplanarTolerance = coplanarTolerance;
+        Planes.clear();
+        Family.assign(count, -1);
+        DualConics.resize(count);
+        AdjDualConics.resize(count);
+
+        std::vector<std::pair<std::array<T, 6>, int>> keys(count);
+        for (int i = 0; i < count; ++i)
+        {
+            Vector3<T> N = members[i].N;
+            Normalize(N);
+
+            int j = 0;
+            for (int k = 1; k < 3; ++k)
+            {
+                if (std::abs(N[k]) > std::abs(N[j])) j = k;
+            }
+            if (N[j] < (T)0) N = -N;
+
+            const Vector3<T>& O = members[i].O;
+            const T bin = std::max(CoplanarTolerance, std::numeric_limits<T>::epsilon());
+            keys[i].first = { O[0], O[1], O[2], std::round(N[0] / bin), std::round(N[1] / bin), std::round(N[2] / bin) };
+            keys[i].second = i;
+        }
+        std::sort(keys.begin(), keys.end());
+
+        int last;
+        for (int first = 0; first < count; first = last)
+        {
+            for (last = first + 1; last < count && keys[last].first == keys[first].first; ++last);
+
+            // A family of one is just a conic
+            if (last - first < 2) continue;
+
+            // The plane's axes are its first member's
+            const ConicPlaneMember<T>& firstMember = members[keys[first].second];
+            Plane plane;
+            plane.O = firstMember.O;
+            plane.P = firstMember.U;
+            plane.Q = firstMember.V;
+            plane.L = (T)0;
+
+            const int f = (int)Planes.size();
+            for (int k = first; k < last; ++k)
+            {
+                const int i = keys[k].second;
+                const Vector3<T>& U = members[i].U;
+                const Vector3<T>& V = members[i].V;
+
+                // From the conic's own axes to the plane's (same origin)
+                const ConicMatrix<T> C = Congruence(
+                    members[i].DualConic,
+                    Vector3<T>{ Dot(U, plane.P), Dot(U, plane.Q), (T)0 },
+                    Vector3<T>{ Dot(V, plane.P), Dot(V, plane.Q), (T)0 },
+                    Vector3<T>{ (T)0, (T)0, (T)1 }
+                );
+
+                DualConics[i] = C;
+                plane.L = std::max(plane.L, std::sqrt(std::max(std::abs(C.m00), std::abs(C.m11))));
+                Family[i] = f;
+            }
+
+            if (!(plane.L > (T)0)) plane.L = (T)1;
+
+            for (int k = first; k < last; ++k)
+            {
+                const int i = keys[k].second;
+                DualConics[i] = ScaleDualConic(DualConics[i], (T)1 / plane.L);
+                AdjDualConics[i] = Adjugate(DualConics[i]);
+            }
+
+            Planes.push_back(plane);
+        }
+    }
+
+    // Pass 1 for the lanes (conic indices[lane]) that are in a family with
+    // others in view, and the rest of the lanes in others.
+    void project(const EllipseProjectionView<T>& view, const std::vector<int>& indices, ConicProjectionBatch<T>& projections, std::vector<int>& others) const
+    {
+        // A family with just one conic in view is no better off than the lanes
+        std::vector<int> inView(Planes.size(), 0);
+        for (int i : indices)
+        {
+            if (Family[i] >= 0) ++inView[Family[i]];
+        }
+
+        std::vector<ConicPlaneView<T>> views(Planes.size());
+        for (int f = 0; f < (int)Planes.size(); ++f)
+        {
+            if (inView[f] > 1)
+            {
+                const Plane& plane = Planes[f];
+                views[f] = GetConicPlaneView(view, plane.O, plane.P, plane.Q, plane.L);
+            }
+        }
+
+        others.clear();
+        for (int lane = 0; lane < (int)indices.size(); ++lane)
+        {
+            const int i = indices[lane];
+            const int f = Family[i];
+            if (f < 0 || inView[f] < 2)
+            {
+                others.push_back(lane);
+                continue;
+            }
+
+            ConicProjection<T> projection;
+            ProjectPlaneConic(views[f], DualConics[i], AdjDualConics[i], projection);
+            projections.setProjection(lane, projection);
+        }
+    }
+};
@@ -0,0 +1,174 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+
+//-----------------------------------------------------------------------------
+// ConicTessellation
+// Where to put the vertices along a segment of an image conic, so that no line
+// strays more than a tolerance from it, with as few lines as that takes.
+// A line of length L strays from the curve by about L^2 / 8 times the
+// curve's curvature, |p' x p''| / |p'|^3.  For the ellipse (a cos t, b sin t)
+// and the hyperbola (a cosh t, b sinh t) the cross product is just ab, and
+// |p'|^2 is
+//      b^2 + (a^2 - b^2) sin^2 t,   or   b^2 + (a^2 + b^2) sinh^2 t
+// which is monotonic between multiples of pi/2 (or either side of 0 for the
+// hyperbola.)  So over a step h the line's no longer than h |p'|max, and the
+// curvature's no more than ab / |p'|min^3, and each step is as long as that
+// allows.
+// Ellipses get their vertices bunched at the ends of the major axis, where
+// they turn, and hyperbolas near their vertex; a hyperbola's arms are nearly
+// straight, and need few.  (Evenly spaced steps of t get that backwards:
+// the arms run off in ever longer lines, and the tolerance has to be met at
+// the vertex, so the arms get far more than they need.)
+// See ReadMe.txt for more information.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+// |p'(t)|^2
+template<class T>
+inline T ConicSpeedSquared(bool hyperbola, T a2, T b2, T t)
+{
+    if (hyperbola)
+    {
+        const T s = std::sinh(t);
+        return b2 + (a2 + b2) * s * s;
+    }
+
+    const T s = std::sin(t);
+    return b2 + (a2 - b2) * s * s;
+}
+
+
+// The least and greatest |p'|^2 over [t0, t1]
+template<class T>
+inline void ConicSpeedSquaredRange(bool hyperbola, T a2, T b2, T t0, T t1, T& least, T& greatest)
+{
+    const T s0 = ConicSpeedSquared(hyperbola, a2, b2, t0);
+    const T s1 = ConicSpeedSquared(hyperbola, a2, b2, t1);
+    least = std::min(s0, s1);
+    greatest = std::max(s0, s1);
+
+    if (hyperbola)
+    {
+        if (t0 < (T)0 && t1 > (T)0) least = b2;
+    }
+    else
+    {
+        // Ellipse steps are never more than pi/2, so there are at most two
+        // turning points in there
+        const T quarter = (T)0.5 * pi<T>;
+        for (T k = std::ceil(t0 / quarter); k * quarter < t1; k += (T)1)
+        {
+            const T s = ConicSpeedSquared(hyperbola, a2, b2, k * quarter);
+            least = std::min(least, s);
+            greatest = std::max(greatest, s);
+        }
+    }
+}
+
+
+// The vertices' parameters, from start to start + length, for no more than
+// tolerance between the lines and the conic.  False if that would take more
+// than maxLines, or the conic, span or tolerance aren't finite (NaN steps
+// never finish it).
+template<class T>
+bool GetConicTessellationSteps(bool hyperbola, T a, T b, T start, T length, T tolerance, int maxLines, std::vector<T>& params)
+{
+    if (!std::isfinite(a * b) || !std::isfinite(start) || !std::isfinite(length) || !std::isfinite(tolerance))
+    {
+        params.clear();
+        return false;
+    }
+
+    const T ab = std::abs(a * b);
+    const T a2 = a * a;
+    const T b2 = b * b;
+    const T direction = length < (T)0 ? (T)-1 : (T)1;
+    const T span = std::abs(length);
+    const T maxStep = hyperbola ? span : std::min(span, (T)0.5 * pi<T>);
+    const T eightTolerance = (T)8 * tolerance;
+
+    params.clear();
+    params.push_back(start);
+
+    T done = (T)0;
+    while (done < span)
+    {
+        if ((int)params.size() > maxLines)
+        {
+            return false;
+        }
+
+        const T t = start + direction * done;
+
+        // As long as here allows, then shorter until the worst of it allows
+        // that (the speed can change a lot over a hyperbola's step)
+        const T here = ConicSpeedSquared(hyperbola, a2, b2, t);
+        T step = std::min(maxStep, std::sqrt(eightTolerance * std::sqrt(here) / ab));
+        step = std::min(step, span - done);
+
+        for (;;)
+        {
+            const T t1 = t + direction * step;
+            T least, greatest;
+            ConicSpeedSquaredRange(hyperbola, a2, b2, std::min(t, t1), std::max(t, t1), least, greatest);
+
+            const T allowed = std::sqrt(eightTolerance * least * std::sqrt(least) / ab / greatest);
+            if (allowed >= step) break;
+
+            step = std::max(allowed, (T)0.5 * step);
+        }
+
+        // (Don't leave a sliver for the last one, split what's left instead)
+        if (span - done - step < (T)0.25 * step)
+        {
+            done = step < span - done ? (T)0.5 * (done + span) : span;
+        }
+        else
+        {
+            done += step;
+        }
+
+        params.push_back(done < span ? start + direction * done : start + length);
+    }
+
+    return true;
+}
+
+
+// GetConicTessellationSteps, loosening the tolerance until it takes no more
+// than maxLines.  (Lines scale with 1 / sqrt(tolerance).)  Degenerate and
+// non-finite conics, and no tolerance, are just evenly spaced.
+template<class T>
+void GetConicTessellation(bool hyperbola, T a, T b, T start, T length, T tolerance, int maxLines, std::vector<T>& params)
+{
+    maxLines = std::max(maxLines, 1);
+
+    const bool finite = std::isfinite(a * b) && std::isfinite(start) && std::isfinite(length);
+
+    if (finite && a * b != (T)0 && tolerance > (T)0 && length != (T)0)
+    {
+        for (int attempt = 0; attempt < 4; ++attempt)
+        {
+            if (GetConicTessellationSteps(hyperbola, a, b, start, length, tolerance, maxLines, params))
+            {
+                return;
+            }
+
+            // (It gives up at maxLines, so how many it'd take isn't known.
+            // Each time round halves them.)
+            tolerance *= (T)4;
+        }
+    }
+
+    params.resize(maxLines + 1);
+    for (int i = 0; i <= maxLines; ++i)
+    {
+        params[i] = start + length * (T)i / (T)maxLines;
+    }
+}
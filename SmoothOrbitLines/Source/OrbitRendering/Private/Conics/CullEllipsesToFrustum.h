@@ -0,0 +1,454 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+
+//-----------------------------------------------------------------------------
+// CullEllipsesToFrustum
+// Culls ellipses to the view frustum in 3D, before anything's projected.
+// ClipEllipseToFrustum can only say an ellipse is off screen once it's been
+// projected, which is most of the work.
+//
+// Each ellipse is bounded by a (flat) oriented box, and the boxes by a
+// bounding volume hierarchy of spheres.  A query walks the hierarchy against
+// the frustum's planes, and tests the boxes in the leaves that might be
+// visible (IntrOrientedBox3Frustum3.)  A box that's in the frustum is then
+// narrowed down to the ellipse's arcs, each in a thin box of its own, since
+// the box takes in all of the ellipse's inside too.  Culling is conservative,
+// if in doubt an ellipse is kept.
+//
+// The frustum is the projection's: from the eye out through the projection
+// plane's (z) edges.  The ellipses aren't clipped to the projection plane,
+// so anything that comes within reach of the near plane is kept regardless.
+// See ReadMe.txt for more information.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "GTE/Mathematics/Vector2.h"
+#include "GTE/Mathematics/Vector3.h"
+#include "GTE/Mathematics/Hypersphere.h"
+#include "GTE/Mathematics/OrientedBox.h"
+#include "GTE/Mathematics/Frustum3.h"
+#include "GTE/Mathematics/IntrOrientedBox3Frustum3.h"
+#include <algorithm>
+#include <vector>
+
+using namespace gte;
+
+#include "Conics.h"
+
+
+// The box around an ellipse, flat in the ellipse's plane
+template<class T>
+OrientedBox3<T> GetEllipseBounds(const Vector3<T>& Ce, const Vector3<T>& Ue, const Vector3<T>& Ve, T A, T B)
+{
+    OrientedBox3<T> box;
+    box.center = Ce;
+    box.axis[0] = Ue;
+    box.axis[1] = Ve;
+    box.axis[2] = UnitCross(Ue, Ve);
+    box.extent = Vector3<T>{ A, B, (T)0 };
+    return box;
+}
+
+
+// The projection's frustum, out to far.  (Up, Vp) are the plane's axes,
+// Np points back at the eye.
+template<class T>
+Frustum3<T> GetViewFrustum(
+    const Vector3<T>& E,
+    const Vector3<T>& Np,
+    const Vector3<T>& Up,
+    const Vector3<T>& Vp,
+    const FrustumParameters<T>& frustum,
+    T far
+)
+{
+    const T maxX = frustum.z * tan(frustum.fov / 2);
+    const T maxY = maxX / frustum.aspectRatio;
+
+    return Frustum3<T>(E, -Np, Vp, Up, frustum.z, std::max(far, (T)2 * frustum.z), maxY, maxX);
+}
+
+
+// An orthographic view's box, as a frustum.  The image doesn't care which side
+// of E an orbit's on, so the box is the plane's rectangle swept from far
+// behind E to far in front of it.  The frustum's eye is pulled back so far
+// that it takes in the box with almost nothing to spare: it's exactly the
+// rectangle at its near end, and only ~2 far / pullback wider at the other.
+template<class T>
+Frustum3<T> GetOrthographicViewFrustum(
+    const Vector3<T>& E,
+    const Vector3<T>& Np,
+    const Vector3<T>& Up,
+    const Vector3<T>& Vp,
+    const FrustumParameters<T>& frustum,
+    T far
+)
+{
+    const T maxX = frustum.z * tan(frustum.fov / 2);
+    const T maxY = maxX / frustum.aspectRatio;
+
+    far = std::max(far, (T)2 * frustum.z);
+    const T pullback = (T)1000 * std::max(far, maxX);
+
+    return Frustum3<T>(E + pullback * Np, -Np, Vp, Up, pullback - far, pullback + far, maxY, maxX);
+}
+
+
+template<class T>
+class EllipseBoundingVolumes
+{
+public:
+    size_t size() const { return boxes.size(); }
+
+    // Far enough to take in every ellipse from E
+    T GetFarDistance(const Vector3<T>& E) const
+    {
+        return nodes.size() ? Length(nodes[0].bound.center - E) + nodes[0].bound.radius : (T)0;
+    }
+
+    void Build(std::vector<OrientedBox3<T>>&& ellipseBoxes)
+    {
+        boxes = std::move(ellipseBoxes);
+        spheres.resize(boxes.size());
+        order.resize(boxes.size());
+        nodes.clear();
+
+        for (int i = 0; i < (int)boxes.size(); ++i)
+        {
+            spheres[i].center = boxes[i].center;
+            spheres[i].radius = Length(boxes[i].extent);
+            order[i] = i;
+        }
+
+        if (boxes.size())
+        {
+            nodes.reserve(2 * boxes.size() / LeafSize + 1);
+            BuildNode(0, (int)boxes.size());
+
+            // Store the leaves' members contiguously, in hierarchy order
+            std::vector<OrientedBox3<T>> orderedBoxes(boxes.size());
+            std::vector<Sphere3<T>> orderedSpheres(boxes.size());
+            for (int i = 0; i < (int)boxes.size(); ++i)
+            {
+                orderedBoxes[i] = boxes[order[i]];
+                orderedSpheres[i] = spheres[order[i]];
+            }
+            boxes = std::move(orderedBoxes);
+            spheres = std::move(orderedSpheres);
+        }
+    }
+
+    // Indices of the ellipses that might be visible, in order
+    void Cull(const Frustum3<T>& frustum, std::vector<int>& visible) const
+    {
+        visible.clear();
+
+        if (nodes.size())
+        {
+            CullSubtree(frustum, 0, visible);
+        }
+
+        std::sort(visible.begin(), visible.end());
+    }
+
+    // The nodes depth levels down (or leaves, short of that.)  Their subtrees
+    // partition the ellipses, and can be culled in parallel.
+    void GetSubtrees(int depth, std::vector<int>& subtrees) const
+    {
+        subtrees.clear();
+
+        if (nodes.size())
+        {
+            GetSubtrees(0, depth, subtrees);
+        }
+    }
+
+    // Cull's work for one subtree.  Appends to visible, not in order.
+    void CullSubtree(const Frustum3<T>& frustum, int subtree, std::vector<int>& visible) const
+    {
+        // The frustum's side planes reject most of the hierarchy more cheaply
+        // than IntrSphere3Frustum3's exact distance would.  Spheres that get
+        // past them are close enough that the boxes are worth testing.
+        const FrustumPlanes planes(frustum);
+        TIQuery<T, OrientedBox3<T>, Frustum3<T>> boxQuery;
+
+        int stack[64];
+        int top = 0;
+        stack[top++] = subtree;
+
+        while (top)
+        {
+            const Node& node = nodes[stack[--top]];
+
+            if (!NearEye(node.bound, frustum) && planes.Outside(node.bound))
+            {
+                continue;
+            }
+
+            if (node.left < 0)
+            {
+                for (int i = node.first; i < node.first + node.count; ++i)
+                {
+                    if (MightBeVisible(boxes[i], spheres[i], frustum, planes, boxQuery))
+                    {
+                        visible.push_back(order[i]);
+                    }
+                }
+            }
+            else
+            {
+                stack[top++] = node.right;
+                stack[top++] = node.left;
+            }
+        }
+    }
+
+private:
+    static constexpr int LeafSize = 8;
+    static constexpr int ArcCount = 16;
+
+    struct Node
+    {
+        Sphere3<T> bound;
+        int first, count;    // <- Range of order[] (and boxes[], once built)
+        int left, right;     // <- Children, -1 for leaves
+    };
+
+    // The frustum's near and side planes (far takes in everything, see
+    // GetFarDistance.)  X is outside plane j if Dot(normal[j], X - origin)
+    // + offset[j] > 0.
+    struct FrustumPlanes
+    {
+        FrustumPlanes(const Frustum3<T>& frustum)
+            : origin(frustum.origin)
+        {
+            normal[0] = -frustum.dVector;
+            normal[1] = frustum.dMin * frustum.rVector - frustum.rBound * frustum.dVector;
+            normal[2] = -frustum.dMin * frustum.rVector - frustum.rBound * frustum.dVector;
+            normal[3] = frustum.dMin * frustum.uVector - frustum.uBound * frustum.dVector;
+            normal[4] = -frustum.dMin * frustum.uVector - frustum.uBound * frustum.dVector;
+            offset[0] = frustum.dMin;
+            for (int j = 1; j < 5; ++j)
+            {
+                Normalize(normal[j]);
+                offset[j] = (T)0;
+            }
+        }
+
+        bool Outside(const Sphere3<T>& sphere) const
+        {
+            const Vector3<T> d = sphere.center - origin;
+            for (int j = 0; j < 5; ++j)
+            {
+                if (Dot(normal[j], d) + offset[j] > sphere.radius) return true;
+            }
+            return false;
+        }
+
+        Vector3<T> origin;
+        Vector3<T> normal[5];
+        T offset[5];
+    };
+
+    // One ellipse.  Its box is only a loose fit: when the eye's near the
+    // ellipse's plane, the box takes in a lot of the plane that the ellipse
+    // doesn't.  So, if the box is in the frustum, the ellipse's arcs are
+    // tried one by one, each in its own (thin) box.
+    static bool MightBeVisible(
+        const OrientedBox3<T>& box,
+        const Sphere3<T>& sphere,
+        const Frustum3<T>& frustum,
+        const FrustumPlanes& planes,
+        TIQuery<T, OrientedBox3<T>, Frustum3<T>>& boxQuery
+    )
+    {
+        if (!NearEye(box, frustum) && (planes.Outside(sphere) || !boxQuery(box, frustum).intersect))
+        {
+            return false;
+        }
+
+        const T A = box.extent[0];
+        const T B = box.extent[1];
+
+        // The arc from t0 to t1 (a quarter turn or less) lies between its
+        // chord and the parallel tangent, which touches at the middle, tm.
+        // (An ellipse is a stretched circle, and that's so for circles.)
+        // The arcs are the same for every ellipse, up to (A, B).
+        static const struct ArcTable
+        {
+            ArcTable()
+            {
+                for (int k = 0; k <= 2 * ArcCount; ++k)
+                {
+                    const T t = pi<T> * (T)k / (T)ArcCount;
+                    cs[k] = Vector2<T>{ cos(t), sin(t) };
+                }
+            }
+            Vector2<T> cs[2 * ArcCount + 1];   // <- t0, tm, t1, tm, ...
+        } arcs;
+
+        // The planes and the eye in the ellipse's plane, so most arcs can be
+        // ruled out in 2D.
+        const Vector3<T> w = box.center - frustum.origin;
+        Vector3<T> planeUV[5];
+        for (int j = 0; j < 5; ++j)
+        {
+            planeUV[j] = Vector3<T>{ Dot(planes.normal[j], box.axis[0]), Dot(planes.normal[j], box.axis[1]), Dot(planes.normal[j], w) + planes.offset[j] };
+        }
+        const Vector2<T> eye{ -Dot(w, box.axis[0]), -Dot(w, box.axis[1]) };
+        const T eyeHeight = Dot(w, box.axis[2]);
+        const T near = NearDistance(frustum);
+        const T nearInPlaneSquared = near * near - eyeHeight * eyeHeight;
+
+        for (int k = 0; k < ArcCount; ++k)
+        {
+            const Vector2<T> p0{ A * arcs.cs[2 * k][0], B * arcs.cs[2 * k][1] };
+            const Vector2<T> pm{ A * arcs.cs[2 * k + 1][0], B * arcs.cs[2 * k + 1][1] };
+            const Vector2<T> p1{ A * arcs.cs[2 * k + 2][0], B * arcs.cs[2 * k + 2][1] };
+
+            // The arc's box: (d, n) with extents (h0, h1)
+            Vector2<T> d = p1 - p0;
+            const T h0 = (T)0.5 * Normalize(d);
+            const Vector2<T> n{ -d[1], d[0] };
+            const T bulge = Dot(pm - p0, n);
+            const T h1 = (T)0.5 * std::abs(bulge);
+            const Vector2<T> center = p0 + h0 * d + ((T)0.5 * bulge) * n;
+
+            // Near the eye?
+            if (nearInPlaneSquared >= (T)0)
+            {
+                const Vector2<T> e = eye - center;
+                const T x = std::max(std::abs(Dot(e, d)) - h0, (T)0);
+                const T y = std::max(std::abs(Dot(e, n)) - h1, (T)0);
+                if (x * x + y * y <= nearInPlaneSquared)
+                {
+                    return true;
+                }
+            }
+
+            // Outside a plane?
+            bool outside = false;
+            for (int j = 0; j < 5 && !outside; ++j)
+            {
+                const T du = planeUV[j][0] * d[0] + planeUV[j][1] * d[1];
+                const T nu = planeUV[j][0] * n[0] + planeUV[j][1] * n[1];
+                outside = planeUV[j][2] + planeUV[j][0] * center[0] + planeUV[j][1] * center[1] > h0 * std::abs(du) + h1 * std::abs(nu);
+            }
+            if (outside)
+            {
+                continue;
+            }
+
+            OrientedBox3<T> arc;
+            arc.center = box.center + center[0] * box.axis[0] + center[1] * box.axis[1];
+            arc.axis[0] = d[0] * box.axis[0] + d[1] * box.axis[1];
+            arc.axis[1] = n[0] * box.axis[0] + n[1] * box.axis[1];
+            arc.axis[2] = box.axis[2];
+            arc.extent = Vector3<T>{ h0, h1, (T)0 };
+
+            if (boxQuery(arc, frustum).intersect)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Within reach of the near plane's corners, where the frustum's cut off
+    // but the projection isn't.
+    static T NearDistance(const Frustum3<T>& frustum)
+    {
+        return std::sqrt(frustum.dMin * frustum.dMin + frustum.uBound * frustum.uBound + frustum.rBound * frustum.rBound);
+    }
+
+    static bool NearEye(const Sphere3<T>& sphere, const Frustum3<T>& frustum)
+    {
+        return Length(sphere.center - frustum.origin) <= sphere.radius + NearDistance(frustum);
+    }
+
+    static bool NearEye(const OrientedBox3<T>& box, const Frustum3<T>& frustum)
+    {
+        const Vector3<T> d = frustum.origin - box.center;
+        T distanceSquared = (T)0;
+        for (int j = 0; j < 3; ++j)
+        {
+            const T x = std::abs(Dot(d, box.axis[j])) - box.extent[j];
+            if (x > (T)0) distanceSquared += x * x;
+        }
+        const T near = NearDistance(frustum);
+        return distanceSquared <= near * near;
+    }
+
+    void GetSubtrees(int index, int depth, std::vector<int>& subtrees) const
+    {
+        if (depth <= 0 || nodes[index].left < 0)
+        {
+            subtrees.push_back(index);
+        }
+        else
+        {
+            GetSubtrees(nodes[index].left, depth - 1, subtrees);
+            GetSubtrees(nodes[index].right, depth - 1, subtrees);
+        }
+    }
+
+    int BuildNode(int first, int count)
+    {
+        const int index = (int)nodes.size();
+        nodes.push_back(Node());
+
+        // Bound the members' spheres, and split on the longest axis of their centers
+        Vector3<T> lo = spheres[order[first]].center, hi = lo;
+        Vector3<T> centerLo = lo, centerHi = lo;
+        for (int i = first; i < first + count; ++i)
+        {
+            const Sphere3<T>& sphere = spheres[order[i]];
+            for (int j = 0; j < 3; ++j)
+            {
+                lo[j] = std::min(lo[j], sphere.center[j] - sphere.radius);
+                hi[j] = std::max(hi[j], sphere.center[j] + sphere.radius);
+                centerLo[j] = std::min(centerLo[j], sphere.center[j]);
+                centerHi[j] = std::max(centerHi[j], sphere.center[j]);
+            }
+        }
+
+        Sphere3<T> bound;
+        bound.center = (T)0.5 * (lo + hi);
+        bound.radius = (T)0;
+        for (int i = first; i < first + count; ++i)
+        {
+            const Sphere3<T>& sphere = spheres[order[i]];
+            bound.radius = std::max(bound.radius, Length(sphere.center - bound.center) + sphere.radius);
+        }
+
+        nodes[index].bound = bound;
+        nodes[index].first = first;
+        nodes[index].count = count;
+        nodes[index].left = -1;
+        nodes[index].right = -1;
+
+        if (count > LeafSize)
+        {
+            const Vector3<T> extent = centerHi - centerLo;
+            const int axis = extent[0] > extent[1] ? (extent[0] > extent[2] ? 0 : 2) : (extent[1] > extent[2] ? 1 : 2);
+            const int half = count / 2;
+
+            std::nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count,
+                [this, axis](int a, int b) { return spheres[a].center[axis] < spheres[b].center[axis]; });
+
+            const int left = BuildNode(first, half);
+            const int right = BuildNode(first + half, count - half);
+            nodes[index].left = left;
+            nodes[index].right = right;
+        }
+
+        return index;
+    }
+
+    std::vector<OrientedBox3<T>> boxes;
+    std::vector<Sphere3<T>> spheres;
+    std::vector<int> order;
+    std::vector<Node> nodes;
+};
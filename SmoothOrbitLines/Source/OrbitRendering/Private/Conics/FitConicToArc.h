@@ -0,0 +1,222 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+
+//-----------------------------------------------------------------------------
+// FitConicToArc
+// Fits an ellipse or hyperbola to a sampled 3D trajectory arc (a propagated
+// or otherwise non-Keplerian path) so the arc can be drawn through the same
+// projected-conic path as a Keplerian orbit.
+// The fit is done in two stages:
+//  1. An orthogonal least-squares plane (GTE ApprOrthogonalPlane3)
+//  2. An algebraic least-squares conic in that plane (GTE ApprQuadratic2)
+// The conic is classified by its quadratic form and reduced to the
+// center/axis representation used by ProjectEllipseToPlane.
+// (GTE's ApprEllipse2 was not used; it is iterative and only fits ellipses.)
+// The samples are assumed to be ordered along the arc.
+// See ReadMe.txt for more information.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "GTE/Mathematics/Vector2.h"
+#include "GTE/Mathematics/Vector3.h"
+#include "GTE/Mathematics/ApprOrthogonalPlane3.h"
+#include "GTE/Mathematics/ApprQuadratic2.h"
+#include "GTE/Mathematics/SymmetricEigensolver2x2.h"
+#include <vector>
+#include <array>
+
+using namespace gte;
+
+#include "Conics.h"
+
+
+template<class T>
+struct ConicArcFit
+{
+    // Center, unit axes and unit normal of the fitted conic
+    Vector3<T>  C, U, V, N;
+    // Semi-axes.  For hyperbolas, a is the transverse semi-axis.
+    T           a, b;
+    bool        isHyperbolic;
+
+    // Parameter range covered by the samples.
+    // (Eccentric-anomaly-like angle for ellipses, hyperbolic angle for hyperbolas.)
+    T           arcStart, arcLength;
+
+    // Distance from the samples to the fitted conic, in input units
+    T           rmsResidual, maxResidual;
+};
+
+
+template<class T>
+bool FitConicToArc(
+    const std::vector<Vector3<T>>& samples,
+    ConicArcFit<T>& fit
+)
+{
+    const int n = (int)samples.size();
+
+    // A conic has 5 degrees of freedom
+    if (n < 5)
+    {
+        return false;
+    }
+
+    // ------------------------------------------------------------------------
+    // Plane
+    // ------------------------------------------------------------------------
+    ApprOrthogonalPlane3<T> planeFitter;
+    planeFitter.Fit(samples);
+    const Vector3<T> origin = planeFitter.GetParameters().first;
+
+    Vector3<T> basis[3];
+    basis[0] = planeFitter.GetParameters().second;
+    ComputeOrthogonalComplement(1, basis);
+    const Vector3<T>& N = basis[0];
+    const Vector3<T>& U0 = basis[1];
+    const Vector3<T>& V0 = basis[2];
+
+    // ------------------------------------------------------------------------
+    // Conic, in normalized plane coordinates (for conditioning)
+    // ------------------------------------------------------------------------
+    std::vector<Vector2<T>> points(n);
+    T scale = (T)0;
+    for (int i = 0; i < n; ++i)
+    {
+        const Vector3<T> diff = samples[i] - origin;
+        points[i] = Vector2<T>{ Dot(diff, U0), Dot(diff, V0) };
+        scale += Dot(points[i], points[i]);
+    }
+    scale = sqrt(scale / (T)n);
+
+    if (!(scale > (T)0))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < n; ++i)
+    {
+        points[i] /= scale;
+    }
+
+    // 0 = c0 + c1*x + c2*y + c3*x^2 + c4*x*y + c5*y^2
+    std::array<T, 6> c;
+    ApprQuadratic2<T> conicFitter;
+    conicFitter(n, points.data(), c);
+
+    // P^T A P + B^T P + K = 0
+    const T a00 = c[3], a01 = (T)0.5 * c[4], a11 = c[5];
+    const T det = a00 * a11 - a01 * a01;
+
+    // Parabolic (or degenerate) fits aren't representable.
+    if (std::abs(det) <= (T)1e-12 * (a00 * a00 + (T)2 * a01 * a01 + a11 * a11))
+    {
+        return false;
+    }
+
+    // Center, k = -A^-1 B / 2
+    const Vector2<T> k{
+        -(T)0.5 * ( a11 * c[1] - a01 * c[2]) / det,
+        -(T)0.5 * (-a01 * c[1] + a00 * c[2]) / det
+    };
+
+    // (P-k)^T A (P-k) = d
+    const T d = a00 * k[0] * k[0] + (T)2 * a01 * k[0] * k[1] + a11 * k[1] * k[1] - c[0];
+
+    SymmetricEigensolver2x2<T> eigensolver;
+    std::array<T, 2> S;
+    std::array<std::array<T, 2>, 2> evec;
+    eigensolver(a00 / d, a01 / d, a11 / d, -1, S, evec);
+
+    // Imaginary ellipse, nothing to draw
+    if (!(S[0] > (T)0))
+    {
+        return false;
+    }
+
+    const bool isHyperbolic = S[1] < (T)0;
+
+    // ------------------------------------------------------------------------
+    // Back to 3D, in input units
+    // ------------------------------------------------------------------------
+    fit.isHyperbolic = isHyperbolic;
+    fit.a = scale / sqrt(S[0]);
+    fit.b = scale / sqrt(std::abs(S[1]));
+    fit.C = origin + scale * (k[0] * U0 + k[1] * V0);
+    fit.U = evec[0][0] * U0 + evec[0][1] * V0;
+    fit.V = evec[1][0] * U0 + evec[1][1] * V0;
+
+    // ------------------------------------------------------------------------
+    // Parameter range, orienting the axes so the parameter increases along
+    // the arc (and the hyperbola's samples are on its +U branch)
+    // ------------------------------------------------------------------------
+    std::vector<T> parameters(n);
+
+    if (isHyperbolic)
+    {
+        if (Dot(samples[n / 2] - fit.C, fit.U) < (T)0)
+        {
+            fit.U = -fit.U;
+        }
+
+        for (int i = 0; i < n; ++i)
+        {
+            parameters[i] = asinh(Dot(samples[i] - fit.C, fit.V) / fit.b);
+        }
+
+        if (parameters[n - 1] < parameters[0])
+        {
+            fit.V = -fit.V;
+            for (int i = 0; i < n; ++i) parameters[i] = -parameters[i];
+        }
+    }
+    else
+    {
+        // Unwrap the angles as we go...
+        T last = (T)0;
+        for (int i = 0; i < n; ++i)
+        {
+            const Vector3<T> diff = samples[i] - fit.C;
+            T theta = atan2(Dot(diff, fit.V) / fit.b, Dot(diff, fit.U) / fit.a);
+            if (i > 0)
+            {
+                while (theta - last > pi<T>) theta -= twopi<T>;
+                while (theta - last < -pi<T>) theta += twopi<T>;
+            }
+            parameters[i] = last = theta;
+        }
+
+        if (parameters[n - 1] < parameters[0])
+        {
+            fit.V = -fit.V;
+            for (int i = 0; i < n; ++i) parameters[i] = -parameters[i];
+        }
+    }
+
+    fit.N = UnitCross(fit.U, fit.V);
+    fit.arcStart = parameters[0];
+    fit.arcLength = parameters[n - 1] - parameters[0];
+
+    // ------------------------------------------------------------------------
+    // Residuals, sample to the conic point at the sample's parameter
+    // ------------------------------------------------------------------------
+    T sumSquares = (T)0;
+    fit.maxResidual = (T)0;
+
+    for (int i = 0; i < n; ++i)
+    {
+        const T t = parameters[i];
+        const Vector3<T> onConic = isHyperbolic
+            ? fit.C + fit.a * cosh(t) * fit.U + fit.b * sinh(t) * fit.V
+            : fit.C + fit.a * cos(t) * fit.U + fit.b * sin(t) * fit.V;
+
+        const T residual = Length(samples[i] - onConic);
+        sumSquares += residual * residual;
+        fit.maxResidual = std::max(fit.maxResidual, residual);
+    }
+
+    fit.rmsResidual = sqrt(sumSquares / (T)n);
+
+    return true;
+}
@@ -0,0 +1,52 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+
+//-----------------------------------------------------------------------------
+// GuardBandFrustum
+// A frustum widened on every side by a guard band (a fraction of its size.)
+// Conics clipped to the band are still clipped right after the camera turns a
+// little, until the band's edges come into view.  How little: the frustum's
+// corners are nearest the band's sides, and the rays through them are
+// sin(angle) from the sides' planes.
+// See ReadMe.txt for more information.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include "Conics.h"
+
+
+// The frustum, widened by guardBand on every side
+template<class T>
+FrustumParameters<T> GetGuardBandFrustum(const FrustumParameters<T>& frustum, T guardBand)
+{
+    FrustumParameters<T> band = frustum;
+    band.fov = (T)2 * std::atan(((T)1 + guardBand) * std::tan((T)0.5 * frustum.fov));
+    return band;
+}
+
+
+// How far the camera can turn (radians) before the frustum leaves its guard
+// band
+template<class T>
+T GetGuardBandRadians(const FrustumParameters<T>& frustum, T guardBand)
+{
+    if (guardBand <= (T)0)
+    {
+        return (T)0;
+    }
+
+    const T tanX = std::tan((T)0.5 * frustum.fov);
+    const T tanY = tanX / frustum.aspectRatio;
+    const T corner = std::sqrt((T)1 + tanX * tanX + tanY * tanY);
+
+    const T bandX = ((T)1 + guardBand) * tanX;
+    const T bandY = ((T)1 + guardBand) * tanY;
+    const T sinX = guardBand * tanX / (corner * std::sqrt((T)1 + bandX * bandX));
+    const T sinY = guardBand * tanY / (corner * std::sqrt((T)1 + bandY * bandY));
+
+    return std::asin(std::min(sinX, sinY));
+}
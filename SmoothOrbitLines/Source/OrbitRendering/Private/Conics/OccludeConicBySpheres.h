@@ -0,0 +1,659 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+
+//-----------------------------------------------------------------------------
+// OccludeConicBySpheres
+// Takes the stretches of an image conic that are hidden behind spheres (the
+// planets) out of its clipped segments, so they're never tessellated.
+//
+// The image conic's point p(t) is the image of the orbit point X(t) seen along
+// the ray from the eye E through it, D(t) = Cp + p(t) - E (p in the plane's
+// Up, Vp.)  D is affine in (C, S) = (cos t, sin t), or (cosh t, sinh t) for a
+// hyperbola, and the orbit point is X = E + lambda D, lambda = W.N / D.N for
+// the orbit's plane (O, N), W = O - E.  X is hidden behind the sphere (S, r)
+// when the ray passes within r of S, S is in front of the eye, and X is in
+// the sphere or past it.  The first and second change where
+//      |D|^2 (|S - E|^2 - r^2) - (D . (S - E))^2 = 0
+//      |(W.N) D - (D.N) (S - E)|^2 - r^2 (D.N)^2 = 0
+// (the ray grazes the sphere, and X crosses its surface.)  Both are quadratic
+// forms in (1, C, S), which are quartics in x = tan(t/2) for an ellipse, or
+// in w = e^t for a hyperbola.  The conic is split at their roots, and each
+// piece is hidden or not according to its middle.  Orthographic views are the
+// same, with the rays running along -Np from the plane instead.
+//
+// There's no approximation in there.  (A sphere's outline isn't a circle in
+// perspective, it's a conic of its own, and this doesn't need to know what
+// it is.)  Spheres that can't be anywhere near the conic, or are off screen,
+// are passed over before any of it, see SphereMayOccludeConic.
+// See ReadMe.txt for more information.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "GTE/Mathematics/Vector2.h"
+#include "GTE/Mathematics/Vector3.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace gte;
+
+#include "Conics.h"
+#include "ProjectEllipseToPlaneClosedForm.h"
+
+
+// v[0] + C v[1] + S v[2]
+template<class T>
+struct ConicAffine
+{
+    Vector3<T> v[3];
+};
+
+
+// (1, C, S) m (1, C, S)^T
+template<class T>
+struct ConicQuadratic
+{
+    T m[3][3];
+};
+
+
+// x . y, as a quadratic form
+template<class T>
+ConicQuadratic<T> DotAffine(const ConicAffine<T>& x, const ConicAffine<T>& y)
+{
+    ConicQuadratic<T> q;
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            q.m[i][j] = (T)0.5 * (Dot(x.v[i], y.v[j]) + Dot(x.v[j], y.v[i]));
+        }
+    }
+    return q;
+}
+
+
+// q - s l l^T, for the linear form l
+template<class T>
+inline void SubtractOuter(ConicQuadratic<T>& q, const T(&l)[3], T s)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            q.m[i][j] -= s * l[i] * l[j];
+        }
+    }
+}
+
+
+// q times (1 + x^2)^2, x = tan(t/2), or (2w)^2, w = e^t, which is a quartic
+template<class T>
+void ConicQuadraticToQuartic(const ConicQuadratic<T>& q, bool hyperbolic, T(&c)[5])
+{
+    // 1, C and S, times (1 + x^2) or 2w, as polynomials
+    static constexpr T EllipseBasis[3][3] = { { 1, 0, 1 }, { 1, 0, -1 }, { 0, 2, 0 } };
+    static constexpr T HyperbolaBasis[3][3] = { { 0, 2, 0 }, { 1, 0, 1 }, { -1, 0, 1 } };
+    const T(&basis)[3][3] = hyperbolic ? HyperbolaBasis : EllipseBasis;
+
+    std::fill(c, c + 5, (T)0);
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            for (int a = 0; a < 3; ++a)
+            {
+                for (int b = 0; b < 3; ++b)
+                {
+                    c[a + b] += q.m[i][j] * basis[i][a] * basis[j][b];
+                }
+            }
+        }
+    }
+}
+
+
+template<class T>
+inline T EvaluatePolynomial(int degree, const T* c, T x)
+{
+    T result = c[degree];
+    for (int i = degree - 1; i >= 0; --i)
+    {
+        result = result * x + c[i];
+    }
+    return result;
+}
+
+
+// A root on [lo, hi], if the polynomial changes sign there.  It's monotonic
+// on [lo, hi], so Newton's steps are safe while they stay in the bracket, and
+// it's bisected when they don't.
+template<class T>
+bool FindBracketedRoot(int degree, const T* c, T lo, T hi, T& root)
+{
+    const T zero = (T)0;
+
+    T plo = EvaluatePolynomial(degree, c, lo);
+    const T phi = EvaluatePolynomial(degree, c, hi);
+    if (plo == zero) { root = lo; return true; }
+    if (phi == zero) { root = hi; return true; }
+    if ((plo > zero) == (phi > zero)) return false;
+
+    root = (T)0.5 * (lo + hi);
+    for (int i = 0; i < 256; ++i)
+    {
+        // p and p' together (Horner's)
+        T p = c[degree], dp = zero;
+        for (int j = degree - 1; j >= 0; --j)
+        {
+            dp = dp * root + p;
+            p = p * root + c[j];
+        }
+        if (p == zero) break;
+
+        if ((p > zero) == (plo > zero))
+        {
+            lo = root;
+            plo = p;
+        }
+        else
+        {
+            hi = root;
+        }
+
+        T next = dp != zero ? root - p / dp : lo;
+        if (!(next > lo && next < hi))
+        {
+            next = (T)0.5 * (lo + hi);
+        }
+
+        if (next == root || next == lo || next == hi) break;
+        if (std::abs(next - root) <= std::numeric_limits<T>::epsilon() * std::abs(root)) { root = next; break; }
+        root = next;
+    }
+
+    return true;
+}
+
+
+// The real roots of c (degree 4 at most) on [xmin, xmax], ascending.  Same as
+// RootsPolynomial::Find: the derivative's roots split the range into pieces
+// the polynomial is monotonic on, with a root in a piece at most.  But on the
+// stack.
+template<class T>
+int FindPolynomialRoots(int degree, const T* c, T xmin, T xmax, T* roots)
+{
+    while (degree > 0 && c[degree] == (T)0) --degree;
+
+    if (degree <= 0)
+    {
+        return 0;
+    }
+
+    if (degree == 1)
+    {
+        const T x = -c[0] / c[1];
+        if (x < xmin || x > xmax) return 0;
+        roots[0] = x;
+        return 1;
+    }
+
+    T derivative[4];
+    for (int i = 0; i < degree; ++i)
+    {
+        derivative[i] = c[i + 1] * (T)(i + 1) / (T)degree;
+    }
+
+    T extrema[4];
+    const int extremaCount = FindPolynomialRoots(degree - 1, derivative, xmin, xmax, extrema);
+
+    int count = 0;
+    T lo = xmin;
+    for (int i = 0; i <= extremaCount; ++i)
+    {
+        const T hi = i < extremaCount ? extrema[i] : xmax;
+        if (FindBracketedRoot(degree, c, lo, hi, roots[count])) ++count;
+        lo = hi;
+    }
+
+    return count;
+}
+
+
+// Can the sphere hide any of the conic that's on screen?  Conservative: its
+// image is bounded by a circle (c, rho) on the plane, which has to reach the
+// rectangle, and an ellipse has to pass within rho of c.
+template<class T>
+bool SphereMayOccludeConic(
+    const EllipseProjectionView<T>& view,
+    bool orthographic,
+    const ClipRectangle<T>& rectangle,
+    const ConicProjection<T>& projection,
+    ProjectionType projectionType,
+    const OccludingSphere<T>& sphere
+)
+{
+    const T r = sphere.Radius;
+    T cx, cy, rho;
+
+    if (orthographic)
+    {
+        const Vector3<T> F = sphere.Center - view.Cp;
+        cx = Dot(F, view.Up);
+        cy = Dot(F, view.Vp);
+        rho = r;
+    }
+    else
+    {
+        const Vector3<T> W = sphere.Center - view.E;
+        const T d = Length(W);
+
+        // The eye's inside it
+        if (d <= r) return false;
+
+        // The angle to it off the view axis, and the angle it subtends
+        const T depth = -Dot(W, view.Np);
+        const T theta = std::acos(std::clamp(depth / d, (T)-1, (T)1));
+        const T alpha = std::asin(r / d);
+        const T halfPi = (T)0.5 * pi<T>;
+
+        // Behind the eye, or reaching round beside it (no bound on the plane)
+        if (theta - alpha >= halfPi) return false;
+        if (theta + alpha >= halfPi) return true;
+
+        // Its center's image, and the plane's stretch at the outline's edge
+        // (z / cos^2) times the angle to it
+        const T z = Dot(view.E - view.Cp, view.Np);
+        const T cosEdge = std::cos(theta + alpha);
+        cx = z * Dot(W, view.Up) / depth;
+        cy = z * Dot(W, view.Vp) / depth;
+        rho = z * alpha / (cosEdge * cosEdge);
+    }
+
+    if (std::abs(cx) - rho > rectangle.maxX || std::abs(cy) - rho > rectangle.maxY)
+    {
+        return false;
+    }
+
+    // Points of the ellipse are at (x/a)^2 + (y/b)^2 = 1, and that changes by
+    // no more than 1/min(a, b) per unit of distance.
+    if (projectionType == ProjectionType::Ellipse)
+    {
+        const Vector2<T> c{ cx - projection.k[0], cy - projection.k[1] };
+        const T x = Dot(c, projection.u) / projection.a;
+        const T y = Dot(c, projection.v) / projection.b;
+        const T f = std::sqrt(x * x + y * y);
+
+        if (std::min(projection.a, std::abs(projection.b)) * std::abs(f - (T)1) > rho)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+// The image conic (rotated by t0, so p(t0 + t) = v[0] + C v[1] + S v[2]), on
+// the plane in 3D
+template<class T>
+ConicAffine<T> GetImageConicAffine(const EllipseProjectionView<T>& view, const ConicProjection<T>& projection, ProjectionType projectionType, T t0)
+{
+    const T sign = projectionType == ProjectionType::NegativeHyperbola ? (T)-1 : (T)1;
+    const Vector3<T> U = sign * projection.a * (projection.u[0] * view.Up + projection.u[1] * view.Vp);
+    const Vector3<T> V = sign * projection.b * (projection.v[0] * view.Up + projection.v[1] * view.Vp);
+    const T c0 = std::cos(t0);
+    const T s0 = std::sin(t0);
+
+    ConicAffine<T> image;
+    image.v[0] = view.Cp + projection.k[0] * view.Up + projection.k[1] * view.Vp;
+    image.v[1] = c0 * U + s0 * V;
+    image.v[2] = c0 * V - s0 * U;
+    return image;
+}
+
+
+// Is the orbit point behind p (the image conic's point, in 3D) hidden?
+template<class T>
+bool IsImagePointOccluded(
+    const EllipseProjectionView<T>& view,
+    bool orthographic,
+    const Vector3<T>& O,
+    const Vector3<T>& N,
+    const OccludingSphere<T>& sphere,
+    const Vector3<T>& p
+)
+{
+    const Vector3<T> R = orthographic ? p : view.E;
+    const Vector3<T> D = orthographic ? -view.Np : p - view.E;
+
+    const T DN = Dot(D, N);
+    if (DN == (T)0) return false;
+
+    const Vector3<T> W = sphere.Center - R;
+    const T DD = Dot(D, D);
+    const T DW = Dot(D, W);
+    const T r2 = sphere.Radius * sphere.Radius;
+
+    // The ray misses it, or it's behind the eye
+    if (DD * Dot(W, W) - DW * DW > r2 * DD) return false;
+    if (!orthographic && DW <= (T)0) return false;
+
+    // In it, or past it
+    const Vector3<T> X = R + (Dot(O - R, N) / DN) * D;
+    const Vector3<T> XS = X - sphere.Center;
+    return Dot(XS, XS) <= r2 || Dot(XS, D) > (T)0;
+}
+
+
+// The (one or two) quadratic forms whose zeros are where the occlusion can
+// change, see above.  image as GetImageConicAffine left it.
+template<class T>
+void GetOcclusionQuadratics(
+    const EllipseProjectionView<T>& view,
+    bool orthographic,
+    const Vector3<T>& O,
+    const Vector3<T>& N,
+    const OccludingSphere<T>& sphere,
+    const ConicAffine<T>& image,
+    ConicQuadratic<T>& graze,
+    ConicQuadratic<T>& surface
+)
+{
+    const T r2 = sphere.Radius * sphere.Radius;
+    const T one[3] = { (T)1, (T)0, (T)0 };
+
+    if (orthographic)
+    {
+        const Vector3<T> d = -view.Np;
+        const T dN = Dot(d, N);
+
+        // Center to ray origin, and the distance along the ray to X
+        ConicAffine<T> W, XS;
+        T l[3], lambda[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            W.v[i] = i == 0 ? sphere.Center - image.v[0] : -image.v[i];
+            l[i] = Dot(d, W.v[i]);
+            lambda[i] = i == 0 ? Dot(O - image.v[0], N) / dN : -Dot(image.v[i], N) / dN;
+            XS.v[i] = lambda[i] * d - W.v[i];
+        }
+
+        graze = DotAffine(W, W);
+        SubtractOuter(graze, l, (T)1);
+        SubtractOuter(graze, one, r2);
+
+        surface = DotAffine(XS, XS);
+        SubtractOuter(surface, one, r2);
+    }
+    else
+    {
+        const Vector3<T> W = sphere.Center - view.E;
+        const T h = Dot(O - view.E, N);
+
+        ConicAffine<T> D, V;
+        T l[3], n[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            D.v[i] = i == 0 ? image.v[0] - view.E : image.v[i];
+            l[i] = Dot(D.v[i], W);
+            n[i] = Dot(D.v[i], N);
+            V.v[i] = h * D.v[i] - n[i] * W;
+        }
+
+        graze = DotAffine(D, D);
+        for (auto& row : graze.m)
+        {
+            for (T& m : row) m *= Dot(W, W) - r2;
+        }
+        SubtractOuter(graze, l, (T)1);
+
+        surface = DotAffine(V, V);
+        SubtractOuter(surface, n, r2);
+    }
+}
+
+
+// Where to put the tan(t/2) substitution's pole (where x is infinite) for an
+// ellipse: in the middle of the widest gap between its segments.
+template<class T>
+T GetEllipsePole(const std::vector<ConicSegment<T>>& segments)
+{
+    T pole = pi<T>;
+    T widest = (T)-1;
+
+    for (const ConicSegment<T>& segment : segments)
+    {
+        const T end = segment.SegmentStart + segment.SegmentLength;
+
+        T gap = twopi<T>;
+        for (const ConicSegment<T>& next : segments)
+        {
+            T toNext = std::fmod(next.SegmentStart - end, twopi<T>);
+            if (toNext < (T)0) toNext += twopi<T>;
+            gap = std::min(gap, toNext);
+        }
+
+        if (gap > widest)
+        {
+            widest = gap;
+            pole = end + (T)0.5 * gap;
+        }
+    }
+
+    return pole;
+}
+
+
+// Take what the sphere hides out of segments.  (For an ellipse, no segments
+// is all the way round.)  True if anything was, and then visible is whether
+// anything's left.
+template<class T>
+bool OccludeConicBySphere(
+    const EllipseProjectionView<T>& view,
+    bool orthographic,
+    const Vector3<T>& O,
+    const Vector3<T>& N,
+    const ConicProjection<T>& projection,
+    ProjectionType projectionType,
+    const OccludingSphere<T>& sphere,
+    std::vector<ConicSegment<T>>& segments,
+    bool& visible
+)
+{
+    // Tangents past this are as good as the pole
+    const T MaxTangent = (T)1e8;
+
+    const bool hyperbolic = projectionType != ProjectionType::Ellipse;
+    const bool whole = !hyperbolic && segments.empty();
+
+    if (orthographic && Dot(view.Np, N) == (T)0) return false;
+    if (hyperbolic && segments.empty()) return false;
+
+    // Ellipses are worked in (t0 - pi, t0 + pi), with the pole at either end.
+    // Each segment, [start, end) in there
+    const T t0 = hyperbolic ? (T)0 : (whole ? pi<T> : GetEllipsePole(segments)) - pi<T>;
+    auto Unroll = [&](T start)
+    {
+        if (hyperbolic) return start;
+        T s = std::fmod(start - (t0 - pi<T>), twopi<T>);
+        if (s < (T)0) s += twopi<T>;
+        return s + t0 - pi<T>;
+    };
+
+    // The range of x (or w) the roots could matter in
+    T xmin = -MaxTangent, xmax = MaxTangent;
+    if (!whole)
+    {
+        T tmin = std::numeric_limits<T>::max(), tmax = std::numeric_limits<T>::lowest();
+        for (const ConicSegment<T>& segment : segments)
+        {
+            const T start = Unroll(segment.SegmentStart);
+            tmin = std::min(tmin, start);
+            tmax = std::max(tmax, start + segment.SegmentLength);
+        }
+
+        if (hyperbolic)
+        {
+            xmin = std::exp(tmin);
+            xmax = std::exp(tmax);
+        }
+        else
+        {
+            xmin = std::max(-MaxTangent, std::tan((T)0.5 * std::max(tmin - t0, -pi<T>)));
+            xmax = std::min(MaxTangent, std::tan((T)0.5 * std::min(tmax - t0, pi<T>)));
+            if (tmin - t0 <= -pi<T>) xmin = -MaxTangent;
+            if (tmax - t0 >= pi<T>) xmax = MaxTangent;
+        }
+    }
+
+    const ConicAffine<T> image = GetImageConicAffine(view, projection, projectionType, t0);
+
+    ConicQuadratic<T> graze, surface;
+    GetOcclusionQuadratics(view, orthographic, O, N, sphere, image, graze, surface);
+
+    // Where it can change (t), sorted
+    T breaks[8];
+    int breakCount = 0;
+    for (const ConicQuadratic<T>* q : { &graze, &surface })
+    {
+        T c[5], roots[4];
+        ConicQuadraticToQuartic(*q, hyperbolic, c);
+
+        const int count = FindPolynomialRoots(4, c, xmin, xmax, roots);
+        for (int i = 0; i < count; ++i)
+        {
+            if (hyperbolic)
+            {
+                if (roots[i] > (T)0) breaks[breakCount++] = std::log(roots[i]);
+            }
+            else
+            {
+                breaks[breakCount++] = t0 + (T)2 * std::atan(roots[i]);
+            }
+        }
+    }
+    std::sort(breaks, breaks + breakCount);
+
+    auto IsOccluded = [&](T t)
+    {
+        const T C = hyperbolic ? std::cosh(t - t0) : std::cos(t - t0);
+        const T S = hyperbolic ? std::sinh(t - t0) : std::sin(t - t0);
+        return IsImagePointOccluded(view, orthographic, O, N, sphere, image.v[0] + C * image.v[1] + S * image.v[2]);
+    };
+
+    // Split each segment at the breaks, and keep the pieces that aren't hidden
+    std::vector<ConicSegment<T>> visibleSegments;
+    bool occluded = false;
+
+    auto Split = [&](T start, T end)
+    {
+        bool open = false;
+        T from = start;
+
+        for (int i = 0; i <= breakCount; ++i)
+        {
+            const T to = i < breakCount ? breaks[i] : end;
+            if (to <= from) continue;
+            if (to >= end && i < breakCount) continue;
+
+            if (IsOccluded((T)0.5 * (from + to)))
+            {
+                occluded = true;
+                open = false;
+            }
+            else if (open)
+            {
+                visibleSegments.back().SegmentLength = to - visibleSegments.back().SegmentStart;
+            }
+            else
+            {
+                visibleSegments.push_back(ConicSegment<T>(from, to - from));
+                open = true;
+            }
+
+            from = to;
+        }
+    };
+
+    if (whole)
+    {
+        Split(t0 - pi<T>, t0 + pi<T>);
+
+        // Round the pole, the last piece runs on into the first
+        if (visibleSegments.size() > 1 && visibleSegments.front().SegmentStart <= t0 - pi<T>)
+        {
+            const ConicSegment<T>& last = visibleSegments.back();
+            if (last.SegmentStart + last.SegmentLength >= t0 + pi<T>)
+            {
+                visibleSegments.front().SegmentStart = last.SegmentStart;
+                visibleSegments.front().SegmentLength += last.SegmentLength;
+                visibleSegments.pop_back();
+            }
+        }
+    }
+    else
+    {
+        for (const ConicSegment<T>& segment : segments)
+        {
+            const T start = Unroll(segment.SegmentStart);
+            Split(start, start + segment.SegmentLength);
+        }
+    }
+
+    if (!occluded)
+    {
+        return false;
+    }
+
+    // Back to [0, 2pi), as the clipping leaves ellipses' segments
+    if (!hyperbolic)
+    {
+        for (ConicSegment<T>& segment : visibleSegments)
+        {
+            segment.SegmentStart = std::fmod(segment.SegmentStart, twopi<T>);
+            if (segment.SegmentStart < (T)0) segment.SegmentStart += twopi<T>;
+        }
+    }
+
+    segments = std::move(visibleSegments);
+    visible = !segments.empty();
+    return true;
+}
+
+
+// OccludeConicBySphere, for each of the spheres that might hide any of it
+template<class T>
+bool OccludeConicBySpheres(
+    const EllipseProjectionView<T>& view,
+    bool orthographic,
+    const ClipRectangle<T>& rectangle,
+    const Vector3<T>& O,
+    const Vector3<T>& N,
+    const ConicProjection<T>& projection,
+    ProjectionType projectionType,
+    const OccludingSphere<T>* spheres,
+    int sphereCount,
+    std::vector<ConicSegment<T>>& segments,
+    bool& visible
+)
+{
+    if (!visible) return false;
+
+    if (projectionType != ProjectionType::Ellipse && projectionType != ProjectionType::PositiveHyperbola && projectionType != ProjectionType::NegativeHyperbola)
+    {
+        return false;
+    }
+
+    bool occluded = false;
+    for (int i = 0; i < sphereCount && visible; ++i)
+    {
+        if (!SphereMayOccludeConic(view, orthographic, rectangle, projection, projectionType, spheres[i])) continue;
+
+        occluded |= OccludeConicBySphere(view, orthographic, O, N, projection, projectionType, spheres[i], segments, visible);
+    }
+
+    return occluded;
+}
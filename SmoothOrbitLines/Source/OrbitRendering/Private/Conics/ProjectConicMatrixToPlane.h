@@ -0,0 +1,243 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+
+//-----------------------------------------------------------------------------
+// ProjectConicMatrixToPlane
+// Projects a conic, given as a matrix in its own plane, onto the view plane.
+//
+// The conic's plane is a point O and unit axes P, Q.  Relative to the eye, a
+// point (x, y) in it is X = W + x * P + y * Q (W = O - E), and its image on
+// the view plane is, in homogeneous coordinates,
+//      h = G (x, y, 1),   G = [ g_P  g_Q  g_W ],   g = (. Up, . Vp, . Np)
+// G is the view's homography, so the image of the conic's dual matrix C* is
+// the congruence
+//      D = G C* G^T
+// and of its point matrix C = adj(C*), with cof(G) = [ g_Q x g_W, g_W x g_P,
+// g_P x g_Q ] (G's inverse, up to scale),
+//      adj(D) = cof(G) C cof(G)^T
+// D's last column is the image's center, adj(D)'s upper 2x2 is its shape, and
+// from there it's the same as ProjectEllipseToPlaneClosedForm (which is this,
+// expanded out for an ellipse's diagonal C*.)  Nothing is inverted.
+//
+// C* depends only on the orbit, so it's computed once per orbit, and it's the
+// same six numbers whatever the orbit's eccentricity, see PerifocalDualConic.
+// Conics that share a plane can share G's setup too, see ConicPlaneView.
+//
+// Float: lengths are divided by max(|O - E|, conic size) up front, as in
+// ProjectEllipseToPlaneClosedForm.
+// See ReadMe.txt for more information.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "GTE/Mathematics/Vector2.h"
+#include "GTE/Mathematics/Vector3.h"
+#include <algorithm>
+
+using namespace gte;
+
+#include "Conics.h"
+#include "ProjectEllipseToPlaneClosedForm.h"
+
+
+// The dual conic of an orbit (eccentricity e, semi-latus rectum p) in its
+// perifocal plane: the focus at the origin, periapsis along +x.  Ellipses,
+// parabolas and hyperbolas alike.  Scaled by p^2, so the entries are length^2,
+// length, and 1, like diag(A^2, B^2, -1) in an ellipse's own axes.
+template<class T>
+ConicMatrix<T> PerifocalDualConic(T e, T p)
+{
+    return ConicMatrix<T>(
+        p * p, (T)0,  e * p,
+               p * p, (T)0,
+                      e * e - (T)1
+    );
+}
+
+
+// adj(M).  Swaps a conic's point and dual matrices (up to scale.)
+template<class T>
+ConicMatrix<T> Adjugate(const ConicMatrix<T>& M)
+{
+    return ConicMatrix<T>(
+        M.m11 * M.m22 - M.m12 * M.m12, M.m02 * M.m12 - M.m01 * M.m22, M.m01 * M.m12 - M.m02 * M.m11,
+                                       M.m00 * M.m22 - M.m02 * M.m02, M.m01 * M.m02 - M.m00 * M.m12,
+                                                                      M.m00 * M.m11 - M.m01 * M.m01
+    );
+}
+
+
+// G M G^T, for G = [ g0  g1  g2 ] (columns.)
+template<class T>
+ConicMatrix<T> Congruence(const ConicMatrix<T>& M, const Vector3<T>& g0, const Vector3<T>& g1, const Vector3<T>& g2)
+{
+    // G's rows, and M times each of them
+    Vector3<T> r[3], Mr[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        r[i] = Vector3<T>{ g0[i], g1[i], g2[i] };
+        Mr[i] = Vector3<T>{
+            M.m00 * r[i][0] + M.m01 * r[i][1] + M.m02 * r[i][2],
+            M.m01 * r[i][0] + M.m11 * r[i][1] + M.m12 * r[i][2],
+            M.m02 * r[i][0] + M.m12 * r[i][1] + M.m22 * r[i][2]
+        };
+    }
+
+    return ConicMatrix<T>(
+        Dot(r[0], Mr[0]), Dot(r[0], Mr[1]), Dot(r[0], Mr[2]),
+                          Dot(r[1], Mr[1]), Dot(r[1], Mr[2]),
+                                            Dot(r[2], Mr[2])
+    );
+}
+
+
+// C* with its lengths divided by L (see ProjectConicMatrixToPlane.)
+template<class T>
+ConicMatrix<T> ScaleDualConic(const ConicMatrix<T>& DualConic, T invL)
+{
+    return ConicMatrix<T>(
+        DualConic.m00 * invL * invL, DualConic.m01 * invL * invL, DualConic.m02 * invL,
+                                     DualConic.m11 * invL * invL, DualConic.m12 * invL,
+                                                                  DualConic.m22
+    );
+}
+
+
+// ----------------------------------------------------------------------------
+// Conics sharing a plane
+// Of D and adj(D), only D's last column and adj(D)'s upper 2x2 are used, and
+// each of those six numbers is a fixed linear combination of the six entries
+// of C* (or adj(C*).)  The combinations only depend on the plane and the view
+// (G and cof(G)), so they're worked out once for all of a plane's conics, and
+// then each conic is 36 multiply-adds and ImageConicShape.
+// ----------------------------------------------------------------------------
+template<class T>
+struct ConicPlaneView
+{
+    // D02, D12, D22 from C*, and adj(D)'s 00, 01, 11 from adj(C*), as
+    // coefficients of (m00, m01, m02, m11, m12, m22)
+    T d[3][6];
+    T adj[3][6];
+
+    // The plane, F = Cp - E, in view coordinates
+    T f[3];
+};
+
+
+// x M y^T, as coefficients of M's upper triangle
+template<class T>
+inline void BilinearCoefficients(const Vector3<T>& x, const Vector3<T>& y, T(&c)[6])
+{
+    c[0] = x[0] * y[0];
+    c[1] = x[0] * y[1] + x[1] * y[0];
+    c[2] = x[0] * y[2] + x[2] * y[0];
+    c[3] = x[1] * y[1];
+    c[4] = x[1] * y[2] + x[2] * y[1];
+    c[5] = x[2] * y[2];
+}
+
+
+template<class T>
+inline T DotConic(const T(&c)[6], const ConicMatrix<T>& M)
+{
+    return c[0] * M.m00 + c[1] * M.m01 + c[2] * M.m02 + c[3] * M.m11 + c[4] * M.m12 + c[5] * M.m22;
+}
+
+
+// The plane (O; P, Q)'s part, for conics whose lengths are divided by L
+template<class T>
+ConicPlaneView<T> GetConicPlaneView(
+    const EllipseProjectionView<T>& view,
+    const Vector3<T>& O,
+    const Vector3<T>& P,
+    const Vector3<T>& Q,
+    T L
+)
+{
+    auto ToView = [&view](const Vector3<T>& X) { return Vector3<T>{ Dot(X, view.Up), Dot(X, view.Vp), Dot(X, view.Np) }; };
+
+    const Vector3<T> gP = ToView(P);
+    const Vector3<T> gQ = ToView(Q);
+    const Vector3<T> gW = ToView((O - view.E) * ((T)1 / L));
+
+    // G's rows, and cof(G)'s
+    const Vector3<T> c0 = Cross(gQ, gW), c1 = Cross(gW, gP), c2 = Cross(gP, gQ);
+    Vector3<T> r[3], k[2];
+    for (int i = 0; i < 3; ++i)
+    {
+        r[i] = Vector3<T>{ gP[i], gQ[i], gW[i] };
+    }
+    for (int i = 0; i < 2; ++i)
+    {
+        k[i] = Vector3<T>{ c0[i], c1[i], c2[i] };
+    }
+
+    ConicPlaneView<T> plane;
+    BilinearCoefficients(r[0], r[2], plane.d[0]);
+    BilinearCoefficients(r[1], r[2], plane.d[1]);
+    BilinearCoefficients(r[2], r[2], plane.d[2]);
+    BilinearCoefficients(k[0], k[0], plane.adj[0]);
+    BilinearCoefficients(k[0], k[1], plane.adj[1]);
+    BilinearCoefficients(k[1], k[1], plane.adj[2]);
+
+    const Vector3<T> f = ToView(view.Cp - view.E);
+    plane.f[0] = f[0];
+    plane.f[1] = f[1];
+    plane.f[2] = f[2];
+
+    return plane;
+}
+
+
+// One of the plane's conics, given as C* and adj(C*) (both scaled by the
+// plane's L.)  Same output as ProjectConicMatrixToPlane.
+template<class T>
+inline void ProjectPlaneConic(
+    const ConicPlaneView<T>& plane,
+    const ConicMatrix<T>& DualConic,
+    const ConicMatrix<T>& AdjDualConic,
+    ConicProjection<T>& projection
+)
+{
+    const T D02 = DotConic(plane.d[0], DualConic);
+    const T D12 = DotConic(plane.d[1], DualConic);
+    const T D22 = DotConic(plane.d[2], DualConic);
+
+    const T adj00 = DotConic(plane.adj[0], AdjDualConic);
+    const T adj01 = DotConic(plane.adj[1], AdjDualConic);
+    const T adj11 = DotConic(plane.adj[2], AdjDualConic);
+
+    // Center, and n^2 S = -adj(upper 2x2 of adj(D)), n = -D22
+    const T invD22 = (T)1 / D22;
+    projection.k[0] = plane.f[2] * D02 * invD22 - plane.f[0];
+    projection.k[1] = plane.f[2] * D12 * invD22 - plane.f[1];
+
+    ImageConicShape(
+        -adj11, adj01, -adj00,
+        std::abs(plane.f[2] * invD22),
+        projection.u[0], projection.u[1],
+        projection.v[0], projection.v[1],
+        projection.a, projection.b
+    );
+}
+
+
+// The image conic of the dual conic C* in the plane (O; P, Q).  b is negative
+// for hyperbolas, as with ImageConicLane.  C*'s and the plane's lengths are in
+// the same units as the view's.
+template<class T>
+void ProjectConicMatrixToPlane(
+    const EllipseProjectionView<T>& view,
+    const Vector3<T>& O,
+    const Vector3<T>& P,
+    const Vector3<T>& Q,
+    const ConicMatrix<T>& DualConic,
+    ConicProjection<T>& projection
+)
+{
+    // Scale lengths by 1/L: G's last column, and C*'s entries by their units.
+    const T L = std::max(Length(O - view.E), std::sqrt(std::max(std::abs(DualConic.m00), std::abs(DualConic.m11))));
+    const ConicMatrix<T> C = ScaleDualConic(DualConic, (T)1 / L);
+
+    ProjectPlaneConic(GetConicPlaneView(view, O, P, Q, L), C, Adjugate(C), projection);
+}
@@ -8,8 +8,10 @@
 // Note - the ellipse is specified by center position.   To use with a perifocal
 // orbit coordinate system, the center is computed as a*e, (a = semi-major axis,
 // e = eccentricity).
-// Although it is defined as a template, it is unlikley to compile for types
-// that are not used in this project (exclusively double types).
+// Compiles for float as well as double, but it's only usable in float with
+// camera-relative inputs (E at the origin), and even then the generic matrix
+// formulation loses a lot to cancellation.  For float, prefer
+// ProjectEllipseToPlaneClosedForm.
 // The implementation is not designed to be robust.   The variables were named
 // to be consistent with an implmentation described as a documented by
 // David Eberly's Geometric Tools.  The algorithm has been revised and the
@@ -171,10 +173,10 @@ void ProjectEllipseToPlane(
     std::array<std::array<T, 2>, 2> evec;
     eigensolver(M(0, 0), M(0, 1), M(1, 1), -1, S, evec);
 
-    T a1 = 1. / sqrt(S[0]);
+    T a1 = (T)1. / sqrt(S[0]);
 
     bool isHyperbolic = (S[1] < 0);
-    T a2 = 1. / sqrt(abs(S[1]));
+    T a2 = (T)1. / sqrt(std::abs(S[1]));
 
     // ------------------------------------------------------------------------
     // End of Projection Algorithm
@@ -189,8 +191,8 @@ void ProjectEllipseToPlane(
     ProjectionType projectionType;
     T ThetaLocation;
 
-    const auto cosT = cos(TestTheta);
-    const auto sinT = sin(TestTheta);
+    const T cosT = cos(TestTheta);
+    const T sinT = sin(TestTheta);
     auto point = Ce + d0 * Ue * cosT + d1 * Ve * sinT;
     auto tangent = -d0 * Ue * sinT + d1 * Ve * cosT;
 
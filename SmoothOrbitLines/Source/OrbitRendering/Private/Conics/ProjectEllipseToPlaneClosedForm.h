@@ -0,0 +1,316 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+
+//-----------------------------------------------------------------------------
+// ProjectEllipseToPlaneClosedForm
+// ProjectEllipseToPlane, hand reduced.  Same inputs, same outputs.
+//
+// Relative to the eye, a point on the ellipse is X = W + x * Ue + y * Ve
+// (W = Ce - E), and its image on the plane is, in homogeneous coordinates,
+//      h = G (x, y, 1),   G = [ g_U  g_V  g_W ],   g = (. Up, . Vp, . Np)
+// The ellipse's dual conic is diag(A^2, B^2, -1), so the image's dual conic is
+//      D = A^2 g_U g_U^T + B^2 g_V g_V^T - g_W g_W^T
+// and a dual conic reads off directly as a center and a shape: for
+//      (p - k)^T S^-1 (p - k) = 1
+// it's [ S - k k^T, -k; -k^T, -1 ], up to scale.  Working that through,
+//      n     = z_W^2 - A^2 z_U^2 - B^2 z_V^2
+//      n k   = z_W p_W - A^2 z_U p_U - B^2 z_V p_V
+//      n^2 S = A^2 m_UW m_UW^T + B^2 m_VW m_VW^T - A^2 B^2 m_UV m_UV^T
+//      m_ij  = z_j p_i - z_i p_j
+// where p (2d) and z are the in-plane and normal parts of each g.  n is zero
+// when the ellipse touches the eye plane (a parabola), and negative when it
+// crosses it (a hyperbola, S has a negative eigenvalue).
+//
+// That's all dot products of the inputs, and a 2x2 eigen decomposition of S
+// (written out, rather than SymmetricEigensolver2x2).  The body's image is a
+// direct ray-plane intersection rather than an FIQuery.  Nothing is inverted:
+// S is never recovered from a point conic, which is what makes this hold up
+// in float for thin (nearly edge on) images, where a point conic is nearly
+// singular.
+//
+// Float:
+// Everything is homogeneous in length, so lengths are divided by
+// max(|Ce - E|, A) up front (A^2 B^2 |W|^4 overflows a float at solar system
+// scales, in km.)  With the inputs camera-relative (E at the origin,
+// subtracted in double before converting to float) it's usable in float all
+// the way out to the outer planets.  Nothing needs E at the origin in double.
+//
+// The per-ellipse "lane" functions are shared with the batched
+// ProjectEllipsesToPlane, and ImageConicShape with ProjectConicMatrixToPlane
+// (the same congruence, for any conic matrix.)
+// See ReadMe.txt for more information.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "GTE/Mathematics/Vector2.h"
+#include "GTE/Mathematics/Vector3.h"
+#include <algorithm>
+#include <limits>
+
+using namespace gte;
+
+#include "Conics.h"
+#include "ProjectEllipseToPlane.h"
+
+
+// Shared by all ellipses projected for the same view
+template<class T>
+struct EllipseProjectionView
+{
+    Vector3<T>  E, Cp, Np, Up, Vp;
+};
+
+
+// The image conic's axes and semi-axes from its shape, n^2 S, scaled by
+// scale = |(F.Np) / n|.  (See above.)
+template<class T>
+inline void ImageConicShape(
+    T s00, T s01, T s11,
+    T scale,
+    T& u0, T& u1,
+    T& v0, T& v1,
+    T& a, T& b
+)
+{
+    const T zero = (T)0, half = (T)0.5, one = (T)1;
+
+    // Eigen decomposition.  (e0, e1) goes with the larger eigenvalue, and is
+    // taken from whichever form of it doesn't cancel.
+    const T mean = half * (s00 + s11);
+    const T delta = half * (s00 - s11);
+    const T radius = std::sqrt(delta * delta + s01 * s01);
+    const T larger = mean + radius;
+    const T smaller = mean - radius;
+
+    const bool deltaPositive = delta >= zero;
+    T e0 = deltaPositive ? delta + radius : s01;
+    T e1 = deltaPositive ? s01 : radius - delta;
+    const bool isCircle = e0 == zero && e1 == zero;
+    e0 = isCircle ? one : e0;
+    const T invLengthE = one / std::sqrt(e0 * e0 + e1 * e1);
+    e0 *= invLengthE;
+    e1 *= invLengthE;
+
+    // u is the minor axis of an ellipse, the transverse axis of a hyperbola,
+    // and Cross(u, v) > 0.
+    const bool isHyperbolic = smaller < zero;
+
+    u0 = isHyperbolic ? e0 : -e1;
+    u1 = isHyperbolic ? e1 : e0;
+    v0 = -u1;
+    v1 = u0;
+    const T rootLarger = scale * std::sqrt(larger);
+    const T rootSmaller = scale * std::sqrt(std::abs(smaller));
+    a = isHyperbolic ? rootLarger : rootSmaller;
+    b = isHyperbolic ? -rootSmaller : rootLarger;
+}
+
+
+// The image conic of one ellipse: center k, axes (u, v) and semi-axes a, b.
+// b is negative for hyperbolas, ImageConicLocateBody sorts out the signs.
+template<class T>
+inline void ImageConicLane(
+    const EllipseProjectionView<T>& view,
+    T Cx, T Cy, T Cz,
+    T Ux, T Uy, T Uz,
+    T Vx, T Vy, T Vz,
+    T A, T B,
+    T& k0, T& k1,
+    T& u0, T& u1,
+    T& v0, T& v1,
+    T& a, T& b
+)
+{
+    const T one = (T)1;
+
+    const T Npx = view.Np[0], Npy = view.Np[1], Npz = view.Np[2];
+    const T Upx = view.Up[0], Upy = view.Up[1], Upz = view.Up[2];
+    const T Vpx = view.Vp[0], Vpy = view.Vp[1], Vpz = view.Vp[2];
+
+    // W = Ce - E, scaled (see above.)
+    T Wx = Cx - view.E[0], Wy = Cy - view.E[1], Wz = Cz - view.E[2];
+    const T invScale = one / std::max(std::sqrt(Wx * Wx + Wy * Wy + Wz * Wz), A);
+    Wx *= invScale; Wy *= invScale; Wz *= invScale;
+    A *= invScale;
+    B *= invScale;
+
+    // The plane, F = Cp - E.  A ray from the eye along h meets the plane at
+    // (F.Np) * (h0, h1) / h2 - (F.Up, F.Vp)
+    const T Fx = view.Cp[0] - view.E[0], Fy = view.Cp[1] - view.E[1], Fz = view.Cp[2] - view.E[2];
+    const T fN = Fx * Npx + Fy * Npy + Fz * Npz;
+    const T fU = Fx * Upx + Fy * Upy + Fz * Upz;
+    const T fV = Fx * Vpx + Fy * Vpy + Fz * Vpz;
+
+    // G's columns
+    const T pU0 = Ux * Upx + Uy * Upy + Uz * Upz, pU1 = Ux * Vpx + Uy * Vpy + Uz * Vpz, zU = Ux * Npx + Uy * Npy + Uz * Npz;
+    const T pV0 = Vx * Upx + Vy * Upy + Vz * Upz, pV1 = Vx * Vpx + Vy * Vpy + Vz * Vpz, zV = Vx * Npx + Vy * Npy + Vz * Npz;
+    const T pW0 = Wx * Upx + Wy * Upy + Wz * Upz, pW1 = Wx * Vpx + Wy * Vpy + Wz * Vpz, zW = Wx * Npx + Wy * Npy + Wz * Npz;
+
+    const T AA = A * A, BB = B * B, AABB = AA * BB;
+
+    // Center
+    const T n = zW * zW - AA * zU * zU - BB * zV * zV;
+    const T invN = one / n;
+    k0 = fN * (zW * pW0 - AA * zU * pU0 - BB * zV * pV0) * invN - fU;
+    k1 = fN * (zW * pW1 - AA * zU * pU1 - BB * zV * pV1) * invN - fV;
+
+    // Shape, n^2 S
+    const T mUW0 = zW * pU0 - zU * pW0, mUW1 = zW * pU1 - zU * pW1;
+    const T mVW0 = zW * pV0 - zV * pW0, mVW1 = zW * pV1 - zV * pW1;
+    const T mUV0 = zV * pU0 - zU * pV0, mUV1 = zV * pU1 - zU * pV1;
+
+    const T s00 = AA * mUW0 * mUW0 + BB * mVW0 * mVW0 - AABB * mUV0 * mUV0;
+    const T s01 = AA * mUW0 * mUW1 + BB * mVW0 * mVW1 - AABB * mUV0 * mUV1;
+    const T s11 = AA * mUW1 * mUW1 + BB * mVW1 * mVW1 - AABB * mUV1 * mUV1;
+
+    ImageConicShape(s00, s01, s11, std::abs(fN * invN), u0, u1, v0, v1, a, b);
+}
+
+
+// Where the body (at TestTheta on the ellipse) lands on the image conic, and
+// so which type of projection it is.  Fixes up b's sign.
+// See ProjectEllipseToPlane for the conventions.
+template<class T>
+inline void ImageConicLocateBody(
+    const EllipseProjectionView<T>& view,
+    T Cx, T Cy, T Cz,
+    T Ux, T Uy, T Uz,
+    T Vx, T Vy, T Vz,
+    T A, T B,
+    T TestTheta,
+    T k0, T k1,
+    T u0, T u1,
+    T v0, T v1,
+    T a,
+    T& b,
+    ProjectionType& projectionType,
+    T& ThetaLocation
+)
+{
+    const T zero = (T)0;
+
+    const bool isHyperbolic = b < zero;
+    b = std::abs(b);
+
+    const T cosT = std::cos(TestTheta);
+    const T sinT = std::sin(TestTheta);
+
+    const T px = Cx + A * Ux * cosT + B * Vx * sinT;
+    const T py = Cy + A * Uy * cosT + B * Vy * sinT;
+    const T pz = Cz + A * Uz * cosT + B * Vz * sinT;
+    const T tx = -A * Ux * sinT + B * Vx * cosT;
+    const T ty = -A * Uy * sinT + B * Vy * cosT;
+    const T tz = -A * Uz * sinT + B * Vz * cosT;
+
+    const T Npx = view.Np[0], Npy = view.Np[1], Npz = view.Np[2];
+    const T Upx = view.Up[0], Upy = view.Up[1], Upz = view.Up[2];
+    const T Vpx = view.Vp[0], Vpy = view.Vp[1], Vpz = view.Vp[2];
+
+    // Ray from the eye through the body, meets the plane at E + t * r.  (Taken
+    // from the eye rather than the body, so nothing the size of the distance
+    // to the body has to cancel out in the plane's coordinates.)
+    const T rx = px - view.E[0], ry = py - view.E[1], rz = pz - view.E[2];
+    const T Fx = view.Cp[0] - view.E[0], Fy = view.Cp[1] - view.E[1], Fz = view.Cp[2] - view.E[2];
+    const T rDotN = rx * Npx + ry * Npy + rz * Npz;
+    const bool forwardOfCamera = rDotN < zero;
+
+    const T t = (Fx * Npx + Fy * Npy + Fz * Npz) / rDotN;
+    const T qx = t * rx - Fx;
+    const T qy = t * ry - Fy;
+    const T qz = t * rz - Fz;
+
+    const T tangent0 = Upx * tx + Upy * ty + Upz * tz;
+    const T tangent1 = Vpx * tx + Vpy * ty + Vpz * tz;
+    const T plane0 = Upx * qx + Upy * qy + Upz * qz - k0;
+    const T plane1 = Vpx * qx + Vpy * qy + Vpz * qz - k1;
+
+    const T conic0 = u0 * plane0 + u1 * plane1;
+    const T conic1 = v0 * plane0 + v1 * plane1;
+
+    if (isHyperbolic)
+    {
+        projectionType = ((conic0 > zero) ^ (!forwardOfCamera)) ? ProjectionType::PositiveHyperbola : ProjectionType::NegativeHyperbola;
+
+        // Ensure the hyperbola is defined such that Cross(v1,v2) > 0
+        const T conicTangent1 = v0 * tangent0 + v1 * tangent1;
+        const bool velocityPointsUpwards = conicTangent1 > zero;
+        if ((projectionType == ProjectionType::PositiveHyperbola) != velocityPointsUpwards)
+        {
+            b = -b;
+        }
+
+        const T location = std::atanh(conic1 * a / conic0 / b);
+        if (forwardOfCamera)
+        {
+            // Same as location, but asinh holds up in float out along the
+            // asymptotes (see ClipHyperbolaToFrustum.)
+            const T branch = projectionType == ProjectionType::PositiveHyperbola ? (T)1 : (T)-1;
+            ThetaLocation = std::asinh(branch * conic1 / b);
+        }
+        else
+        {
+            // Off the projected hyperbola, but on which side?
+            ThetaLocation = location > zero ? std::numeric_limits<T>::infinity() : -std::numeric_limits<T>::infinity();
+        }
+    }
+    else
+    {
+        projectionType = forwardOfCamera ? ProjectionType::Ellipse : ProjectionType::NotVisible;
+
+        // Ensure the ellipse is defined such that Cross(v1,v2) > 0
+        if (plane0 * tangent1 - plane1 * tangent0 < zero)
+        {
+            b = -b;
+            ThetaLocation = std::atan2(-conic1 * a, -conic0 * b);
+        }
+        else
+        {
+            ThetaLocation = std::atan2(+conic1 * a, +conic0 * b);
+        }
+        if (ThetaLocation < zero) ThetaLocation += twopi<T>;
+    }
+}
+
+
+template<class T>
+void ProjectEllipseToPlaneClosedForm(
+    const EllipseProjectionInputs<T>& inputs,
+    EllipseProjectionOutputs<T>& outputs
+)
+{
+    const EllipseProjectionView<T> view{ inputs.E, inputs.Cp, inputs.Np, inputs.Up, inputs.Vp };
+    const Vector3<T>& Ce = inputs.Ce;
+    const Vector3<T>& Ue = inputs.Ue;
+    const Vector3<T>& Ve = inputs.Ve;
+
+    ConicProjection<T>& projection = outputs.projection;
+
+    ImageConicLane(
+        view,
+        Ce[0], Ce[1], Ce[2],
+        Ue[0], Ue[1], Ue[2],
+        Ve[0], Ve[1], Ve[2],
+        inputs.A, inputs.B,
+        projection.k[0], projection.k[1],
+        projection.u[0], projection.u[1],
+        projection.v[0], projection.v[1],
+        projection.a, projection.b
+    );
+
+    ImageConicLocateBody(
+        view,
+        Ce[0], Ce[1], Ce[2],
+        Ue[0], Ue[1], Ue[2],
+        Ve[0], Ve[1], Ve[2],
+        inputs.A, inputs.B,
+        inputs.TestTheta,
+        projection.k[0], projection.k[1],
+        projection.u[0], projection.u[1],
+        projection.v[0], projection.v[1],
+        projection.a,
+        projection.b,
+        outputs.projectionType,
+        outputs.ThetaLocation
+    );
+}
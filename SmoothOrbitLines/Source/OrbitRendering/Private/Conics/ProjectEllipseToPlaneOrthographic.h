@@ -0,0 +1,160 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+
+//-----------------------------------------------------------------------------
+// ProjectEllipseToPlaneOrthographic
+// ProjectEllipseToPlane, for an orthographic view: straight along Np rather
+// than toward the eye point.  Same inputs (E is unused), same outputs.
+//
+// A parallel projection is affine, so the image of the ellipse is just
+//      p(t) = k + P cos t + Q sin t
+//      P = A (Ue . Up, Ue . Vp),  Q = B (Ve . Up, Ve . Vp)
+// (t the eccentric anomaly), an ellipse with conjugate semi-diameters P and Q.
+// |p(t) - k|^2 is greatest at t0,
+//      tan 2 t0 = 2 P . Q / (P . P - Q . Q)
+// and with phi = t - t0,
+//      p = k + (P cos t0 + Q sin t0) cos phi + (Q cos t0 - P sin t0) sin phi
+// where the two are the image's (orthogonal) semi-axes.  No conic matrix, no
+// eigen decomposition, no ray casts.  The image is always an ellipse (edge on,
+// a line segment) and there's nothing behind the eye to worry about.
+//
+// Going back from the image's phi to the orbit's true anomaly is just t0
+// again, see OrthographicAngleToTrueAnomaly.
+// See ReadMe.txt for more information.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "GTE/Mathematics/Vector2.h"
+#include "GTE/Mathematics/Vector3.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace gte;
+
+#include "Conics.h"
+#include "ProjectEllipseToPlane.h"
+#include "ProjectionAngleToTrueAnomaly.h"
+
+
+// The image's conjugate semi-diameters, P and Q (see above)
+template<class T>
+inline void OrthographicConjugateAxes(const EllipseProjectionInputs<T>& inputs, Vector2<T>& P, Vector2<T>& Q)
+{
+    P = Vector2<T>{ inputs.A * Dot(inputs.Ue, inputs.Up), inputs.A * Dot(inputs.Ue, inputs.Vp) };
+    Q = Vector2<T>{ inputs.B * Dot(inputs.Ve, inputs.Up), inputs.B * Dot(inputs.Ve, inputs.Vp) };
+}
+
+
+// The eccentric anomaly at the image's phi = 0, t0 (see above)
+template<class T>
+inline T OrthographicImageOffset(const Vector2<T>& P, const Vector2<T>& Q)
+{
+    return (T)0.5 * std::atan2((T)2 * Dot(P, Q), Dot(P, P) - Dot(Q, Q));
+}
+
+
+template<class T>
+void ProjectEllipseToPlaneOrthographic(
+    const EllipseProjectionInputs<T>& inputs,
+    EllipseProjectionOutputs<T>& outputs
+)
+{
+    const T zero = (T)0;
+
+    ConicProjection<T>& projection = outputs.projection;
+
+    Vector2<T> P, Q;
+    OrthographicConjugateAxes(inputs, P, Q);
+
+    const T t0 = OrthographicImageOffset(P, Q);
+    const T cosT0 = std::cos(t0);
+    const T sinT0 = std::sin(t0);
+    const Vector2<T> major = cosT0 * P + sinT0 * Q;
+    const Vector2<T> minor = cosT0 * Q - sinT0 * P;
+
+    const Vector3<T> F = inputs.Ce - inputs.Cp;
+    projection.k = Vector2<T>{ Dot(F, inputs.Up), Dot(F, inputs.Vp) };
+
+    projection.a = Length(major);
+    projection.u = projection.a > zero ? major / projection.a : Vector2<T>{ (T)1, zero };
+
+    // v is u turned a quarter, and b's sign has phi running the way the body
+    // does, as ImageConicLocateBody leaves it.
+    projection.v = Vector2<T>{ -projection.u[1], projection.u[0] };
+    projection.b = Dot(minor, projection.v);
+
+    outputs.projectionType = projection.a > zero ? ProjectionType::Ellipse : ProjectionType::NotVisible;
+
+    T ThetaLocation = inputs.TestTheta - t0;
+    if (ThetaLocation < zero) ThetaLocation += twopi<T>;
+    if (ThetaLocation >= twopi<T>) ThetaLocation -= twopi<T>;
+    outputs.ThetaLocation = ThetaLocation;
+}
+
+
+// ProjectionAngleToTrueAnomaly, for ProjectEllipseToPlaneOrthographic's image
+template<class T>
+bool OrthographicAngleToTrueAnomaly(
+    const EllipseProjectionInputs<T>& orbitData,
+    const EllipseProjectionOutputs<T>& projectionData,
+    T theta,
+    T& trueAnomaly
+)
+{
+    if (projectionData.projectionType != ProjectionType::Ellipse)
+    {
+        return false;
+    }
+
+    Vector2<T> P, Q;
+    OrthographicConjugateAxes(orbitData, P, Q);
+
+    const T t = theta + OrthographicImageOffset(P, Q);
+    const T A = orbitData.A;
+    const T B = orbitData.B;
+
+    // Center to focus
+    const T ae = std::sqrt(std::max((A - B) * (A + B), (T)0));
+
+    trueAnomaly = std::atan2(B * std::sin(t), A * std::cos(t) - ae);
+
+    return true;
+}
+
+
+// OrthographicAngleToTrueAnomaly as a TrueAnomalyMapping: the orbit's
+// eccentric anomaly is just theta + t0, so the (focus relative) perifocal
+// coordinates are
+//      (A cos(theta + t0) - ae, B sin(theta + t0))
+// which is linear in (cos theta, sin theta, 1), and n is 1.
+template<class T>
+bool GetOrthographicTrueAnomalyMapping(
+    const EllipseProjectionInputs<T>& orbitData,
+    const EllipseProjectionOutputs<T>& projectionData,
+    TrueAnomalyMapping<T>& mapping
+)
+{
+    if (projectionData.projectionType != ProjectionType::Ellipse)
+    {
+        return false;
+    }
+
+    Vector2<T> P, Q;
+    OrthographicConjugateAxes(orbitData, P, Q);
+
+    const T t0 = OrthographicImageOffset(P, Q);
+    const T cosT0 = std::cos(t0);
+    const T sinT0 = std::sin(t0);
+    const T A = orbitData.A;
+    const T B = orbitData.B;
+    const T ae = std::sqrt(std::max((A - B) * (A + B), (T)0));
+
+    Matrix3x3<T>& G = mapping.G;
+    G(0, 0) = A * cosT0;   G(0, 1) = -A * sinT0;  G(0, 2) = -ae;
+    G(1, 0) = B * sinT0;   G(1, 1) = B * cosT0;   G(1, 2) = (T)0;
+    G(2, 0) = (T)0;        G(2, 1) = (T)0;        G(2, 2) = (T)1;
+    mapping.hyperbola = false;
+
+    return true;
+}
@@ -0,0 +1,272 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+
+//-----------------------------------------------------------------------------
+// ProjectEllipsesToPlane
+// Batched ProjectEllipseToPlane.  The view (eye point and projection plane)
+// is given once, the ellipses are given in structure-of-arrays form, and the
+// projections come back in structure-of-arrays form.
+// The math is ProjectEllipseToPlaneClosedForm's, one lane per ellipse:
+//  Pass 1: image conic, center, and eigen decomposition.  No branches, no
+//          calls other than sqrt, so the compiler can vectorize it.
+//  Pass 2: locating the body and classifying the projection.  This has the
+//          transcendentals and the branches, and stays scalar.
+// See ReadMe.txt for more information.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "GTE/Mathematics/Vector2.h"
+#include "GTE/Mathematics/Vector3.h"
+#include <vector>
+#include <array>
+
+using namespace gte;
+
+#include "Conics.h"
+#include "ProjectEllipseToPlane.h"
+#include "ProjectEllipseToPlaneClosedForm.h"
+
+
+// Ellipses, structure-of-arrays.  Ne is implied (Ue x Ve).
+template<class T>
+struct EllipseBatch
+{
+    std::array<std::vector<T>, 3> Ce, Ue, Ve;
+    std::vector<T> A, B;
+    std::vector<T> TestTheta;
+
+    size_t size() const { return A.size(); }
+
+    void resize(size_t n)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            Ce[j].resize(n);
+            Ue[j].resize(n);
+            Ve[j].resize(n);
+        }
+        A.resize(n);
+        B.resize(n);
+        TestTheta.resize(n);
+    }
+
+    void set(size_t i, const Vector3<T>& _Ce, const Vector3<T>& _Ue, const Vector3<T>& _Ve, T _A, T _B, T _TestTheta)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            Ce[j][i] = _Ce[j];
+            Ue[j][i] = _Ue[j];
+            Ve[j][i] = _Ve[j];
+        }
+        A[i] = _A;
+        B[i] = _B;
+        TestTheta[i] = _TestTheta;
+    }
+
+    // Some of another batch's ellipses, in the given order
+    void gather(const EllipseBatch& from, const std::vector<int>& indices)
+    {
+        const size_t n = indices.size();
+        resize(n);
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            const size_t k = (size_t)indices[i];
+            for (int j = 0; j < 3; ++j)
+            {
+                Ce[j][i] = from.Ce[j][k];
+                Ue[j][i] = from.Ue[j][k];
+                Ve[j][i] = from.Ve[j][k];
+            }
+            A[i] = from.A[k];
+            B[i] = from.B[k];
+            TestTheta[i] = from.TestTheta[k];
+        }
+    }
+
+    // Per-ellipse inputs, for the stages that aren't batched
+    // (clipping, true anomaly mapping.)
+    EllipseProjectionInputs<T> getInputs(const EllipseProjectionView<T>& view, size_t i) const
+    {
+        const Vector3<T> _Ce{ Ce[0][i], Ce[1][i], Ce[2][i] };
+        const Vector3<T> _Ue{ Ue[0][i], Ue[1][i], Ue[2][i] };
+        const Vector3<T> _Ve{ Ve[0][i], Ve[1][i], Ve[2][i] };
+
+        return EllipseProjectionInputs<T>(
+            view.E, _Ce, UnitCross(_Ue, _Ve), _Ue, _Ve,
+            A[i], B[i],
+            view.Cp, view.Np, view.Up, view.Vp,
+            TestTheta[i]
+        );
+    }
+};
+
+
+// Projections, structure-of-arrays
+template<class T>
+struct ConicProjectionBatch
+{
+    std::array<std::vector<T>, 2> k, u, v;
+    std::vector<T> a, b;
+    std::vector<T> ThetaLocation;
+    std::vector<ProjectionType> projectionType;
+
+    size_t size() const { return a.size(); }
+
+    void resize(size_t n)
+    {
+        for (int j = 0; j < 2; ++j)
+        {
+            k[j].resize(n);
+            u[j].resize(n);
+            v[j].resize(n);
+        }
+        a.resize(n);
+        b.resize(n);
+        ThetaLocation.resize(n);
+        projectionType.resize(n);
+    }
+
+    void getOutputs(size_t i, EllipseProjectionOutputs<T>& outputs) const
+    {
+        outputs.projection.k = Vector2<T>{ k[0][i], k[1][i] };
+        outputs.projection.u = Vector2<T>{ u[0][i], u[1][i] };
+        outputs.projection.v = Vector2<T>{ v[0][i], v[1][i] };
+        outputs.projection.a = a[i];
+        outputs.projection.b = b[i];
+        outputs.projectionType = projectionType[i];
+        outputs.ThetaLocation = ThetaLocation[i];
+    }
+
+    void getProjection(size_t i, ConicProjection<T>& projection) const
+    {
+        projection.k = Vector2<T>{ k[0][i], k[1][i] };
+        projection.u = Vector2<T>{ u[0][i], u[1][i] };
+        projection.v = Vector2<T>{ v[0][i], v[1][i] };
+        projection.a = a[i];
+        projection.b = b[i];
+    }
+
+    // Pass 1's part of lane i, from elsewhere
+    void setProjection(size_t i, const ConicProjection<T>& projection)
+    {
+        k[0][i] = projection.k[0]; k[1][i] = projection.k[1];
+        u[0][i] = projection.u[0]; u[1][i] = projection.u[1];
+        v[0][i] = projection.v[0]; v[1][i] = projection.v[1];
+        a[i] = projection.a;
+        b[i] = projection.b;
+    }
+};
+
+
+// Pass 1 for some of the lanes, the rest are left as they are (see
+// ProjectPlaneConic, for lanes whose image conics come from elsewhere.)
+template<class T>
+void ProjectEllipsesToPlaneLanes(
+    const EllipseProjectionView<T>& view,
+    const EllipseBatch<T>& ellipses,
+    const std::vector<int>& lanes,
+    ConicProjectionBatch<T>& outputs
+)
+{
+    for (int i : lanes)
+    {
+        ImageConicLane(
+            view,
+            ellipses.Ce[0][i], ellipses.Ce[1][i], ellipses.Ce[2][i],
+            ellipses.Ue[0][i], ellipses.Ue[1][i], ellipses.Ue[2][i],
+            ellipses.Ve[0][i], ellipses.Ve[1][i], ellipses.Ve[2][i],
+            ellipses.A[i], ellipses.B[i],
+            outputs.k[0][i], outputs.k[1][i],
+            outputs.u[0][i], outputs.u[1][i],
+            outputs.v[0][i], outputs.v[1][i],
+            outputs.a[i], outputs.b[i]
+        );
+    }
+}
+
+
+// Pass 2 alone, for all the lanes
+template<class T>
+void LocateBodiesOnProjections(
+    const EllipseProjectionView<T>& view,
+    const EllipseBatch<T>& ellipses,
+    ConicProjectionBatch<T>& outputs
+)
+{
+    const int n = (int)ellipses.size();
+
+    const T* Cx = ellipses.Ce[0].data(); const T* Cy = ellipses.Ce[1].data(); const T* Cz = ellipses.Ce[2].data();
+    const T* Ux = ellipses.Ue[0].data(); const T* Uy = ellipses.Ue[1].data(); const T* Uz = ellipses.Ue[2].data();
+    const T* Vx = ellipses.Ve[0].data(); const T* Vy = ellipses.Ve[1].data(); const T* Vz = ellipses.Ve[2].data();
+    const T* A = ellipses.A.data();
+    const T* B = ellipses.B.data();
+    const T* TestTheta = ellipses.TestTheta.data();
+
+    for (int i = 0; i < n; ++i)
+    {
+        ImageConicLocateBody(
+            view,
+            Cx[i], Cy[i], Cz[i],
+            Ux[i], Uy[i], Uz[i],
+            Vx[i], Vy[i], Vz[i],
+            A[i], B[i],
+            TestTheta[i],
+            outputs.k[0][i], outputs.k[1][i],
+            outputs.u[0][i], outputs.u[1][i],
+            outputs.v[0][i], outputs.v[1][i],
+            outputs.a[i],
+            outputs.b[i],
+            outputs.projectionType[i],
+            outputs.ThetaLocation[i]
+        );
+    }
+}
+
+
+template<class T>
+void ProjectEllipsesToPlane(
+    const EllipseProjectionView<T>& view,
+    const EllipseBatch<T>& ellipses,
+    ConicProjectionBatch<T>& outputs
+)
+{
+    const int n = (int)ellipses.size();
+    outputs.resize(n);
+
+    const T* Cx = ellipses.Ce[0].data(); const T* Cy = ellipses.Ce[1].data(); const T* Cz = ellipses.Ce[2].data();
+    const T* Ux = ellipses.Ue[0].data(); const T* Uy = ellipses.Ue[1].data(); const T* Uz = ellipses.Ue[2].data();
+    const T* Vx = ellipses.Ve[0].data(); const T* Vy = ellipses.Ve[1].data(); const T* Vz = ellipses.Ve[2].data();
+    const T* A = ellipses.A.data();
+    const T* B = ellipses.B.data();
+
+    T* k0 = outputs.k[0].data(); T* k1 = outputs.k[1].data();
+    T* u0 = outputs.u[0].data(); T* u1 = outputs.u[1].data();
+    T* v0 = outputs.v[0].data(); T* v1 = outputs.v[1].data();
+    T* a = outputs.a.data();
+    T* b = outputs.b.data();
+
+    // ------------------------------------------------------------------------
+    // Pass 1: the image conic
+    // ------------------------------------------------------------------------
+    for (int i = 0; i < n; ++i)
+    {
+        ImageConicLane(
+            view,
+            Cx[i], Cy[i], Cz[i],
+            Ux[i], Uy[i], Uz[i],
+            Vx[i], Vy[i], Vz[i],
+            A[i], B[i],
+            k0[i], k1[i],
+            u0[i], u1[i],
+            v0[i], v1[i],
+            a[i], b[i]
+        );
+    }
+
+    // ------------------------------------------------------------------------
+    // Pass 2: where's the body, and what's visible?
+    // ------------------------------------------------------------------------
+    LocateBodiesOnProjections(view, ellipses, outputs);
+}
@@ -5,12 +5,28 @@
 // ProjectionAngleToTrueAnomaly
 // Given an angle on the projection conic, determine the point's true anomaly
 // angle on the original orbit plane
+// Nothing here assumes the origin is at the orbit's focus, so it works with
+// camera-relative inputs, in float as well as double.
+//
+// TrueAnomalyMapping does the same in closed form, for many angles on the
+// same projection (every segment's ends, say.)  The eye's rays take the
+// projection plane to the orbit plane by a projective transform: with
+// D = Cp - E, c = Ne . (Ce - E), and a plane point h = (x, y, 1),
+//      n = Ne . (x Up + y Vp + D)
+//      n (X - Ce) = n (E - Ce) + c (x Up + y Vp + D)
+// which is linear in h, so the orbit point's perifocal coordinates (about
+// the focus) are H h, up to the scale n.  And the image conic's points are
+// h = K (cos t, sin t, 1) (or +-(cosh t, sinh t), 1), K affine.  So one 3x3
+// G = H K takes the conic parameter straight to the perifocal (x, y, n),
+//      true anomaly = atan2(y sign(n), x sign(n))
+// No ray casts or matrices per point, and no normalizing.
 //-----------------------------------------------------------------------------
 
 #pragma once
 
 #include "GTE/Mathematics/IntrLine3Plane3.h"
 #include "GTE/Mathematics/Matrix3x3.h"
+#include <algorithm>
 
 using namespace gte;
 
@@ -26,17 +42,15 @@ bool ProjectionAngleToTrueAnomaly(
 )
 {
     bool result = true;
-    Vector3<double> point;
-    Vector<2,double> pointOnConicPlane;
+    Vector3<T> point;
+    Vector<2, T> pointOnConicPlane;
     const Vector3<T>& E = orbitData.E;
     const Vector3<T>& Ce = orbitData.Ce;
     const Vector3<T>& Ne = orbitData.Ne;
     const Vector3<T>& Ue = orbitData.Ue;
     const Vector3<T>& Ve = orbitData.Ve;
-    /*
     T A = orbitData.A;
     T B = orbitData.B;
-    */
     const Vector3<T>& Cp = orbitData.Cp;
     const Vector3<T>& Np = orbitData.Np;
     const Vector3<T>& Up = orbitData.Up;
@@ -51,21 +65,21 @@ bool ProjectionAngleToTrueAnomaly(
 
     if (projectionData.projectionType == ProjectionType::Ellipse)
     {
-        const auto cosT = cos(theta);
-        const auto sinT = sin(theta);
+        const T cosT = cos(theta);
+        const T sinT = sin(theta);
         pointOnConicPlane = cosT * a * u + sinT * b * v;
     }
     else if (projectionData.projectionType == ProjectionType::PositiveHyperbola)
     {
-        const auto coshT = cosh(theta);
-        const auto sinhT = sinh(theta);
+        const T coshT = cosh(theta);
+        const T sinhT = sinh(theta);
         pointOnConicPlane = coshT * a * u + sinhT * b * v;
     }
     else if (projectionData.projectionType == ProjectionType::NegativeHyperbola)
     {
-        const auto coshT = -cosh(theta);
-        const auto sinhT = -sinh(theta);
-        pointOnConicPlane = coshT * a * u - sinhT * b * v;
+        const T coshT = -cosh(theta);
+        const T sinhT = -sinh(theta);
+        pointOnConicPlane = coshT * a * u + sinhT * b * v;
     }
     else
     {
@@ -75,7 +89,7 @@ bool ProjectionAngleToTrueAnomaly(
     if (result)
     {
         pointOnConicPlane += k;
-        Vector3<double> pointOnProjectionPlane = Cp + pointOnConicPlane[0] * Up + pointOnConicPlane[1] * Vp;
+        Vector3<T> pointOnProjectionPlane = Cp + pointOnConicPlane[0] * Up + pointOnConicPlane[1] * Vp;
 
         auto toEyePoint = E - pointOnProjectionPlane;
         Normalize(toEyePoint);
@@ -89,20 +103,122 @@ bool ProjectionAngleToTrueAnomaly(
 
         point -= Ce;
 
-        Matrix3x3<double> Q;
+        Matrix3x3<T> Q;
         Q.SetRow(0, Ue);
         Q.SetRow(1, Ve);
         Q.SetRow(2, Ne);
 
         auto perifocalPoint = Q * point;
 
-        double x = perifocalPoint[0];
-        double y = perifocalPoint[1];
+        T x = perifocalPoint[0];
+        T y = perifocalPoint[1];
 
-        double ae = Length(Ce);
+        // Center to focus
+        T ae = sqrt(std::max((A - B) * (A + B), (T)0));
 
         trueAnomaly = atan2(y, (x - ae));
     }
 
     return result;
 }
+
+
+// The conic parameter to true anomaly, as one matrix (see above)
+template<class T>
+struct TrueAnomalyMapping
+{
+    Matrix3x3<T> G;
+    bool hyperbola = false;
+};
+
+
+// G = H K, for a perspective projection.  False if it's not visible.
+template<class T>
+bool GetTrueAnomalyMapping(
+    const EllipseProjectionInputs<T>& orbitData,
+    const EllipseProjectionOutputs<T>& projectionData,
+    TrueAnomalyMapping<T>& mapping
+)
+{
+    const ProjectionType projectionType = projectionData.projectionType;
+    if (projectionType != ProjectionType::Ellipse && projectionType != ProjectionType::PositiveHyperbola && projectionType != ProjectionType::NegativeHyperbola)
+    {
+        return false;
+    }
+
+    const T A = orbitData.A;
+    const T B = orbitData.B;
+    const Vector3<T>& Ne = orbitData.Ne;
+    const Vector3<T> EtoC = orbitData.E - orbitData.Ce;
+    const T c = -Dot(Ne, EtoC);
+
+    // Center to focus
+    const T ae = std::sqrt(std::max((A - B) * (A + B), (T)0));
+
+    // n's row, then W . (n (X - Ce)) for W = Ue, Ve, then the focus taken
+    // off x
+    const Vector3<T> D = orbitData.Cp - orbitData.E;
+    const Vector3<T>* planeAxes[3] = { &orbitData.Up, &orbitData.Vp, &D };
+
+    Matrix3x3<T> H;
+    for (int col = 0; col < 3; ++col)
+    {
+        const Vector3<T>& axis = *planeAxes[col];
+        H(2, col) = Dot(Ne, axis);
+        H(0, col) = Dot(orbitData.Ue, EtoC) * H(2, col) + c * Dot(orbitData.Ue, axis);
+        H(1, col) = Dot(orbitData.Ve, EtoC) * H(2, col) + c * Dot(orbitData.Ve, axis);
+        H(0, col) -= ae * H(2, col);
+    }
+
+    const ConicProjection<T>& p = projectionData.projection;
+    const T sign = projectionType == ProjectionType::NegativeHyperbola ? (T)-1 : (T)1;
+
+    Matrix3x3<T> K;
+    K(0, 0) = sign * p.a * p.u[0];  K(0, 1) = sign * p.b * p.v[0];  K(0, 2) = p.k[0];
+    K(1, 0) = sign * p.a * p.u[1];  K(1, 1) = sign * p.b * p.v[1];  K(1, 2) = p.k[1];
+    K(2, 0) = (T)0;                 K(2, 1) = (T)0;                 K(2, 2) = (T)1;
+
+    mapping.G = H * K;
+    mapping.hyperbola = projectionType != ProjectionType::Ellipse;
+
+    return true;
+}
+
+
+template<class T>
+inline T MapToTrueAnomaly(const TrueAnomalyMapping<T>& mapping, T theta)
+{
+    const Matrix3x3<T>& G = mapping.G;
+    T C, S;
+    if (mapping.hyperbola)
+    {
+        // (One exp for both)
+        const T e = std::exp(theta);
+        const T inverse = (T)1 / e;
+        C = (T)0.5 * (e + inverse);
+        S = (T)0.5 * (e - inverse);
+    }
+    else
+    {
+        C = std::cos(theta);
+        S = std::sin(theta);
+    }
+
+    const T x = G(0, 0) * C + G(0, 1) * S + G(0, 2);
+    const T y = G(1, 0) * C + G(1, 1) * S + G(1, 2);
+    const T n = G(2, 0) * C + G(2, 1) * S + G(2, 2);
+
+    return n < (T)0 ? std::atan2(-y, -x) : std::atan2(y, x);
+}
+
+
+// Both ends of each segment, start then end, into trueAnomalies[2 count]
+template<class T>
+void MapToTrueAnomalies(const TrueAnomalyMapping<T>& mapping, const ConicSegment<T>* segments, int count, T* trueAnomalies)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        trueAnomalies[2 * i] = MapToTrueAnomaly(mapping, segments[i].SegmentStart);
+        trueAnomalies[2 * i + 1] = MapToTrueAnomaly(mapping, segments[i].SegmentStart + segments[i].SegmentLength);
+    }
+}
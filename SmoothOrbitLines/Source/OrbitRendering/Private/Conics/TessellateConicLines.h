@@ -0,0 +1,277 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+
+//-----------------------------------------------------------------------------
+// TessellateConicLines
+// The renderer's per-vertex work for a segment of a conic: the points on the
+// unit conic, then each vertex's two corners (the line has a thickness) and
+// tangent frame.
+//  Points:  UnitConic is specialized for each type of conic, so there's no
+//           call through a function pointer, and evenly spaced parameters
+//           are stepped with the angle addition formulas,
+//              cos(t + d) = cos t cos d - sin t sin d, ...
+//           (or their cosh/sinh twins) rather than calling sin/cos for each.
+//  Corners: A vertex is Center + x Axis1 + y Axis2, on the projection plane,
+//           and the world to local transform is affine, so the two are
+//           composed once for the segment (ConicLineFrame.)  The line's
+//           direction is dx Axis1 + dy Axis2, and across it is
+//           dx (Axis1 x Z) + dy (Axis2 x Z), with Z the view direction, so
+//           those are set up once too.  What's left for each
+//           vertex is multiply-adds and two reciprocal square roots, in a
+//           pass with no branches or calls, that the compiler vectorizes.
+// The distance along the line's a running sum, and stays its own (scalar)
+// pass.
+// See ReadMe.txt for more information.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "GTE/Mathematics/Vector3.h"
+#include <array>
+#include <cmath>
+#include <vector>
+
+using namespace gte;
+
+#include "Conics.h"
+
+
+// The unit conic, (cos t, sin t) or +-(cosh t, sinh t), one specialization for
+// each type.  Step gives the rotation (or boost) by d that Advance applies.
+template<class T, ProjectionType Type>
+struct UnitConic;
+
+template<class T>
+struct UnitConic<T, ProjectionType::Ellipse>
+{
+    static void Point(T t, T& x, T& y) { x = std::cos(t); y = std::sin(t); }
+    static void Step(T d, T& cd, T& sd) { cd = std::cos(d); sd = std::sin(d); }
+    static void Advance(T cd, T sd, T& x, T& y)
+    {
+        const T x1 = x * cd - y * sd;
+        y = y * cd + x * sd;
+        x = x1;
+    }
+};
+
+template<class T>
+struct UnitConic<T, ProjectionType::PositiveHyperbola>
+{
+    static void Point(T t, T& x, T& y) { x = std::cosh(t); y = std::sinh(t); }
+    static void Step(T d, T& cd, T& sd) { cd = std::cosh(d); sd = std::sinh(d); }
+    static void Advance(T cd, T sd, T& x, T& y)
+    {
+        const T x1 = x * cd + y * sd;
+        y = y * cd + x * sd;
+        x = x1;
+    }
+};
+
+// (Advance is linear, so it's the same for the other branch)
+template<class T>
+struct UnitConic<T, ProjectionType::NegativeHyperbola> : UnitConic<T, ProjectionType::PositiveHyperbola>
+{
+    static void Point(T t, T& x, T& y) { x = -std::cosh(t); y = -std::sinh(t); }
+};
+
+
+// The unit conic at each of params
+template<class T, ProjectionType Type, class P>
+void EvaluateUnitConic(const P* params, int count, T* x, T* y)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        UnitConic<T, Type>::Point((T)params[i], x[i], y[i]);
+    }
+}
+
+
+// lines + 1 evenly spaced points from start to start + length.  The last one
+// is evaluated, so whatever the recurrence has drifted doesn't show at the
+// end of the segment.
+template<class T, ProjectionType Type>
+void EvaluateUnitConicEvenly(T start, T length, int lines, T* x, T* y)
+{
+    T cd, sd;
+    UnitConic<T, Type>::Step(length / (T)lines, cd, sd);
+
+    T px, py;
+    UnitConic<T, Type>::Point(start, px, py);
+
+    for (int i = 0; i < lines; ++i)
+    {
+        x[i] = px;
+        y[i] = py;
+        UnitConic<T, Type>::Advance(cd, sd, px, py);
+    }
+
+    UnitConic<T, Type>::Point(start + length, x[lines], y[lines]);
+}
+
+
+// The same, for a type that's only known at run time.  False if it isn't one.
+template<class T, class P>
+bool EvaluateUnitConic(ProjectionType type, const P* params, int count, T* x, T* y)
+{
+    switch (type)
+    {
+    case ProjectionType::Ellipse: EvaluateUnitConic<T, ProjectionType::Ellipse>(params, count, x, y); return true;
+    case ProjectionType::PositiveHyperbola: EvaluateUnitConic<T, ProjectionType::PositiveHyperbola>(params, count, x, y); return true;
+    case ProjectionType::NegativeHyperbola: EvaluateUnitConic<T, ProjectionType::NegativeHyperbola>(params, count, x, y); return true;
+    default: return false;
+    }
+}
+
+template<class T>
+bool EvaluateUnitConicEvenly(ProjectionType type, T start, T length, int lines, T* x, T* y)
+{
+    switch (type)
+    {
+    case ProjectionType::Ellipse: EvaluateUnitConicEvenly<T, ProjectionType::Ellipse>(start, length, lines, x, y); return true;
+    case ProjectionType::PositiveHyperbola: EvaluateUnitConicEvenly<T, ProjectionType::PositiveHyperbola>(start, length, lines, x, y); return true;
+    case ProjectionType::NegativeHyperbola: EvaluateUnitConicEvenly<T, ProjectionType::NegativeHyperbola>(start, length, lines, x, y); return true;
+    default: return false;
+    }
+}
+
+
+// A segment's placement, set up once for all of its vertices (see above.)
+// Local is wherever the vertices are going (the renderer's local space.)
+template<class T>
+struct ConicLineFrame
+{
+    // World, for the tangents
+    Vector3<T> Axis1;
+    Vector3<T> Axis2;
+    Vector3<T> Across1;         // <- Axis1 x Z
+    Vector3<T> Across2;         // <- Axis2 x Z
+
+    // Local, for the corners
+    Vector3<T> LocalCenter;
+    Vector3<T> LocalAxis1;
+    Vector3<T> LocalAxis2;
+    Vector3<T> LocalAcross1;
+    Vector3<T> LocalAcross2;
+
+    T HalfThickness;
+};
+
+
+// The corners and tangents, structure-of-arrays.  (Dx, Dy and Length are
+// scratch, kept so they don't have to be allocated every time.)
+template<class T>
+struct ConicLineVertices
+{
+    std::array<std::vector<T>, 3> Left;         // <- Point + across
+    std::array<std::vector<T>, 3> Right;        // <- Point - across
+    std::array<std::vector<T>, 3> TangentX;     // <- Along the line
+    std::array<std::vector<T>, 3> TangentY;     // <- Across it
+    std::vector<T> Distance;                    // <- Along the line, from the first vertex
+
+    std::vector<T> Dx, Dy, Length;
+
+    size_t size() const { return Distance.size(); }
+
+    void resize(size_t count)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            Left[j].resize(count);
+            Right[j].resize(count);
+            TangentX[j].resize(count);
+            TangentY[j].resize(count);
+        }
+        Distance.resize(count);
+        Dx.resize(count);
+        Dy.resize(count);
+        Length.resize(count);
+    }
+};
+
+
+// count vertices (count > 1) at the unit conic points x, y
+template<class T>
+void TessellateConicLines(const ConicLineFrame<T>& frame, const T* x, const T* y, int count, ConicLineVertices<T>& out)
+{
+    out.resize(count);
+
+    T* dx = out.Dx.data();
+    T* dy = out.Dy.data();
+    T* length = out.Length.data();
+
+    // Each vertex's line to the next.  (The last one's carries on along the
+    // last line.)
+    for (int i = 0; i + 1 < count; ++i)
+    {
+        dx[i] = x[i + 1] - x[i];
+        dy[i] = y[i + 1] - y[i];
+    }
+    dx[count - 1] = dx[count - 2];
+    dy[count - 1] = dy[count - 2];
+
+    const Vector3<T>& A1 = frame.Axis1;
+    const Vector3<T>& A2 = frame.Axis2;
+    const Vector3<T>& X1 = frame.Across1;
+    const Vector3<T>& X2 = frame.Across2;
+    const Vector3<T>& C = frame.LocalCenter;
+    const Vector3<T>& L1 = frame.LocalAxis1;
+    const Vector3<T>& L2 = frame.LocalAxis2;
+    const Vector3<T>& LX1 = frame.LocalAcross1;
+    const Vector3<T>& LX2 = frame.LocalAcross2;
+    const T h = frame.HalfThickness;
+
+    T* leftX = out.Left[0].data(); T* leftY = out.Left[1].data(); T* leftZ = out.Left[2].data();
+    T* rightX = out.Right[0].data(); T* rightY = out.Right[1].data(); T* rightZ = out.Right[2].data();
+    T* alongX = out.TangentX[0].data(); T* alongY = out.TangentX[1].data(); T* alongZ = out.TangentX[2].data();
+    T* acrossX = out.TangentY[0].data(); T* acrossY = out.TangentY[1].data(); T* acrossZ = out.TangentY[2].data();
+
+    for (int i = 0; i < count; ++i)
+    {
+        const T u = dx[i];
+        const T v = dy[i];
+
+        // Along the line (world)
+        const T ax = u * A1[0] + v * A2[0];
+        const T ay = u * A1[1] + v * A2[1];
+        const T az = u * A1[2] + v * A2[2];
+        const T a2 = ax * ax + ay * ay + az * az;
+        const T invA = a2 > (T)0 ? (T)1 / std::sqrt(a2) : (T)0;
+
+        alongX[i] = ax * invA;
+        alongY[i] = ay * invA;
+        alongZ[i] = az * invA;
+        length[i] = a2 * invA;
+
+        // Across it (world)
+        const T cx = u * X1[0] + v * X2[0];
+        const T cy = u * X1[1] + v * X2[1];
+        const T cz = u * X1[2] + v * X2[2];
+        const T c2 = cx * cx + cy * cy + cz * cz;
+        const T invC = c2 > (T)0 ? (T)1 / std::sqrt(c2) : (T)0;
+
+        acrossX[i] = cx * invC;
+        acrossY[i] = cy * invC;
+        acrossZ[i] = cz * invC;
+
+        // The corners (local)
+        const T px = C[0] + x[i] * L1[0] + y[i] * L2[0];
+        const T py = C[1] + x[i] * L1[1] + y[i] * L2[1];
+        const T pz = C[2] + x[i] * L1[2] + y[i] * L2[2];
+
+        const T s = h * invC;
+        const T ox = s * (u * LX1[0] + v * LX2[0]);
+        const T oy = s * (u * LX1[1] + v * LX2[1]);
+        const T oz = s * (u * LX1[2] + v * LX2[2]);
+
+        leftX[i] = px + ox; leftY[i] = py + oy; leftZ[i] = pz + oz;
+        rightX[i] = px - ox; rightY[i] = py - oy; rightZ[i] = pz - oz;
+    }
+
+    T* distance = out.Distance.data();
+    T sum = (T)0;
+    for (int i = 0; i < count; ++i)
+    {
+        distance[i] = sum;
+        sum += length[i];
+    }
+}
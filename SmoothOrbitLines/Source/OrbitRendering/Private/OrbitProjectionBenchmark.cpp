@@ -0,0 +1,1345 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+// -----------------------------------------------------------------------------
+// OrbitProjectionBenchmark.cpp
+//
+// Development-only console commands for measuring the conic projection code
+// outside of a running scene.  Random (but plausible, solar system scale)
+// orbits are projected for a random view.
+//
+// Orbit.BenchmarkProjection
+//   Orbits per second through ProjectEllipseToPlane (one ellipse at a time),
+//   ProjectEllipseToPlaneClosedForm, ProjectConicMatrixToPlane (with the
+//   conic matrices precomputed) and ProjectEllipsesToPlane (batched), at 1,
+//   100 and 100k orbits.
+//
+// Orbit.ValidateProjection [Count]
+//   Runs the closed form and conic matrix projections against the
+//   ProjectEllipseToPlane template over a randomized corpus of orbits and
+//   views (planetary to outer solar system scales).  Reports how well they
+//   agree, and, since disagreement alone doesn't say which one is wrong, how
+//   well each one's image conic fits points on the orbit projected by brute
+//   force.
+//
+// Orbit.ValidateFloatProjection [Count]
+//   Runs the projection, clipping and true anomaly mapping in float, with
+//   camera-relative inputs, against the double path.  Reports the difference
+//   in pixels (1920 wide, 90 degree fov) for planetary, inner and outer solar
+//   system scales:
+//    conic:   the float image conic's distance from the double one's, where
+//             the double one is on screen.
+//    clip:    clip points, clipping the (same) image conic in float.
+//    anomaly: where the orbit is at the true anomaly of each clip point,
+//             mapped in float (TrueAnomalyMapping.)
+//
+// Orbit.BenchmarkCulling [Count] [FovDegrees]
+//   Culls Count orbits (default 100k) to a zoomed in view (default 5 degree
+//   fov) with CullEllipsesToFrustum, for a few views, each looking at a point
+//   on one of the orbits.  Reports the fraction culled, how many orbits are
+//   actually on screen (projected and clipped, all of them) and how many of
+//   those were culled (which should be none), and the time to cull against
+//   the time to project and clip every orbit.
+//
+// Orbit.BenchmarkClipping [Count]
+//   Clips per second: Count orbits (default 100k) are projected for a few
+//   views, wide and zoomed in, and the projections are clipped one at a time
+//   (ClipEllipseToFrustum / ClipHyperbolaToFrustum) and batched
+//   (ClipConicsToFrustum.)
+//
+// Orbit.BenchmarkTessellation [Count]
+//   Tessellates Count random segments (default 500) of ellipses and of
+//   hyperbolas, in pixels, to the renderer's default 0.25 pixel tolerance
+//   with GetConicTessellation.  Reports the lines it took against the evenly
+//   spaced lines it'd take to stray no further from the conic (found by
+//   bisection), how far the lines actually strayed, and the time taken.
+//
+// Orbit.BenchmarkBezier [Count]
+//   Points per second along Count random segments (default 10k) of ellipses
+//   and of hyperbolas, in pixels, 64 lines each: evaluated with sin/cos (or
+//   cosh/sinh) at each point, as the renderer did, and stepped along the
+//   segment's rational Bezier pieces (ConicBezier.h), pieces included.
+//   Reports how far the Bezier points are from the conic, which should be
+//   rounding.
+//
+// Orbit.BenchmarkTrueAnomaly [Count]
+//   Segment ends mapped to true anomalies per second: Count orbits (default
+//   100k) are projected and clipped for a few views, and every segment's ends
+//   are mapped one at a time with ProjectionAngleToTrueAnomaly, and batched
+//   through a TrueAnomalyMapping for each orbit (set up included.)  Reports
+//   the largest difference between them.
+//
+// Orbit.BenchmarkConicLines [Count]
+//   Vertices per second through the renderer's per-vertex work: Count random
+//   segments (default 10k) of each type of conic, 64 lines each, with a
+//   random renderer transform.  The way the renderer did it (a call through a
+//   function pointer and sin/cos for each point, three GetSafeNormals and two
+//   InverseTransformPositions for each vertex) against TessellateConicLines.h
+//   (the points stepped with the angle addition formulas, the frame and
+//   transform set up once for each segment.)  Reports the largest difference
+//   between their corners.
+// -----------------------------------------------------------------------------
+
+#include "OrbitProjectorComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+#include "Tests/OrbitTestFixtures.h"
+#include "Conics/ProjectEllipseToPlane.h"
+#include "Conics/ProjectEllipseToPlaneClosedForm.h"
+#include "Conics/ProjectEllipsesToPlane.h"
+#include "Conics/ProjectConicMatrixToPlane.h"
+#include "Conics/ClipEllipseToFrustum.h"
+#include "Conics/ClipHyperbolaToFrustum.h"
+#include "Conics/ClipConicsToFrustum.h"
+#include "Conics/ProjectionAngleToTrueAnomaly.h"
+#include "Conics/CullEllipsesToFrustum.h"
+#include "Conics/ConicTessellation.h"
+#include "Conics/ConicBezier.h"
+#include "Conics/TessellateConicLines.h"
+
+#if !UE_BUILD_SHIPPING
+
+namespace OrbitProjectionBenchmark
+{
+    using namespace OrbitTestFixtures;
+
+    // The ellipse as a conic matrix in its perifocal plane, (Focus; Ue, Ve)
+    struct PerifocalConic
+    {
+        Vector3<double> Focus, Ue, Ve;
+        ConicMatrix<double> DualConic;
+    };
+
+    PerifocalConic MakePerifocalConic(const EllipseProjectionInputs<double>& inputs)
+    {
+        const double ae = sqrt((inputs.A - inputs.B) * (inputs.A + inputs.B));
+        return PerifocalConic{ inputs.Ce + ae * inputs.Ue, inputs.Ue, inputs.Ve, PerifocalDualConic(ae / inputs.A, inputs.B * inputs.B / inputs.A) };
+    }
+
+    void ProjectPerifocalConic(const EllipseProjectionInputs<double>& inputs, const PerifocalConic& conic, EllipseProjectionOutputs<double>& outputs)
+    {
+        const EllipseProjectionView<double> view{ inputs.E, inputs.Cp, inputs.Np, inputs.Up, inputs.Vp };
+        ConicProjection<double>& p = outputs.projection;
+
+        ProjectConicMatrixToPlane(view, conic.Focus, conic.Ue, conic.Ve, conic.DualConic, p);
+
+        ImageConicLocateBody(
+            view,
+            inputs.Ce[0], inputs.Ce[1], inputs.Ce[2],
+            inputs.Ue[0], inputs.Ue[1], inputs.Ue[2],
+            inputs.Ve[0], inputs.Ve[1], inputs.Ve[2],
+            inputs.A, inputs.B,
+            inputs.TestTheta,
+            p.k[0], p.k[1],
+            p.u[0], p.u[1],
+            p.v[0], p.v[1],
+            p.a,
+            p.b,
+            outputs.projectionType,
+            outputs.ThetaLocation
+        );
+    }
+
+    void BenchmarkProjection(const TArray<FString>& Args)
+    {
+        FRandomStream Random(1234);
+
+        EllipseProjectionView<double> view;
+        MakeView(Random, 1000., view);
+
+        for (int Count : { 1, 100, 100000 })
+        {
+            EllipseBatch<double> ellipses;
+            MakeEllipses(Random, Count, ellipses);
+
+            std::vector<EllipseProjectionInputs<double>> inputs(Count);
+            std::vector<PerifocalConic> conics(Count);
+            for (int i = 0; i < Count; ++i)
+            {
+                inputs[i] = ellipses.getInputs(view, i);
+                conics[i] = MakePerifocalConic(inputs[i]);
+            }
+
+            // Enough repetitions to get out of the timer's noise
+            const int Repetitions = FMath::Max(1, 1000000 / Count);
+            double Checksum = 0.;
+
+            const double SingleStart = FPlatformTime::Seconds();
+            for (int r = 0; r < Repetitions; ++r)
+            {
+                for (int i = 0; i < Count; ++i)
+                {
+                    EllipseProjectionOutputs<double> outputs;
+                    ProjectEllipseToPlane(inputs[i], outputs);
+                    Checksum += outputs.projection.a;
+                }
+            }
+            const double SingleSeconds = FPlatformTime::Seconds() - SingleStart;
+
+            const double ClosedFormStart = FPlatformTime::Seconds();
+            for (int r = 0; r < Repetitions; ++r)
+            {
+                for (int i = 0; i < Count; ++i)
+                {
+                    EllipseProjectionOutputs<double> outputs;
+                    ProjectEllipseToPlaneClosedForm(inputs[i], outputs);
+                    Checksum += outputs.projection.a;
+                }
+            }
+            const double ClosedFormSeconds = FPlatformTime::Seconds() - ClosedFormStart;
+
+            const double MatrixStart = FPlatformTime::Seconds();
+            for (int r = 0; r < Repetitions; ++r)
+            {
+                for (int i = 0; i < Count; ++i)
+                {
+                    EllipseProjectionOutputs<double> outputs;
+                    ProjectPerifocalConic(inputs[i], conics[i], outputs);
+                    Checksum += outputs.projection.a;
+                }
+            }
+            const double MatrixSeconds = FPlatformTime::Seconds() - MatrixStart;
+
+            ConicProjectionBatch<double> projections;
+            const double BatchStart = FPlatformTime::Seconds();
+            for (int r = 0; r < Repetitions; ++r)
+            {
+                ProjectEllipsesToPlane(view, ellipses, projections);
+                Checksum += projections.a[0];
+            }
+            const double BatchSeconds = FPlatformTime::Seconds() - BatchStart;
+
+            const double Projected = (double)Count * (double)Repetitions;
+
+            UE_LOG(LogTemp, Display, TEXT("Orbit.BenchmarkProjection %6d orbits: per-ellipse %8.3f, closed form %8.3f, conic matrix %8.3f, batched %8.3f M orbits/s  [%g]"),
+                Count,
+                Projected / SingleSeconds * 1e-6,
+                Projected / ClosedFormSeconds * 1e-6,
+                Projected / MatrixSeconds * 1e-6,
+                Projected / BatchSeconds * 1e-6,
+                Checksum
+            );
+        }
+    }
+
+    // Point on the image conic
+    Vector2<double> ImagePoint(const ConicProjection<double>& p, ProjectionType projectionType, double t)
+    {
+        if (projectionType == ProjectionType::Ellipse)
+        {
+            return p.k + p.a * cos(t) * p.u + p.b * sin(t) * p.v;
+        }
+
+        const double sign = projectionType == ProjectionType::PositiveHyperbola ? 1. : -1.;
+        return p.k + sign * p.a * cosh(t) * p.u + sign * p.b * sinh(t) * p.v;
+    }
+
+    // Position of the body on the image conic
+    Vector2<double> ImageOfBody(const EllipseProjectionOutputs<double>& outputs)
+    {
+        return ImagePoint(outputs.projection, outputs.projectionType, outputs.ThetaLocation);
+    }
+
+    // Worst |conic equation| over points of the orbit in front of the eye,
+    // projected onto the plane one at a time.  Zero for an exact image conic.
+    double ImageResidual(const EllipseProjectionInputs<double>& inputs, const EllipseProjectionOutputs<double>& outputs)
+    {
+        const ConicProjection<double>& p = outputs.projection;
+        const bool isHyperbolic = outputs.projectionType != ProjectionType::Ellipse;
+        double Worst = 0.;
+
+        for (int j = 0; j < 16; ++j)
+        {
+            const double theta = j * twopi<double> / 16.;
+            const Vector3<double> P = inputs.Ce + inputs.A * cos(theta) * inputs.Ue + inputs.B * sin(theta) * inputs.Ve;
+            const Vector3<double> ToEye = inputs.E - P;
+
+            const double ToEyeDotN = Dot(ToEye, inputs.Np);
+            if (ToEyeDotN <= 0.) continue;
+
+            const Vector3<double> Q = P + (Dot(inputs.Cp - P, inputs.Np) / ToEyeDotN) * ToEye - inputs.Cp;
+            const Vector2<double> S{ Dot(Q, inputs.Up) - p.k[0], Dot(Q, inputs.Vp) - p.k[1] };
+            const double x = Dot(S, p.u) / p.a;
+            const double y = Dot(S, p.v) / p.b;
+
+            Worst = FMath::Max(Worst, FMath::Abs(isHyperbolic ? x * x - y * y - 1. : x * x + y * y - 1.));
+        }
+
+        return Worst;
+    }
+
+    FString Percentiles(TArray<double>& Values)
+    {
+        if (!Values.Num()) return TEXT("-");
+
+        Values.Sort();
+        auto At = [&Values](double q) { return Values[FMath::Min(Values.Num() - 1, (int)(q * Values.Num()))]; };
+        return FString::Printf(TEXT("p50 %.2e  p90 %.2e  p99 %.2e  p99.9 %.2e  max %.2e"), At(0.5), At(0.9), At(0.99), At(0.999), Values.Last());
+    }
+
+    void ValidateProjection(const TArray<FString>& Args)
+    {
+        const int Count = Args.Num() ? FCString::Atoi(*Args[0]) : 100000;
+        FRandomStream Random(4321);
+
+        int TypeMismatches = 0;
+        TArray<double> ShapeErrors, BodyErrors, MatrixErrors, TemplateResiduals, ClosedFormResiduals, MatrixResiduals;
+
+        for (int i = 0; i < Count; ++i)
+        {
+            EllipseProjectionView<double> view;
+            view.E = RandomVector(Random, AU * Random.FRandRange(0.01f, 40.f));
+            view.Np = RandomDirection(Random);
+            view.Cp = view.E - (double)Random.FRandRange(1.f, 10000.f) * view.Np;
+            view.Up = UnitCross(Vector3<double>({ 0, 0, 1 }), view.Np);
+            view.Vp = UnitCross(view.Np, view.Up);
+
+            EllipseBatch<double> ellipses;
+            const Vector3<double> Ue = RandomDirection(Random);
+            const Vector3<double> Ve = UnitCross(RandomDirection(Random), Ue);
+            const double A = AU * Random.FRandRange(0.002f, 40.f);
+            const double e = Random.FRandRange(0.f, 0.95f);
+            ellipses.resize(1);
+            ellipses.set(0, -A * e * Ue, Ue, Ve, A, A * sqrt(1. - e * e), twopi<double> * Random.FRand());
+
+            const EllipseProjectionInputs<double> inputs = ellipses.getInputs(view, 0);
+            EllipseProjectionOutputs<double> expected, actual, matrix;
+            ProjectEllipseToPlane(inputs, expected);
+            ProjectEllipseToPlaneClosedForm(inputs, actual);
+            ProjectPerifocalConic(inputs, MakePerifocalConic(inputs), matrix);
+
+            if (expected.projectionType != actual.projectionType || expected.projectionType != matrix.projectionType)
+            {
+                ++TypeMismatches;
+                continue;
+            }
+
+            if (actual.projectionType == ProjectionType::NotVisible)
+            {
+                continue;
+            }
+
+            const double Scale = FMath::Max(expected.projection.a, FMath::Abs(expected.projection.b));
+            ShapeErrors.Add(FMath::Max3(
+                FMath::Abs(actual.projection.a - expected.projection.a) / expected.projection.a,
+                FMath::Abs(FMath::Abs(actual.projection.b) - FMath::Abs(expected.projection.b)) / FMath::Abs(expected.projection.b),
+                Length(actual.projection.k - expected.projection.k) / Scale
+            ));
+
+            if (FMath::IsFinite(expected.ThetaLocation))
+            {
+                BodyErrors.Add(Length(ImageOfBody(actual) - ImageOfBody(expected)) / Scale);
+            }
+
+            MatrixErrors.Add(FMath::Max3(
+                FMath::Abs(matrix.projection.a - actual.projection.a) / actual.projection.a,
+                FMath::Abs(matrix.projection.b - actual.projection.b) / FMath::Abs(actual.projection.b),
+                Length(matrix.projection.k - actual.projection.k) / Scale
+            ));
+
+            TemplateResiduals.Add(ImageResidual(inputs, expected));
+            ClosedFormResiduals.Add(ImageResidual(inputs, actual));
+            MatrixResiduals.Add(ImageResidual(inputs, matrix));
+        }
+
+        UE_LOG(LogTemp, Display, TEXT("Orbit.ValidateProjection %d orbits, %d visible, %d classified differently"), Count, ShapeErrors.Num(), TypeMismatches);
+        UE_LOG(LogTemp, Display, TEXT("  closed form vs template, conic (relative): %s"), *Percentiles(ShapeErrors));
+        UE_LOG(LogTemp, Display, TEXT("  closed form vs template, body  (relative): %s"), *Percentiles(BodyErrors));
+        UE_LOG(LogTemp, Display, TEXT("  conic matrix vs closed form    (relative): %s"), *Percentiles(MatrixErrors));
+        UE_LOG(LogTemp, Display, TEXT("  template    residual: %s"), *Percentiles(TemplateResiduals));
+        UE_LOG(LogTemp, Display, TEXT("  closed form residual: %s"), *Percentiles(ClosedFormResiduals));
+        UE_LOG(LogTemp, Display, TEXT("  conic matrix residual: %s"), *Percentiles(MatrixResiduals));
+    }
+
+    // ------------------------------------------------------------------------
+    // Float
+    // ------------------------------------------------------------------------
+    template<int N>
+    Vector<N, float> ToFloat(const Vector<N, double>& v)
+    {
+        Vector<N, float> Result;
+        for (int i = 0; i < N; ++i) Result[i] = (float)v[i];
+        return Result;
+    }
+
+    template<int N>
+    Vector<N, double> ToDouble(const Vector<N, float>& v)
+    {
+        Vector<N, double> Result;
+        for (int i = 0; i < N; ++i) Result[i] = (double)v[i];
+        return Result;
+    }
+
+    ConicProjection<float> ToFloat(const ConicProjection<double>& p)
+    {
+        return ConicProjection<float>{ ToFloat(p.k), ToFloat(p.u), ToFloat(p.v), (float)p.a, (float)p.b };
+    }
+
+    ConicProjection<double> ToDouble(const ConicProjection<float>& p)
+    {
+        return ConicProjection<double>{ ToDouble(p.k), ToDouble(p.u), ToDouble(p.v), (double)p.a, (double)p.b };
+    }
+
+    // The eye is subtracted in double, before anything's rounded to float
+    EllipseProjectionInputs<float> CameraRelative(const EllipseProjectionInputs<double>& inputs)
+    {
+        return EllipseProjectionInputs<float>(
+            Vector3<float>{ 0.f, 0.f, 0.f }, ToFloat(inputs.Ce - inputs.E), ToFloat(inputs.Ne), ToFloat(inputs.Ue), ToFloat(inputs.Ve),
+            (float)inputs.A, (float)inputs.B,
+            ToFloat(inputs.Cp - inputs.E), ToFloat(inputs.Np), ToFloat(inputs.Up), ToFloat(inputs.Vp),
+            (float)inputs.TestTheta
+        );
+    }
+
+    void ClipConic(const FrustumParameters<double>& frustum, const ConicProjection<double>& p, ProjectionType projectionType, std::vector<ConicSegment<double>>& segments)
+    {
+        if (projectionType == ProjectionType::Ellipse) ClipEllipseToFrustum(frustum, p, segments);
+        else ClipHyperbolaToFrustum(frustum, p, projectionType == ProjectionType::PositiveHyperbola, segments);
+    }
+
+    void ClipConic(const FrustumParameters<float>& frustum, const ConicProjection<float>& p, ProjectionType projectionType, std::vector<ConicSegment<float>>& segments)
+    {
+        if (projectionType == ProjectionType::Ellipse) ClipEllipseToFrustum(frustum, p, segments);
+        else ClipHyperbolaToFrustum(frustum, p, projectionType == ProjectionType::PositiveHyperbola, segments);
+    }
+
+    // Distance from x to the conic, to first order
+    double ConicDistance(const ConicProjection<double>& p, ProjectionType projectionType, const Vector2<double>& x)
+    {
+        const Vector2<double> d = x - p.k;
+        const double X = Dot(d, p.u);
+        const double Y = Dot(d, p.v);
+        const double a2 = p.a * p.a;
+        const double b2 = projectionType == ProjectionType::Ellipse ? p.b * p.b : -p.b * p.b;
+
+        const double f = X * X / a2 + Y * Y / b2 - 1.;
+        const Vector2<double> Gradient = (2. * X / a2) * p.u + (2. * Y / b2) * p.v;
+        return FMath::Abs(f) / Length(Gradient);
+    }
+
+    // Where a point lands on the projection plane, false if it's behind the eye
+    bool ProjectPoint(const EllipseProjectionInputs<double>& inputs, const Vector3<double>& P, Vector2<double>& Image)
+    {
+        const Vector3<double> w = P - inputs.E;
+        const Vector3<double> F = inputs.Cp - inputs.E;
+        const double wDotN = Dot(w, inputs.Np);
+
+        const Vector3<double> q = (Dot(F, inputs.Np) / wDotN) * w - F;
+        Image = Vector2<double>{ Dot(q, inputs.Up), Dot(q, inputs.Vp) };
+        return wDotN < 0.;
+    }
+
+    Vector3<double> OrbitPoint(const EllipseProjectionInputs<double>& inputs, double TrueAnomaly)
+    {
+        const double ae = sqrt(inputs.A * inputs.A - inputs.B * inputs.B);
+        const double e = ae / inputs.A;
+        const double r = inputs.A * (1. - e * e) / (1. + e * cos(TrueAnomaly));
+
+        return inputs.Ce + ae * inputs.Ue + r * (cos(TrueAnomaly) * inputs.Ue + sin(TrueAnomaly) * inputs.Ve);
+    }
+
+    void ValidateFloatProjection(const TArray<FString>& Args)
+    {
+        const int Count = Args.Num() ? FCString::Atoi(*Args[0]) : 30000;
+        FRandomStream Random(2468);
+
+        const double z = 1000.;
+        const FrustumParameters<double> Frustum(z, pi<double> / 2., 16. / 9.);
+        const FrustumParameters<float> FloatFrustum((float)Frustum.z, (float)Frustum.fov, (float)Frustum.aspectRatio);
+        const double MaxX = z * tan(Frustum.fov / 2.);
+        const double MaxY = MaxX / Frustum.aspectRatio;
+        const double PixelsPerKm = 960. / MaxX;
+
+        struct FScale
+        {
+            const TCHAR* Name;
+            double Smallest, Largest;
+        };
+
+        const FScale Scales[] =
+        {
+            { TEXT("planetary"), 1e4, 1e7 },
+            { TEXT("inner"), 1e7, 5. * AU },
+            { TEXT("outer"), 5. * AU, 40. * AU }
+        };
+
+        for (const FScale& Scale : Scales)
+        {
+            int Visible = 0, TypeMismatches = 0, ClipMismatches = 0;
+            TArray<double> ConicErrors, ClipErrors, AnomalyErrors;
+
+            for (int i = 0; i < Count; ++i)
+            {
+                const double Size = FMath::Exp(FMath::Lerp(FMath::Loge(Scale.Smallest), FMath::Loge(Scale.Largest), (double)Random.FRand()));
+
+                EllipseProjectionView<double> view;
+                view.E = RandomVector(Random, 1.5 * Size);
+                view.Np = RandomDirection(Random);
+                view.Cp = view.E - z * view.Np;
+                view.Up = UnitCross(Vector3<double>({ 0, 0, 1 }), view.Np);
+                view.Vp = UnitCross(view.Np, view.Up);
+
+                EllipseBatch<double> ellipses;
+                const Vector3<double> Ue = RandomDirection(Random);
+                const Vector3<double> Ve = UnitCross(RandomDirection(Random), Ue);
+                const double A = Size * Random.FRandRange(0.05f, 1.5f);
+                const double e = Random.FRandRange(0.f, 0.95f);
+                ellipses.resize(1);
+                ellipses.set(0, -A * e * Ue, Ue, Ve, A, A * sqrt(1. - e * e), twopi<double> * Random.FRand());
+
+                const EllipseProjectionInputs<double> inputs = ellipses.getInputs(view, 0);
+                const EllipseProjectionInputs<float> floatInputs = CameraRelative(inputs);
+
+                EllipseProjectionOutputs<double> outputs;
+                EllipseProjectionOutputs<float> floatOutputs;
+                ProjectEllipseToPlaneClosedForm(inputs, outputs);
+                ProjectEllipseToPlaneClosedForm(floatInputs, floatOutputs);
+
+                const ProjectionType projectionType = outputs.projectionType;
+
+                if (projectionType == ProjectionType::NotVisible && floatOutputs.projectionType == ProjectionType::NotVisible)
+                {
+                    continue;
+                }
+
+                ++Visible;
+
+                if (projectionType != floatOutputs.projectionType)
+                {
+                    ++TypeMismatches;
+                    continue;
+                }
+
+                std::vector<ConicSegment<double>> segments;
+                ClipConic(Frustum, outputs.projection, projectionType, segments);
+
+                // Conic, wherever the double one's on screen
+                const ConicProjection<double> floatConic = ToDouble(floatOutputs.projection);
+                double Worst = -1.;
+                for (const ConicSegment<double>& segment : segments)
+                {
+                    for (int j = 0; j <= 16; ++j)
+                    {
+                        const Vector2<double> x = ImagePoint(outputs.projection, projectionType, segment.SegmentStart + segment.SegmentLength * j / 16.);
+                        if (FMath::Abs(x[0]) > MaxX || FMath::Abs(x[1]) > MaxY) continue;
+
+                        Worst = FMath::Max(Worst, ConicDistance(floatConic, projectionType, x) * PixelsPerKm);
+                    }
+                }
+                if (Worst >= 0.) ConicErrors.Add(Worst);
+
+                // Clipping, the same conic in float
+                EllipseProjectionOutputs<float> roundedOutputs;
+                roundedOutputs.projection = ToFloat(outputs.projection);
+                roundedOutputs.projectionType = projectionType;
+                roundedOutputs.ThetaLocation = (float)outputs.ThetaLocation;
+
+                std::vector<ConicSegment<float>> floatSegments;
+                ClipConic(FloatFrustum, roundedOutputs.projection, projectionType, floatSegments);
+
+                if (floatSegments.size() != segments.size())
+                {
+                    ++ClipMismatches;
+                }
+                else if (segments.size())
+                {
+                    Worst = 0.;
+                    for (int j = 0; j < (int)segments.size(); ++j)
+                    {
+                        for (int End = 0; End < 2; ++End)
+                        {
+                            const double t = segments[j].SegmentStart + End * segments[j].SegmentLength;
+                            const double floatT = (double)floatSegments[j].SegmentStart + End * (double)floatSegments[j].SegmentLength;
+                            const Vector2<double> Difference = ImagePoint(outputs.projection, projectionType, t) - ImagePoint(outputs.projection, projectionType, floatT);
+                            Worst = FMath::Max(Worst, Length(Difference) * PixelsPerKm);
+                        }
+                    }
+                    ClipErrors.Add(Worst);
+                }
+
+                // True anomaly, the same clip points in float
+                Worst = -1.;
+                for (const ConicSegment<double>& segment : segments)
+                {
+                    for (int End = 0; End < 2; ++End)
+                    {
+                        const double t = segment.SegmentStart + End * segment.SegmentLength;
+                        double TrueAnomaly;
+                        float FloatTrueAnomaly;
+
+                        TrueAnomalyMapping<double> Mapping;
+                        TrueAnomalyMapping<float> FloatMapping;
+                        if (!GetTrueAnomalyMapping(inputs, outputs, Mapping)) continue;
+                        if (!GetTrueAnomalyMapping(floatInputs, roundedOutputs, FloatMapping)) continue;
+                        TrueAnomaly = MapToTrueAnomaly(Mapping, t);
+                        FloatTrueAnomaly = MapToTrueAnomaly(FloatMapping, (float)t);
+
+                        Vector2<double> Image, FloatImage;
+                        if (!ProjectPoint(inputs, OrbitPoint(inputs, TrueAnomaly), Image)) continue;
+                        if (!ProjectPoint(inputs, OrbitPoint(inputs, (double)FloatTrueAnomaly), FloatImage)) continue;
+
+                        Worst = FMath::Max(Worst, Length(FloatImage - Image) * PixelsPerKm);
+                    }
+                }
+                if (Worst >= 0.) AnomalyErrors.Add(Worst);
+            }
+
+            UE_LOG(LogTemp, Display, TEXT("Orbit.ValidateFloatProjection %s: %d visible, %d classified differently, %d clipped differently"), Scale.Name, Visible, TypeMismatches, ClipMismatches);
+            UE_LOG(LogTemp, Display, TEXT("  conic   (pixels): %s"), *Percentiles(ConicErrors));
+            UE_LOG(LogTemp, Display, TEXT("  clip    (pixels): %s"), *Percentiles(ClipErrors));
+            UE_LOG(LogTemp, Display, TEXT("  anomaly (pixels): %s"), *Percentiles(AnomalyErrors));
+        }
+    }
+
+    // Is the clipped image conic on screen?  (The clippers keep an ellipse
+    // that surrounds the screen without crossing it, so it's checked at the
+    // middle of each segment.)
+    bool IsOnScreen(const FrustumParameters<double>& frustum, const EllipseProjectionOutputs<double>& outputs, const std::vector<ConicSegment<double>>& segments)
+    {
+        const double maxX = frustum.z * tan(frustum.fov / 2) * (1. + 1e-6);
+        const double maxY = maxX / frustum.aspectRatio;
+
+        for (const ConicSegment<double>& segment : segments)
+        {
+            const Vector2<double> Point = ImagePoint(outputs.projection, outputs.projectionType, segment.SegmentStart + 0.5 * segment.SegmentLength);
+            if (FMath::Abs(Point[0]) <= maxX && FMath::Abs(Point[1]) <= maxY)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void BenchmarkCulling(const TArray<FString>& Args)
+    {
+        const int Count = Args.Num() ? FCString::Atoi(*Args[0]) : 100000;
+        const double FovDegrees = Args.Num() > 1 ? FCString::Atod(*Args[1]) : 5.;
+
+        FRandomStream Random(1234);
+
+        EllipseBatch<double> ellipses;
+        MakeEllipses(Random, Count, ellipses);
+
+        // (Just for getting at the ellipses, getInputs wants a view)
+        const EllipseProjectionView<double> origin{ Vector3<double>::Zero(), Vector3<double>::Zero(), Vector3<double>::Unit(2), Vector3<double>::Unit(0), Vector3<double>::Unit(1) };
+
+        const double BuildStart = FPlatformTime::Seconds();
+        std::vector<OrientedBox3<double>> Boxes(Count);
+        for (int i = 0; i < Count; ++i)
+        {
+            const EllipseProjectionInputs<double> inputs = ellipses.getInputs(origin, i);
+            Boxes[i] = GetEllipseBounds(inputs.Ce, inputs.Ue, inputs.Ve, inputs.A, inputs.B);
+        }
+        EllipseBoundingVolumes<double> Volumes;
+        Volumes.Build(std::move(Boxes));
+        const double BuildSeconds = FPlatformTime::Seconds() - BuildStart;
+
+        UE_LOG(LogTemp, Display, TEXT("Orbit.BenchmarkCulling %d orbits, %.1f degree fov: built in %.2f ms"), Count, FovDegrees, BuildSeconds * 1e3);
+
+        const FrustumParameters<double> frustum(1000., FovDegrees / 180. * pi<double>, 16. / 9.);
+
+        for (int v = 0; v < 8; ++v)
+        {
+            // Zoomed in on a point on one of the orbits
+            EllipseProjectionView<double> view;
+            MakeView(Random, 1000., view);
+
+            const EllipseProjectionInputs<double> target = ellipses.getInputs(origin, Random.RandHelper(Count));
+            const double t = twopi<double> * Random.FRand();
+            view.Np = view.E - (target.Ce + target.A * cos(t) * target.Ue + target.B * sin(t) * target.Ve);
+            Normalize(view.Np);
+            view.Cp = view.E - frustum.z * view.Np;
+            view.Up = UnitCross(Vector3<double>({ 0, 0, 1 }), view.Np);
+            view.Vp = UnitCross(view.Np, view.Up);
+
+            const double CullStart = FPlatformTime::Seconds();
+            std::vector<int> Visible;
+            Volumes.Cull(GetViewFrustum(view.E, view.Np, view.Up, view.Vp, frustum, Volumes.GetFarDistance(view.E)), Visible);
+            const double CullSeconds = FPlatformTime::Seconds() - CullStart;
+
+            // Everything, the way the projector would without culling
+            const double ProjectStart = FPlatformTime::Seconds();
+            ConicProjectionBatch<double> projections;
+            ProjectEllipsesToPlane(view, ellipses, projections);
+
+            TArray<bool> OnScreen;
+            OnScreen.SetNumZeroed(Count);
+            std::vector<ConicSegment<double>> segments;
+            for (int i = 0; i < Count; ++i)
+            {
+                EllipseProjectionOutputs<double> outputs;
+                projections.getOutputs(i, outputs);
+
+                segments.clear();
+                if (outputs.projectionType == ProjectionType::Ellipse)
+                {
+                    ClipEllipseToFrustum(frustum, outputs.projection, segments);
+                }
+                else if (outputs.projectionType != ProjectionType::NotVisible)
+                {
+                    ClipHyperbolaToFrustum(frustum, outputs.projection, outputs.projectionType == ProjectionType::PositiveHyperbola, segments);
+                }
+
+                OnScreen[i] = IsOnScreen(frustum, outputs, segments);
+            }
+            const double ProjectSeconds = FPlatformTime::Seconds() - ProjectStart;
+
+            int OnScreenCount = 0;
+            int CulledOnScreen = 0;
+            int Next = 0;
+            for (int i = 0; i < Count; ++i)
+            {
+                const bool bKept = Next < (int)Visible.size() && Visible[Next] == i;
+                if (bKept) ++Next;
+
+                if (OnScreen[i])
+                {
+                    ++OnScreenCount;
+                    if (!bKept) ++CulledOnScreen;
+                }
+            }
+
+            UE_LOG(LogTemp, Display, TEXT("Orbit.BenchmarkCulling view %d: %6d kept (%5.2f%% culled), %6d on screen, %d of them culled.  Cull %8.3f ms, project and clip all %8.3f ms"),
+                v,
+                (int)Visible.size(),
+                100. * (double)(Count - (int)Visible.size()) / (double)FMath::Max(Count, 1),
+                OnScreenCount,
+                CulledOnScreen,
+                CullSeconds * 1e3,
+                ProjectSeconds * 1e3
+            );
+        }
+    }
+
+    void BenchmarkClipping(const TArray<FString>& Args)
+    {
+        const int Count = Args.Num() ? FCString::Atoi(*Args[0]) : 100000;
+
+        FRandomStream Random(1234);
+
+        EllipseBatch<double> ellipses;
+        MakeEllipses(Random, Count, ellipses);
+
+        for (int v = 0; v < 4; ++v)
+        {
+            const double FovDegrees = v < 2 ? 90. : 5.;
+            const FrustumParameters<double> frustum(1000., FovDegrees / 180. * pi<double>, 16. / 9.);
+
+            EllipseProjectionView<double> view;
+            MakeView(Random, 1000., view);
+
+            ConicProjectionBatch<double> projections;
+            ProjectEllipsesToPlane(view, ellipses, projections);
+
+            int Ellipses = 0;
+            int Hyperbolas = 0;
+            for (int i = 0; i < Count; ++i)
+            {
+                if (projections.projectionType[i] == ProjectionType::Ellipse) ++Ellipses;
+                else if (projections.projectionType[i] != ProjectionType::NotVisible) ++Hyperbolas;
+            }
+
+            // Enough repetitions to get out of the timer's noise
+            const int Repetitions = FMath::Max(1, 1000000 / FMath::Max(Count, 1));
+            int64 Checksum = 0;
+
+            std::vector<ConicSegment<double>> segments;
+            const double SingleStart = FPlatformTime::Seconds();
+            for (int r = 0; r < Repetitions; ++r)
+            {
+                for (int i = 0; i < Count; ++i)
+                {
+                    EllipseProjectionOutputs<double> outputs;
+                    projections.getOutputs(i, outputs);
+
+                    if (outputs.projectionType == ProjectionType::Ellipse)
+                    {
+                        ClipEllipseToFrustum(frustum, outputs.projection, segments);
+                    }
+                    else if (outputs.projectionType != ProjectionType::NotVisible)
+                    {
+                        ClipHyperbolaToFrustum(frustum, outputs.projection, outputs.projectionType == ProjectionType::PositiveHyperbola, segments);
+                    }
+                    Checksum += segments.size();
+                }
+            }
+            const double SingleSeconds = FPlatformTime::Seconds() - SingleStart;
+
+            std::vector<ConicClip<double>> clips;
+            const double BatchStart = FPlatformTime::Seconds();
+            for (int r = 0; r < Repetitions; ++r)
+            {
+                ClipConicsToFrustum(frustum, projections, clips);
+                Checksum += clips[0].SegmentCount;
+            }
+            const double BatchSeconds = FPlatformTime::Seconds() - BatchStart;
+
+            const double Clipped = (double)Count * (double)Repetitions;
+
+            UE_LOG(LogTemp, Display, TEXT("Orbit.BenchmarkClipping %6d orbits, %4.1f degree fov (%d ellipses, %d hyperbolas): one at a time %8.3f, batched %8.3f M clips/s  [%lld]"),
+                Count,
+                FovDegrees,
+                Ellipses,
+                Hyperbolas,
+                Clipped / SingleSeconds * 1e-6,
+                Clipped / BatchSeconds * 1e-6,
+                Checksum
+            );
+        }
+    }
+
+    // How far the lines between params stray from the conic (a cos t, b sin t)
+    // or (a cosh t, b sinh t), sampled
+    double GetTessellationDeviation(bool Hyperbola, double a, double b, const std::vector<double>& Params)
+    {
+        auto Point = [&](double t)
+        {
+            return Hyperbola ? Vector2<double>{ a * std::cosh(t), b * std::sinh(t) } : Vector2<double>{ a * std::cos(t), b * std::sin(t) };
+        };
+
+        double Deviation = 0.;
+        for (size_t i = 0; i + 1 < Params.size(); ++i)
+        {
+            const Vector2<double> A = Point(Params[i]);
+            const Vector2<double> B = Point(Params[i + 1]);
+            const Vector2<double> AtoB = B - A;
+            const double LengthSquared = Dot(AtoB, AtoB);
+
+            for (int j = 1; j < 32; ++j)
+            {
+                const Vector2<double> P = Point(Params[i] + (Params[i + 1] - Params[i]) * j / 32.);
+                const double u = LengthSquared > 0. ? FMath::Clamp(Dot(P - A, AtoB) / LengthSquared, 0., 1.) : 0.;
+                Deviation = FMath::Max(Deviation, Length(A + u * AtoB - P));
+            }
+        }
+        return Deviation;
+    }
+
+    void BenchmarkTessellation(const TArray<FString>& Args)
+    {
+        const int Count = Args.Num() ? FCString::Atoi(*Args[0]) : 500;
+        const double Tolerance = 0.25;
+
+        FRandomStream Random(1234);
+
+        for (int h = 0; h < 2; ++h)
+        {
+            const bool Hyperbola = h == 1;
+            int64 AdaptiveLines = 0;
+            int64 EvenLines = 0;
+            double WorstDeviation = 0.;
+            double Seconds = 0.;
+
+            std::vector<double> Params;
+            std::vector<double> Even;
+            auto MakeEven = [&](double Start, double Length, int Lines)
+            {
+                Even.resize(Lines + 1);
+                for (int i = 0; i <= Lines; ++i) Even[i] = Start + Length * i / Lines;
+                return Even;
+            };
+
+            for (int i = 0; i < Count; ++i)
+            {
+                // 10 to 5000 pixels across, and anywhere from round to very flat
+                double a = FMath::Exp(Random.FRandRange(FMath::Loge(10.f), FMath::Loge(5000.f)));
+                double b = a * FMath::Exp(Random.FRandRange(FMath::Loge(0.02f), 0.f));
+                if (Hyperbola && Random.FRand() < 0.5f) Swap(a, b);
+
+                double Start = Hyperbola ? Random.FRandRange(-8.f, 0.f) : Random.FRandRange(0.f, twopi<float>);
+                double Length = Hyperbola ? Random.FRandRange(0.5f, 16.f) : Random.FRandRange(0.2f, twopi<float>);
+                if (Random.FRand() < 0.5f)
+                {
+                    Start += Length;
+                    Length = -Length;
+                }
+
+                const double Begin = FPlatformTime::Seconds();
+                GetConicTessellation(Hyperbola, a, b, Start, Length, Tolerance, 100000, Params);
+                Seconds += FPlatformTime::Seconds() - Begin;
+
+                const double Deviation = GetTessellationDeviation(Hyperbola, a, b, Params);
+                WorstDeviation = FMath::Max(WorstDeviation, Deviation);
+
+                // The fewest evenly spaced lines that stray no further
+                int Lo = 1, Hi = 1;
+                while (GetTessellationDeviation(Hyperbola, a, b, MakeEven(Start, Length, Hi)) > Deviation) Hi *= 2;
+                Lo = Hi / 2;
+                while (Hi - Lo > 1)
+                {
+                    const int Mid = (Lo + Hi) / 2;
+                    if (GetTessellationDeviation(Hyperbola, a, b, MakeEven(Start, Length, Mid)) > Deviation) Lo = Mid;
+                    else Hi = Mid;
+                }
+
+                AdaptiveLines += Params.size() - 1;
+                EvenLines += Hi;
+            }
+
+            UE_LOG(LogTemp, Display, TEXT("Orbit.BenchmarkTessellation %d %s segments: %lld lines, %lld evenly spaced (%.1f%% fewer), worst %.3f pixels (tolerance %.2f), %.3f us each"),
+                Count,
+                Hyperbola ? TEXT("hyperbola") : TEXT("ellipse"),
+                AdaptiveLines,
+                EvenLines,
+                EvenLines ? 100. * (double)(EvenLines - AdaptiveLines) / (double)EvenLines : 0.,
+                WorstDeviation,
+                Tolerance,
+                Seconds / FMath::Max(Count, 1) * 1e6
+            );
+        }
+    }
+
+    void BenchmarkBezier(const TArray<FString>& Args)
+    {
+        const int Count = Args.Num() ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 10000;
+        const int Lines = 64;
+
+        FRandomStream Random(1234);
+
+        for (int h = 0; h < 2; ++h)
+        {
+            const bool Hyperbola = h == 1;
+
+            struct FSegment
+            {
+                ConicProjection<double> Projection;
+                double Sign;
+                double Start;
+                double Length;
+            };
+
+            std::vector<FSegment> Segments(Count);
+            for (FSegment& Segment : Segments)
+            {
+                ConicProjection<double>& p = Segment.Projection;
+                const double Angle = Random.FRandRange(0.f, twopi<float>);
+                p.k = Vector<2, double>{ Random.FRandRange(-500.f, 500.f), Random.FRandRange(-500.f, 500.f) };
+                p.u = Vector<2, double>{ std::cos(Angle), std::sin(Angle) };
+                p.v = Vector<2, double>{ -std::sin(Angle), std::cos(Angle) };
+                p.a = FMath::Exp(Random.FRandRange(FMath::Loge(10.f), FMath::Loge(5000.f)));
+                p.b = p.a * FMath::Exp(Random.FRandRange(FMath::Loge(0.02f), 0.f));
+
+                Segment.Sign = Random.FRand() < 0.5f ? -1. : 1.;
+                Segment.Start = Hyperbola ? Random.FRandRange(-6.f, 0.f) : Random.FRandRange(0.f, twopi<float>);
+                Segment.Length = Hyperbola ? Random.FRandRange(0.2f, 12.f) : Random.FRandRange(0.1f, twopi<float>);
+            }
+
+            std::vector<Vector<2, double>> Points(Lines + ConicBezierMaxPieces + 1);
+            std::vector<double> X(Points.size()), Y(Points.size());
+            const int Repetitions = FMath::Max(1, 1000000 / (Count * Lines));
+            double Checksum = 0.;
+
+            const double TranscendentalStart = FPlatformTime::Seconds();
+            for (int r = 0; r < Repetitions; ++r)
+            {
+                for (const FSegment& Segment : Segments)
+                {
+                    const ConicProjection<double>& p = Segment.Projection;
+                    for (int i = 0; i <= Lines; ++i)
+                    {
+                        const double t = Segment.Start + Segment.Length * i / Lines;
+                        Points[i] = Hyperbola
+                            ? p.k + Segment.Sign * (p.a * std::cosh(t) * p.u + p.b * std::sinh(t) * p.v)
+                            : p.k + p.a * std::cos(t) * p.u + p.b * std::sin(t) * p.v;
+                    }
+                    Checksum += Points[Lines / 2][0];
+                }
+            }
+            const double TranscendentalSeconds = FPlatformTime::Seconds() - TranscendentalStart;
+
+            // (The lines are shared out between the pieces the way the renderer does)
+            ConicBezier<double> Pieces[ConicBezierMaxPieces];
+            double WorstError = 0.;
+
+            const double BezierStart = FPlatformTime::Seconds();
+            for (int r = 0; r < Repetitions; ++r)
+            {
+                for (const FSegment& Segment : Segments)
+                {
+                    const int PieceCount = GetConicBeziers(Segment.Projection, Hyperbola, Segment.Sign, Segment.Start, Segment.Length, Pieces);
+                    const int TotalLines = FMath::Max(Lines, PieceCount);
+
+                    int First = 0;
+                    for (int i = 0; i < PieceCount; ++i)
+                    {
+                        const int Next = (i + 1) * TotalLines / PieceCount;
+                        TessellateConicBezier(Pieces[i], Next - First, &X[First], &Y[First]);
+                        First = Next;
+                    }
+                    Checksum += X[Lines / 2];
+                }
+            }
+            const double BezierSeconds = FPlatformTime::Seconds() - BezierStart;
+
+            // How far off they are, outside of the timing
+            for (const FSegment& Segment : Segments)
+            {
+                const ConicProjection<double>& p = Segment.Projection;
+                const int PieceCount = GetConicBeziers(p, Hyperbola, Segment.Sign, Segment.Start, Segment.Length, Pieces);
+                const int TotalLines = FMath::Max(Lines, PieceCount);
+
+                int First = 0;
+                for (int i = 0; i < PieceCount; ++i)
+                {
+                    const int Next = (i + 1) * TotalLines / PieceCount;
+                    TessellateConicBezier(Pieces[i], Next - First, &X[First], &Y[First]);
+
+                    for (int j = 0; j <= Next - First; ++j)
+                    {
+                        const double t = GetConicBezierParameter(Pieces[i], Hyperbola, (double)j / (double)(Next - First));
+                        const Vector<2, double> Exact = Hyperbola
+                            ? p.k + Segment.Sign * (p.a * std::cosh(t) * p.u + p.b * std::sinh(t) * p.v)
+                            : p.k + p.a * std::cos(t) * p.u + p.b * std::sin(t) * p.v;
+                        WorstError = FMath::Max(WorstError, Length(Vector<2, double>{ X[First + j], Y[First + j] } - Exact));
+                    }
+                    First = Next;
+                }
+            }
+
+            const double Evaluated = (double)Count * (double)Repetitions * (double)(Lines + 1);
+
+            UE_LOG(LogTemp, Display, TEXT("Orbit.BenchmarkBezier %d %s segments: sin/cos %8.2f, Bezier %8.2f M points/s, worst %.3g pixels off  [%g]"),
+                Count,
+                Hyperbola ? TEXT("hyperbola") : TEXT("ellipse"),
+                Evaluated / TranscendentalSeconds * 1e-6,
+                Evaluated / BezierSeconds * 1e-6,
+                WorstError,
+                Checksum
+            );
+        }
+    }
+
+    void BenchmarkTrueAnomaly(const TArray<FString>& Args)
+    {
+        const int Count = Args.Num() ? FCString::Atoi(*Args[0]) : 100000;
+
+        FRandomStream Random(1234);
+
+        EllipseBatch<double> ellipses;
+        MakeEllipses(Random, Count, ellipses);
+
+        for (int v = 0; v < 4; ++v)
+        {
+            const double FovDegrees = v < 2 ? 90. : 5.;
+            const FrustumParameters<double> frustum(1000., FovDegrees / 180. * pi<double>, 16. / 9.);
+
+            EllipseProjectionView<double> view;
+            MakeView(Random, 1000., view);
+
+            ConicProjectionBatch<double> projections;
+            ProjectEllipsesToPlane(view, ellipses, projections);
+
+            std::vector<ConicClip<double>> clips;
+            ClipConicsToFrustum(frustum, projections, clips);
+
+            // The visible ones, and their segments
+            std::vector<int> Visible;
+            int Ends = 0;
+            for (int i = 0; i < Count; ++i)
+            {
+                if (clips[i].Visible && clips[i].SegmentCount)
+                {
+                    Visible.push_back(i);
+                    Ends += 2 * clips[i].SegmentCount;
+                }
+            }
+
+            const int Repetitions = FMath::Max(1, 1000000 / FMath::Max(Ends, 1));
+            double Checksum = 0.;
+            double TrueAnomalies[2 * ConicClip<double>::MaxSegments];
+
+            const double SingleStart = FPlatformTime::Seconds();
+            for (int r = 0; r < Repetitions; ++r)
+            {
+                for (int i : Visible)
+                {
+                    const EllipseProjectionInputs<double> inputs = ellipses.getInputs(view, i);
+                    EllipseProjectionOutputs<double> outputs;
+                    projections.getOutputs(i, outputs);
+
+                    for (int j = 0; j < clips[i].SegmentCount; ++j)
+                    {
+                        const ConicSegment<double>& segment = clips[i].Segments[j];
+                        ProjectionAngleToTrueAnomaly(inputs, outputs, segment.SegmentStart, TrueAnomalies[2 * j]);
+                        ProjectionAngleToTrueAnomaly(inputs, outputs, segment.SegmentStart + segment.SegmentLength, TrueAnomalies[2 * j + 1]);
+                    }
+                    Checksum += TrueAnomalies[0];
+                }
+            }
+            const double SingleSeconds = FPlatformTime::Seconds() - SingleStart;
+
+            const double BatchStart = FPlatformTime::Seconds();
+            for (int r = 0; r < Repetitions; ++r)
+            {
+                for (int i : Visible)
+                {
+                    const EllipseProjectionInputs<double> inputs = ellipses.getInputs(view, i);
+                    EllipseProjectionOutputs<double> outputs;
+                    projections.getOutputs(i, outputs);
+
+                    TrueAnomalyMapping<double> mapping;
+                    GetTrueAnomalyMapping(inputs, outputs, mapping);
+                    MapToTrueAnomalies(mapping, clips[i].Segments, clips[i].SegmentCount, TrueAnomalies);
+                    Checksum += TrueAnomalies[0];
+                }
+            }
+            const double BatchSeconds = FPlatformTime::Seconds() - BatchStart;
+
+            // How far apart they are, outside of the timing
+            double Worst = 0.;
+            for (int i : Visible)
+            {
+                const EllipseProjectionInputs<double> inputs = ellipses.getInputs(view, i);
+                EllipseProjectionOutputs<double> outputs;
+                projections.getOutputs(i, outputs);
+
+                TrueAnomalyMapping<double> mapping;
+                GetTrueAnomalyMapping(inputs, outputs, mapping);
+                MapToTrueAnomalies(mapping, clips[i].Segments, clips[i].SegmentCount, TrueAnomalies);
+
+                for (int j = 0; j < 2 * clips[i].SegmentCount; ++j)
+                {
+                    const ConicSegment<double>& segment = clips[i].Segments[j / 2];
+                    double TrueAnomaly;
+                    ProjectionAngleToTrueAnomaly(inputs, outputs, segment.SegmentStart + (j & 1) * segment.SegmentLength, TrueAnomaly);
+                    Worst = FMath::Max(Worst, FMath::Abs(FMath::UnwindRadians(TrueAnomaly - TrueAnomalies[j])));
+                }
+            }
+
+            const double Mapped = (double)Ends * (double)Repetitions;
+
+            UE_LOG(LogTemp, Display, TEXT("Orbit.BenchmarkTrueAnomaly %6d orbits, %4.1f degree fov (%d visible, %d segment ends): one at a time %8.3f, mapped %8.3f M ends/s, worst %.3g radians apart  [%g]"),
+                Count,
+                FovDegrees,
+                (int)Visible.size(),
+                Ends,
+                SingleSeconds > 0. ? Mapped / SingleSeconds * 1e-6 : 0.,
+                BatchSeconds > 0. ? Mapped / BatchSeconds * 1e-6 : 0.,
+                Worst,
+                Checksum
+            );
+        }
+    }
+
+    // The renderer's unit conics, as they were
+    FVector2D UnitEllipse(float theta) { return FVector2D(cos(theta), sin(theta)); }
+    FVector2D UnitPositiveHyperbola(float theta) { return FVector2D(cosh(theta), sinh(theta)); }
+    FVector2D UnitNegativeHyperbola(float theta) { return FVector2D(-cosh(theta), -sinh(theta)); }
+
+    void BenchmarkConicLines(const TArray<FString>& Args)
+    {
+        const int Count = Args.Num() ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 10000;
+        const int Lines = 64;
+        const float LineThickness = 2.f;
+
+        FRandomStream Random(1234);
+
+        const FMatrix LocalToWorld = FTransform(
+            FRotator(Random.FRandRange(-90.f, 90.f), Random.FRandRange(-180.f, 180.f), Random.FRandRange(-180.f, 180.f)),
+            FVector(Random.FRandRange(-1000.f, 1000.f), Random.FRandRange(-1000.f, 1000.f), Random.FRandRange(-1000.f, 1000.f))
+        ).ToMatrixWithScale();
+        const FVector CameraDirection = FVector(Random.FRandRange(-1.f, 1.f), Random.FRandRange(-1.f, 1.f), Random.FRandRange(-1.f, 1.f));
+
+        const ProjectionType Types[] = { ProjectionType::Ellipse, ProjectionType::PositiveHyperbola, ProjectionType::NegativeHyperbola };
+
+        for (const ProjectionType Type : Types)
+        {
+            const bool Hyperbola = Type != ProjectionType::Ellipse;
+
+            FVector2D(*ConicPoint)(float) = Type == ProjectionType::Ellipse ? &UnitEllipse
+                : Type == ProjectionType::PositiveHyperbola ? &UnitPositiveHyperbola : &UnitNegativeHyperbola;
+
+            struct FSegment
+            {
+                FVector Center;
+                FVector Axis1;
+                FVector Axis2;
+                float Start;
+                float Length;
+            };
+
+            std::vector<FSegment> Segments(Count);
+            for (FSegment& Segment : Segments)
+            {
+                const FVector U = FVector(Random.FRandRange(-1.f, 1.f), Random.FRandRange(-1.f, 1.f), Random.FRandRange(-1.f, 1.f)).GetSafeNormal();
+                const FVector V = (U ^ CameraDirection).GetSafeNormal();
+                const float A = FMath::Exp(Random.FRandRange(FMath::Loge(10.f), FMath::Loge(5000.f)));
+
+                Segment.Center = FVector(Random.FRandRange(-500.f, 500.f), Random.FRandRange(-500.f, 500.f), Random.FRandRange(-500.f, 500.f));
+                Segment.Axis1 = A * U;
+                Segment.Axis2 = A * FMath::Exp(Random.FRandRange(FMath::Loge(0.02f), 0.f)) * V;
+                Segment.Start = Hyperbola ? Random.FRandRange(-6.f, 0.f) : Random.FRandRange(0.f, twopi<float>);
+                Segment.Length = Hyperbola ? Random.FRandRange(0.2f, 12.f) : Random.FRandRange(0.1f, twopi<float>);
+            }
+
+            const int Repetitions = FMath::Max(1, 1000000 / (Count * (Lines + 1)));
+            std::vector<FVector> OldLeft(Lines + 1), OldRight(Lines + 1);
+            double Checksum = 0.;
+
+            // The way the renderer did it
+            auto TessellateOld = [&](const FSegment& Segment)
+            {
+                FVector2D c0 = ConicPoint(Segment.Start);
+                FVector A = Segment.Center + c0.X * Segment.Axis1 + c0.Y * Segment.Axis2;
+
+                for (int i = 0; i <= Lines; ++i)
+                {
+                    const float theta1 = Segment.Start + Segment.Length * (float)(i + 1) / (float)Lines;
+                    const FVector2D c1 = ConicPoint(theta1);
+                    const FVector B = Segment.Center + c1.X * Segment.Axis1 + c1.Y * Segment.Axis2;
+
+                    const FVector TangentX = (B - A).GetSafeNormal();
+                    const FVector TangentZ = CameraDirection.GetSafeNormal();
+                    const FVector TangentY = (TangentX ^ TangentZ).GetSafeNormal();
+                    const FVector Perp = TangentY * LineThickness * 0.5f;
+
+                    OldLeft[i] = LocalToWorld.InverseTransformPosition(A + Perp);
+                    OldRight[i] = LocalToWorld.InverseTransformPosition(A - Perp);
+
+                    A = B;
+                }
+            };
+
+            const double OldStart = FPlatformTime::Seconds();
+            for (int r = 0; r < Repetitions; ++r)
+            {
+                for (const FSegment& Segment : Segments)
+                {
+                    TessellateOld(Segment);
+                    Checksum += OldLeft[Lines / 2].X;
+                }
+            }
+            const double OldSeconds = FPlatformTime::Seconds() - OldStart;
+
+            // TessellateConicLines, set up the way the renderer does
+            std::vector<double> X(Lines + 1), Y(Lines + 1);
+            ConicLineVertices<double> Vertices;
+            const FMatrix WorldToLocal = LocalToWorld.Inverse();
+
+            auto TessellateNew = [&](const FSegment& Segment)
+            {
+                EvaluateUnitConicEvenly(Type, (double)Segment.Start, (double)Segment.Length, Lines, X.data(), Y.data());
+
+                const FVector TangentZ = CameraDirection.GetSafeNormal();
+                const FVector Across1 = Segment.Axis1 ^ TangentZ;
+                const FVector Across2 = Segment.Axis2 ^ TangentZ;
+                const FVector LocalCenter = WorldToLocal.TransformPosition(Segment.Center);
+                const FVector LocalAxis1 = WorldToLocal.TransformVector(Segment.Axis1);
+                const FVector LocalAxis2 = WorldToLocal.TransformVector(Segment.Axis2);
+                const FVector LocalAcross1 = WorldToLocal.TransformVector(Across1);
+                const FVector LocalAcross2 = WorldToLocal.TransformVector(Across2);
+
+                ConicLineFrame<double> Frame;
+                Frame.Axis1 = Vector3<double>{ Segment.Axis1.X, Segment.Axis1.Y, Segment.Axis1.Z };
+                Frame.Axis2 = Vector3<double>{ Segment.Axis2.X, Segment.Axis2.Y, Segment.Axis2.Z };
+                Frame.Across1 = Vector3<double>{ Across1.X, Across1.Y, Across1.Z };
+                Frame.Across2 = Vector3<double>{ Across2.X, Across2.Y, Across2.Z };
+                Frame.LocalCenter = Vector3<double>{ LocalCenter.X, LocalCenter.Y, LocalCenter.Z };
+                Frame.LocalAxis1 = Vector3<double>{ LocalAxis1.X, LocalAxis1.Y, LocalAxis1.Z };
+                Frame.LocalAxis2 = Vector3<double>{ LocalAxis2.X, LocalAxis2.Y, LocalAxis2.Z };
+                Frame.LocalAcross1 = Vector3<double>{ LocalAcross1.X, LocalAcross1.Y, LocalAcross1.Z };
+                Frame.LocalAcross2 = Vector3<double>{ LocalAcross2.X, LocalAcross2.Y, LocalAcross2.Z };
+                Frame.HalfThickness = LineThickness * 0.5;
+
+                TessellateConicLines(Frame, X.data(), Y.data(), Lines + 1, Vertices);
+            };
+
+            const double NewStart = FPlatformTime::Seconds();
+            for (int r = 0; r < Repetitions; ++r)
+            {
+                for (const FSegment& Segment : Segments)
+                {
+                    TessellateNew(Segment);
+                    Checksum += Vertices.Left[0][Lines / 2];
+                }
+            }
+            const double NewSeconds = FPlatformTime::Seconds() - NewStart;
+
+            // How far apart the corners are, outside of the timing.  (The
+            // last vertex is left out, since the old way stepped past the end
+            // of the segment for its tangent, rather than carrying on along the
+            // last line.)
+            double WorstDifference = 0.;
+            for (const FSegment& Segment : Segments)
+            {
+                TessellateOld(Segment);
+                TessellateNew(Segment);
+
+                for (int i = 0; i < Lines; ++i)
+                {
+                    const FVector NewLeft(Vertices.Left[0][i], Vertices.Left[1][i], Vertices.Left[2][i]);
+                    const FVector NewRight(Vertices.Right[0][i], Vertices.Right[1][i], Vertices.Right[2][i]);
+                    WorstDifference = FMath::Max(WorstDifference, (double)FVector::Dist(OldLeft[i], NewLeft));
+                    WorstDifference = FMath::Max(WorstDifference, (double)FVector::Dist(OldRight[i], NewRight));
+                }
+            }
+
+            const double Tessellated = (double)Count * (double)Repetitions * (double)(Lines + 1);
+
+            UE_LOG(LogTemp, Display, TEXT("Orbit.BenchmarkConicLines %d %s segments: per vertex %8.2f, TessellateConicLines %8.2f M vertices/s, worst %.3g apart  [%g]"),
+                Count,
+                Type == ProjectionType::Ellipse ? TEXT("ellipse") : Type == ProjectionType::PositiveHyperbola ? TEXT("positive hyperbola") : TEXT("negative hyperbola"),
+                Tessellated / OldSeconds * 1e-6,
+                Tessellated / NewSeconds * 1e-6,
+                WorstDifference,
+                Checksum
+            );
+        }
+    }
+
+    FAutoConsoleCommand BenchmarkConicLinesCommand(
+        TEXT("Orbit.BenchmarkConicLines"),
+        TEXT("Vertices per second through the renderer's per-vertex work, as it was and with TessellateConicLines.  Orbit.BenchmarkConicLines [Count]"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkConicLines)
+    );
+
+    FAutoConsoleCommand BenchmarkTrueAnomalyCommand(
+        TEXT("Orbit.BenchmarkTrueAnomaly"),
+        TEXT("Segment ends mapped to true anomalies per second, one at a time and through a closed form mapping.  Orbit.BenchmarkTrueAnomaly [Count]"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkTrueAnomaly)
+    );
+
+    FAutoConsoleCommand BenchmarkBezierCommand(
+        TEXT("Orbit.BenchmarkBezier"),
+        TEXT("Points per second along conics, with sin/cos at every point and stepped along rational Bezier pieces.  Orbit.BenchmarkBezier [Count]"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkBezier)
+    );
+
+    FAutoConsoleCommand BenchmarkTessellationCommand(
+        TEXT("Orbit.BenchmarkTessellation"),
+        TEXT("Lines to tessellate conics to a pixel tolerance, by curvature against evenly spaced.  Orbit.BenchmarkTessellation [Count]"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkTessellation)
+    );
+
+    FAutoConsoleCommand BenchmarkClippingCommand(
+        TEXT("Orbit.BenchmarkClipping"),
+        TEXT("Conics clipped per second, one at a time and batched.  Orbit.BenchmarkClipping [Count]"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkClipping)
+    );
+
+    FAutoConsoleCommand ValidateFloatProjectionCommand(
+        TEXT("Orbit.ValidateFloatProjection"),
+        TEXT("Compare float (camera-relative) projection, clipping and true anomaly mapping with double, in pixels.  Orbit.ValidateFloatProjection [Count]"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&ValidateFloatProjection)
+    );
+
+    FAutoConsoleCommand ValidateProjectionCommand(
+        TEXT("Orbit.ValidateProjection"),
+        TEXT("Compare the closed form conic projection with the ProjectEllipseToPlane template over random orbits.  Orbit.ValidateProjection [Count]"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&ValidateProjection)
+    );
+
+    FAutoConsoleCommand BenchmarkCullingCommand(
+        TEXT("Orbit.BenchmarkCulling"),
+        TEXT("Frustum culling of orbits for a zoomed in view: fraction culled, and time against projecting everything.  Orbit.BenchmarkCulling [Count] [FovDegrees]"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkCulling)
+    );
+
+    FAutoConsoleCommand BenchmarkProjectionCommand(
+        TEXT("Orbit.BenchmarkProjection"),
+        TEXT("Orbits per second through the per-ellipse and batched conic projections"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkProjection)
+    );
+}
+
+#endif
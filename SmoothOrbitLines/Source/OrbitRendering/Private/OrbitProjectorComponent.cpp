@@ -6,28 +6,143 @@
 #include "Components/ActorComponent.h"
 #include "Camera/CameraComponent.h"
 #include "GameFramework/GameStateBase.h"
+#include "Engine/Engine.h"
+#include "Engine/GameViewportClient.h"
 #include "Conics/ProjectEllipseToPlane.h"
+#include "Conics/ProjectEllipseToPlaneClosedForm.h"
+#include "Conics/ProjectEllipsesToPlane.h"
+#include "Conics/ProjectConicMatrixToPlane.h"
+#include "Conics/ProjectEllipseToPlaneOrthographic.h"
 #include "Conics/ProjectionAngleToTrueAnomaly.h"
 #include "Conics/ClipEllipseToFrustum.h"
 #include "Conics/ClipHyperbolaToFrustum.h"
+#include "Conics/ClipConicsToFrustum.h"
+#include "Conics/ClipConicToDepth.h"
+#include "Conics/CullEllipsesToFrustum.h"
+#include "Conics/ConicPlaneFamilies.h"
+#include "Conics/GuardBandFrustum.h"
+#include "Conics/CachedConicProjection.h"
+#include "Conics/OccludeConicBySpheres.h"
+#include "Conics/FitConicToArc.h"
 #include "GTE/Mathematics/IntrRay3Plane3.h"
 #include "OrbitSystemStateComponent.h"
 #include "OrbitViewerControllerComponent.h"
+#include "Async/ParallelFor.h"
+#include <array>
 
 
 // Forward decl's.  No need to dirty the public header with the input/output types.
-void GetEllipticalProjectionTrueAnomalies(
+EllipseProjectionView<double> GetEllipseProjectionView(
+    const FrustumParameters<double>& frustum,
+    const FFramePosition& eyePointPosition,
+    const FFrameVector& eyeDirection,
+    const FFrameVector& eyeUp
+);
+
+void ClipProjection(
+    const FrustumParameters<double>& frustum,
+    bool bOrthographic,
     const EllipseProjectionInputs<double>& projInputs,
     const EllipseProjectionOutputs<double>& projOutputs,
+    ProjectionType& projectionType,
+    FFramePosition& projectedCenterPosition,
+    FFrameVector& projectedAxis1Vector,
+    FFrameVector& projectedAxis2Vector,
     std::vector<ConicSegment<double>>& segmentList,
     std::vector<ConicSegment<double>>& advancementList,
+    double& Advancement,
+    const ConicClip<double>* clip = nullptr,
+    const ClipPolygon<double>* region = nullptr,
+    double nearDepth = 0.,
+    double farDepth = 0.,
+    const std::vector<OccludingSphere<double>>* occluders = nullptr
+);
+
+double GetTestTheta(const FOrbitItem& orbit);
+
+EllipseProjectionInputs<double> GetOrbitProjectionInputs(const EllipseProjectionView<double>& view, const FOrbitItem& orbit);
+
+void LocateBodyOnProjection(const EllipseProjectionInputs<double>& projInputs, EllipseProjectionOutputs<double>& projOutputs);
+
+bool IsCachedProjectionValid(const FOrbitProjectionCacheEntry& Entry, const FOrbitProjectionView& View, const FOrbitItem& orbit, double ToleranceRadians, double GuardBandRadians);
+
+void GetOrbitsToProject(const FOrbitProjectionView& View, const TArray<FOrbitItem>& Orbits, const FOrbitBoundingVolumes* Bounds, std::vector<int>& Indices);
+
+void SetOrbitEllipse(const FOrbitItem& orbit, EllipseBatch<double>& ellipses, int i);
+
+void ProjectOrbitLanes(const EllipseProjectionView<double>& view, const TArray<FOrbitItem>& Orbits, const std::vector<int>& Indices, const EllipseBatch<double>& ellipses, const FOrbitPlaneFamilies* Families, ConicProjectionBatch<double>& projections);
+
+void ProjectOrbitEllipses(const FOrbitProjectionView& View, const TArray<FOrbitItem>& Orbits, const std::vector<int>& Indices, const EllipseBatch<double>& ellipses, const FOrbitPlaneFamilies* Families, TArray<FConicSection>& Conics);
+
+bool PackConic(
+    const FOrbitProjectionView& View,
+    const FOrbitItem& orbit,
+    ProjectionType projectionType,
+    const FFramePosition& ProjectedCenter,
+    const FFrameVector& ProjectedAxis1,
+    const FFrameVector& ProjectedAxis2,
+    const std::vector<ConicSegment<double>>& clipSegments,
+    const std::vector<ConicSegment<double>>& clipTrueAnomalies,
     double Advancement,
-    double TrueAnomaly
+    FConicSection& conic
 );
 
-void GetHyperbolicProjectionTrueAnomalies(
+bool ClipProjectionSegments(
+    const FrustumParameters<double>& frustum,
+    bool bOrthographic,
+    const EllipseProjectionInputs<double>& projInputs,
+    const EllipseProjectionOutputs<double>& projOutputs,
+    std::vector<ConicSegment<double>>& segmentList,
+    std::vector<double>& segmentTrueAnomalies,
+    const ConicClip<double>* clip = nullptr,
+    const ClipPolygon<double>* region = nullptr,
+    double nearDepth = 0.,
+    double farDepth = 0.,
+    const std::vector<OccludingSphere<double>>* occluders = nullptr
+);
+
+bool OccludeProjectionSegments(
+    const FrustumParameters<double>& frustum,
+    bool bOrthographic,
+    const std::vector<OccludingSphere<double>>& occluders,
+    const EllipseProjectionInputs<double>& projInputs,
+    const EllipseProjectionOutputs<double>& projOutputs,
+    std::vector<ConicSegment<double>>& segmentList,
+    bool& visible
+);
+
+void PlaceBodyOnProjection(
+    const EllipseProjectionInputs<double>& projInputs,
+    const EllipseProjectionOutputs<double>& projOutputs,
+    bool visible,
+    const std::vector<double>& segmentTrueAnomalies,
+    ProjectionType& projectionType,
+    FFramePosition& projectedCenterPosition,
+    FFrameVector& projectedAxis1Vector,
+    FFrameVector& projectedAxis2Vector,
+    std::vector<ConicSegment<double>>& segmentList,
+    std::vector<ConicSegment<double>>& advancementList,
+    double& Advancement
+);
+
+void GetSegmentTrueAnomalies(
+    bool bOrthographic,
     const EllipseProjectionInputs<double>& projInputs,
     const EllipseProjectionOutputs<double>& projOutputs,
+    const std::vector<ConicSegment<double>>& segmentList,
+    std::vector<double>& segmentTrueAnomalies
+);
+
+void GetEllipticalProjectionTrueAnomalies(
+    const std::vector<double>& segmentTrueAnomalies,
+    std::vector<ConicSegment<double>>& segmentList,
+    std::vector<ConicSegment<double>>& advancementList,
+    double Advancement,
+    double TrueAnomaly
+);
+
+void GetHyperbolicProjectionTrueAnomalies(
+    const std::vector<double>& segmentTrueAnomalies,
     std::vector<ConicSegment<double>>& segmentList,
     std::vector<ConicSegment<double>>& advancementList,
     double Advancement,
@@ -35,6 +150,49 @@ void GetHyperbolicProjectionTrueAnomalies(
 );
 
 
+// The orbits' shapes, for telling whether something built for them is stale
+struct FOrbitShapes
+{
+    void Set(const TArray<FOrbitItem>& Orbits);
+    bool Matches(const TArray<FOrbitItem>& Orbits) const;
+
+    TArray<FFramePosition> Centers;
+    TArray<FFrameVector> Axes1;
+    TArray<FFrameVector> Axes2;
+};
+
+
+// Each orbit's ellipse in a box, and a hierarchy over the boxes
+struct FOrbitBoundingVolumes
+{
+    FOrbitBoundingVolumes(const TArray<FOrbitItem>& Orbits);
+
+    // Was it built for these orbits?
+    bool Matches(const TArray<FOrbitItem>& Orbits) const { return Shapes.Matches(Orbits); }
+
+    EllipseBoundingVolumes<double> Volumes;
+
+    // The shapes it was built for
+    FOrbitShapes Shapes;
+};
+
+
+// Orbits that share a plane (and a focus), and each one's dual conic in its
+// family's plane.  Orbits in no family project on their own.  (See
+// ConicPlaneFamilies.)
+struct FOrbitPlaneFamilies
+{
+    FOrbitPlaneFamilies(const TArray<FOrbitItem>& Orbits, double CoplanarTolerance);
+
+    // Was it built for these orbits, and tolerance?
+    bool Matches(const TArray<FOrbitItem>& Orbits, double CoplanarTolerance) const { return Planes.CoplanarTolerance == CoplanarTolerance && Shapes.Matches(Orbits); }
+
+    ConicPlaneFamilies<double> Planes;
+
+    FOrbitShapes Shapes;
+};
+
+
 // Sets default values for this component's properties
 UOrbitProjectorComponent::UOrbitProjectorComponent()
 {
@@ -61,102 +219,972 @@ void UOrbitProjectorComponent::BeginPlay()
         if (!OrbitViewerController) OrbitViewerController = Cast<UOrbitViewerControllerComponent>(component);
     }
 
-
-    for (auto component : GetOwner()->GetComponents())
+
+    for (auto component : GetOwner()->GetComponents())
+    {
+        if (!OrbitCamera) OrbitCamera = Cast<UCameraComponent>(component);
+        if (!OrbitSystemState) OrbitSystemState = Cast<UOrbitSystemStateComponent>(component);
+    }
+
+
+    PrimaryComponentTick.TickGroup = ETickingGroup::TG_LastDemotable;
+    if (!OrbitCamera || !OrbitSystemState)
+    {
+        PrimaryComponentTick.bCanEverTick = false;
+    }
+    else if (bAsyncProjection)
+    {
+        // Launch as soon as the camera and et are final for the frame, so
+        // the projection overlaps the rest of the frame's game thread work.
+        PrimaryComponentTick.TickGroup = ETickingGroup::TG_PrePhysics;
+        PrimaryComponentTick.AddPrerequisite(GetOwner(), GetOwner()->PrimaryActorTick);
+        PrimaryComponentTick.AddPrerequisite(OrbitSystemState, OrbitSystemState->PrimaryComponentTick);
+    }
+}
+
+
+void UOrbitProjectorComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    JoinProjection();
+
+    Super::EndPlay(EndPlayReason);
+}
+
+
+// Called every frame
+void UOrbitProjectorComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+    TArray<UOrbitingBodyComponent*> ActiveBodies;
+    OrbitViewerController->GetActiveBodies(ActiveBodies);
+
+    OrbitArray.Empty();
+    for (auto ActiveBody : ActiveBodies)
+    {
+        if (ActiveBody->IsInertial)
+            continue;
+
+        FOrbitItem orbit;
+        if (CollectOrbit(ActiveBody, orbit))
+        {
+            OrbitArray.Add(orbit);
+        }
+    }
+
+    if (!bFrustumCulling)
+    {
+        OrbitBounds.Reset();
+    }
+    else if (!OrbitBounds || !OrbitBounds->Matches(OrbitArray))
+    {
+        QUICK_SCOPE_CYCLE_COUNTER(STAT_OrbitProjector_BuildOrbitBounds);
+        OrbitBounds = MakeShared<const FOrbitBoundingVolumes, ESPMode::ThreadSafe>(OrbitArray);
+    }
+
+    if (!bCoplanarBatching)
+    {
+        OrbitFamilies.Reset();
+    }
+    else if (!OrbitFamilies || !OrbitFamilies->Matches(OrbitArray, CoplanarTolerance))
+    {
+        QUICK_SCOPE_CYCLE_COUNTER(STAT_OrbitProjector_BuildOrbitFamilies);
+        OrbitFamilies = MakeShared<const FOrbitPlaneFamilies, ESPMode::ThreadSafe>(OrbitArray, CoplanarTolerance);
+    }
+
+    if (bAsyncProjection)
+    {
+        LaunchProjection();
+    }
+}
+
+
+void UOrbitProjectorComponent::GetProjectionView(FOrbitProjectionView& View)
+{
+    double fieldOfView = (double)OrbitCamera->FieldOfView / 180 * pi<double>;
+    double aspectRatio = (double)OrbitCamera->AspectRatio;
+    double distance;
+    OrbitViewerController->GetFrameDistance(ProjectionPlaneDistance, distance);
+
+    View.bOrthographic = OrbitCamera->ProjectionMode == ECameraProjectionMode::Orthographic;
+    if (View.bOrthographic)
+    {
+        double halfWidth;
+        OrbitViewerController->GetFrameDistance(0.5 * OrbitCamera->OrthoWidth, halfWidth);
+        fieldOfView = 2. * atan(halfWidth / distance);
+    }
+
+    View.Frustum = FrustumParameters<double>(distance, fieldOfView, aspectRatio);
+
+    OrbitViewerController->GetFramePosition(OrbitCamera->GetComponentLocation(), View.EyePoint);
+    OrbitViewerController->GetFrameVector(OrbitCamera->GetForwardVector(), View.EyeDirection);
+    OrbitViewerController->GetFrameVector(OrbitCamera->GetUpVector(), View.EyeUp);
+    View.ProjectionOffset = FVector2D::ZeroVector;
+
+    OrbitViewerController->GetFramePosition(FVector::ZeroVector, View.SceneOrigin);
+    View.SceneScale = OrbitViewerController->SceneScale;
+
+    if (GEngine && GEngine->GameViewport)
+    {
+        FVector2D ViewportSize;
+        GEngine->GameViewport->GetViewportSize(ViewportSize);
+        View.ViewportWidth = FMath::Max(ViewportSize.X, 1.);
+    }
+
+    View.NearDepth = View.FarDepth = 0.;
+    if (NearClipDistance > 0.f)
+    {
+        OrbitViewerController->GetFrameDistance(NearClipDistance, View.NearDepth);
+    }
+    if (FarClipDistance > 0.f)
+    {
+        OrbitViewerController->GetFrameDistance(FarClipDistance, View.FarDepth);
+    }
+
+    View.ClipRegion = ClipRegion;
+
+    // The bodies, where the scene has them
+    View.Occluders.clear();
+    if (bBodyOcclusion)
+    {
+        TArray<UOrbitingBodyComponent*> Bodies;
+        OrbitViewerController->GetActiveBodies(Bodies);
+
+        for (const UOrbitingBodyComponent* Body : Bodies)
+        {
+            if (Body->OcclusionRadius <= 0. || !Body->GetOwner()) continue;
+
+            FFramePosition Center;
+            OrbitViewerController->GetFramePosition(Body->GetOwner()->GetActorLocation(), Center);
+            View.Occluders.push_back(OccludingSphere<double>{ (Vector3<double>)Center, Body->OcclusionRadius });
+        }
+    }
+}
+
+
+FVector FOrbitProjectionView::ToScenePosition(const FFramePosition& FramePosition) const
+{
+    return SceneScale * UOrbitViewerControllerComponent::Swizzle(FramePosition - SceneOrigin);
+}
+
+
+FVector FOrbitProjectionView::ToSceneVector(const FFrameVector& FrameVector) const
+{
+    return SceneScale * UOrbitViewerControllerComponent::Swizzle(FrameVector);
+}
+
+
+FFramePosition FOrbitProjectionView::ToFramePosition(const FVector& ScenePosition) const
+{
+    return SceneOrigin + FFrameVector((1. / SceneScale) * UOrbitViewerControllerComponent::Swizzle(ScenePosition));
+}
+
+
+FFrameVector FOrbitProjectionView::ToFrameVector(const FVector& SceneVector) const
+{
+    return FFrameVector((1. / SceneScale) * UOrbitViewerControllerComponent::Swizzle(SceneVector));
+}
+
+
+double FOrbitProjectionView::ToPixels(double PlaneLength) const
+{
+    // Horizontal fov, as the frustum's
+    return PlaneLength * 0.5 * ViewportWidth / (Frustum.z * tan(0.5 * Frustum.fov));
+}
+
+
+bool FOrbitProjectionView::GetClipPolygon(ClipPolygon<double>& Polygon) const
+{
+    // Viewport coordinates are relative to the rectangle, which is why they
+    // (not the plane's) are kept: a late latched view can change its fov.
+    const ClipRectangle<double> rectangle(Frustum);
+    const double cx = ProjectionOffset.X * rectangle.maxX;
+    const double cy = ProjectionOffset.Y * rectangle.maxY;
+
+    if (ClipRegion.Num() < 3 || ClipRegion.Num() > ClipPolygon<double>::MaxVertices)
+    {
+        if (ProjectionOffset.IsZero())
+        {
+            return false;
+        }
+
+        Polygon = ClipPolygon<double>(cx - rectangle.maxX, cy - rectangle.maxY, cx + rectangle.maxX, cy + rectangle.maxY);
+        return true;
+    }
+
+    Vector<2, double> Vertices[ClipPolygon<double>::MaxVertices];
+    for (int i = 0; i < ClipRegion.Num(); ++i)
+    {
+        const double x = FMath::Clamp(ClipRegion[i].X, 0., 1.);
+        const double y = FMath::Clamp(ClipRegion[i].Y, 0., 1.);
+        Vertices[i] = Vector<2, double>{ cx + (2. * x - 1.) * rectangle.maxX, cy + (1. - 2. * y) * rectangle.maxY };
+    }
+
+    return Polygon.SetVertices(Vertices, ClipRegion.Num());
+}
+
+
+FrustumParameters<double> FOrbitProjectionView::GetBoundingFrustum() const
+{
+    if (ProjectionOffset.IsZero())
+    {
+        return Frustum;
+    }
+
+    // Wide and tall enough for the rectangle's far side, either way
+    const double ScaleX = 1. + FMath::Abs(ProjectionOffset.X);
+    const double ScaleY = 1. + FMath::Abs(ProjectionOffset.Y);
+
+    FrustumParameters<double> Bounds = Frustum;
+    Bounds.fov = 2. * atan(ScaleX * tan(0.5 * Frustum.fov));
+    Bounds.aspectRatio = Frustum.aspectRatio * ScaleX / ScaleY;
+    return Bounds;
+}
+
+
+void UOrbitProjectorComponent::LaunchProjection()
+{
+    // Never have two in flight, they'd share the back buffer
+    JoinProjection();
+
+    FOrbitProjectionView View;
+    GetProjectionView(View);
+
+    // (Only the conics are the task's to write)
+    FConicBuffer& Back = ConicBuffers[1 - FrontBuffer];
+    Back.CameraLocation = OrbitCamera->GetComponentLocation();
+    Back.CameraDirection = OrbitCamera->GetForwardVector();
+    Back.SampleCycles = FPlatformTime::Cycles64();
+    TArray<FConicSection>* BackBuffer = &Back.Conics;
+
+    // Captured now, the task doesn't read the UPROPERTYs
+    const bool bCache = bProjectionCache;
+    const double ToleranceRadians = GetProjectionCacheToleranceRadians(View);
+    const double GuardBand = ProjectionCacheGuardBand;
+
+    Projection = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, View, Orbits = OrbitArray, Bounds = OrbitBounds, Families = OrbitFamilies, BackBuffer, bCache, ToleranceRadians, GuardBand]()
+        {
+            QUICK_SCOPE_CYCLE_COUNTER(STAT_OrbitProjector_AsyncProjection);
+
+            if (bCache)
+            {
+                TransformOrbitsCached(View, ToleranceRadians, GuardBand, Orbits, *BackBuffer, Bounds.Get(), Families.Get());
+            }
+            else
+            {
+                TransformOrbits(View, Orbits, *BackBuffer, Bounds.Get(), Families.Get());
+            }
+        });
+}
+
+
+void UOrbitProjectorComponent::JoinProjection()
+{
+    if (Projection.IsValid())
+    {
+        QUICK_SCOPE_CYCLE_COUNTER(STAT_OrbitProjector_JoinProjection);
+
+        Projection.Wait();
+        Projection = {};
+        FrontBuffer = 1 - FrontBuffer;
+
+        ProjectionCacheHits += PendingCacheHits;
+        ProjectionCacheMisses += PendingCacheMisses;
+        PendingCacheHits = PendingCacheMisses = 0;
+    }
+}
+
+
+bool UOrbitProjectorComponent::CollectOrbit(UOrbitingBodyComponent* ActiveBody, FOrbitItem& orbit)
+{
+    bool result = !ActiveBody->IsInertial;
+
+    if (result)
+    {
+
+        ES_ResultCode ResultCode;
+        FOscullatingOrbitGeometry OscillatingGeometry;
+        UOrbitalMechanics::ComputeGeometry(ActiveBody->ConicElements, OscillatingGeometry, ResultCode);
+
+        result &= ResultCode == ES_ResultCode::Success;
+        if (result)
+        {
+            orbit.ConicType = ES_ConicType::Ellipse;
+            orbit.Color = ActiveBody->LineColor;
+            orbit.Body = ActiveBody;
+
+            orbit.Center = FFramePosition(-OscillatingGeometry.ae * (Vector3<double>)OscillatingGeometry.p_hat);
+            orbit.Axis1 = FFrameVector(OscillatingGeometry.a * (Vector3<double>)OscillatingGeometry.p_hat);
+            orbit.Axis2 = FFrameVector(OscillatingGeometry.b * (Vector3<double>)OscillatingGeometry.q_hat);
+
+            // Assumes the orbit is at the solar system barycenter's origin...
+            // Child orbits would break here.
+            orbit.Focus = FFramePosition();
+            orbit.Normal = OscillatingGeometry.w_hat;
+
+            // Only depends on the orbit, so it's done once here rather than per view
+            const double e = OscillatingGeometry.ae / OscillatingGeometry.a;
+            const double p = OscillatingGeometry.b * OscillatingGeometry.b / OscillatingGeometry.a;
+            orbit.PlaneConic = PerifocalDualConic(e, p);
+
+            // Fixed step simulations have already propagated the state...
+            if (!OrbitSystemState->GetInterpolatedState(ActiveBody, orbit.FrameState))
+            {
+                UOrbitalMechanics::ComputeState(ActiveBody->ConicElements, OrbitSystemState->et, orbit.FrameState, ResultCode);
+            }
+        }
+    }
+
+    return result;
+}
+
+// Project conic based on the captured camera view...
+// (Static and only touches its arguments, so it's safe to call from any thread.)
+bool UOrbitProjectorComponent::TransformOrbit(const FOrbitProjectionView& View, const FOrbitItem& orbit, FConicSection& conic)
+{
+    const EllipseProjectionView<double> view = GetEllipseProjectionView(View.Frustum, View.EyePoint, View.EyeDirection, View.EyeUp);
+
+    EllipseProjectionInputs<double> projInputs = GetOrbitProjectionInputs(view, orbit);
+    EllipseProjectionOutputs<double> projOutputs;
+
+    // ------------------------------------------------------------------------
+    // Project the orbit to the plane, one congruence of its conic matrix...
+    // (or, orthographic, just its affine image.)
+    // ------------------------------------------------------------------------
+    if (View.bOrthographic)
+    {
+        ProjectEllipseToPlaneOrthographic(projInputs, projOutputs);
+    }
+    else
+    {
+        ProjectConicMatrixToPlane(view, (Vector3<double>)orbit.Focus, projInputs.Ue, projInputs.Ve, orbit.PlaneConic, projOutputs.projection);
+        LocateBodyOnProjection(projInputs, projOutputs);
+    }
+
+    // Outputs...
+    ProjectionType projectionType;
+    FFramePosition ProjectedCenter;
+    FFrameVector ProjectedAxis1;
+    FFrameVector ProjectedAxis2;
+    std::vector<ConicSegment<double>> clipSegments;
+    std::vector<ConicSegment<double>> clipTrueAnomalies;
+    double Advancement = 0;
+
+    ClipPolygon<double> Region;
+    const bool bRegion = View.GetClipPolygon(Region);
+
+    ClipProjection(View.GetBoundingFrustum(), View.bOrthographic, projInputs, projOutputs, projectionType, ProjectedCenter, ProjectedAxis1, ProjectedAxis2, clipSegments, clipTrueAnomalies, Advancement, nullptr, bRegion ? &Region : nullptr, View.NearDepth, View.FarDepth, &View.Occluders);
+
+    return PackConic(View, orbit, projectionType, ProjectedCenter, ProjectedAxis1, ProjectedAxis2, clipSegments, clipTrueAnomalies, Advancement, conic);
+}
+
+
+// Same as TransformOrbit, for all the orbits at once.  The projections are
+// batched (one view, structure-of-arrays ellipses), the clipping is parallel.
+void UOrbitProjectorComponent::TransformOrbits(const FOrbitProjectionView& View, const TArray<FOrbitItem>& Orbits, TArray<FConicSection>& Conics, const FOrbitBoundingVolumes* Bounds, const FOrbitPlaneFamilies* Families)
+{
+    QUICK_SCOPE_CYCLE_COUNTER(STAT_OrbitProjector_TransformOrbits);
+
+    std::vector<int> Indices;
+    GetOrbitsToProject(View, Orbits, Bounds, Indices);
+    const int Count = (int)Indices.size();
+
+    EllipseBatch<double> ellipses;
+    ellipses.resize(Count);
+
+    for (int i = 0; i < Count; ++i)
+    {
+        SetOrbitEllipse(Orbits[Indices[i]], ellipses, i);
+    }
+
+    ProjectOrbitEllipses(View, Orbits, Indices, ellipses, Families, Conics);
+}
+
+
+// TransformOrbits for several views (split screen, stereo.)  What only
+// depends on the orbits is done once, for every orbit any of the views can
+// see, and the rest is done for each view in parallel.
+void UOrbitProjectorComponent::TransformOrbitsForViews(const TArray<FOrbitProjectionView>& Views, const TArray<FOrbitItem>& Orbits, TArray<TArray<FConicSection>>& Conics, const FOrbitBoundingVolumes* Bounds, const FOrbitPlaneFamilies* Families)
+{
+    QUICK_SCOPE_CYCLE_COUNTER(STAT_OrbitProjector_TransformOrbitsForViews);
+
+    Conics.SetNum(Views.Num());
+
+    if (Views.Num() == 1)
+    {
+        TransformOrbits(Views[0], Orbits, Conics[0], Bounds, Families);
+        return;
+    }
+
+    std::vector<std::vector<int>> Indices(Views.Num());
+    ParallelFor(Views.Num(), [&](int32 v)
+        {
+            GetOrbitsToProject(Views[v], Orbits, Bounds, Indices[v]);
+        });
+
+    // The orbits' own part, once each
+    std::vector<char> bSeen(Orbits.Num(), 0);
+    for (const std::vector<int>& ViewIndices : Indices)
+    {
+        for (int i : ViewIndices) bSeen[i] = 1;
+    }
+
+    EllipseBatch<double> allEllipses;
+    allEllipses.resize(Orbits.Num());
+
+    ParallelFor(Orbits.Num(), [&](int32 i)
+        {
+            if (bSeen[i]) SetOrbitEllipse(Orbits[i], allEllipses, i);
+        });
+
+    // Each view's part
+    ParallelFor(Views.Num(), [&](int32 v)
+        {
+            EllipseBatch<double> ellipses;
+            ellipses.gather(allEllipses, Indices[v]);
+
+            ProjectOrbitEllipses(Views[v], Orbits, Indices[v], ellipses, Families, Conics[v]);
+        });
+}
+
+
+// Everything about an orbit's ellipse that doesn't depend on the view
+void SetOrbitEllipse(const FOrbitItem& orbit, EllipseBatch<double>& ellipses, int i)
+{
+    Vector3<double> Ue = (Vector3<double>)orbit.Axis1;
+    Vector3<double> Ve = (Vector3<double>)orbit.Axis2;
+    double A = Normalize(Ue);
+    double B = Normalize(Ve);
+
+    ellipses.set(i, orbit.Center, Ue, Ve, A, B, GetTestTheta(orbit));
+}
+
+
+// The perspective image conics of Orbits[Indices[lane]] (whose ellipse is
+// ellipses' lane'th) for view, with the bodies located on them.  With
+// Families (built for Orbits), coplanar orbits share their plane's setup.
+void ProjectOrbitLanes(const EllipseProjectionView<double>& view, const TArray<FOrbitItem>& Orbits, const std::vector<int>& Indices, const EllipseBatch<double>& ellipses, const FOrbitPlaneFamilies* Families, ConicProjectionBatch<double>& projections)
+{
+    if (Families && Families->Planes.size() == (size_t)Orbits.Num())
+    {
+        projections.resize(Indices.size());
+
+        std::vector<int> Others;
+        Families->Planes.project(view, Indices, projections, Others);
+        ProjectEllipsesToPlaneLanes(view, ellipses, Others, projections);
+
+        LocateBodiesOnProjections(view, ellipses, projections);
+    }
+    else
+    {
+        ProjectEllipsesToPlane(view, ellipses, projections);
+    }
+}
+
+
+// Project, clip and pack Orbits[Indices[i]] (whose ellipse is ellipses' i'th)
+// for View, into Conics[i].  Families, if any, were built for Orbits.
+void ProjectOrbitEllipses(const FOrbitProjectionView& View, const TArray<FOrbitItem>& Orbits, const std::vector<int>& Indices, const EllipseBatch<double>& ellipses, const FOrbitPlaneFamilies* Families, TArray<FConicSection>& Conics)
+{
+    const EllipseProjectionView<double> view = GetEllipseProjectionView(View.Frustum, View.EyePoint, View.EyeDirection, View.EyeUp);
+    const int Count = (int)Indices.size();
+
+    // Orthographic projections are done one by one below, there's next to
+    // nothing to them.
+    ConicProjectionBatch<double> projections;
+    if (!View.bOrthographic)
+    {
+        ProjectOrbitLanes(view, Orbits, Indices, ellipses, Families, projections);
+    }
+
+    // Clipped in batches, against the one rectangle (or region)
+    ClipPolygon<double> Region;
+    const bool bRegion = View.GetClipPolygon(Region);
+
+    std::vector<ConicClip<double>> clips;
+    if (!View.bOrthographic)
+    {
+        const ClipRectangle<double> rectangle(View.Frustum);
+        const int BatchSize = 256;
+
+        clips.resize(Count);
+        ParallelFor((Count + BatchSize - 1) / BatchSize, [&](int32 Batch)
+            {
+                if (bRegion)
+                {
+                    ClipConicsToFrustum(Region, projections, Batch * BatchSize, FMath::Min(Count, (Batch + 1) * BatchSize), clips);
+                }
+                else
+                {
+                    ClipConicsToFrustum(rectangle, projections, Batch * BatchSize, FMath::Min(Count, (Batch + 1) * BatchSize), clips);
+                }
+            });
+    }
+
+    // (Off axis, Region is the rectangle.  This is for what only takes a
+    // centered one, the occluders' early out.)
+    const FrustumParameters<double> BoundingFrustum = View.GetBoundingFrustum();
+
+    Conics.SetNum(Count);
+
+    ParallelFor(Count, [&](int32 i)
+        {
+            EllipseProjectionInputs<double> projInputs = ellipses.getInputs(view, i);
+            EllipseProjectionOutputs<double> projOutputs;
+            if (View.bOrthographic)
+            {
+                ProjectEllipseToPlaneOrthographic(projInputs, projOutputs);
+            }
+            else
+            {
+                projections.getOutputs(i, projOutputs);
+            }
+
+            ProjectionType projectionType;
+            FFramePosition ProjectedCenter;
+            FFrameVector ProjectedAxis1;
+            FFrameVector ProjectedAxis2;
+            std::vector<ConicSegment<double>> clipSegments;
+            std::vector<ConicSegment<double>> clipTrueAnomalies;
+            double Advancement = 0;
+
+            ClipProjection(BoundingFrustum, View.bOrthographic, projInputs, projOutputs, projectionType, ProjectedCenter, ProjectedAxis1, ProjectedAxis2, clipSegments, clipTrueAnomalies, Advancement, View.bOrthographic ? nullptr : &clips[i], bRegion ? &Region : nullptr, View.NearDepth, View.FarDepth, &View.Occluders);
+
+            Conics[i] = FConicSection();
+            PackConic(View, Orbits[Indices[i]], projectionType, ProjectedCenter, ProjectedAxis1, ProjectedAxis2, clipSegments, clipTrueAnomalies, Advancement, Conics[i]);
+        });
+}
+
+
+// ----------------------------------------------------------------------------
+// Frustum culling
+// Projecting is most of the work, and most orbits aren't in view when the
+// camera's zoomed in.  So, each orbit's ellipse is boxed, and the boxes are
+// culled against the view frustum in 3D, through a bounding volume hierarchy.
+// Culling is conservative: anything that might be visible is projected and
+// clipped as before.
+// ----------------------------------------------------------------------------
+FOrbitBoundingVolumes::FOrbitBoundingVolumes(const TArray<FOrbitItem>& Orbits)
+{
+    std::vector<OrientedBox3<double>> Boxes(Orbits.Num());
+
+    Shapes.Set(Orbits);
+
+    for (int i = 0; i < Orbits.Num(); ++i)
+    {
+        const FOrbitItem& orbit = Orbits[i];
+
+        Vector3<double> Ue = (Vector3<double>)orbit.Axis1;
+        Vector3<double> Ve = (Vector3<double>)orbit.Axis2;
+        double A = Normalize(Ue);
+        double B = Normalize(Ve);
+
+        Boxes[i] = GetEllipseBounds((Vector3<double>)orbit.Center, Ue, Ve, A, B);
+    }
+
+    Volumes.Build(std::move(Boxes));
+}
+
+
+void FOrbitShapes::Set(const TArray<FOrbitItem>& Orbits)
+{
+    Centers.SetNum(Orbits.Num());
+    Axes1.SetNum(Orbits.Num());
+    Axes2.SetNum(Orbits.Num());
+
+    for (int i = 0; i < Orbits.Num(); ++i)
+    {
+        Centers[i] = Orbits[i].Center;
+        Axes1[i] = Orbits[i].Axis1;
+        Axes2[i] = Orbits[i].Axis2;
+    }
+}
+
+
+bool FOrbitShapes::Matches(const TArray<FOrbitItem>& Orbits) const
+{
+    if (Orbits.Num() != Centers.Num())
+    {
+        return false;
+    }
+
+    for (int i = 0; i < Orbits.Num(); ++i)
+    {
+        if ((Vector3<double>)Orbits[i].Center != (Vector3<double>)Centers[i]
+            || (Vector3<double>)Orbits[i].Axis1 != (Vector3<double>)Axes1[i]
+            || (Vector3<double>)Orbits[i].Axis2 != (Vector3<double>)Axes2[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+// Which of Orbits to project: all of them, or with Bounds just the ones that
+// might be visible.  In order.
+void GetOrbitsToProject(const FOrbitProjectionView& View, const TArray<FOrbitItem>& Orbits, const FOrbitBoundingVolumes* Bounds, std::vector<int>& Indices)
+{
+    // Bounds that were built for some other set of orbits are no use
+    if (!Bounds || (int)Bounds->Volumes.size() != Orbits.Num())
+    {
+        Indices.resize(Orbits.Num());
+        for (int i = 0; i < Orbits.Num(); ++i)
+        {
+            Indices[i] = i;
+        }
+        return;
+    }
+
+    QUICK_SCOPE_CYCLE_COUNTER(STAT_OrbitProjector_CullOrbits);
+
+    const EllipseProjectionView<double> view = GetEllipseProjectionView(View.Frustum, View.EyePoint, View.EyeDirection, View.EyeUp);
+    const double far = Bounds->Volumes.GetFarDistance(view.E);
+    const Frustum3<double> frustum = View.bOrthographic
+        ? GetOrthographicViewFrustum(view.E, view.Np, view.Up, view.Vp, View.GetBoundingFrustum(), far)
+        : GetViewFrustum(view.E, view.Np, view.Up, view.Vp, View.GetBoundingFrustum(), far);
+
+    // Subtrees in parallel (32 of them, give or take)
+    std::vector<int> Subtrees;
+    Bounds->Volumes.GetSubtrees(5, Subtrees);
+
+    std::vector<std::vector<int>> Visible(Subtrees.size());
+    ParallelFor((int32)Subtrees.size(), [&](int32 i)
+        {
+            Bounds->Volumes.CullSubtree(frustum, Subtrees[i], Visible[i]);
+        });
+
+    Indices.clear();
+    for (const std::vector<int>& SubtreeVisible : Visible)
+    {
+        Indices.insert(Indices.end(), SubtreeVisible.begin(), SubtreeVisible.end());
+    }
+    std::sort(Indices.begin(), Indices.end());
+}
+
+
+// ----------------------------------------------------------------------------
+// Coplanar families
+// Moons in their planet's equatorial plane, ring particles and the like all
+// share a plane (and a focus), see ConicPlaneFamilies.
+// ----------------------------------------------------------------------------
+FOrbitPlaneFamilies::FOrbitPlaneFamilies(const TArray<FOrbitItem>& Orbits, double CoplanarTolerance)
+{
+    Shapes.Set(Orbits);
+
+    std::vector<ConicPlaneMember<double>> Members(Orbits.Num());
+    for (int i = 0; i < Orbits.Num(); ++i)
+    {
+        const FOrbitItem& orbit = Orbits[i];
+        ConicPlaneMember<double>& Member = Members[i];
+
+        Member.O = (Vector3<double>)orbit.Focus;
+        Member.N = (Vector3<double>)orbit.Normal;
+        Member.U = (Vector3<double>)orbit.Axis1;
+        Member.V = (Vector3<double>)orbit.Axis2;
+        Normalize(Member.U);
+        Normalize(Member.V);
+        Member.DualConic = orbit.PlaneConic;
+    }
+
+    Planes.build(Members, CoplanarTolerance);
+}
+
+
+// ----------------------------------------------------------------------------
+// Projection cache
+// An orbit's shape doesn't change from frame to frame, only the camera and
+// where the body is do.  So, while the camera hasn't moved (much), each
+// orbit's projection and clipping is reused and only the body is relocated.
+// The clipping's to a guard band around the frustum, so turning the camera
+// doesn't invalidate it until the band's edges come into view; then it's
+// clipped again, to a band around the new view.
+// The misses are projected together, through the same lanes (and coplanar
+// families) as TransformOrbits.
+// (The renderer's late latched projection doesn't go through the cache, it
+// projects for the render thread's view every frame, by design.)
+// ----------------------------------------------------------------------------
+void UOrbitProjectorComponent::TransformOrbitsCached(const FOrbitProjectionView& View, double ToleranceRadians, double GuardBand, const TArray<FOrbitItem>& Orbits, TArray<FConicSection>& Conics, const FOrbitBoundingVolumes* Bounds, const FOrbitPlaneFamilies* Families)
+{
+    QUICK_SCOPE_CYCLE_COUNTER(STAT_OrbitProjector_TransformOrbitsCached);
+
+    // Orthographic projections cost less than checking the cache would
+    if (View.bOrthographic)
+    {
+        TransformOrbits(View, Orbits, Conics, Bounds, Families);
+        return;
+    }
+
+    // Carry over the entries for this frame's orbits, and drop the rest.
+    // (Culled orbits keep theirs, for when they come back into view.)
+    // (All the adding is done before taking any pointers.)
+    TMap<const UOrbitingBodyComponent*, FOrbitProjectionCacheEntry> Cache;
+    Cache.Reserve(Orbits.Num());
+    for (const FOrbitItem& orbit : Orbits)
     {
-        if (!OrbitCamera) OrbitCamera = Cast<UCameraComponent>(component);
-        if (!OrbitSystemState) OrbitSystemState = Cast<UOrbitSystemStateComponent>(component);
+        if (!orbit.Body) continue;
+
+        FOrbitProjectionCacheEntry* Previous = ProjectionCache.Find(orbit.Body);
+        Cache.Add(orbit.Body, Previous ? MoveTemp(*Previous) : FOrbitProjectionCacheEntry());
     }
+    ProjectionCache = MoveTemp(Cache);
 
+    std::vector<int> Indices;
+    GetOrbitsToProject(View, Orbits, Bounds, Indices);
+    const int Count = (int)Indices.size();
 
-    PrimaryComponentTick.TickGroup = ETickingGroup::TG_LastDemotable;
-    if (!OrbitCamera || !OrbitSystemState)
+    TArray<FOrbitProjectionCacheEntry*> Entries;
+    Entries.SetNum(Count);
+    for (int i = 0; i < Count; ++i)
     {
-        PrimaryComponentTick.bCanEverTick = false;
+        const FOrbitItem& orbit = Orbits[Indices[i]];
+        Entries[i] = orbit.Body ? ProjectionCache.Find(orbit.Body) : nullptr;
     }
-}
 
+    const EllipseProjectionView<double> currentView = GetEllipseProjectionView(View.Frustum, View.EyePoint, View.EyeDirection, View.EyeUp);
 
-// Called every frame
-void UOrbitProjectorComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
-{
-    Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+    ClipPolygon<double> Region;
+    const bool bRegion = View.GetClipPolygon(Region);
 
-    TArray<UOrbitingBodyComponent*> ActiveBodies;
-    OrbitViewerController->GetActiveBodies(ActiveBodies);
+    // (A clip region's sides aren't the frustum's, so it gets no band.)
+    const double Band = bRegion ? 0. : FMath::Max(GuardBand, 0.);
+    const FrustumParameters<double> BandFrustum = GetGuardBandFrustum(View.GetBoundingFrustum(), Band);
+    const double BandRadians = GetGuardBandRadians(View.Frustum, Band);
 
-    OrbitArray.Empty();
-    for (auto ActiveBody : ActiveBodies)
-    {
-        if (ActiveBody->IsInertial)
-            continue;
+    // Which are still good.  (Those are relocated on their cached planes.)
+    std::vector<EllipseProjectionInputs<double>> Inputs(Count);
+    std::vector<EllipseProjectionOutputs<double>> Outputs(Count);
+    std::vector<char> bHits(Count, 0);
 
-        FOrbitItem orbit;
-        if (CollectOrbit(ActiveBody, orbit))
+    ParallelFor(Count, [&](int32 i)
         {
-            OrbitArray.Add(orbit);
-        }
-    }
-}
+            const FOrbitItem& orbit = Orbits[Indices[i]];
+            const FOrbitProjectionCacheEntry* Entry = Entries[i];
 
+            if (!Entry || Entry->GuardBand != Band || !IsCachedProjectionValid(*Entry, View, orbit, ToleranceRadians, BandRadians))
+            {
+                return;
+            }
 
-bool UOrbitProjectorComponent::CollectOrbit(UOrbitingBodyComponent* ActiveBody, FOrbitItem& orbit)
-{
-    bool result = !ActiveBody->IsInertial;
+            // The cached plane, carried along with the eye
+            const EllipseProjectionView<double> cachedView{ Entry->Eye, Entry->PlaneCenter, Entry->PlaneNormal, Entry->PlaneU, Entry->PlaneV };
+            const EllipseProjectionView<double> view = CarryProjectionView(cachedView, currentView.E);
+
+            EllipseProjectionInputs<double>& projInputs = Inputs[i];
+            EllipseProjectionOutputs<double>& projOutputs = Outputs[i];
+            projInputs = GetOrbitProjectionInputs(view, orbit);
+
+            // Back to how ImageConicLocateBody takes it, b < 0 for hyperbolas
+            const bool bHyperbolic = Entry->Type == ProjectionType::PositiveHyperbola || Entry->Type == ProjectionType::NegativeHyperbola;
+            projOutputs.projection = Entry->Projection;
+            projOutputs.projection.b = bHyperbolic ? -FMath::Abs(Entry->Projection.b) : FMath::Abs(Entry->Projection.b);
+            LocateBodyOnProjection(projInputs, projOutputs);
+
+            // If the body's crossed over to the other branch (or the
+            // orientation flipped) the clipping doesn't hold either
+            bHits[i] = projOutputs.projectionType == Entry->Type && projOutputs.projection.b == Entry->Projection.b;
+        });
+
+    // The misses, projected for the current view all at once
+    std::vector<int> MissIndices;
+    std::vector<int> MissLanes(Count, -1);
+    for (int i = 0; i < Count; ++i)
+    {
+        if (!bHits[i])
+        {
+            MissLanes[i] = (int)MissIndices.size();
+            MissIndices.push_back(Indices[i]);
+        }
+    }
+    const int Hits = Count - (int)MissIndices.size();
 
-    if (result)
+    EllipseBatch<double> ellipses;
+    ellipses.resize(MissIndices.size());
+    for (int lane = 0; lane < (int)MissIndices.size(); ++lane)
     {
+        SetOrbitEllipse(Orbits[MissIndices[lane]], ellipses, lane);
+    }
 
-        ES_ResultCode ResultCode;
-        FOscullatingOrbitGeometry OscillatingGeometry;
-        UOrbitalMechanics::ComputeGeometry(ActiveBody->ConicElements, OscillatingGeometry, ResultCode);
+    ConicProjectionBatch<double> projections;
+    ProjectOrbitLanes(currentView, Orbits, MissIndices, ellipses, Families, projections);
 
-        result &= ResultCode == ES_ResultCode::Success;
-        if (result)
+    Conics.SetNum(Count);
+
+    ParallelFor(Count, [&](int32 i)
         {
-            orbit.ConicType = ES_ConicType::Ellipse;
-            orbit.Color = ActiveBody->LineColor;
+            const FOrbitItem& orbit = Orbits[Indices[i]];
+            FOrbitProjectionCacheEntry* Entry = Entries[i];
+            EllipseProjectionInputs<double>& projInputs = Inputs[i];
+            EllipseProjectionOutputs<double>& projOutputs = Outputs[i];
 
-            orbit.Center = FFramePosition(-OscillatingGeometry.ae * (Vector3<double>)OscillatingGeometry.p_hat);
-            orbit.Axis1 = FFrameVector(OscillatingGeometry.a * (Vector3<double>)OscillatingGeometry.p_hat);
-            orbit.Axis2 = FFrameVector(OscillatingGeometry.b * (Vector3<double>)OscillatingGeometry.q_hat);
+            Conics[i] = FConicSection();
 
-            // Assumes the orbit is at the solar system barycenter's origin...
-            // Child orbits would break here.
-            orbit.Focus = FFramePosition();
-            orbit.Normal = OscillatingGeometry.w_hat;
+            if (!bHits[i])
+            {
+                const int lane = MissLanes[i];
+                projInputs = ellipses.getInputs(currentView, lane);
+                projections.getOutputs(lane, projOutputs);
+            }
 
-            UOrbitalMechanics::ComputeState(ActiveBody->ConicElements, OrbitSystemState->et, orbit.FrameState, ResultCode);
-        }
+            // Nothing to cache it under, so it's clipped for this view alone
+            if (!Entry)
+            {
+                ProjectionType projectionType;
+                FFramePosition ProjectedCenter;
+                FFrameVector ProjectedAxis1;
+                FFrameVector ProjectedAxis2;
+                std::vector<ConicSegment<double>> clipSegments;
+                std::vector<ConicSegment<double>> clipTrueAnomalies;
+                double Advancement = 0;
+
+                ClipProjection(View.GetBoundingFrustum(), false, projInputs, projOutputs, projectionType, ProjectedCenter, ProjectedAxis1, ProjectedAxis2, clipSegments, clipTrueAnomalies, Advancement, nullptr, bRegion ? &Region : nullptr, View.NearDepth, View.FarDepth, &View.Occluders);
+                PackConic(View, orbit, projectionType, ProjectedCenter, ProjectedAxis1, ProjectedAxis2, clipSegments, clipTrueAnomalies, Advancement, Conics[i]);
+                return;
+            }
+
+            if (!bHits[i])
+            {
+                Entry->bValid = true;
+                Entry->Center = orbit.Center;
+                Entry->Axis1 = orbit.Axis1;
+                Entry->Axis2 = orbit.Axis2;
+                Entry->View = View;
+                Entry->Eye = currentView.E;
+                Entry->PlaneCenter = currentView.Cp;
+                Entry->PlaneNormal = currentView.Np;
+                Entry->PlaneU = currentView.Up;
+                Entry->PlaneV = currentView.Vp;
+                Entry->Projection = projOutputs.projection;
+                Entry->Type = projOutputs.projectionType;
+                Entry->GuardBand = Band;
+                Entry->bVisible = ClipProjectionSegments(BandFrustum, false, projInputs, projOutputs, Entry->Segments, Entry->SegmentTrueAnomalies, nullptr, bRegion ? &Region : nullptr, View.NearDepth, View.FarDepth);
+            }
+
+            ProjectionType projectionType;
+            FFramePosition ProjectedCenter;
+            FFrameVector ProjectedAxis1;
+            FFrameVector ProjectedAxis2;
+            std::vector<ConicSegment<double>> clipSegments = Entry->Segments;
+            std::vector<ConicSegment<double>> clipTrueAnomalies;
+            double Advancement = 0;
+
+            // The bodies move on whether the view does or not, so what they
+            // hide isn't cached.  Only orbits they hide pay for it again.
+            bool bVisible = Entry->bVisible;
+            const std::vector<double>* SegmentTrueAnomalies = &Entry->SegmentTrueAnomalies;
+            std::vector<double> OccludedTrueAnomalies;
+            if (bVisible && OccludeProjectionSegments(BandFrustum, false, View.Occluders, projInputs, projOutputs, clipSegments, bVisible))
+            {
+                if (bVisible)
+                {
+                    GetSegmentTrueAnomalies(false, projInputs, projOutputs, clipSegments, OccludedTrueAnomalies);
+                }
+                SegmentTrueAnomalies = &OccludedTrueAnomalies;
+            }
+
+            PlaceBodyOnProjection(projInputs, projOutputs, bVisible, *SegmentTrueAnomalies, projectionType, ProjectedCenter, ProjectedAxis1, ProjectedAxis2, clipSegments, clipTrueAnomalies, Advancement);
+
+            PackConic(View, orbit, projectionType, ProjectedCenter, ProjectedAxis1, ProjectedAxis2, clipSegments, clipTrueAnomalies, Advancement, Conics[i]);
+        });
+
+    PendingCacheHits += Hits;
+    PendingCacheMisses += Count - Hits;
+}
+
+
+double UOrbitProjectorComponent::GetProjectionCacheToleranceRadians(const FOrbitProjectionView& View) const
+{
+    // Horizontal fov, as the frustum's
+    const double PixelsPerRadian = 0.5 * View.ViewportWidth / FMath::Tan(0.5 * View.Frustum.fov);
+
+    return (double)ProjectionCacheTolerance / PixelsPerRadian;
+}
+
+
+// Is the cached projection within ToleranceRadians of what projecting the
+// orbit for View would give?  (The camera can turn GuardBandRadians further
+// before its frustum leaves what was clipped.)  Same orbit and frustum, and
+// near enough the same eye, see CachedConicProjection.
+bool IsCachedProjectionValid(const FOrbitProjectionCacheEntry& Entry, const FOrbitProjectionView& View, const FOrbitItem& orbit, double ToleranceRadians, double GuardBandRadians)
+{
+    if (!Entry.bValid)
+    {
+        return false;
     }
 
-    return result;
+    // Same orbit, same frustum?
+    if ((Vector3<double>)Entry.Center != (Vector3<double>)orbit.Center
+        || (Vector3<double>)Entry.Axis1 != (Vector3<double>)orbit.Axis1
+        || (Vector3<double>)Entry.Axis2 != (Vector3<double>)orbit.Axis2
+        || Entry.View.Frustum.z != View.Frustum.z
+        || Entry.View.Frustum.fov != View.Frustum.fov
+        || Entry.View.Frustum.aspectRatio != View.Frustum.aspectRatio
+        || Entry.View.ProjectionOffset != View.ProjectionOffset
+        || Entry.View.NearDepth != View.NearDepth
+        || Entry.View.FarDepth != View.FarDepth
+        || Entry.View.ClipRegion != View.ClipRegion)
+    {
+        return false;
+    }
+
+    return IsCachedProjectionCurrent(
+        (Vector3<double>)Entry.View.EyePoint,
+        (Vector3<double>)Entry.View.EyeDirection,
+        (Vector3<double>)Entry.View.EyeUp,
+        (Vector3<double>)View.EyePoint,
+        (Vector3<double>)View.EyeDirection,
+        (Vector3<double>)View.EyeUp,
+        (Vector3<double>)orbit.Focus,
+        (Vector3<double>)orbit.Center,
+        (Vector3<double>)orbit.Axis1,
+        (Vector3<double>)orbit.Normal,
+        ToleranceRadians,
+        GuardBandRadians
+    );
 }
 
-// Project conic based on current camera view...
-bool UOrbitProjectorComponent::TransformOrbit(const FOrbitItem& orbit, FConicSection& conic)
+
+EllipseProjectionInputs<double> GetOrbitProjectionInputs(const EllipseProjectionView<double>& view, const FOrbitItem& orbit)
 {
-    double fieldOfView = (double)OrbitCamera->FieldOfView / 180 * pi<double>;
-    double aspectRatio = (double)OrbitCamera->AspectRatio;
-    double distance;
-    OrbitViewerController->GetFrameDistance(ProjectionPlaneDistance, distance);
+    Vector3<double> Ue = (Vector3<double>)orbit.Axis1;
+    Vector3<double> Ve = (Vector3<double>)orbit.Axis2;
+    double A = Normalize(Ue);
+    double B = Normalize(Ve);
 
-    const FrustumParameters<double> frustumParameters(distance, fieldOfView, aspectRatio);
+    return EllipseProjectionInputs<double>(view.E, orbit.Center, UnitCross(Ue, Ve), Ue, Ve, A, B, view.Cp, view.Np, view.Up, view.Vp, GetTestTheta(orbit));
+}
 
-    // Inputs...
-    FFramePosition EyePoint;
-    OrbitViewerController->GetFramePosition(OrbitCamera->GetComponentLocation(), EyePoint);
-    FFrameVector EyeDirection;
-    OrbitViewerController->GetFrameVector(OrbitCamera->GetForwardVector(), EyeDirection);
 
-    // Outputs...
-    ProjectionType projectionType;
-    FFramePosition ProjectedCenter;
-    FFrameVector ProjectedAxis1;
-    FFrameVector ProjectedAxis2;
-    std::vector<ConicSegment<double>> clipSegments;
-    std::vector<ConicSegment<double>> clipTrueAnomalies;
+// Where's the body on the (unlocated) image conic in projOutputs?
+void LocateBodyOnProjection(const EllipseProjectionInputs<double>& projInputs, EllipseProjectionOutputs<double>& projOutputs)
+{
+    const EllipseProjectionView<double> view{ projInputs.E, projInputs.Cp, projInputs.Np, projInputs.Up, projInputs.Vp };
+    const Vector3<double>& Ce = projInputs.Ce;
+    const Vector3<double>& Ue = projInputs.Ue;
+    const Vector3<double>& Ve = projInputs.Ve;
+    ConicProjection<double>& p = projOutputs.projection;
+
+    ImageConicLocateBody(
+        view,
+        Ce[0], Ce[1], Ce[2],
+        Ue[0], Ue[1], Ue[2],
+        Ve[0], Ve[1], Ve[2],
+        projInputs.A, projInputs.B,
+        projInputs.TestTheta,
+        p.k[0], p.k[1],
+        p.u[0], p.u[1],
+        p.v[0], p.v[1],
+        p.a,
+        p.b,
+        projOutputs.projectionType,
+        projOutputs.ThetaLocation
+    );
+}
+
 
+double GetTestTheta(const FOrbitItem& orbit)
+{
     double TrueAnomaly = orbit.FrameState.Theta / 180 * pi<double>;
 
     double a = Length((Vector3<double>)orbit.Axis1);
@@ -164,28 +1192,24 @@ bool UOrbitProjectorComponent::TransformOrbit(const FOrbitItem& orbit, FConicSec
     double ae = Length((Vector3<double>)orbit.Center);
     double x = orbit.FrameState.r * cos(TrueAnomaly);
     double y = orbit.FrameState.r * sin(TrueAnomaly);
-    double TestTheta = atan2(y / b, (x + ae) / a);
-    
-    double Advancement = 0;
 
+    return atan2(y / b, (x + ae) / a);
+}
 
-    ProjectToPlane(
-        frustumParameters,
-        orbit.Center,
-        orbit.Axis1,
-        orbit.Axis2,
-        EyePoint,
-        EyeDirection,
-        projectionType,
-        ProjectedCenter,
-        ProjectedAxis1,
-        ProjectedAxis2,
-        clipSegments,
-        clipTrueAnomalies,
-        Advancement,
-        TestTheta
-    );
 
+bool PackConic(
+    const FOrbitProjectionView& View,
+    const FOrbitItem& orbit,
+    ProjectionType projectionType,
+    const FFramePosition& ProjectedCenter,
+    const FFrameVector& ProjectedAxis1,
+    const FFrameVector& ProjectedAxis2,
+    const std::vector<ConicSegment<double>>& clipSegments,
+    const std::vector<ConicSegment<double>>& clipTrueAnomalies,
+    double Advancement,
+    FConicSection& conic
+)
+{
     switch (projectionType)
     {
     case ProjectionType::Ellipse:
@@ -207,15 +1231,20 @@ bool UOrbitProjectorComponent::TransformOrbit(const FOrbitItem& orbit, FConicSec
 
     if (result)
     {
-        OrbitViewerController->GetScenePosition(ProjectedCenter, conic.Center);
-        OrbitViewerController->GetSceneVector(ProjectedAxis1, conic.Axis1);
-        OrbitViewerController->GetSceneVector(ProjectedAxis2, conic.Axis2);
+        conic.Center = View.ToScenePosition(ProjectedCenter);
+        conic.Axis1 = View.ToSceneVector(ProjectedAxis1);
+        conic.Axis2 = View.ToSceneVector(ProjectedAxis2);
 
-        OrbitViewerController->GetScenePosition(orbit.Focus, conic.OrbitalPlaneCenter);
-        OrbitViewerController->GetSceneVector(orbit.Normal, conic.OrbitalPlaneNormal);
+        conic.OrbitalPlaneCenter = View.ToScenePosition(orbit.Focus);
+        conic.OrbitalPlaneNormal = View.ToSceneVector(orbit.Normal);
 
         conic.Color = orbit.Color;
 
+        conic.ScreenRadius = conic.ConicType == ES_ConicType::Ellipse
+            ? (float)View.ToPixels(FMath::Max(Length((Vector3<double>)ProjectedAxis1), Length((Vector3<double>)ProjectedAxis2)))
+            : MAX_flt;
+        conic.PixelsPerUnit = (float)(View.ToPixels(1.) / View.SceneScale);
+
         // Munge from non-UE-specific types to UE-specific types...
         conic.Segments.Empty();
 
@@ -264,14 +1293,16 @@ void UOrbitProjectorComponent::ProjectToPlane(
     std::vector<ConicSegment<double>>& segmentList,
     std::vector<ConicSegment<double>>& advancementList,
     double& Advancement,
-    double TrueAnomaly
+    double TrueAnomaly,
+    bool bOrthographic
 )
 {
     // ------------------------------------------------------------------------
     // Inputs
     // Convert from UE friendly representations to generalized
     // ------------------------------------------------------------------------
-    Vector3<double> E = eyePointPosition;
+    const EllipseProjectionView<double> view = GetEllipseProjectionView(frustum, eyePointPosition, eyeDirection, FFrameVector(0., 0., 1.));
+
     Vector3<double> Ce = ellipseCenterPosition;
     double A = Length((Vector3<double>)ellipseAxis1Vector);
     double B = Length((Vector3<double>)ellipseAxis2Vector);
@@ -282,19 +1313,194 @@ void UOrbitProjectorComponent::ProjectToPlane(
     Normalize(Ve);
     Vector3<double> Ne = UnitCross(Ue, Ve);
 
-    Vector3<double> Np = -(Vector3<double>)eyeDirection;
-    Normalize(Np);
-    const Vector3<double> Cp = eyePointPosition - frustum.z * Np;
-    const Vector3<double> Up = UnitCross(Vector3<double>({ 0, 0, 1 }), Np);
-    const Vector3<double> Vp = UnitCross(Np, Up);
-
-    EllipseProjectionInputs<double> projInputs(E, Ce, Ne, Ue, Ve, A, B, Cp, Np, Up, Vp, TrueAnomaly);
+    EllipseProjectionInputs<double> projInputs(view.E, Ce, Ne, Ue, Ve, A, B, view.Cp, view.Np, view.Up, view.Vp, TrueAnomaly);
     EllipseProjectionOutputs<double> projOutputs;
 
     // ------------------------------------------------------------------------
     // Project the orbit to the plane...
     // ------------------------------------------------------------------------
-    ProjectEllipseToPlane(projInputs, projOutputs);
+    if (bOrthographic)
+    {
+        ProjectEllipseToPlaneOrthographic(projInputs, projOutputs);
+    }
+    else
+    {
+        ProjectEllipseToPlaneClosedForm(projInputs, projOutputs);
+    }
+
+    ClipProjection(frustum, bOrthographic, projInputs, projOutputs, projectionType, projectedCenterPosition, projectedAxis1Vector, projectedAxis2Vector, segmentList, advancementList, Advancement);
+}
+
+
+EllipseProjectionView<double> GetEllipseProjectionView(
+    const FrustumParameters<double>& frustum,
+    const FFramePosition& eyePointPosition,
+    const FFrameVector& eyeDirection,
+    const FFrameVector& eyeUp
+)
+{
+    EllipseProjectionView<double> view;
+
+    // Up is the plane's right (x), Vp its up (y), rolled with the camera
+    view.E = eyePointPosition;
+    view.Np = -(Vector3<double>)eyeDirection;
+    Normalize(view.Np);
+    view.Cp = view.E - frustum.z * view.Np;
+    view.Up = UnitCross((Vector3<double>)eyeUp, view.Np);
+    view.Vp = UnitCross(view.Np, view.Up);
+
+    return view;
+}
+
+
+void ClipProjection(
+    const FrustumParameters<double>& frustum,
+    bool bOrthographic,
+    const EllipseProjectionInputs<double>& projInputs,
+    const EllipseProjectionOutputs<double>& projOutputs,
+    ProjectionType& projectionType,
+    FFramePosition& projectedCenterPosition,
+    FFrameVector& projectedAxis1Vector,
+    FFrameVector& projectedAxis2Vector,
+    std::vector<ConicSegment<double>>& segmentList,
+    std::vector<ConicSegment<double>>& advancementList,
+    double& Advancement,
+    const ConicClip<double>* clip,
+    const ClipPolygon<double>* region,
+    double nearDepth,
+    double farDepth,
+    const std::vector<OccludingSphere<double>>* occluders
+)
+{
+    std::vector<double> segmentTrueAnomalies;
+    bool visible = ClipProjectionSegments(frustum, bOrthographic, projInputs, projOutputs, segmentList, segmentTrueAnomalies, clip, region, nearDepth, farDepth, occluders);
+
+    PlaceBodyOnProjection(projInputs, projOutputs, visible, segmentTrueAnomalies, projectionType, projectedCenterPosition, projectedAxis1Vector, projectedAxis2Vector, segmentList, advancementList, Advancement);
+}
+
+
+// The half of ClipProjection that only depends on the view: clip the
+// projection to the frustum, and map the clip points to true anomalies.
+// (With clip, the projection's already been clipped, see ClipConicsToFrustum.
+// Otherwise, with region, it's clipped to that rather than the whole frustum.
+// Orbits that reach nearer than nearDepth, or further than farDepth, are
+// clipped again with those planes as well, see ClipConicToDepth.
+// With occluders, whatever they hide is taken out before the mapping.)
+bool ClipProjectionSegments(
+    const FrustumParameters<double>& frustum,
+    bool bOrthographic,
+    const EllipseProjectionInputs<double>& projInputs,
+    const EllipseProjectionOutputs<double>& projOutputs,
+    std::vector<ConicSegment<double>>& segmentList,
+    std::vector<double>& segmentTrueAnomalies,
+    const ConicClip<double>* clip,
+    const ClipPolygon<double>* region,
+    double nearDepth,
+    double farDepth,
+    const std::vector<OccludingSphere<double>>* occluders
+)
+{
+    bool visible = false;
+
+    segmentList.clear();
+    segmentTrueAnomalies.clear();
+
+    ConicClip<double> clipped;
+
+    // Past the near or far planes?  Then what came in won't do.
+    ClipPolygon<double> depthRegion;
+    if (GetDepthClipRegion(projInputs, frustum, bOrthographic, region, nearDepth, farDepth, depthRegion))
+    {
+        clip = nullptr;
+        region = &depthRegion;
+    }
+
+    if (!clip && region)
+    {
+        ClipConicToFrustum(*region, projOutputs.projection, projOutputs.projectionType, clipped);
+        clip = &clipped;
+    }
+    else if (!clip)
+    {
+        ClipConicToFrustum(ClipRectangle<double>(frustum), projOutputs.projection, projOutputs.projectionType, clipped);
+        clip = &clipped;
+    }
+
+    if (projOutputs.projectionType == ProjectionType::Ellipse)
+    {
+        // Elliptical!
+        visible = clip->Visible;
+    }
+    else if (projOutputs.projectionType == ProjectionType::PositiveHyperbola || projOutputs.projectionType == ProjectionType::NegativeHyperbola)
+    {
+        // Hyperbolic!!!
+        visible = true;
+    }
+    else
+    {
+        // Parabolic... Not worth handing.
+    }
+
+    segmentList.assign(clip->Segments, clip->Segments + clip->SegmentCount);
+
+    if (visible && occluders)
+    {
+        OccludeProjectionSegments(frustum, bOrthographic, *occluders, projInputs, projOutputs, segmentList, visible);
+    }
+
+    if (visible)
+    {
+        GetSegmentTrueAnomalies(bOrthographic, projInputs, projOutputs, segmentList, segmentTrueAnomalies);
+    }
+
+    return visible;
+}
+
+
+// Take the parts of the projection hidden behind the occluders out of
+// segmentList, as ClipProjectionSegments clipped it.  True if there were any,
+// and then visible is whether anything's left.
+bool OccludeProjectionSegments(
+    const FrustumParameters<double>& frustum,
+    bool bOrthographic,
+    const std::vector<OccludingSphere<double>>& occluders,
+    const EllipseProjectionInputs<double>& projInputs,
+    const EllipseProjectionOutputs<double>& projOutputs,
+    std::vector<ConicSegment<double>>& segmentList,
+    bool& visible
+)
+{
+    if (occluders.empty())
+    {
+        return false;
+    }
+
+    const EllipseProjectionView<double> view{ projInputs.E, projInputs.Cp, projInputs.Np, projInputs.Up, projInputs.Vp };
+
+    return OccludeConicBySpheres(view, bOrthographic, ClipRectangle<double>(frustum), projInputs.Ce, projInputs.Ne, projOutputs.projection, projOutputs.projectionType, occluders.data(), (int)occluders.size(), segmentList, visible);
+}
+
+
+// The other half, which depends on where the body is.  segmentList comes in
+// as ClipProjectionSegments left it.
+void PlaceBodyOnProjection(
+    const EllipseProjectionInputs<double>& projInputs,
+    const EllipseProjectionOutputs<double>& projOutputs,
+    bool visible,
+    const std::vector<double>& segmentTrueAnomalies,
+    ProjectionType& projectionType,
+    FFramePosition& projectedCenterPosition,
+    FFrameVector& projectedAxis1Vector,
+    FFrameVector& projectedAxis2Vector,
+    std::vector<ConicSegment<double>>& segmentList,
+    std::vector<ConicSegment<double>>& advancementList,
+    double& Advancement
+)
+{
+    const Vector3<double>& Cp = projInputs.Cp;
+    const Vector3<double>& Up = projInputs.Up;
+    const Vector3<double>& Vp = projInputs.Vp;
+    const double TrueAnomaly = projInputs.TestTheta;
 
     // ------------------------------------------------------------------------
     // Outputs
@@ -309,58 +1515,126 @@ void UOrbitProjectorComponent::ProjectToPlane(
     projectionType = projOutputs.projectionType;
     Advancement = projOutputs.ThetaLocation;
 
-    segmentList.clear();
     projectedCenterPosition = FFramePosition(Cp + k[0] * Up + k[1] * Vp);
 
     projectedAxis1Vector = FFrameVector(a * (u_proj[0] * Up + u_proj[1] * Vp));
     projectedAxis2Vector = FFrameVector(b * (v_proj[0] * Up + v_proj[1] * Vp));
 
-    // ------------------------------------------------------------------------
-    // Clip the projection to the frustum
-    // ------------------------------------------------------------------------
-    if (projectionType == ProjectionType::Ellipse)
+    if (!visible)
     {
-        // Elliptical!
-        bool visible = ClipEllipseToFrustum(frustum, projOutputs.projection, segmentList);
-
-        if (visible)
-        {
-            GetEllipticalProjectionTrueAnomalies(projInputs, projOutputs, segmentList, advancementList, Advancement, TrueAnomaly);
-        }
+        segmentList.clear();
     }
-    else if (projectionType == ProjectionType::PositiveHyperbola || projectionType == ProjectionType::NegativeHyperbola)
+    else if (projectionType == ProjectionType::Ellipse)
     {
-        // Hyperbolic!!!
-        ClipHyperbolaToFrustum(frustum, projOutputs.projection, projectionType == ProjectionType::PositiveHyperbola, segmentList);
-
-        GetHyperbolicProjectionTrueAnomalies(projInputs, projOutputs, segmentList, advancementList, Advancement, TrueAnomaly);
+        GetEllipticalProjectionTrueAnomalies(segmentTrueAnomalies, segmentList, advancementList, Advancement, TrueAnomaly);
     }
     else
     {
-        // Parabolic... Not worth handing.
+        GetHyperbolicProjectionTrueAnomalies(segmentTrueAnomalies, segmentList, advancementList, Advancement, TrueAnomaly);
     }
-
 }
 
 
 
-void UOrbitProjectorComponent::GetConics(TArray<FConicSection>& Conics)
+void UOrbitProjectorComponent::GetConics(TArray<FConicSection>& Conics, FVector& CameraLocation, FVector& CameraDirection, uint64& CameraSampleCycles)
 {
-    Conics.Empty();
+    if (bAsyncProjection)
+    {
+        // Joining here would wait on the task launched this frame, and the
+        // back buffer would never be drawn from while the next is written.
+        const FConicBuffer& Front = ConicBuffers[FrontBuffer];
+        Conics = Front.Conics;
+        CameraLocation = Front.CameraLocation;
+        CameraDirection = Front.CameraDirection;
+        CameraSampleCycles = Front.SampleCycles;
+        return;
+    }
+
+    CameraLocation = OrbitCamera->GetComponentLocation();
+    CameraDirection = OrbitCamera->GetForwardVector();
+    CameraSampleCycles = FPlatformTime::Cycles64();
 
-    for (auto Orbit : OrbitArray)
+    FOrbitProjectionView View;
+    GetProjectionView(View);
+
+    if (bProjectionCache)
     {
-        FConicSection conic;
-        TransformOrbit(Orbit, conic);
-        Conics.Add(conic);
+        TransformOrbitsCached(View, GetProjectionCacheToleranceRadians(View), ProjectionCacheGuardBand, OrbitArray, Conics, OrbitBounds.Get(), OrbitFamilies.Get());
+
+        ProjectionCacheHits += PendingCacheHits;
+        ProjectionCacheMisses += PendingCacheMisses;
+        PendingCacheHits = PendingCacheMisses = 0;
+        return;
     }
+
+    TransformOrbits(View, OrbitArray, Conics, OrbitBounds.Get(), OrbitFamilies.Get());
 }
 
 
 
-void GetEllipticalProjectionTrueAnomalies(
+bool UOrbitProjectorComponent::FitTrajectoryArc(const TArray<FFramePosition>& Samples, FConicArcFit& Fit)
+{
+    double StartTime = FPlatformTime::Seconds();
+
+    std::vector<Vector3<double>> samples;
+    samples.reserve(Samples.Num());
+    for (const FFramePosition& Sample : Samples)
+    {
+        samples.push_back(Sample);
+    }
+
+    ConicArcFit<double> fit;
+    bool result = FitConicToArc(samples, fit);
+
+    if (result)
+    {
+        Fit.ConicType = fit.isHyperbolic ? ES_ConicType::PositiveHyperbola : ES_ConicType::Ellipse;
+        Fit.Center = FFramePosition(fit.C);
+        Fit.Axis1 = FFrameVector(fit.a * fit.U);
+        Fit.Axis2 = FFrameVector(fit.b * fit.V);
+        Fit.Normal = FFrameVector(fit.N);
+        Fit.ArcStart = fit.arcStart;
+        Fit.ArcLength = fit.arcLength;
+        Fit.RmsResidual = fit.rmsResidual;
+        Fit.MaxResidual = fit.maxResidual;
+    }
+    else
+    {
+        Fit.ConicType = ES_ConicType::None;
+    }
+
+    Fit.FitSeconds = FPlatformTime::Seconds() - StartTime;
+
+    return result;
+}
+
+
+// True anomalies at the start and end of each segment (two per segment.)
+void GetSegmentTrueAnomalies(
+    bool bOrthographic,
     const EllipseProjectionInputs<double>& projInputs,
     const EllipseProjectionOutputs<double>& projOutputs,
+    const std::vector<ConicSegment<double>>& segmentList,
+    std::vector<double>& segmentTrueAnomalies
+)
+{
+    // One mapping for all of the segments' ends (see TrueAnomalyMapping)
+    segmentTrueAnomalies.assign(2 * segmentList.size(), 0.);
+
+    TrueAnomalyMapping<double> mapping;
+    const bool bMapped = bOrthographic
+        ? GetOrthographicTrueAnomalyMapping(projInputs, projOutputs, mapping)
+        : GetTrueAnomalyMapping(projInputs, projOutputs, mapping);
+
+    if (bMapped && segmentList.size())
+    {
+        MapToTrueAnomalies(mapping, segmentList.data(), (int)segmentList.size(), segmentTrueAnomalies.data());
+    }
+}
+
+
+void GetEllipticalProjectionTrueAnomalies(
+    const std::vector<double>& segmentTrueAnomalies,
     std::vector<ConicSegment<double>>& segmentList,
     std::vector<ConicSegment<double>>& advancementList,
     double Advancement,
@@ -382,10 +1656,8 @@ void GetEllipticalProjectionTrueAnomalies(
             double segmentStart = segment.SegmentStart;
             double segmentLength = segment.SegmentLength;
             double segmentEnd = segmentStart + segmentLength;
-            double trueAnomaly1 = 0;
-            double trueAnomaly2 = 0;
-            ProjectionAngleToTrueAnomaly(projInputs, projOutputs, segmentStart, trueAnomaly1);
-            ProjectionAngleToTrueAnomaly(projInputs, projOutputs, segmentEnd, trueAnomaly2);
+            double trueAnomaly1 = segmentTrueAnomalies[2 * i];
+            double trueAnomaly2 = segmentTrueAnomalies[2 * i + 1];
 
             trueAnomaly1 -= TrueAnomaly;
             trueAnomaly2 -= TrueAnomaly;
@@ -406,8 +1678,7 @@ void GetEllipticalProjectionTrueAnomalies(
 }
 
 void GetHyperbolicProjectionTrueAnomalies(
-    const EllipseProjectionInputs<double>& projInputs,
-    const EllipseProjectionOutputs<double>& projOutputs,
+    const std::vector<double>& segmentTrueAnomalies,
     std::vector<ConicSegment<double>>& segmentList,
     std::vector<ConicSegment<double>>& advancementList,
     double Advancement,
@@ -418,14 +1689,8 @@ void GetHyperbolicProjectionTrueAnomalies(
 
     for (int i = 0; i < segmentList.size(); ++i)
     {
-        auto segment = segmentList[i];
-        double segmentStart = segment.SegmentStart;
-        double segmentLength = segment.SegmentLength;
-        double segmentEnd = segmentStart + segmentLength;
-        double trueAnomaly1 = 0;
-        double trueAnomaly2 = 0;
-        ProjectionAngleToTrueAnomaly(projInputs, projOutputs, segmentStart, trueAnomaly1);
-        ProjectionAngleToTrueAnomaly(projInputs, projOutputs, segmentEnd, trueAnomaly2);
+        double trueAnomaly1 = segmentTrueAnomalies[2 * i];
+        double trueAnomaly2 = segmentTrueAnomalies[2 * i + 1];
 
         trueAnomaly1 -= TrueAnomaly;
         trueAnomaly2 -= TrueAnomaly;
@@ -437,5 +1702,3 @@ void GetHyperbolicProjectionTrueAnomalies(
         advancementList.push_back(ConicSegment<double>(trueAnomaly1, trueAnomalyLength));
     }
 }
-
-
@@ -7,6 +7,7 @@
 #include "Kismet/GameplayStatics.h"
 #include "GameFramework/GameStateBase.h"
 #include "OrbitSystemStateComponent.h"
+#include "ApparentPosition.h"
 
 using namespace gte;
 
@@ -147,6 +148,88 @@ void UOrbitViewerControllerComponent::GetActiveBodies(TArray<UOrbitingBodyCompon
     BodyMap.GenerateValueArray(ActiveBodies);
 }
 
+void UOrbitViewerControllerComponent::GetApparentPositions(const TArray<UOrbitingBodyComponent*>& Targets, const FVector& CameraLocation, TArray<FFramePosition>& ApparentPositions)
+{
+    double et = GameState->et;
+
+    // Observer state...
+    FFramePosition ObserverPosition;
+    FFrameVector ObserverVelocity;
+    ES_ResultCode ResultCode;
+
+    if (ApparentObserver == ES_ApparentObserver::Camera)
+    {
+        GetFramePosition(CameraLocation, ObserverPosition);
+    }
+    else
+    {
+        ObserverPosition = GetScenegraphOrigin();
+    }
+
+    // The camera rides along with the focus body, so either way the observer
+    // moves with the focus body's velocity.  (At rest, if that can't be
+    // computed: no aberration rather than a bad one.)
+    if (FocusBody && !FocusBody->IsInertial)
+    {
+        UOrbitalMechanics::ComputeVelocity(FocusBody->ConicElements, et, ObserverVelocity, ResultCode);
+
+        if (ResultCode != ES_ResultCode::Success)
+        {
+            ObserverVelocity = FFrameVector();
+        }
+    }
+
+    // Null targets are left out of the batch, and at the origin
+    TArray<int32> Lanes;
+    Lanes.Reserve(Targets.Num());
+    for (int32 i = 0; i < Targets.Num(); ++i)
+    {
+        if (Targets[i])
+        {
+            Lanes.Add(i);
+        }
+    }
+
+    FApparentPositionBatch Batch;
+    Batch.SetNum(Lanes.Num());
+
+    for (int32 Lane = 0; Lane < Lanes.Num(); ++Lane)
+    {
+        UOrbitingBodyComponent* Target = Targets[Lanes[Lane]];
+        Batch.Elements[Lane] = Target->ConicElements;
+        Batch.IsInertial[Lane] = Target->IsInertial;
+
+        // Warm start from the last call
+        double* LastLightTime = LightTimes.Find(TWeakObjectPtr<UOrbitingBodyComponent>(Target));
+        Batch.LightTimes[Lane] = LastLightTime ? *LastLightTime : 0.;
+    }
+
+    ComputeApparentPositions(Batch, et, ObserverPosition, ObserverVelocity, bApplyAberration, LightTimeMaxIterations, LightTimeTolerance);
+
+    LightTimeIterations = 0;
+    LightTimePeakIterations = 0;
+    LightTimeUnconverged = 0;
+
+    ApparentPositions.Init(FFramePosition(), Targets.Num());
+
+    // Only this call's targets carry over, so bodies that have gone away (or
+    // dropped out of view) don't linger in the map.
+    TMap<TWeakObjectPtr<UOrbitingBodyComponent>, double> NextLightTimes;
+    NextLightTimes.Reserve(Lanes.Num());
+
+    for (int32 Lane = 0; Lane < Lanes.Num(); ++Lane)
+    {
+        ApparentPositions[Lanes[Lane]] = Batch.Positions[Lane];
+        NextLightTimes.Add(Targets[Lanes[Lane]], Batch.LightTimes[Lane]);
+
+        LightTimeIterations += Batch.Iterations[Lane];
+        LightTimePeakIterations = FMath::Max(LightTimePeakIterations, Batch.Iterations[Lane]);
+        LightTimeUnconverged += Batch.Converged[Lane] ? 0 : 1;
+    }
+
+    LightTimes = MoveTemp(NextLightTimes);
+}
+
 void UOrbitViewerControllerComponent::DrawDebugOrbit(const FSceneOrbitGeometry& Geometry, FColor lineColor, float thickness)
 {
 #if defined(CONTROLLER_DRAW_DEBUG_ORBIT) && CONTROLLER_DRAW_DEBUG_ORBIT==1
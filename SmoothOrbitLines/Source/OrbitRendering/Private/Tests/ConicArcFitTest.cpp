@@ -0,0 +1,152 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+// -----------------------------------------------------------------------------
+// ConicArcFitTest.cpp
+//
+// FitConicToArc against the conics the samples came from.  Arcs of random
+// (solar system scale) ellipses and hyperbolas, sampled exactly, have to fit
+// with ~0 residual, to the same kind of conic over the same parameter span.
+// And the fitted conic has to be the known one everywhere, not just at the
+// samples: its points (all the way around, for an ellipse) have to lie on the
+// known conic.
+// -----------------------------------------------------------------------------
+
+#include "Misc/AutomationTest.h"
+#include "OrbitProjectorComponent.h"
+#include "Math/RandomStream.h"
+#include "OrbitTestFixtures.h"
+#include "Conics/FitConicToArc.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ConicArcFitTest
+{
+    using namespace OrbitTestFixtures;
+
+    const int Count = 2000;
+    const int SampleCount = 40;
+
+    // Fractions of the semi-major (transverse) axis, from the samples to the
+    // fit.  Exact samples are within a few 1e-10 of it.
+    const double Tolerance = 1e-9;
+
+    // The fit against the known conic, away from the samples: radians of arc
+    // length, and relative distances off the conic.  Short arcs leave the
+    // rest of the conic less certain, the worst are a few 1e-7 off.
+    const double ShapeTolerance = 1e-6;
+
+    // A known conic, and the samples along an arc of it
+    struct KnownArc
+    {
+        Vector3<double> C, U, V, N;
+        double A, B;
+        bool bHyperbolic;
+        double Start, Length;
+        std::vector<Vector3<double>> Samples;
+    };
+
+    void MakeArc(FRandomStream& Random, bool bHyperbolic, KnownArc& Arc)
+    {
+        Arc.C = RandomVector(Random, 2. * AU);
+        Arc.U = RandomDirection(Random);
+        Arc.V = UnitCross(RandomDirection(Random), Arc.U);
+        Arc.N = UnitCross(Arc.U, Arc.V);
+        Arc.A = AU * Random.FRandRange(0.3f, 5.f);
+        Arc.B = Arc.A * Random.FRandRange(0.1f, 1.f);
+        Arc.bHyperbolic = bHyperbolic;
+
+        // Anything from a short arc to nearly a whole ellipse, or a stretch
+        // of the hyperbola either side of its vertex
+        Arc.Length = bHyperbolic ? Random.FRandRange(0.5f, 3.f) : Random.FRandRange(0.5f, 6.f);
+        Arc.Start = bHyperbolic ? Random.FRandRange(-1.5f, 1.5f) - 0.5 * Arc.Length : twopi<double> * Random.FRand();
+
+        Arc.Samples.resize(SampleCount);
+        for (int i = 0; i < SampleCount; ++i)
+        {
+            const double t = Arc.Start + Arc.Length * i / (SampleCount - 1);
+            Arc.Samples[i] = bHyperbolic
+                ? Arc.C + Arc.A * cosh(t) * Arc.U + Arc.B * sinh(t) * Arc.V
+                : Arc.C + Arc.A * cos(t) * Arc.U + Arc.B * sin(t) * Arc.V;
+        }
+    }
+
+    // How far P is off the known conic: out of its plane, and off its
+    // implicit equation, x^2/A^2 +/- y^2/B^2 = 1.  (Both relative to P's
+    // distance from the center, which is all a hyperbola's far points can
+    // be held to.)
+    double OffConic(const KnownArc& Arc, const Vector3<double>& P)
+    {
+        const Vector3<double> d = P - Arc.C;
+        const double x = Dot(d, Arc.U) / Arc.A;
+        const double y = Dot(d, Arc.V) / Arc.B;
+        const double Implicit = Arc.bHyperbolic ? x * x - y * y - 1. : x * x + y * y - 1.;
+        return FMath::Max(FMath::Abs(Dot(d, Arc.N)) / Length(d), FMath::Abs(Implicit) / (x * x + y * y));
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FConicArcFitKnownConicTest, "OrbitRendering.Fitting.KnownConic", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FConicArcFitKnownConicTest::RunTest(const FString& Parameters)
+{
+    using namespace ConicArcFitTest;
+
+    FRandomStream Random(1234);
+
+    int Unfitted = 0;
+    int WrongType = 0;
+    double WorstResidual = 0.;
+    double WorstArcLength = 0.;
+    double WorstOffConic = 0.;
+
+    for (int i = 0; i < Count; ++i)
+    {
+        KnownArc Arc;
+        MakeArc(Random, (i & 1) != 0, Arc);
+
+        ConicArcFit<double> fit;
+        if (!FitConicToArc(Arc.Samples, fit))
+        {
+            ++Unfitted;
+            continue;
+        }
+
+        if (fit.isHyperbolic != Arc.bHyperbolic)
+        {
+            ++WrongType;
+            continue;
+        }
+
+        WorstResidual = FMath::Max(WorstResidual, fit.maxResidual / Arc.A);
+        WorstResidual = FMath::Max(WorstResidual, fit.rmsResidual / Arc.A);
+
+        // The fit's axes can be the known ones swapped or reversed, which
+        // only shifts (or flips) the parameter; the span is the same
+        WorstArcLength = FMath::Max(WorstArcLength, FMath::Abs(fit.arcLength - Arc.Length));
+
+        // Around the whole fitted ellipse, or along the sampled arc of the
+        // hyperbola
+        const int Points = 100;
+        for (int j = 0; j <= Points; ++j)
+        {
+            const double t = Arc.bHyperbolic
+                ? fit.arcStart + fit.arcLength * j / Points
+                : twopi<double> * j / Points;
+
+            const Vector3<double> P = Arc.bHyperbolic
+                ? fit.C + fit.a * cosh(t) * fit.U + fit.b * sinh(t) * fit.V
+                : fit.C + fit.a * cos(t) * fit.U + fit.b * sin(t) * fit.V;
+
+            WorstOffConic = FMath::Max(WorstOffConic, OffConic(Arc, P));
+        }
+    }
+
+    TestEqual(TEXT("Arcs that didn't fit"), Unfitted, 0);
+    TestEqual(TEXT("Arcs fitted to the wrong kind of conic"), WrongType, 0);
+    TestEqual(TEXT("Worst residual (semi-axes)"), WorstResidual, 0., Tolerance);
+    TestEqual(TEXT("Worst arc length (radians)"), WorstArcLength, 0., ShapeTolerance);
+    TestEqual(TEXT("Worst fitted point off the conic"), WorstOffConic, 0., ShapeTolerance);
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,526 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+// -----------------------------------------------------------------------------
+// ConicClipTest.cpp
+//
+// Clipping image conics to the screen.  ClipEvents' sorting network has to
+// sort (all 0/1 inputs, which is enough for a sorting network, and random
+// ones with ties.)  The batched ClipConicsToFrustum has to give what the
+// one-at-a-time clippers give, and both have to agree with the conic,
+// sampled: a sample inside the screen is in a segment, and one outside
+// isn't.  The same goes for convex polygons (ClipPolygon), and the screen's
+// rectangle as a polygon has to clip as the rectangle does.  And for the
+// near and far planes (GetDepthClipRegion): a random orbit's point that's on
+// screen is in a segment exactly when it's between them, perspective or
+// orthographic.
+// -----------------------------------------------------------------------------
+
+#include "Misc/AutomationTest.h"
+#include "OrbitProjectorComponent.h"
+#include "Math/RandomStream.h"
+#include "OrbitTestFixtures.h"
+#include "Conics/ClipEvents.h"
+#include "Conics/ClipEllipseToFrustum.h"
+#include "Conics/ClipHyperbolaToFrustum.h"
+#include "Conics/ClipConicsToFrustum.h"
+#include "Conics/ClipConicToDepth.h"
+#include "Conics/ProjectEllipseToPlaneClosedForm.h"
+#include "Conics/ProjectEllipseToPlaneOrthographic.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ConicClipTest
+{
+    using namespace OrbitTestFixtures;
+
+    const int Count = 20000;
+
+    // 1920 x 1080, 90 degree fov: the screen is |x| <= 1000, |y| <= 562.5
+    const FrustumParameters<double> Frustum(1000., pi<double> / 2., 16. / 9.);
+
+    // Samples this close to a side (relative to the screen) could go either way
+    const double Slack = 1e-6;
+
+    // Hyperbolas are sampled over |t| <= this.  (Past it they're 1e4 screens
+    // away.)
+    const double HyperbolaRange = 16.;
+    const int Samples = 1024;
+
+    // An ellipse or a hyperbola of either branch, anywhere from a few pixels
+    // to a few screens across, near the screen
+    void MakeConic(FRandomStream& Random, ConicProjection<double>& p, ProjectionType& projectionType)
+    {
+        const int Type = Random.RandHelper(3);
+        projectionType = Type == 0 ? ProjectionType::Ellipse : Type == 1 ? ProjectionType::PositiveHyperbola : ProjectionType::NegativeHyperbola;
+
+        const double Angle = Random.FRandRange(0.f, twopi<float>);
+        p.k = Vector<2, double>{ Random.FRandRange(-1500.f, 1500.f), Random.FRandRange(-1500.f, 1500.f) };
+        p.u = Vector<2, double>{ std::cos(Angle), std::sin(Angle) };
+        p.v = Vector<2, double>{ -std::sin(Angle), std::cos(Angle) };
+        p.a = FMath::Exp(Random.FRandRange(FMath::Loge(2.f), FMath::Loge(5000.f)));
+        p.b = FMath::Exp(Random.FRandRange(FMath::Loge(2.f), FMath::Loge(5000.f)));
+    }
+
+    Vector2<double> ConicPoint(const ConicProjection<double>& p, ProjectionType projectionType, double t)
+    {
+        if (projectionType == ProjectionType::Ellipse)
+        {
+            return p.k + p.a * cos(t) * p.u + p.b * sin(t) * p.v;
+        }
+
+        const double sign = projectionType == ProjectionType::PositiveHyperbola ? 1. : -1.;
+        return p.k + sign * p.a * cosh(t) * p.u + sign * p.b * sinh(t) * p.v;
+    }
+
+    bool IsInSegment(const ConicSegment<double>& segment, bool periodic, double t)
+    {
+        double s = t - segment.SegmentStart;
+        if (periodic)
+        {
+            s = std::fmod(s, twopi<double>);
+            if (s < 0.) s += twopi<double>;
+        }
+        return s >= 0. && s <= segment.SegmentLength;
+    }
+
+    // How many samples of the conic the clip gets wrong: inside region but
+    // not in a segment, or the other way round.  Scale is the region's size.
+    int CountMisclipped(const ClipPolygon<double>& region, double Scale, const ConicProjection<double>& p, ProjectionType projectionType, const ConicClip<double>& clip)
+    {
+        const bool periodic = projectionType == ProjectionType::Ellipse;
+        int Misclipped = 0;
+
+        for (int j = 0; j < Samples; ++j)
+        {
+            const double t = periodic
+                ? twopi<double> * (j + 0.5) / Samples
+                : HyperbolaRange * (2. * (j + 0.5) / Samples - 1.);
+            const Vector2<double> x = ConicPoint(p, projectionType, t);
+
+            // Inside every side, or beyond one, and not too close to call
+            double Beyond = -std::numeric_limits<double>::max();
+            for (int i = 0; i < region.SideCount; ++i)
+            {
+                const Vector2<double>& n = region.Normals[i];
+                Beyond = FMath::Max(Beyond, (Dot(n, x) - region.Distances[i]) / Length(n));
+            }
+            if (FMath::Abs(Beyond) < Slack * Scale) continue;
+
+            // (A visible ellipse without segments is visible all the way round)
+            bool bClipped = clip.Visible && periodic && clip.SegmentCount == 0;
+            for (int i = 0; i < clip.SegmentCount; ++i)
+            {
+                bClipped = bClipped || IsInSegment(clip.Segments[i], periodic, t);
+            }
+
+            if (bClipped != (Beyond < 0.)) ++Misclipped;
+        }
+
+        return Misclipped;
+    }
+
+    // A convex polygon of 3 to MaxVertices vertices, either way round, on a
+    // circle around somewhere on the screen
+    void MakePolygon(FRandomStream& Random, std::vector<Vector2<double>>& Vertices)
+    {
+        const int n = 3 + Random.RandHelper(ClipPolygon<double>::MaxVertices - 2);
+        const Vector2<double> Center{ Random.FRandRange(-800.f, 800.f), Random.FRandRange(-400.f, 400.f) };
+        const double Radius = Random.FRandRange(50.f, 1000.f);
+
+        std::vector<double> Angles(n);
+        for (double& Angle : Angles)
+        {
+            Angle = twopi<double> * Random.FRand();
+        }
+        std::sort(Angles.begin(), Angles.end());
+        if (Random.FRand() < 0.5f) std::reverse(Angles.begin(), Angles.end());
+
+        Vertices.resize(n);
+        for (int i = 0; i < n; ++i)
+        {
+            Vertices[i] = Center + Radius * Vector2<double>{ std::cos(Angles[i]), std::sin(Angles[i]) };
+        }
+    }
+
+    bool SetVertices(ClipPolygon<double>& Polygon, std::initializer_list<Vector2<double>> Vertices)
+    {
+        const std::vector<Vector2<double>> v(Vertices);
+        return Polygon.SetVertices(v.data(), (int)v.size());
+    }
+
+    // The image conic's t for an orbit point, and where it lands.  False if
+    // it's behind the eye (on no branch that's drawn.)
+    bool ImageOfOrbitPoint(const EllipseProjectionInputs<double>& inputs, bool orthographic, const EllipseProjectionOutputs<double>& outputs, const Vector3<double>& X, double& t, Vector2<double>& x)
+    {
+        Vector3<double> q = X - inputs.Cp;
+        if (!orthographic)
+        {
+            const Vector3<double> w = X - inputs.E;
+            const Vector3<double> F = inputs.Cp - inputs.E;
+            if (Dot(w, inputs.Np) >= 0.) return false;
+            q = (Dot(F, inputs.Np) / Dot(w, inputs.Np)) * w - F;
+        }
+        x = Vector2<double>{ Dot(q, inputs.Up), Dot(q, inputs.Vp) };
+
+        const ConicProjection<double>& p = outputs.projection;
+        const Vector2<double> d = x - p.k;
+        const double u = Dot(d, p.u) / p.a;
+        const double v = Dot(d, p.v) / p.b;
+
+        if (outputs.projectionType == ProjectionType::Ellipse)
+        {
+            t = atan2(v, u);
+            return true;
+        }
+
+        const double sign = outputs.projectionType == ProjectionType::NegativeHyperbola ? -1. : 1.;
+        t = asinh(sign * v);
+        return sign * u > 0.;
+    }
+
+    // Whens in order, and nothing lost or duplicated
+    bool IsSorted(const ClipEvents<double>& events, const std::vector<std::pair<double, int>>& Expected)
+    {
+        std::vector<std::pair<double, int>> Sorted;
+        for (int i = 0; i < events.Count; ++i)
+        {
+            if (i > 0 && events.Events[i].When < events.Events[i - 1].When) return false;
+            Sorted.push_back({ events.Events[i].When, events.Events[i].Bit });
+        }
+
+        std::sort(Sorted.begin(), Sorted.end());
+        return Sorted == Expected;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClipEventsSortTest, "OrbitRendering.Clipping.SortingNetwork", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FClipEventsSortTest::RunTest(const FString& Parameters)
+{
+    using namespace ConicClipTest;
+
+    // Every 0/1 input, of every length
+    int Unsorted = 0;
+    for (int n = 0; n <= ClipEvents<double>::MaxEvents; ++n)
+    {
+        for (int Bits = 0; Bits < (1 << n); ++Bits)
+        {
+            ClipEvents<double> events;
+            std::vector<std::pair<double, int>> Expected;
+            for (int i = 0; i < n; ++i)
+            {
+                const double When = (double)((Bits >> i) & 1);
+                events.Add(When, 1 << i);
+                Expected.push_back({ When, 1 << i });
+            }
+            std::sort(Expected.begin(), Expected.end());
+
+            events.Sort();
+            if (!IsSorted(events, Expected)) ++Unsorted;
+        }
+    }
+    TestEqual(TEXT("0/1 inputs sorted wrongly"), Unsorted, 0);
+
+    // Random ones, with ties
+    FRandomStream Random(1357);
+    Unsorted = 0;
+    for (int r = 0; r < Count; ++r)
+    {
+        const int n = Random.RandHelper(ClipEvents<double>::MaxEvents + 1);
+
+        ClipEvents<double> events;
+        std::vector<std::pair<double, int>> Expected;
+        for (int i = 0; i < n; ++i)
+        {
+            const double When = Random.FRand() < 0.25f ? 1. : twopi<double> * Random.FRand();
+            const int Bit = 1 << Random.RandHelper(4);
+            events.Add(When, Bit);
+            Expected.push_back({ When, Bit });
+        }
+        std::sort(Expected.begin(), Expected.end());
+
+        events.Sort();
+        if (!IsSorted(events, Expected)) ++Unsorted;
+    }
+    TestEqual(TEXT("Random inputs sorted wrongly"), Unsorted, 0);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClipConicsToFrustumTest, "OrbitRendering.Clipping.Frustum", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FClipConicsToFrustumTest::RunTest(const FString& Parameters)
+{
+    using namespace ConicClipTest;
+
+    FRandomStream Random(2468);
+
+    ConicProjectionBatch<double> projections;
+    projections.resize(Count);
+    for (int i = 0; i < Count; ++i)
+    {
+        ConicProjection<double> p;
+        MakeConic(Random, p, projections.projectionType[i]);
+        projections.setProjection(i, p);
+    }
+
+    std::vector<ConicClip<double>> clips;
+    ClipConicsToFrustum(Frustum, projections, clips);
+
+    const ClipRectangle<double> Rectangle(Frustum);
+    const ClipPolygon<double> Screen(Rectangle);
+
+    int Visible = 0;
+    int Different = 0;
+    int Misclipped = 0;
+    std::vector<ConicSegment<double>> segments;
+
+    for (int i = 0; i < Count; ++i)
+    {
+        ConicProjection<double> p;
+        projections.getProjection(i, p);
+        const ProjectionType projectionType = projections.projectionType[i];
+        const ConicClip<double>& clip = clips[i];
+
+        // One at a time
+        if (projectionType == ProjectionType::Ellipse) ClipEllipseToFrustum(Frustum, p, segments);
+        else ClipHyperbolaToFrustum(Frustum, p, projectionType == ProjectionType::PositiveHyperbola, segments);
+
+        bool bSame = (int)segments.size() == clip.SegmentCount;
+        for (int j = 0; bSame && j < clip.SegmentCount; ++j)
+        {
+            bSame = segments[j].SegmentStart == clip.Segments[j].SegmentStart && segments[j].SegmentLength == clip.Segments[j].SegmentLength;
+        }
+        if (!bSame) ++Different;
+
+        if (clip.Visible) ++Visible;
+        Misclipped += CountMisclipped(Screen, Rectangle.maxX, p, projectionType, clip);
+    }
+
+    TestTrue(TEXT("Some conics visible"), Visible > Count / 10);
+    TestTrue(TEXT("Some conics not visible"), Visible < Count * 9 / 10);
+    TestEqual(TEXT("Conics clipped differently batched"), Different, 0);
+    TestEqual(TEXT("Samples clipped wrongly"), Misclipped, 0);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClipConicsToPolygonTest, "OrbitRendering.Clipping.Polygon", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FClipConicsToPolygonTest::RunTest(const FString& Parameters)
+{
+    using namespace ConicClipTest;
+
+    // Convex, either way round, and with a repeated vertex
+    ClipPolygon<double> Polygon;
+    TestTrue(TEXT("Square, counterclockwise"), SetVertices(Polygon, { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } }) && Polygon.SideCount == 4);
+    TestTrue(TEXT("Square, clockwise"), SetVertices(Polygon, { { 0, 0 }, { 0, 1 }, { 1, 1 }, { 1, 0 } }) && Polygon.SideCount == 4);
+    TestTrue(TEXT("Square, a vertex repeated"), SetVertices(Polygon, { { 0, 0 }, { 1, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } }) && Polygon.SideCount == 4);
+
+    // Not: every corner turns the same way, but it goes round twice
+    const double Turn = twopi<double> * 2. / 5.;
+    TestFalse(TEXT("Pentagram"), SetVertices(Polygon, {
+        { cos(0. * Turn), sin(0. * Turn) },
+        { cos(1. * Turn), sin(1. * Turn) },
+        { cos(2. * Turn), sin(2. * Turn) },
+        { cos(3. * Turn), sin(3. * Turn) },
+        { cos(4. * Turn), sin(4. * Turn) } }));
+    TestEqual(TEXT("Pentagram's sides"), Polygon.SideCount, 0);
+    TestFalse(TEXT("Bow tie"), SetVertices(Polygon, { { 0, 0 }, { 1, 1 }, { 1, 0 }, { 0, 1 } }));
+    TestFalse(TEXT("Doubling back"), SetVertices(Polygon, { { 0, 0 }, { 2, 0 }, { 1, 0 }, { 1, 1 } }));
+    TestFalse(TEXT("A line"), SetVertices(Polygon, { { 0, 0 }, { 1, 0 }, { 2, 0 } }));
+    TestFalse(TEXT("Too many vertices"), SetVertices(Polygon, { { 0, 0 }, { 1, 0 }, { 2, 0 }, { 3, 0 }, { 4, 1 }, { 3, 2 }, { 2, 2 }, { 1, 2 }, { 0, 1 } }));
+
+    FRandomStream Random(3579);
+
+    const ClipRectangle<double> Rectangle(Frustum);
+    const ClipPolygon<double> Screen(Rectangle);
+
+    // The screen as a polygon, against the rectangle.  The ellipse's crossings
+    // are worked out the same way, the hyperbola's aren't, so only to a
+    // tolerance (radians.)
+    const double Tolerance = 1e-9;
+    int Different = 0;
+    double Worst = 0.;
+
+    for (int i = 0; i < Count; ++i)
+    {
+        ConicProjection<double> p;
+        ProjectionType projectionType;
+        MakeConic(Random, p, projectionType);
+
+        ConicClip<double> RectangleClip, PolygonClip;
+        ClipConicToFrustum(Rectangle, p, projectionType, RectangleClip);
+        ClipConicToFrustum(Screen, p, projectionType, PolygonClip);
+
+        if (RectangleClip.Visible != PolygonClip.Visible || RectangleClip.SegmentCount != PolygonClip.SegmentCount)
+        {
+            ++Different;
+            continue;
+        }
+
+        for (int j = 0; j < RectangleClip.SegmentCount; ++j)
+        {
+            const ConicSegment<double>& a = RectangleClip.Segments[j];
+            const ConicSegment<double>& b = PolygonClip.Segments[j];
+            Worst = FMath::Max(Worst, FMath::Max(FMath::Abs(a.SegmentStart - b.SegmentStart), FMath::Abs(a.SegmentLength - b.SegmentLength)));
+        }
+    }
+
+    TestEqual(TEXT("Conics clipped differently by the screen as a polygon"), Different, 0);
+    TestEqual(TEXT("Worst segment difference from the rectangle (radians)"), Worst, 0., Tolerance);
+
+    // Random convex polygons, against the conic sampled
+    int Visible = 0;
+    int Rejected = 0;
+    int Misclipped = 0;
+    std::vector<Vector2<double>> Vertices;
+
+    for (int i = 0; i < Count; ++i)
+    {
+        MakePolygon(Random, Vertices);
+        if (!Polygon.SetVertices(Vertices.data(), (int)Vertices.size()))
+        {
+            ++Rejected;
+            continue;
+        }
+
+        ConicProjection<double> p;
+        ProjectionType projectionType;
+        MakeConic(Random, p, projectionType);
+
+        ConicClip<double> clip;
+        ClipConicToFrustum(Polygon, p, projectionType, clip);
+
+        if (clip.Visible) ++Visible;
+        Misclipped += CountMisclipped(Polygon, Rectangle.maxX, p, projectionType, clip);
+    }
+
+    TestEqual(TEXT("Convex polygons rejected"), Rejected, 0);
+    TestTrue(TEXT("Some conics visible in a polygon"), Visible > Count / 10);
+    TestEqual(TEXT("Samples clipped wrongly by a polygon"), Misclipped, 0);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClipConicsToDepthTest, "OrbitRendering.Clipping.Depth", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FClipConicsToDepthTest::RunTest(const FString& Parameters)
+{
+    using namespace ConicClipTest;
+
+    const int Orbits = 2000;
+    const int OrbitSamples = 1024;
+
+    FRandomStream Random(4680);
+
+    EllipseBatch<double> ellipses;
+    MakeEllipses(Random, Orbits, ellipses);
+
+    for (const bool bOrthographic : { false, true })
+    {
+        // Orthographic, the plane's in the orbits' units
+        const FrustumParameters<double> frustum = bOrthographic ? FrustumParameters<double>(4. * AU, pi<double> / 2., 16. / 9.) : Frustum;
+        const ClipRectangle<double> Rectangle(frustum);
+        const ClipPolygon<double> Screen(Rectangle);
+        const TCHAR* Kind = bOrthographic ? TEXT("orthographic") : TEXT("perspective");
+
+        int Clipped = 0;
+        int Hyperbolas = 0;
+        int Inside = 0;
+        int Outside = 0;
+        int Misclipped = 0;
+
+        for (int i = 0; i < Orbits; ++i)
+        {
+            EllipseProjectionView<double> view;
+            MakeView(Random, frustum.z, view);
+            const EllipseProjectionInputs<double> inputs = ellipses.getInputs(view, i);
+
+            EllipseProjectionOutputs<double> outputs;
+            if (bOrthographic)
+            {
+                ProjectEllipseToPlaneOrthographic(inputs, outputs);
+            }
+            else
+            {
+                ProjectEllipseToPlaneClosedForm(inputs, outputs);
+            }
+
+            // Near and far somewhere across the orbit's depths (in front of
+            // the eye, perspective), and sometimes no far
+            const double Center = Dot(inputs.Np, inputs.E - inputs.Ce);
+            const double Swing = Length(Vector2<double>{ inputs.A * Dot(inputs.Np, inputs.Ue), inputs.B * Dot(inputs.Np, inputs.Ve) });
+            const double Nearest = bOrthographic ? Center - Swing : FMath::Max(Center - Swing, 0.);
+            const double Furthest = Center + Swing;
+            if (Furthest <= Nearest) continue;
+
+            const double NearDepth = bOrthographic && Random.FRand() < 0.25f ? 0. : Nearest + (Furthest - Nearest) * Random.FRandRange(0.01f, 0.6f);
+            const double FarDepth = Random.FRand() < 0.25f ? 0. : FMath::Max(NearDepth, Nearest) + (Furthest - FMath::Max(NearDepth, Nearest)) * Random.FRandRange(0.2f, 0.99f);
+            if (NearDepth <= 0. && FarDepth <= 0.) continue;
+
+            ClipPolygon<double> region;
+            if (!GetDepthClipRegion(inputs, frustum, bOrthographic, (const ClipPolygon<double>*)nullptr, NearDepth, FarDepth, region))
+            {
+                continue;
+            }
+
+            ConicClip<double> clip;
+            ClipConicToFrustum(region, outputs.projection, outputs.projectionType, clip);
+
+            const bool periodic = outputs.projectionType == ProjectionType::Ellipse;
+            ++Clipped;
+            Hyperbolas += !periodic;
+
+            for (int j = 0; j < OrbitSamples; ++j)
+            {
+                const double E = twopi<double> * (j + 0.5) / OrbitSamples;
+                const Vector3<double> X = inputs.Ce + inputs.A * cos(E) * inputs.Ue + inputs.B * sin(E) * inputs.Ve;
+
+                double t;
+                Vector2<double> x;
+                if (!ImageOfOrbitPoint(inputs, bOrthographic, outputs, X, t, x)) continue;
+
+                // On screen, or off it, and not too close to call
+                double Beyond = -std::numeric_limits<double>::max();
+                for (int k = 0; k < Screen.SideCount; ++k)
+                {
+                    const Vector2<double>& n = Screen.Normals[k];
+                    Beyond = FMath::Max(Beyond, (Dot(n, x) - Screen.Distances[k]) / Length(n));
+                }
+                if (FMath::Abs(Beyond) < Slack * Rectangle.maxX) continue;
+
+                // Between the planes, or not, ditto
+                const double Depth = Dot(inputs.Np, inputs.E - X);
+                const double DepthSlack = Slack * (Furthest - Nearest);
+                if (NearDepth > 0. && FMath::Abs(Depth - NearDepth) < DepthSlack) continue;
+                if (FarDepth > 0. && FMath::Abs(Depth - FarDepth) < DepthSlack) continue;
+                const bool bBetween = (NearDepth <= 0. || Depth > NearDepth) && (FarDepth <= 0. || Depth < FarDepth);
+
+                const bool bExpected = Beyond < 0. && bBetween;
+                bool bClipped = clip.Visible && periodic && clip.SegmentCount == 0;
+                for (int k = 0; k < clip.SegmentCount; ++k)
+                {
+                    bClipped = bClipped || IsInSegment(clip.Segments[k], periodic, t);
+                }
+
+                bExpected ? ++Inside : ++Outside;
+                if (bClipped != bExpected) ++Misclipped;
+            }
+        }
+
+        TestTrue(FString::Printf(TEXT("Some %s orbits clipped to depth"), Kind), Clipped > Orbits / 4);
+        TestTrue(FString::Printf(TEXT("Some %s samples between near and far, on screen"), Kind), Inside > 0);
+        TestTrue(FString::Printf(TEXT("Some %s samples not"), Kind), Outside > 0);
+        TestEqual(FString::Printf(TEXT("Samples clipped wrongly to depth, %s"), Kind), Misclipped, 0);
+
+        if (!bOrthographic)
+        {
+            TestTrue(TEXT("Some hyperbolas clipped to depth"), Hyperbolas > 0);
+        }
+    }
+
+    return true;
+}
+
+#endif
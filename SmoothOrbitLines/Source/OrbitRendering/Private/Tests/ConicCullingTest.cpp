@@ -0,0 +1,112 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+// -----------------------------------------------------------------------------
+// ConicCullingTest.cpp
+//
+// Culling is conservative: an orbit that's on screen once it's projected and
+// clipped must never be culled.  Random (solar system scale) orbits, culled
+// for wide views and for zoomed in views looking at a point on one of them,
+// as Orbit.BenchmarkCulling.
+// -----------------------------------------------------------------------------
+
+#include "Misc/AutomationTest.h"
+#include "OrbitProjectorComponent.h"
+#include "Math/RandomStream.h"
+#include "OrbitTestFixtures.h"
+#include "Conics/ProjectEllipsesToPlane.h"
+#include "Conics/ClipConicsToFrustum.h"
+#include "Conics/CullEllipsesToFrustum.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ConicCullingTest
+{
+    using namespace OrbitTestFixtures;
+
+    const int Count = 20000;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FConicCullingTest, "OrbitRendering.Culling.Conservative", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FConicCullingTest::RunTest(const FString& Parameters)
+{
+    using namespace ConicCullingTest;
+
+    FRandomStream Random(1234);
+
+    EllipseBatch<double> ellipses;
+    MakeEllipses(Random, Count, ellipses);
+
+    // (Just for getting at the ellipses, getInputs wants a view)
+    const EllipseProjectionView<double> origin{ Vector3<double>::Zero(), Vector3<double>::Zero(), Vector3<double>::Unit(2), Vector3<double>::Unit(0), Vector3<double>::Unit(1) };
+
+    std::vector<OrientedBox3<double>> Boxes(Count);
+    for (int i = 0; i < Count; ++i)
+    {
+        const EllipseProjectionInputs<double> inputs = ellipses.getInputs(origin, i);
+        Boxes[i] = GetEllipseBounds(inputs.Ce, inputs.Ue, inputs.Ve, inputs.A, inputs.B);
+    }
+    EllipseBoundingVolumes<double> Volumes;
+    Volumes.Build(std::move(Boxes));
+
+    for (int v = 0; v < 12; ++v)
+    {
+        // A few wide views anywhere, the rest zoomed in on a point on one of
+        // the orbits (so there's something on screen)
+        const bool bWide = v < 4;
+        const FrustumParameters<double> frustum(1000., (bWide ? 90. : 5.) / 180. * pi<double>, 16. / 9.);
+
+        EllipseProjectionView<double> view;
+        const Vector3<double> E = RandomVector(Random, 2. * AU);
+
+        if (bWide)
+        {
+            SetView(E, RandomDirection(Random), frustum.z, view);
+        }
+        else
+        {
+            const EllipseProjectionInputs<double> target = ellipses.getInputs(origin, Random.RandHelper(Count));
+            const double t = twopi<double> * Random.FRand();
+            SetView(E, E - (target.Ce + target.A * cos(t) * target.Ue + target.B * sin(t) * target.Ve), frustum.z, view);
+        }
+
+        std::vector<int> Visible;
+        Volumes.Cull(GetViewFrustum(view.E, view.Np, view.Up, view.Vp, frustum, Volumes.GetFarDistance(view.E)), Visible);
+
+        std::vector<bool> Kept(Count, false);
+        for (int i : Visible)
+        {
+            Kept[i] = true;
+        }
+
+        // Everything, the way the projector would without culling
+        ConicProjectionBatch<double> projections;
+        ProjectEllipsesToPlane(view, ellipses, projections);
+
+        std::vector<ConicClip<double>> clips;
+        ClipConicsToFrustum(frustum, projections, clips);
+
+        int OnScreen = 0;
+        int CulledOnScreen = 0;
+        for (int i = 0; i < Count; ++i)
+        {
+            if (!clips[i].Visible) continue;
+
+            ++OnScreen;
+            if (!Kept[i]) ++CulledOnScreen;
+        }
+
+        TestTrue(FString::Printf(TEXT("Something on screen in view %d"), v), OnScreen > 0);
+        TestEqual(FString::Printf(TEXT("Orbits on screen but culled in view %d"), v), CulledOnScreen, 0);
+
+        // Zoomed in, it has to actually cull something
+        if (!bWide)
+        {
+            TestTrue(FString::Printf(TEXT("Most orbits culled in view %d"), v), (int)Visible.size() < Count / 2);
+        }
+    }
+
+    return true;
+}
+
+#endif
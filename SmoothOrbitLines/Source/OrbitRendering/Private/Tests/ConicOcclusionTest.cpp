@@ -0,0 +1,320 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+// -----------------------------------------------------------------------------
+// ConicOcclusionTest.cpp
+//
+// OccludeConicBySpheres against a ray cast.  Points all the way round random
+// orbits are cast at from the eye (or, orthographic, from the viewer's side
+// along the view axis); a point is hidden if the sight line meets a sphere
+// before it gets to the point.  A hidden point's image can't be in the
+// segments that are left, and one that isn't hidden, and was in the segments
+// that went in, has to be.  Whole ellipses (no segments), ellipses clipped
+// to a zoomed in screen, hyperbolas (the eye inside the orbit), and
+// orthographic views.
+// -----------------------------------------------------------------------------
+
+#include "Misc/AutomationTest.h"
+#include "OrbitProjectorComponent.h"
+#include "Math/RandomStream.h"
+#include "OrbitTestFixtures.h"
+#include "Conics/ProjectEllipseToPlaneClosedForm.h"
+#include "Conics/ProjectEllipseToPlaneOrthographic.h"
+#include "Conics/ClipConicsToFrustum.h"
+#include "Conics/OccludeConicBySpheres.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ConicOcclusionTest
+{
+    using namespace OrbitTestFixtures;
+
+    const int Count = 200;
+
+    // Points cast at, round each orbit (or, zoomed in, round where it's
+    // looking.)  Where one's neighbors don't agree with it (it's at a
+    // stretch's end), it could go either way.
+    const int Samples = 4096;
+    const double ZoomedSpan = 0.1;
+
+    enum class EScene
+    {
+        Whole,
+        Clipped,
+        Hyperbola,
+        Orthographic
+    };
+
+    struct FOcclusionCounts
+    {
+        int Conics = 0;
+        int Occluded = 0;
+        int Hidden = 0;
+        int Shown = 0;
+        int HiddenInSegments = 0;
+        int ShownNotInSegments = 0;
+        int Unreported = 0;
+    };
+
+    // The orbit's point at eccentric anomaly E
+    Vector3<double> OrbitPoint(const EllipseProjectionInputs<double>& inputs, double E)
+    {
+        return inputs.Ce + inputs.A * cos(E) * inputs.Ue + inputs.B * sin(E) * inputs.Ve;
+    }
+
+    // Does the sight line to X meet the sphere before X does?  Where it
+    // enters it, |R + s D - S| = r, is the smaller root of a quadratic in s.
+    // Perspective, R is the eye and the point is at s = 1; orthographic, the
+    // line comes in along -Np from as far off as it likes, to X at s = 0.
+    bool IsHidden(const EllipseProjectionView<double>& view, bool orthographic, const OccludingSphere<double>& sphere, const Vector3<double>& X)
+    {
+        const Vector3<double> R = orthographic ? X : view.E;
+        const Vector3<double> D = orthographic ? view.Np : X - view.E;
+        const Vector3<double> W = R - sphere.Center;
+
+        const double a = Dot(D, D);
+        const double b = Dot(D, W);
+        const double c = Dot(W, W) - sphere.Radius * sphere.Radius;
+        const double Discriminant = b * b - a * c;
+        if (Discriminant < 0.) return false;
+
+        if (orthographic)
+        {
+            // Anywhere on the viewer's side of X (or X in it)
+            return (-b + sqrt(Discriminant)) / a >= 0.;
+        }
+
+        const double Enter = (-b - sqrt(Discriminant)) / a;
+        return Enter > 0. && Enter <= 1.;
+    }
+
+    // The image conic's t for an orbit point, or false if it's behind the
+    // eye, or on the branch that isn't drawn.  (Found from where it lands,
+    // not by any of the occlusion's own working.)
+    bool ImageParameter(const EllipseProjectionView<double>& view, bool orthographic, const EllipseProjectionOutputs<double>& outputs, const Vector3<double>& X, double& t)
+    {
+        Vector3<double> q = X - view.Cp;
+        if (!orthographic)
+        {
+            const Vector3<double> w = X - view.E;
+            const Vector3<double> F = view.Cp - view.E;
+            if (Dot(w, view.Np) >= 0.) return false;
+            q = (Dot(F, view.Np) / Dot(w, view.Np)) * w - F;
+        }
+
+        const ConicProjection<double>& p = outputs.projection;
+        const Vector2<double> d = Vector2<double>{ Dot(q, view.Up), Dot(q, view.Vp) } - p.k;
+        const double x = Dot(d, p.u) / p.a;
+        const double y = Dot(d, p.v) / p.b;
+
+        if (outputs.projectionType == ProjectionType::Ellipse)
+        {
+            t = atan2(y, x);
+            if (t < 0.) t += twopi<double>;
+            return true;
+        }
+
+        const double sign = outputs.projectionType == ProjectionType::NegativeHyperbola ? -1. : 1.;
+        t = asinh(sign * y);
+        return sign * x > 0.;
+    }
+
+    bool InSegments(const std::vector<ConicSegment<double>>& segments, ProjectionType projectionType, double t)
+    {
+        for (const ConicSegment<double>& segment : segments)
+        {
+            if (projectionType == ProjectionType::Ellipse)
+            {
+                double s = fmod(t - segment.SegmentStart, twopi<double>);
+                if (s < 0.) s += twopi<double>;
+                if (s <= segment.SegmentLength) return true;
+            }
+            else if (t >= segment.SegmentStart && t <= segment.SegmentStart + segment.SegmentLength)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // A view for the scene, of orbit i, looking at its point at Look
+    void MakeSceneView(FRandomStream& Random, EScene Scene, const EllipseProjectionInputs<double>& orbit, double Look, EllipseProjectionView<double>& view)
+    {
+        const Vector3<double> Target = OrbitPoint(orbit, Look);
+        Vector3<double> E;
+
+        switch (Scene)
+        {
+        case EScene::Whole:
+        case EScene::Orthographic:
+            // Well off the orbit's plane, all of it in front
+            E = orbit.Ce + 3. * orbit.A * orbit.Ne + RandomVector(Random, orbit.B);
+            SetView(E, E - orbit.Ce, 1000., view);
+            break;
+        case EScene::Clipped:
+            // A few degrees of it, from well off its plane (so it's still an
+            // ellipse)
+            E = orbit.Ne + 0.2 * RandomDirection(Random);
+            Normalize(E);
+            E = Target + orbit.A * Random.FRandRange(0.5f, 2.f) * E;
+            SetView(E, E - Target, 1000., view);
+            break;
+        case EScene::Hyperbola:
+            // Inside it, a little off its plane
+            E = orbit.Ce + RandomVector(Random, 0.3 * orbit.B) + Random.FRandRange(-0.05f, 0.05f) * orbit.B * orbit.Ne;
+            SetView(E, E - Target, 1000., view);
+            break;
+        }
+    }
+
+    void CheckScene(FRandomStream& Random, EScene Scene, FOcclusionCounts& Counts)
+    {
+        const bool bOrthographic = Scene == EScene::Orthographic;
+        const double FovDegrees = Scene == EScene::Clipped ? 5. : 90.;
+
+        EllipseBatch<double> ellipses;
+        MakeEllipses(Random, Count, ellipses);
+
+        for (int i = 0; i < Count; ++i)
+        {
+            const double Look = twopi<double> * Random.FRand();
+
+            EllipseProjectionView<double> view;
+            MakeSceneView(Random, Scene, ellipses.getInputs(EllipseProjectionView<double>(), i), Look, view);
+            const EllipseProjectionInputs<double> inputs = ellipses.getInputs(view, i);
+
+            // Orthographic, the plane's units are the orbit's
+            const FrustumParameters<double> frustum(bOrthographic ? 4. * inputs.A : 1000., FovDegrees / 180. * pi<double>, 16. / 9.);
+            const ClipRectangle<double> rectangle(frustum);
+
+            EllipseProjectionOutputs<double> outputs;
+            if (bOrthographic)
+            {
+                ProjectEllipseToPlaneOrthographic(inputs, outputs);
+            }
+            else
+            {
+                ProjectEllipseToPlaneClosedForm(inputs, outputs);
+            }
+
+            const bool bHyperbola = outputs.projectionType == ProjectionType::PositiveHyperbola || outputs.projectionType == ProjectionType::NegativeHyperbola;
+            if (bHyperbola != (Scene == EScene::Hyperbola) || (!bHyperbola && outputs.projectionType != ProjectionType::Ellipse))
+            {
+                continue;
+            }
+
+            // What goes in: all of it, or what's on screen
+            std::vector<ConicSegment<double>> segments;
+            if (Scene == EScene::Clipped || Scene == EScene::Hyperbola)
+            {
+                ConicClip<double> clip;
+                ClipConicToFrustum(rectangle, outputs.projection, outputs.projectionType, clip);
+                if (!clip.Visible || !clip.SegmentCount) continue;
+                segments.assign(clip.Segments, clip.Segments + clip.SegmentCount);
+            }
+            const std::vector<ConicSegment<double>> segmentsIn = segments;
+
+            // Spheres across the sight lines to points near where it's
+            // looking: in front of the orbit, straddling it, or behind it
+            OccludingSphere<double> spheres[3];
+            const int SphereCount = 1 + Random.RandHelper(3);
+            for (int j = 0; j < SphereCount; ++j)
+            {
+                const double Spread = Scene == EScene::Clipped ? 0.01 : 0.5;
+                const Vector3<double> Near = OrbitPoint(inputs, Look + Random.FRandRange(-Spread, Spread));
+                const double Along = Random.FRandRange(0.3f, 1.3f);
+
+                if (bOrthographic)
+                {
+                    spheres[j].Center = Near + (1. - Along) * 2. * inputs.A * view.Np;
+                    spheres[j].Radius = inputs.A * Random.FRandRange(0.02f, 0.3f);
+                }
+                else
+                {
+                    const double Angle = (Scene == EScene::Clipped ? 0.005 : 0.05) * Random.FRandRange(0.2f, 4.f);
+                    spheres[j].Center = view.E + Along * (Near - view.E);
+                    spheres[j].Radius = Along * Length(Near - view.E) * sin(Angle);
+                }
+            }
+
+            bool bVisible = true;
+            const bool bOccluded = OccludeConicBySpheres(view, bOrthographic, rectangle, inputs.Ce, inputs.Ne, outputs.projection, outputs.projectionType, spheres, SphereCount, segments, bVisible);
+
+            ++Counts.Conics;
+            Counts.Occluded += bOccluded;
+
+            // Cast at each point, and at its neighbors
+            auto Cast = [&](int k, bool& bHidden, bool& bIn, double& t)
+            {
+                const double Span = Scene == EScene::Clipped ? ZoomedSpan : twopi<double>;
+                const Vector3<double> X = OrbitPoint(inputs, Look + Span * ((double)k / Samples - 0.5));
+                if (!ImageParameter(view, bOrthographic, outputs, X, t)) return false;
+
+                bHidden = false;
+                for (int j = 0; j < SphereCount; ++j)
+                {
+                    bHidden |= IsHidden(view, bOrthographic, spheres[j], X);
+                }
+                bIn = segmentsIn.empty() || InSegments(segmentsIn, outputs.projectionType, t);
+                return true;
+            };
+
+            bool bAnyHidden = false;
+            for (int k = 0; k < Samples; ++k)
+            {
+                bool bHidden, bIn, bHiddenBefore, bInBefore, bHiddenAfter, bInAfter;
+                double t, tBefore, tAfter;
+                if (!Cast(k, bHidden, bIn, t) || !Cast(k - 1, bHiddenBefore, bInBefore, tBefore) || !Cast(k + 1, bHiddenAfter, bInAfter, tAfter)) continue;
+                if (bHidden != bHiddenBefore || bHidden != bHiddenAfter || bIn != bInBefore || bIn != bInAfter || !bIn) continue;
+
+                const bool bInOut = bVisible && ((outputs.projectionType == ProjectionType::Ellipse && segments.empty()) || InSegments(segments, outputs.projectionType, t));
+
+                if (bHidden)
+                {
+                    bAnyHidden = true;
+                    ++Counts.Hidden;
+                    Counts.HiddenInSegments += bInOut;
+                }
+                else
+                {
+                    ++Counts.Shown;
+                    Counts.ShownNotInSegments += !bInOut;
+                }
+            }
+
+            Counts.Unreported += bAnyHidden && !bOccluded;
+        }
+    }
+
+    void TestScene(FAutomationTestBase& Test, EScene Scene, const TCHAR* Name, int Seed)
+    {
+        FRandomStream Random(Seed);
+
+        FOcclusionCounts Counts;
+        CheckScene(Random, Scene, Counts);
+
+        Test.TestTrue(FString::Printf(TEXT("%s: conics checked"), Name), Counts.Conics > Count / 4);
+        Test.TestTrue(FString::Printf(TEXT("%s: some occluded"), Name), Counts.Occluded > Counts.Conics / 4);
+        Test.TestTrue(FString::Printf(TEXT("%s: hidden points"), Name), Counts.Hidden > 0);
+        Test.TestTrue(FString::Printf(TEXT("%s: shown points"), Name), Counts.Shown > 0);
+        Test.TestEqual(FString::Printf(TEXT("%s: hidden points left in the segments"), Name), Counts.HiddenInSegments, 0);
+        Test.TestEqual(FString::Printf(TEXT("%s: shown points taken out of the segments"), Name), Counts.ShownNotInSegments, 0);
+        Test.TestEqual(FString::Printf(TEXT("%s: conics with hidden points, not reported occluded"), Name), Counts.Unreported, 0);
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FConicOcclusionRayCastTest, "OrbitRendering.Occlusion.RayCast", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FConicOcclusionRayCastTest::RunTest(const FString& Parameters)
+{
+    using namespace ConicOcclusionTest;
+
+    TestScene(*this, EScene::Whole, TEXT("Whole ellipses"), 1234);
+    TestScene(*this, EScene::Clipped, TEXT("Clipped ellipses"), 2345);
+    TestScene(*this, EScene::Hyperbola, TEXT("Hyperbolas"), 3456);
+    TestScene(*this, EScene::Orthographic, TEXT("Orthographic"), 4567);
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,701 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+// -----------------------------------------------------------------------------
+// ConicProjectionTest.cpp
+//
+// The hand reduced projections against the orbit itself, projected onto the
+// plane a point at a time.  Random (but plausible, planetary to outer solar
+// system scale) orbits and views, as Orbit.ValidateProjection.  The
+// ProjectEllipseToPlane template isn't the reference: it inverts a point
+// conic, and loses too many digits at these scales to say much.
+//
+// In float, with camera-relative inputs, the image conic, its clipping and
+// the clip points' true anomalies have to land within a fraction of a pixel
+// (1920 wide, 90 degree fov) of double's, as Orbit.ValidateFloatProjection,
+// for all but one orbit in a thousand.
+//
+// The conic matrix projection (the perifocal dual conic, precomputed, through
+// one congruence) is held to the orbit the same way, and to the closed form.
+// And a coplanar family's members, projected through their shared plane
+// (ConicPlaneFamilies), to each projected on its own.
+// -----------------------------------------------------------------------------
+
+#include "Misc/AutomationTest.h"
+#include "OrbitProjectorComponent.h"
+#include "Math/RandomStream.h"
+#include "OrbitTestFixtures.h"
+#include "Conics/ProjectEllipseToPlaneClosedForm.h"
+#include "Conics/ProjectEllipsesToPlane.h"
+#include "Conics/ProjectConicMatrixToPlane.h"
+#include "Conics/ConicPlaneFamilies.h"
+#include "Conics/ClipEllipseToFrustum.h"
+#include "Conics/ClipHyperbolaToFrustum.h"
+#include "Conics/ProjectionAngleToTrueAnomaly.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ConicProjectionTest
+{
+    using namespace OrbitTestFixtures;
+
+    const int Count = 20000;
+
+    // An orbit and a view of it, anywhere from planetary to outer solar
+    // system scale
+    EllipseProjectionInputs<double> MakeInputs(FRandomStream& Random)
+    {
+        EllipseProjectionView<double> view;
+        view.E = RandomVector(Random, AU * Random.FRandRange(0.01f, 40.f));
+        view.Np = RandomDirection(Random);
+        view.Cp = view.E - (double)Random.FRandRange(1.f, 10000.f) * view.Np;
+        view.Up = UnitCross(Vector3<double>({ 0, 0, 1 }), view.Np);
+        view.Vp = UnitCross(view.Np, view.Up);
+
+        EllipseBatch<double> ellipses;
+        const Vector3<double> Ue = RandomDirection(Random);
+        const Vector3<double> Ve = UnitCross(RandomDirection(Random), Ue);
+        const double A = AU * Random.FRandRange(0.002f, 40.f);
+        const double e = Random.FRandRange(0.f, 0.95f);
+        ellipses.resize(1);
+        ellipses.set(0, -A * e * Ue, Ue, Ve, A, A * sqrt(1. - e * e), twopi<double> * Random.FRand());
+
+        return ellipses.getInputs(view, 0);
+    }
+
+    Vector3<double> EllipsePoint(const EllipseProjectionInputs<double>& inputs, double theta)
+    {
+        return inputs.Ce + inputs.A * cos(theta) * inputs.Ue + inputs.B * sin(theta) * inputs.Ve;
+    }
+
+    // Point on the image conic
+    Vector2<double> ImagePoint(const ConicProjection<double>& p, ProjectionType projectionType, double t)
+    {
+        if (projectionType == ProjectionType::Ellipse)
+        {
+            return p.k + p.a * cos(t) * p.u + p.b * sin(t) * p.v;
+        }
+
+        const double sign = projectionType == ProjectionType::PositiveHyperbola ? 1. : -1.;
+        return p.k + sign * p.a * cosh(t) * p.u + sign * p.b * sinh(t) * p.v;
+    }
+
+    // Where a point lands on the projection plane, false if it's behind the eye
+    bool ProjectPoint(const EllipseProjectionInputs<double>& inputs, const Vector3<double>& P, Vector2<double>& Image)
+    {
+        const Vector3<double> w = P - inputs.E;
+        const Vector3<double> F = inputs.Cp - inputs.E;
+        const double wDotN = Dot(w, inputs.Np);
+
+        const Vector3<double> q = (Dot(F, inputs.Np) / wDotN) * w - F;
+        Image = Vector2<double>{ Dot(q, inputs.Up), Dot(q, inputs.Vp) };
+        return wDotN < 0.;
+    }
+
+    // Distance from x to the conic, to first order
+    double ConicDistance(const ConicProjection<double>& p, ProjectionType projectionType, const Vector2<double>& x)
+    {
+        const Vector2<double> d = x - p.k;
+        const double X = Dot(d, p.u);
+        const double Y = Dot(d, p.v);
+        const double a2 = p.a * p.a;
+        const double b2 = projectionType == ProjectionType::Ellipse ? p.b * p.b : -p.b * p.b;
+
+        const double f = X * X / a2 + Y * Y / b2 - 1.;
+        const Vector2<double> Gradient = (2. * X / a2) * p.u + (2. * Y / b2) * p.v;
+        return FMath::Abs(f) / Length(Gradient);
+    }
+
+    // What the image has to be, from which side of the eye's plane the orbit
+    // is on: in front an ellipse, behind nothing, both a hyperbola (either
+    // branch.)  False if it's too close to touching the plane to say.
+    bool GetExpectedType(const EllipseProjectionInputs<double>& inputs, ProjectionType& Expected)
+    {
+        int InFront = 0;
+        double Nearest = inputs.A;
+
+        for (int j = 0; j < 64; ++j)
+        {
+            const double Side = Dot(inputs.E - EllipsePoint(inputs, j * twopi<double> / 64.), inputs.Np);
+            if (Side > 0.) ++InFront;
+            Nearest = FMath::Min(Nearest, FMath::Abs(Side));
+        }
+
+        Expected = InFront == 64 ? ProjectionType::Ellipse : InFront == 0 ? ProjectionType::NotVisible : ProjectionType::PositiveHyperbola;
+        return Expected == ProjectionType::PositiveHyperbola || Nearest > 1e-3 * inputs.A;
+    }
+
+    // How well a projection holds up against the orbit.  Distances are
+    // relative to the image's size.
+    struct FProjectionErrors
+    {
+        int Checked = 0;
+        int Visible = 0;
+        int TypeMismatches = 0;
+        double WorstConic = 0.;
+        double WorstBody = 0.;
+
+        void Add(const EllipseProjectionInputs<double>& inputs, const EllipseProjectionOutputs<double>& outputs)
+        {
+            ProjectionType Expected;
+            if (GetExpectedType(inputs, Expected))
+            {
+                ++Checked;
+                const ProjectionType Actual = outputs.projectionType == ProjectionType::NegativeHyperbola ? ProjectionType::PositiveHyperbola : outputs.projectionType;
+                if (Actual != Expected) ++TypeMismatches;
+            }
+
+            if (outputs.projectionType == ProjectionType::NotVisible)
+            {
+                return;
+            }
+
+            ++Visible;
+
+            const ConicProjection<double>& p = outputs.projection;
+            const double Scale = FMath::Max(p.a, FMath::Abs(p.b));
+            Vector2<double> Image;
+
+            for (int j = 0; j < 16; ++j)
+            {
+                if (!ProjectPoint(inputs, EllipsePoint(inputs, j * twopi<double> / 16.), Image)) continue;
+                WorstConic = FMath::Max(WorstConic, ConicDistance(p, outputs.projectionType, Image) / Scale);
+            }
+
+            if (FMath::IsFinite(outputs.ThetaLocation) && ProjectPoint(inputs, EllipsePoint(inputs, inputs.TestTheta), Image))
+            {
+                WorstBody = FMath::Max(WorstBody, Length(ImagePoint(p, outputs.projectionType, outputs.ThetaLocation) - Image) / Scale);
+            }
+        }
+    };
+
+    // The ellipse as a conic matrix in its perifocal plane, (Focus; Ue, Ve)
+    struct PerifocalConic
+    {
+        Vector3<double> Focus, Ue, Ve;
+        ConicMatrix<double> DualConic;
+    };
+
+    PerifocalConic MakePerifocalConic(const EllipseProjectionInputs<double>& inputs)
+    {
+        const double ae = sqrt((inputs.A - inputs.B) * (inputs.A + inputs.B));
+        return PerifocalConic{ inputs.Ce + ae * inputs.Ue, inputs.Ue, inputs.Ve, PerifocalDualConic(ae / inputs.A, inputs.B * inputs.B / inputs.A) };
+    }
+
+    void ProjectPerifocalConic(const EllipseProjectionInputs<double>& inputs, const PerifocalConic& conic, EllipseProjectionOutputs<double>& outputs)
+    {
+        const EllipseProjectionView<double> view{ inputs.E, inputs.Cp, inputs.Np, inputs.Up, inputs.Vp };
+        ConicProjection<double>& p = outputs.projection;
+
+        ProjectConicMatrixToPlane(view, conic.Focus, conic.Ue, conic.Ve, conic.DualConic, p);
+
+        ImageConicLocateBody(
+            view,
+            inputs.Ce[0], inputs.Ce[1], inputs.Ce[2],
+            inputs.Ue[0], inputs.Ue[1], inputs.Ue[2],
+            inputs.Ve[0], inputs.Ve[1], inputs.Ve[2],
+            inputs.A, inputs.B,
+            inputs.TestTheta,
+            p.k[0], p.k[1],
+            p.u[0], p.u[1],
+            p.v[0], p.v[1],
+            p.a,
+            p.b,
+            outputs.projectionType,
+            outputs.ThetaLocation
+        );
+    }
+
+    // ------------------------------------------------------------------------
+    // Float
+    // ------------------------------------------------------------------------
+    template<int N>
+    Vector<N, float> ToFloat(const Vector<N, double>& v)
+    {
+        Vector<N, float> Result;
+        for (int i = 0; i < N; ++i) Result[i] = (float)v[i];
+        return Result;
+    }
+
+    template<int N>
+    Vector<N, double> ToDouble(const Vector<N, float>& v)
+    {
+        Vector<N, double> Result;
+        for (int i = 0; i < N; ++i) Result[i] = (double)v[i];
+        return Result;
+    }
+
+    ConicProjection<float> ToFloat(const ConicProjection<double>& p)
+    {
+        return ConicProjection<float>{ ToFloat(p.k), ToFloat(p.u), ToFloat(p.v), (float)p.a, (float)p.b };
+    }
+
+    ConicProjection<double> ToDouble(const ConicProjection<float>& p)
+    {
+        return ConicProjection<double>{ ToDouble(p.k), ToDouble(p.u), ToDouble(p.v), (double)p.a, (double)p.b };
+    }
+
+    // The eye is subtracted in double, before anything's rounded to float
+    EllipseProjectionInputs<float> CameraRelative(const EllipseProjectionInputs<double>& inputs)
+    {
+        return EllipseProjectionInputs<float>(
+            Vector3<float>{ 0.f, 0.f, 0.f }, ToFloat(inputs.Ce - inputs.E), ToFloat(inputs.Ne), ToFloat(inputs.Ue), ToFloat(inputs.Ve),
+            (float)inputs.A, (float)inputs.B,
+            ToFloat(inputs.Cp - inputs.E), ToFloat(inputs.Np), ToFloat(inputs.Up), ToFloat(inputs.Vp),
+            (float)inputs.TestTheta
+        );
+    }
+
+    template<class T>
+    void ClipConic(const FrustumParameters<T>& frustum, const ConicProjection<T>& p, ProjectionType projectionType, std::vector<ConicSegment<T>>& segments)
+    {
+        if (projectionType == ProjectionType::Ellipse) ClipEllipseToFrustum(frustum, p, segments);
+        else ClipHyperbolaToFrustum(frustum, p, projectionType == ProjectionType::PositiveHyperbola, segments);
+    }
+
+    Vector3<double> OrbitPoint(const EllipseProjectionInputs<double>& inputs, double TrueAnomaly)
+    {
+        const double ae = sqrt(inputs.A * inputs.A - inputs.B * inputs.B);
+        const double e = ae / inputs.A;
+        const double r = inputs.A * (1. - e * e) / (1. + e * cos(TrueAnomaly));
+
+        return inputs.Ce + ae * inputs.Ue + r * (cos(TrueAnomaly) * inputs.Ue + sin(TrueAnomaly) * inputs.Ve);
+    }
+
+    // The q quantile (0 to 1) of Values, sorting them
+    double Quantile(std::vector<double>& Values, double q)
+    {
+        if (Values.empty()) return 0.;
+
+        std::sort(Values.begin(), Values.end());
+        return Values[FMath::Min((int)Values.size() - 1, (int)(q * Values.size()))];
+    }
+
+    // How far float strays from double, in pixels, for orbits Smallest to
+    // Largest across: each orbit's worst.  A conic that's classified or
+    // clipped differently (it's on the edge of being one or the other) is
+    // counted rather than measured.
+    struct FFloatErrors
+    {
+        int Visible = 0;
+        int TypeMismatches = 0;
+        int ClipMismatches = 0;
+        std::vector<double> Conic;
+        std::vector<double> Clip;
+        std::vector<double> Anomaly;
+    };
+
+    FFloatErrors GetFloatErrors(FRandomStream& Random, double Smallest, double Largest)
+    {
+        const double z = 1000.;
+        const FrustumParameters<double> Frustum(z, pi<double> / 2., 16. / 9.);
+        const FrustumParameters<float> FloatFrustum((float)Frustum.z, (float)Frustum.fov, (float)Frustum.aspectRatio);
+        const double MaxX = z * tan(Frustum.fov / 2.);
+        const double MaxY = MaxX / Frustum.aspectRatio;
+        const double PixelsPerKm = 960. / MaxX;
+
+        FFloatErrors Errors;
+
+        for (int i = 0; i < Count; ++i)
+        {
+            const double Size = FMath::Exp(FMath::Lerp(FMath::Loge(Smallest), FMath::Loge(Largest), (double)Random.FRand()));
+
+            EllipseProjectionView<double> view;
+            view.E = RandomVector(Random, 1.5 * Size);
+            view.Np = RandomDirection(Random);
+            view.Cp = view.E - z * view.Np;
+            view.Up = UnitCross(Vector3<double>({ 0, 0, 1 }), view.Np);
+            view.Vp = UnitCross(view.Np, view.Up);
+
+            EllipseBatch<double> ellipses;
+            const Vector3<double> Ue = RandomDirection(Random);
+            const Vector3<double> Ve = UnitCross(RandomDirection(Random), Ue);
+            const double A = Size * Random.FRandRange(0.05f, 1.5f);
+            const double e = Random.FRandRange(0.f, 0.95f);
+            ellipses.resize(1);
+            ellipses.set(0, -A * e * Ue, Ue, Ve, A, A * sqrt(1. - e * e), twopi<double> * Random.FRand());
+
+            const EllipseProjectionInputs<double> inputs = ellipses.getInputs(view, 0);
+            const EllipseProjectionInputs<float> floatInputs = CameraRelative(inputs);
+
+            EllipseProjectionOutputs<double> outputs;
+            EllipseProjectionOutputs<float> floatOutputs;
+            ProjectEllipseToPlaneClosedForm(inputs, outputs);
+            ProjectEllipseToPlaneClosedForm(floatInputs, floatOutputs);
+
+            const ProjectionType projectionType = outputs.projectionType;
+
+            if (projectionType == ProjectionType::NotVisible && floatOutputs.projectionType == ProjectionType::NotVisible)
+            {
+                continue;
+            }
+
+            ++Errors.Visible;
+
+            if (projectionType != floatOutputs.projectionType)
+            {
+                ++Errors.TypeMismatches;
+                continue;
+            }
+
+            std::vector<ConicSegment<double>> segments;
+            ClipConic(Frustum, outputs.projection, projectionType, segments);
+
+            // Conic, wherever the double one's on screen
+            const ConicProjection<double> floatConic = ToDouble(floatOutputs.projection);
+            double Worst = -1.;
+            for (const ConicSegment<double>& segment : segments)
+            {
+                for (int j = 0; j <= 16; ++j)
+                {
+                    const Vector2<double> x = ImagePoint(outputs.projection, projectionType, segment.SegmentStart + segment.SegmentLength * j / 16.);
+                    if (FMath::Abs(x[0]) > MaxX || FMath::Abs(x[1]) > MaxY) continue;
+
+                    Worst = FMath::Max(Worst, ConicDistance(floatConic, projectionType, x) * PixelsPerKm);
+                }
+            }
+            if (Worst >= 0.) Errors.Conic.push_back(Worst);
+
+            // Clipping, the same conic in float
+            EllipseProjectionOutputs<float> roundedOutputs;
+            roundedOutputs.projection = ToFloat(outputs.projection);
+            roundedOutputs.projectionType = projectionType;
+            roundedOutputs.ThetaLocation = (float)outputs.ThetaLocation;
+
+            std::vector<ConicSegment<float>> floatSegments;
+            ClipConic(FloatFrustum, roundedOutputs.projection, projectionType, floatSegments);
+
+            if (floatSegments.size() != segments.size())
+            {
+                ++Errors.ClipMismatches;
+                continue;
+            }
+
+            Worst = -1.;
+            for (int j = 0; j < (int)segments.size(); ++j)
+            {
+                for (int End = 0; End < 2; ++End)
+                {
+                    const double t = segments[j].SegmentStart + End * segments[j].SegmentLength;
+                    const double floatT = (double)floatSegments[j].SegmentStart + End * (double)floatSegments[j].SegmentLength;
+                    const Vector2<double> Difference = ImagePoint(outputs.projection, projectionType, t) - ImagePoint(outputs.projection, projectionType, floatT);
+                    Worst = FMath::Max(Worst, Length(Difference) * PixelsPerKm);
+                }
+            }
+            if (Worst >= 0.) Errors.Clip.push_back(Worst);
+
+            // True anomaly, the same clip points in float
+            Worst = -1.;
+            for (const ConicSegment<double>& segment : segments)
+            {
+                for (int End = 0; End < 2; ++End)
+                {
+                    const double t = segment.SegmentStart + End * segment.SegmentLength;
+                    double TrueAnomaly;
+                    float FloatTrueAnomaly;
+                    if (!ProjectionAngleToTrueAnomaly(inputs, outputs, t, TrueAnomaly)) continue;
+                    if (!ProjectionAngleToTrueAnomaly(floatInputs, roundedOutputs, (float)t, FloatTrueAnomaly)) continue;
+
+                    Vector2<double> Image, FloatImage;
+                    if (!ProjectPoint(inputs, OrbitPoint(inputs, TrueAnomaly), Image)) continue;
+                    if (!ProjectPoint(inputs, OrbitPoint(inputs, (double)FloatTrueAnomaly), FloatImage)) continue;
+
+                    Worst = FMath::Max(Worst, Length(FloatImage - Image) * PixelsPerKm);
+                }
+            }
+            if (Worst >= 0.) Errors.Anomaly.push_back(Worst);
+        }
+
+        return Errors;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FConicProjectionClosedFormTest, "OrbitRendering.Projection.ClosedForm", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FConicProjectionClosedFormTest::RunTest(const FString& Parameters)
+{
+    using namespace ConicProjectionTest;
+
+    FRandomStream Random(4321);
+    FProjectionErrors Errors;
+
+    for (int i = 0; i < Count; ++i)
+    {
+        const EllipseProjectionInputs<double> inputs = MakeInputs(Random);
+
+        EllipseProjectionOutputs<double> outputs;
+        ProjectEllipseToPlaneClosedForm(inputs, outputs);
+        Errors.Add(inputs, outputs);
+    }
+
+    // The worst of these runs to about 1e-11 (conic) and 1e-8 (body, where
+    // it's near a hyperbola's asymptote), a few orders short of the limits.
+    TestTrue(TEXT("Most orbits checked"), Errors.Checked > Count * 99 / 100);
+    TestTrue(TEXT("Some orbits visible"), Errors.Visible > Count / 10);
+    TestEqual(TEXT("Orbits classified wrongly"), Errors.TypeMismatches, 0);
+    TestEqual(TEXT("Worst distance from the orbit to its image (relative)"), Errors.WorstConic, 0., 1e-9);
+    TestEqual(TEXT("Worst distance from the body to its image (relative)"), Errors.WorstBody, 0., 1e-6);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FConicProjectionMatrixTest, "OrbitRendering.Projection.ConicMatrix", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FConicProjectionMatrixTest::RunTest(const FString& Parameters)
+{
+    using namespace ConicProjectionTest;
+
+    FRandomStream Random(4321);
+    FProjectionErrors Errors;
+    int TypeMismatches = 0;
+    double WorstDifference = 0.;
+
+    for (int i = 0; i < Count; ++i)
+    {
+        const EllipseProjectionInputs<double> inputs = MakeInputs(Random);
+
+        EllipseProjectionOutputs<double> outputs, closedForm;
+        ProjectPerifocalConic(inputs, MakePerifocalConic(inputs), outputs);
+        ProjectEllipseToPlaneClosedForm(inputs, closedForm);
+        Errors.Add(inputs, outputs);
+
+        if (outputs.projectionType != closedForm.projectionType)
+        {
+            ++TypeMismatches;
+            continue;
+        }
+
+        if (outputs.projectionType == ProjectionType::NotVisible)
+        {
+            continue;
+        }
+
+        const ConicProjection<double>& p = outputs.projection;
+        const ConicProjection<double>& q = closedForm.projection;
+        const double Scale = FMath::Max(q.a, FMath::Abs(q.b));
+        WorstDifference = FMath::Max(WorstDifference, FMath::Max3(
+            FMath::Abs(p.a - q.a) / q.a,
+            FMath::Abs(p.b - q.b) / FMath::Abs(q.b),
+            Length(p.k - q.k) / Scale
+        ));
+    }
+
+    // About as good as the closed form: 1e-10 or so (conic), 1e-7 (body.)
+    // Against the closed form, a thin image's minor axis has the least to
+    // go on, and differs by up to 1e-6 of itself.
+    TestTrue(TEXT("Most orbits checked"), Errors.Checked > Count * 99 / 100);
+    TestTrue(TEXT("Some orbits visible"), Errors.Visible > Count / 10);
+    TestEqual(TEXT("Orbits classified wrongly"), Errors.TypeMismatches, 0);
+    TestEqual(TEXT("Orbits classified differently from the closed form"), TypeMismatches, 0);
+    TestEqual(TEXT("Worst distance from the orbit to its image (relative)"), Errors.WorstConic, 0., 1e-9);
+    TestEqual(TEXT("Worst distance from the body to its image (relative)"), Errors.WorstBody, 0., 1e-6);
+    TestEqual(TEXT("Worst difference from the closed form (relative)"), WorstDifference, 0., 1e-5);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FConicProjectionFloatTest, "OrbitRendering.Projection.Float", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FConicProjectionFloatTest::RunTest(const FString& Parameters)
+{
+    using namespace ConicProjectionTest;
+
+    FRandomStream Random(2468);
+
+    struct FScale
+    {
+        const TCHAR* Name;
+        double Smallest, Largest;
+    };
+
+    const FScale Scales[] =
+    {
+        { TEXT("planetary"), 1e4, 1e7 },
+        { TEXT("inner"), 1e7, 5. * AU },
+        { TEXT("outer"), 5. * AU, 40. * AU }
+    };
+
+    // A hundredth of a pixel is typical, a tenth the worst in a thousand (the
+    // odd orbit that's a sliver, or all but edge on, does worse.)  Both have
+    // a few times that to spare.
+    const double Typical = 0.05;
+    const double Worst = 0.25;
+
+    for (const FScale& Scale : Scales)
+    {
+        FFloatErrors Errors = GetFloatErrors(Random, Scale.Smallest, Scale.Largest);
+
+        TestTrue(FString::Printf(TEXT("Some %s orbits visible"), Scale.Name), Errors.Visible > Count / 10);
+        TestTrue(FString::Printf(TEXT("Few %s orbits classified differently"), Scale.Name), Errors.TypeMismatches <= Errors.Visible / 1000);
+        TestTrue(FString::Printf(TEXT("Few %s orbits clipped differently"), Scale.Name), Errors.ClipMismatches <= Errors.Visible / 1000);
+
+        TestEqual(FString::Printf(TEXT("99%% of %s conic differences (pixels)"), Scale.Name), Quantile(Errors.Conic, 0.99), 0., Typical);
+        TestEqual(FString::Printf(TEXT("99.9%% of %s conic differences (pixels)"), Scale.Name), Quantile(Errors.Conic, 0.999), 0., Worst);
+        TestEqual(FString::Printf(TEXT("99%% of %s clip point differences (pixels)"), Scale.Name), Quantile(Errors.Clip, 0.99), 0., Typical);
+        TestEqual(FString::Printf(TEXT("99.9%% of %s clip point differences (pixels)"), Scale.Name), Quantile(Errors.Clip, 0.999), 0., Worst);
+        TestEqual(FString::Printf(TEXT("99%% of %s true anomaly differences (pixels)"), Scale.Name), Quantile(Errors.Anomaly, 0.99), 0., Typical);
+        TestEqual(FString::Printf(TEXT("99.9%% of %s true anomaly differences (pixels)"), Scale.Name), Quantile(Errors.Anomaly, 0.999), 0., Worst);
+    }
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FConicProjectionPlaneFamiliesTest, "OrbitRendering.Projection.PlaneFamilies", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FConicProjectionPlaneFamiliesTest::RunTest(const FString& Parameters)
+{
+    using namespace ConicProjectionTest;
+
+    FRandomStream Random(8642);
+
+    const int Families = 40;
+    const int Views = 50;
+    const double Tolerance = ConicPlaneFamilies<double>::DefaultCoplanarTolerance;
+
+    // Each family: a focus and a plane, and 2 to 12 conics in it at any angle
+    // (normals from their own axes, so they only agree to rounding.)  Then
+    // some on their own: a plane of their own, or tilted well past the
+    // tolerance off a family's.
+    std::vector<ConicPlaneMember<double>> members;
+    std::vector<int> Expected;
+    for (int f = 0; f < Families; ++f)
+    {
+        const Vector3<double> O = RandomVector(Random, 2. * AU);
+        const Vector3<double> N = RandomDirection(Random);
+        const Vector3<double> P = UnitCross(N, RandomDirection(Random));
+        const Vector3<double> Q = UnitCross(N, P);
+
+        const int Size = 2 + Random.RandHelper(11);
+        for (int j = 0; j <= Size; ++j)
+        {
+            const bool bLoner = j == Size;
+            const double Phi = twopi<double> * Random.FRand();
+            const double Tilt = bLoner ? 100. * Tolerance * Random.FRandRange(1.f, 100.f) : 0.;
+
+            ConicPlaneMember<double> member;
+            member.O = O;
+            member.U = cos(Phi) * P + sin(Phi) * Q;
+            member.V = UnitCross(cos(Tilt) * N + sin(Tilt) * UnitCross(N, member.U), member.U);
+            member.N = UnitCross(member.U, member.V);
+
+            const double A = AU * Random.FRandRange(0.001f, 1.f);
+            const double e = Random.FRandRange(0.f, 0.95f);
+            member.DualConic = PerifocalDualConic(e, A * (1. - e * e));
+
+            members.push_back(member);
+            Expected.push_back(bLoner ? -1 : f);
+        }
+    }
+
+    ConicPlaneFamilies<double> families;
+    families.build(members, Tolerance);
+
+    // The families found are the ones made (under any numbering)
+    int Misgrouped = 0;
+    for (int i = 0; i < (int)members.size(); ++i)
+    {
+        for (int j = i + 1; j < (int)members.size(); ++j)
+        {
+            const bool bSame = families.Family[i] >= 0 && families.Family[i] == families.Family[j];
+            if (bSame != (Expected[i] >= 0 && Expected[i] == Expected[j])) ++Misgrouped;
+        }
+    }
+    TestEqual(TEXT("Families found"), (int)families.Planes.size(), Families);
+    TestEqual(TEXT("Pairs of conics grouped wrongly"), Misgrouped, 0);
+
+    int Projected = 0;
+    int Others = 0;
+    int WrongOthers = 0;
+    int TypeMismatches = 0;
+    double WorstDifference = 0.;
+    double WorstAxis = 0.;
+
+    for (int v = 0; v < Views; ++v)
+    {
+        EllipseProjectionView<double> view;
+        MakeView(Random, 1000., view);
+
+        // Any subset of the conics in view, in any order
+        std::vector<int> indices;
+        for (int i = 0; i < (int)members.size(); ++i)
+        {
+            if (Random.FRand() < 0.8f) indices.push_back(i);
+        }
+        for (int i = (int)indices.size() - 1; i > 0; --i)
+        {
+            std::swap(indices[i], indices[Random.RandHelper(i + 1)]);
+        }
+
+        ConicProjectionBatch<double> projections;
+        projections.resize(indices.size());
+        std::vector<int> others;
+        families.project(view, indices, projections, others);
+
+        // Left for the lanes: those in no family, or the only one of theirs in
+        // view
+        std::vector<int> inView(families.Planes.size(), 0);
+        for (int i : indices)
+        {
+            if (families.Family[i] >= 0) ++inView[families.Family[i]];
+        }
+
+        std::vector<bool> bOther(indices.size(), false);
+        for (int lane : others)
+        {
+            bOther[lane] = true;
+        }
+
+        for (int lane = 0; lane < (int)indices.size(); ++lane)
+        {
+            const int i = indices[lane];
+            const int f = families.Family[i];
+            if (bOther[lane] != (f < 0 || inView[f] < 2)) ++WrongOthers;
+            if (bOther[lane])
+            {
+                ++Others;
+                continue;
+            }
+
+            const ConicPlaneMember<double>& member = members[i];
+            ConicProjection<double> q;
+            ProjectConicMatrixToPlane(view, member.O, member.U, member.V, member.DualConic, q);
+
+            ConicProjection<double> p;
+            projections.getProjection(lane, p);
+            ++Projected;
+
+            // Ellipse or hyperbola (b < 0), the same
+            if ((p.b < 0.) != (q.b < 0.))
+            {
+                ++TypeMismatches;
+                continue;
+            }
+
+            const double Scale = FMath::Max(q.a, FMath::Abs(q.b));
+            WorstDifference = FMath::Max(WorstDifference, FMath::Max3(
+                FMath::Abs(p.a - q.a) / q.a,
+                FMath::Abs(p.b - q.b) / FMath::Abs(q.b),
+                Length(p.k - q.k) / Scale
+            ));
+
+            // The axes, up to sign (unless it's near enough a circle that
+            // they're anywhere)
+            if (FMath::Abs(FMath::Abs(q.b) - q.a) > 1e-6 * q.a)
+            {
+                WorstAxis = FMath::Max(WorstAxis, 1. - FMath::Abs(Dot(p.u, q.u)));
+            }
+        }
+    }
+
+    // The family's plane and L are its first member's (and largest's), not
+    // each conic's own, so they round differently: by a few 1e-10 at worst.
+    TestTrue(TEXT("Conics projected through their family"), Projected > 0);
+    TestTrue(TEXT("Conics left for the lanes"), Others > 0);
+    TestEqual(TEXT("Conics left for the lanes wrongly"), WrongOthers, 0);
+    TestEqual(TEXT("Conics classified differently from their own projection"), TypeMismatches, 0);
+    TestEqual(TEXT("Worst difference from their own projection (relative)"), WorstDifference, 0., 1e-8);
+    TestEqual(TEXT("Worst axis difference from their own projection (1 - cos)"), WorstAxis, 0., 1e-9);
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,430 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+// -----------------------------------------------------------------------------
+// ConicTessellationTest.cpp
+//
+// Tessellating image conics.  GetConicTessellation's lines have to stay
+// within its tolerance of the conic (to a little slack), and take fewer of
+// them than evenly spaced lines that stray no further, over random
+// segments of ellipses and hyperbolas in pixels, as
+// Orbit.BenchmarkTessellation.  Anything it can't step along (not finite, or
+// degenerate) is evenly spaced.
+// The rational Bezier pieces (ConicBezier.h) are exactly the conic, so their
+// points have to land on it to rounding, as Orbit.BenchmarkBezier.
+// TessellateConicLines' corners, tangents and distances have to match the
+// same built a vertex at a time in double, with sin/cos (or cosh/sinh) at
+// each point, as Orbit.BenchmarkConicLines.
+// -----------------------------------------------------------------------------
+
+#include "Misc/AutomationTest.h"
+#include "OrbitProjectorComponent.h"
+#include "Math/RandomStream.h"
+#include "OrbitTestFixtures.h"
+#include "GTE/Mathematics/Vector2.h"
+#include "Conics/Conics.h"
+#include "Conics/ConicTessellation.h"
+#include "Conics/ConicBezier.h"
+#include "Conics/TessellateConicLines.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ConicTessellationTest
+{
+    using namespace OrbitTestFixtures;
+
+    const int Count = 200;
+
+    // The renderer's default, in pixels
+    const double Tolerance = 0.25;
+
+    // The steps are sized from the lines' length and the curvature, to first
+    // order, so a line can stray a little past the tolerance
+    const double Slack = 1.05;
+
+    // How far the lines between params stray from the conic (a cos t, b sin t)
+    // or (a cosh t, b sinh t), sampled
+    double GetTessellationDeviation(bool Hyperbola, double a, double b, const std::vector<double>& Params)
+    {
+        auto Point = [&](double t)
+        {
+            return Hyperbola ? Vector2<double>{ a * std::cosh(t), b * std::sinh(t) } : Vector2<double>{ a * std::cos(t), b * std::sin(t) };
+        };
+
+        double Deviation = 0.;
+        for (size_t i = 0; i + 1 < Params.size(); ++i)
+        {
+            const Vector2<double> A = Point(Params[i]);
+            const Vector2<double> B = Point(Params[i + 1]);
+            const Vector2<double> AtoB = B - A;
+            const double LengthSquared = Dot(AtoB, AtoB);
+
+            for (int j = 1; j < 32; ++j)
+            {
+                const Vector2<double> P = Point(Params[i] + (Params[i + 1] - Params[i]) * j / 32.);
+                const double u = LengthSquared > 0. ? FMath::Clamp(Dot(P - A, AtoB) / LengthSquared, 0., 1.) : 0.;
+                Deviation = FMath::Max(Deviation, Length(A + u * AtoB - P));
+            }
+        }
+        return Deviation;
+    }
+
+    void MakeEven(double Start, double Length, int Lines, std::vector<double>& Params)
+    {
+        Params.resize(Lines + 1);
+        for (int i = 0; i <= Lines; ++i)
+        {
+            Params[i] = Start + Length * i / Lines;
+        }
+    }
+
+    // The fewest evenly spaced lines that stray no further than Deviation (by
+    // bisection)
+    int GetEvenLines(bool Hyperbola, double a, double b, double Start, double Length, double Deviation)
+    {
+        std::vector<double> Even;
+        auto Strays = [&](int Lines)
+        {
+            MakeEven(Start, Length, Lines, Even);
+            return GetTessellationDeviation(Hyperbola, a, b, Even) > Deviation;
+        };
+
+        int Hi = 1;
+        while (Strays(Hi)) Hi *= 2;
+
+        int Lo = Hi / 2;
+        while (Hi - Lo > 1)
+        {
+            const int Mid = (Lo + Hi) / 2;
+            if (Strays(Mid)) Lo = Mid;
+            else Hi = Mid;
+        }
+        return Hi;
+    }
+
+    // Bezier points and the conic are in pixels, out to a few hundred thousand
+    // along a hyperbola's arm, so this is rounding
+    const double BezierTolerance = 1e-6;
+
+    // The points are stepped, so they drift with how far out they are (a few
+    // hundred thousand pixels along a hyperbola's arm.)  Corners are relative
+    // to that, tangents are unit vectors, distances relative to the
+    // distance.  All of it rounding.
+    const double LinesTolerance = 1e-9;
+
+    // A rotation and translation, standing in for the renderer's world to
+    // local transform
+    struct FLocalTransform
+    {
+        Vector3<double> Rows[3];
+        Vector3<double> Translation;
+
+        Vector3<double> TransformVector(const Vector3<double>& V) const
+        {
+            return Vector3<double>{ Dot(Rows[0], V), Dot(Rows[1], V), Dot(Rows[2], V) };
+        }
+
+        Vector3<double> TransformPosition(const Vector3<double>& P) const
+        {
+            return TransformVector(P) + Translation;
+        }
+    };
+
+    // Evenly spaced from Start, and Lines of them
+    bool IsEven(double Start, double Length, int Lines, const std::vector<double>& Params)
+    {
+        if ((int)Params.size() != Lines + 1) return false;
+
+        for (int i = 0; i <= Lines; ++i)
+        {
+            if (Params[i] != Start + Length * i / Lines) return false;
+        }
+        return true;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FConicTessellationTest, "OrbitRendering.Tessellation.Curvature", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FConicTessellationTest::RunTest(const FString& Parameters)
+{
+    using namespace ConicTessellationTest;
+
+    FRandomStream Random(1234);
+    std::vector<double> Params;
+
+    for (int h = 0; h < 2; ++h)
+    {
+        const bool Hyperbola = h == 1;
+        const TCHAR* Name = Hyperbola ? TEXT("hyperbola") : TEXT("ellipse");
+
+        int64 Lines = 0;
+        int64 EvenLines = 0;
+        int MoreThanEven = 0;
+        double WorstDeviation = 0.;
+
+        for (int i = 0; i < Count; ++i)
+        {
+            // 10 to 5000 pixels across, and anywhere from round to very flat
+            double a = FMath::Exp(Random.FRandRange(FMath::Loge(10.f), FMath::Loge(5000.f)));
+            double b = a * FMath::Exp(Random.FRandRange(FMath::Loge(0.02f), 0.f));
+            if (Hyperbola && Random.FRand() < 0.5f) Swap(a, b);
+
+            double Start = Hyperbola ? Random.FRandRange(-8.f, 0.f) : Random.FRandRange(0.f, twopi<float>);
+            double Length = Hyperbola ? Random.FRandRange(0.5f, 16.f) : Random.FRandRange(0.2f, twopi<float>);
+            if (Random.FRand() < 0.5f)
+            {
+                Start += Length;
+                Length = -Length;
+            }
+
+            GetConicTessellation(Hyperbola, a, b, Start, Length, Tolerance, 100000, Params);
+
+            const double Deviation = GetTessellationDeviation(Hyperbola, a, b, Params);
+            const int Even = GetEvenLines(Hyperbola, a, b, Start, Length, Deviation);
+
+            WorstDeviation = FMath::Max(WorstDeviation, Deviation);
+            Lines += Params.size() - 1;
+            EvenLines += Even;
+            if ((int)Params.size() - 1 > Even + Even / 2 + 1) ++MoreThanEven;
+        }
+
+        // A segment that's only a pixel or so thick can take a few more than
+        // evenly spaced (a line's as good as a curve there), but overall it's
+        // a third fewer for ellipses, two thirds for hyperbolas.
+        TestEqual(FString::Printf(TEXT("Worst %s deviation (pixels)"), Name), WorstDeviation, 0., Slack * Tolerance);
+        TestEqual(FString::Printf(TEXT("%s segments taking half again more lines than evenly spaced"), Name), MoreThanEven, 0);
+        TestTrue(FString::Printf(TEXT("A quarter fewer %s lines than evenly spaced"), Name), 4 * Lines < 3 * EvenLines);
+    }
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FConicTessellationFallbackTest, "OrbitRendering.Tessellation.Fallback", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FConicTessellationFallbackTest::RunTest(const FString& Parameters)
+{
+    using namespace ConicTessellationTest;
+
+    const double NaN = std::numeric_limits<double>::quiet_NaN();
+    const double Infinity = std::numeric_limits<double>::infinity();
+    const int MaxLines = 64;
+    std::vector<double> Params;
+
+    for (int h = 0; h < 2; ++h)
+    {
+        const bool Hyperbola = h == 1;
+        const TCHAR* Name = Hyperbola ? TEXT("hyperbola") : TEXT("ellipse");
+
+        // Not finite, or nothing to step along: evenly spaced
+        GetConicTessellation(Hyperbola, NaN, 100., 0., 1., Tolerance, MaxLines, Params);
+        TestTrue(FString::Printf(TEXT("NaN %s axis evenly spaced"), Name), IsEven(0., 1., MaxLines, Params));
+
+        GetConicTessellation(Hyperbola, Infinity, 100., 0., 1., Tolerance, MaxLines, Params);
+        TestTrue(FString::Printf(TEXT("Infinite %s axis evenly spaced"), Name), IsEven(0., 1., MaxLines, Params));
+
+        GetConicTessellation(Hyperbola, 0., 100., 0., 1., Tolerance, MaxLines, Params);
+        TestTrue(FString::Printf(TEXT("Degenerate %s evenly spaced"), Name), IsEven(0., 1., MaxLines, Params));
+
+        GetConicTessellation(Hyperbola, 100., 50., 0., 1., NaN, MaxLines, Params);
+        TestTrue(FString::Printf(TEXT("NaN %s tolerance evenly spaced"), Name), IsEven(0., 1., MaxLines, Params));
+
+        GetConicTessellation(Hyperbola, 100., 50., 0., 1., 0., MaxLines, Params);
+        TestTrue(FString::Printf(TEXT("No %s tolerance evenly spaced"), Name), IsEven(0., 1., MaxLines, Params));
+
+        GetConicTessellation(Hyperbola, 100., 50., 0., Infinity, Tolerance, MaxLines, Params);
+        TestEqual(FString::Printf(TEXT("Infinite %s span's vertices"), Name), (int)Params.size(), MaxLines + 1);
+
+        GetConicTessellation(Hyperbola, 100., 50., NaN, 1., Tolerance, MaxLines, Params);
+        TestEqual(FString::Printf(TEXT("NaN %s start's vertices"), Name), (int)Params.size(), MaxLines + 1);
+
+        // Finite, but too fine for MaxLines: loosened until it fits
+        GetConicTessellation(Hyperbola, 5000., 5000., 0., 1., 1e-6, MaxLines, Params);
+        TestTrue(FString::Printf(TEXT("Too fine a %s tolerance still fits"), Name), (int)Params.size() <= MaxLines + 1);
+        TestTrue(FString::Printf(TEXT("Too fine a %s tolerance ends at the end"), Name), Params.size() > 1 && Params.front() == 0. && Params.back() == 1.);
+    }
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FConicBezierTest, "OrbitRendering.Tessellation.Bezier", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FConicBezierTest::RunTest(const FString& Parameters)
+{
+    using namespace ConicTessellationTest;
+
+    const int Lines = 64;
+    FRandomStream Random(1234);
+
+    ConicBezier<double> Pieces[ConicBezierMaxPieces];
+    std::vector<double> X(Lines + ConicBezierMaxPieces + 1), Y(X.size());
+
+    for (int h = 0; h < 2; ++h)
+    {
+        const bool Hyperbola = h == 1;
+        const TCHAR* Name = Hyperbola ? TEXT("hyperbola") : TEXT("ellipse");
+
+        double WorstError = 0.;
+        double WorstParameter = 0.;
+        double WorstSeam = 0.;
+
+        for (int i = 0; i < Count * 10; ++i)
+        {
+            ConicProjection<double> p;
+            const double Angle = Random.FRandRange(0.f, twopi<float>);
+            p.k = Vector<2, double>{ Random.FRandRange(-500.f, 500.f), Random.FRandRange(-500.f, 500.f) };
+            p.u = Vector<2, double>{ std::cos(Angle), std::sin(Angle) };
+            p.v = Vector<2, double>{ -std::sin(Angle), std::cos(Angle) };
+            p.a = FMath::Exp(Random.FRandRange(FMath::Loge(10.f), FMath::Loge(5000.f)));
+            p.b = p.a * FMath::Exp(Random.FRandRange(FMath::Loge(0.02f), 0.f));
+
+            const double Sign = Random.FRand() < 0.5f ? -1. : 1.;
+            const double Start = Hyperbola ? Random.FRandRange(-6.f, 0.f) : Random.FRandRange(0.f, twopi<float>);
+            const double Span = Hyperbola ? Random.FRandRange(0.2f, 12.f) : Random.FRandRange(0.1f, twopi<float>);
+
+            auto Exact = [&](double t)
+            {
+                return Hyperbola
+                    ? p.k + Sign * (p.a * std::cosh(t) * p.u + p.b * std::sinh(t) * p.v)
+                    : p.k + p.a * std::cos(t) * p.u + p.b * std::sin(t) * p.v;
+            };
+
+            // (The lines are shared out between the pieces the way the renderer does)
+            const int PieceCount = GetConicBeziers(p, Hyperbola, Sign, Start, Span, Pieces);
+            const int TotalLines = FMath::Max(Lines, PieceCount);
+
+            int First = 0;
+            for (int j = 0; j < PieceCount; ++j)
+            {
+                const int Next = (j + 1) * TotalLines / PieceCount;
+                const int PieceLines = Next - First;
+
+                // The next piece starts where this one ends (to rounding, since
+                // each piece's end is its start plus its length)
+                if (j + 1 < PieceCount) WorstSeam = FMath::Max(WorstSeam, Length(Pieces[j + 1].P0 - Pieces[j].P2));
+
+                TessellateConicBezier(Pieces[j], PieceLines, &X[First], &Y[First]);
+                for (int k = 0; k <= PieceLines; ++k)
+                {
+                    const double t = GetConicBezierParameter(Pieces[j], Hyperbola, (double)k / (double)PieceLines);
+                    WorstError = FMath::Max(WorstError, Length(Vector<2, double>{ X[First + k], Y[First + k] } - Exact(t)));
+                }
+                First = Next;
+            }
+
+            // And they cover the segment, end to end
+            WorstParameter = FMath::Max(WorstParameter, std::abs(Pieces[0].start - Start));
+            WorstParameter = FMath::Max(WorstParameter, std::abs(Pieces[PieceCount - 1].start + Pieces[PieceCount - 1].length - (Start + Span)));
+        }
+
+        TestEqual(FString::Printf(TEXT("Worst %s Bezier point off the conic (pixels)"), Name), WorstError, 0., BezierTolerance);
+        TestEqual(FString::Printf(TEXT("Worst %s Bezier end off the segment's"), Name), WorstParameter, 0., 1e-12);
+        TestEqual(FString::Printf(TEXT("Worst gap between %s Bezier pieces (pixels)"), Name), WorstSeam, 0., BezierTolerance);
+    }
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FConicLinesTest, "OrbitRendering.Tessellation.Lines", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FConicLinesTest::RunTest(const FString& Parameters)
+{
+    using namespace ConicTessellationTest;
+
+    const int Lines = 64;
+    const double HalfThickness = 1.;
+    FRandomStream Random(1234);
+
+    FLocalTransform WorldToLocal;
+    WorldToLocal.Rows[0] = RandomDirection(Random);
+    WorldToLocal.Rows[1] = UnitCross(RandomDirection(Random), WorldToLocal.Rows[0]);
+    WorldToLocal.Rows[2] = Cross(WorldToLocal.Rows[0], WorldToLocal.Rows[1]);
+    WorldToLocal.Translation = RandomVector(Random, 1000.);
+    const Vector3<double> Z = RandomDirection(Random);
+
+    std::vector<double> X(Lines + 1), Y(Lines + 1);
+    std::vector<Vector3<double>> Points(Lines + 1);
+    ConicLineVertices<double> Vertices;
+
+    const ProjectionType Types[] = { ProjectionType::Ellipse, ProjectionType::PositiveHyperbola, ProjectionType::NegativeHyperbola };
+    const TCHAR* Names[] = { TEXT("ellipse"), TEXT("positive hyperbola"), TEXT("negative hyperbola") };
+
+    for (int k = 0; k < 3; ++k)
+    {
+        const ProjectionType Type = Types[k];
+        const bool Hyperbola = Type != ProjectionType::Ellipse;
+        const TCHAR* Name = Names[k];
+
+        double WorstCorner = 0.;
+        double WorstTangent = 0.;
+        double WorstDistance = 0.;
+
+        for (int i = 0; i < Count; ++i)
+        {
+            const Vector3<double> U = RandomDirection(Random);
+            const double a = FMath::Exp(Random.FRandRange(FMath::Loge(10.f), FMath::Loge(5000.f)));
+            const Vector3<double> Center = RandomVector(Random, 500.);
+            const Vector3<double> Axis1 = a * U;
+            const Vector3<double> Axis2 = a * FMath::Exp(Random.FRandRange(FMath::Loge(0.02f), 0.f)) * UnitCross(U, Z);
+            const double Start = Hyperbola ? Random.FRandRange(-6.f, 0.f) : Random.FRandRange(0.f, twopi<float>);
+            const double Span = Hyperbola ? Random.FRandRange(0.2f, 12.f) : Random.FRandRange(0.1f, twopi<float>);
+
+            EvaluateUnitConicEvenly(Type, Start, Span, Lines, X.data(), Y.data());
+
+            ConicLineFrame<double> Frame;
+            Frame.Axis1 = Axis1;
+            Frame.Axis2 = Axis2;
+            Frame.Across1 = Cross(Axis1, Z);
+            Frame.Across2 = Cross(Axis2, Z);
+            Frame.LocalCenter = WorldToLocal.TransformPosition(Center);
+            Frame.LocalAxis1 = WorldToLocal.TransformVector(Axis1);
+            Frame.LocalAxis2 = WorldToLocal.TransformVector(Axis2);
+            Frame.LocalAcross1 = WorldToLocal.TransformVector(Frame.Across1);
+            Frame.LocalAcross2 = WorldToLocal.TransformVector(Frame.Across2);
+            Frame.HalfThickness = HalfThickness;
+
+            TessellateConicLines(Frame, X.data(), Y.data(), Lines + 1, Vertices);
+
+            // The reference: each point evaluated, and each vertex's frame
+            // from its line to the next (the last carrying on along the last)
+            for (int j = 0; j <= Lines; ++j)
+            {
+                const double t = Start + Span * j / Lines;
+                const double Sign = Type == ProjectionType::NegativeHyperbola ? -1. : 1.;
+                Points[j] = Hyperbola
+                    ? Center + Sign * (std::cosh(t) * Axis1 + std::sinh(t) * Axis2)
+                    : Center + std::cos(t) * Axis1 + std::sin(t) * Axis2;
+            }
+
+            double Distance = 0.;
+            for (int j = 0; j <= Lines; ++j)
+            {
+                const Vector3<double> Line = j < Lines ? Points[j + 1] - Points[j] : Points[Lines] - Points[Lines - 1];
+                const Vector3<double> TangentX = Line / Length(Line);
+                const Vector3<double> TangentY = UnitCross(Line, Z);
+                const Vector3<double> Left = WorldToLocal.TransformPosition(Points[j] + HalfThickness * TangentY);
+                const Vector3<double> Right = WorldToLocal.TransformPosition(Points[j] - HalfThickness * TangentY);
+
+                auto Get = [j](const std::array<std::vector<double>, 3>& V)
+                {
+                    return Vector3<double>{ V[0][j], V[1][j], V[2][j] };
+                };
+
+                const double Scale = FMath::Max(Length(Points[j] - Center), 1.);
+                WorstCorner = FMath::Max(WorstCorner, Length(Get(Vertices.Left) - Left) / Scale);
+                WorstCorner = FMath::Max(WorstCorner, Length(Get(Vertices.Right) - Right) / Scale);
+                WorstTangent = FMath::Max(WorstTangent, Length(Get(Vertices.TangentX) - TangentX));
+                WorstTangent = FMath::Max(WorstTangent, Length(Get(Vertices.TangentY) - TangentY));
+                WorstDistance = FMath::Max(WorstDistance, FMath::Abs(Vertices.Distance[j] - Distance) / FMath::Max(Distance, 1.));
+
+                Distance += Length(Line);
+            }
+        }
+
+        TestEqual(FString::Printf(TEXT("Worst %s corner (relative)"), Name), WorstCorner, 0., LinesTolerance);
+        TestEqual(FString::Printf(TEXT("Worst %s tangent"), Name), WorstTangent, 0., LinesTolerance);
+        TestEqual(FString::Printf(TEXT("Worst %s distance along the line (relative)"), Name), WorstDistance, 0., LinesTolerance);
+    }
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,75 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+// -----------------------------------------------------------------------------
+// OrbitTestFixtures.h
+//
+// Random orbits and views, shared by the automation tests and the
+// Orbit.Benchmark* console commands (OrbitProjectionBenchmark.cpp.)  Solar
+// system scale, in kilometers.
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Math/RandomStream.h"
+#include "Conics/Conics.h"
+#include "Conics/ProjectEllipsesToPlane.h"
+
+namespace OrbitTestFixtures
+{
+    // Kilometers
+    const double AU = 1.495978707e8;
+
+    inline Vector3<double> RandomVector(FRandomStream& Random, double Scale)
+    {
+        return Vector3<double>{ Scale * Random.FRandRange(-1.f, 1.f), Scale * Random.FRandRange(-1.f, 1.f), Scale * Random.FRandRange(-1.f, 1.f) };
+    }
+
+    inline Vector3<double> RandomDirection(FRandomStream& Random)
+    {
+        Vector3<double> Direction = RandomVector(Random, 1.);
+        Normalize(Direction);
+        return Direction;
+    }
+
+    // Count ellipses, 0.3 to 5 AU across and up to 0.9 eccentric, with a
+    // focus at the origin
+    inline void MakeEllipses(FRandomStream& Random, int Count, EllipseBatch<double>& ellipses)
+    {
+        ellipses.resize(Count);
+
+        for (int i = 0; i < Count; ++i)
+        {
+            const Vector3<double> Ue = RandomDirection(Random);
+            const Vector3<double> Ve = UnitCross(RandomDirection(Random), Ue);
+            const double A = AU * Random.FRandRange(0.3f, 5.f);
+            const double e = Random.FRandRange(0.f, 0.9f);
+
+            ellipses.set(i, -A * e * Ue, Ue, Ve, A, A * sqrt(1. - e * e), twopi<double> * Random.FRand());
+        }
+    }
+
+    // Looking along -Np from E, EyeUp up, the projection plane z in front
+    inline void SetView(const Vector3<double>& E, const Vector3<double>& Np, const Vector3<double>& EyeUp, double z, EllipseProjectionView<double>& view)
+    {
+        view.E = E;
+        view.Np = Np;
+        Normalize(view.Np);
+        view.Cp = view.E - z * view.Np;
+        view.Up = UnitCross(EyeUp, view.Np);
+        view.Vp = UnitCross(view.Np, view.Up);
+    }
+
+    // The same, Z up
+    inline void SetView(const Vector3<double>& E, const Vector3<double>& Np, double z, EllipseProjectionView<double>& view)
+    {
+        SetView(E, Np, Vector3<double>({ 0, 0, 1 }), z, view);
+    }
+
+    // From anywhere within 2 AU of the origin, looking any way
+    inline void MakeView(FRandomStream& Random, double z, EllipseProjectionView<double>& view)
+    {
+        const Vector3<double> E = RandomVector(Random, 2. * AU);
+        const Vector3<double> Np = RandomDirection(Random);
+        SetView(E, Np, z, view);
+    }
+}
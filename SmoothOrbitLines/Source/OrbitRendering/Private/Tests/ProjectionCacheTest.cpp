@@ -0,0 +1,325 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+// -----------------------------------------------------------------------------
+// ProjectionCacheTest.cpp
+//
+// The projection cache's hits, against projecting afresh.  Random orbits are
+// projected for a view, then the camera's moved and turned (and rolled) a
+// little.  Wherever IsCachedProjectionCurrent says the cached image will do,
+// it's carried along with the eye (CarryProjectionView) as
+// TransformOrbitsCached draws it, and every sight line through it has to be
+// within the tolerance of the freshly projected image conic.  Turning only
+// (the eye where it was), the image mustn't move at all.  And turning (and
+// rolling) any way, up to GetGuardBandRadians, mustn't bring any of the
+// frustum's corners out of the GetGuardBandFrustum it was clipped to.
+// -----------------------------------------------------------------------------
+
+#include "Misc/AutomationTest.h"
+#include "OrbitProjectorComponent.h"
+#include "Math/RandomStream.h"
+#include "OrbitTestFixtures.h"
+#include "Conics/ProjectEllipseToPlaneClosedForm.h"
+#include "Conics/CachedConicProjection.h"
+#include "Conics/GuardBandFrustum.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ProjectionCacheTest
+{
+    using namespace OrbitTestFixtures;
+
+    const int Count = 500;
+    const int Moves = 8;
+    const int Samples = 256;
+
+    // Half a pixel of a 1920 wide, 90 degree view (as the component's
+    // default ProjectionCacheTolerance), and a guard band of about 3 degrees
+    const double Tolerance = 5e-4;
+    const double GuardBandRadians = 0.05;
+
+    // Hyperbolas are sampled over |t| <= this
+    const double HyperbolaRange = 8.;
+
+    Vector2<double> ImagePoint(const ConicProjection<double>& p, ProjectionType projectionType, double t)
+    {
+        if (projectionType == ProjectionType::Ellipse)
+        {
+            return p.k + p.a * cos(t) * p.u + p.b * sin(t) * p.v;
+        }
+
+        const double sign = projectionType == ProjectionType::PositiveHyperbola ? 1. : -1.;
+        return p.k + sign * p.a * cosh(t) * p.u + sign * p.b * sinh(t) * p.v;
+    }
+
+    // The sight line from the eye through the plane's point p
+    Vector3<double> SightLine(const EllipseProjectionView<double>& view, const Vector2<double>& p)
+    {
+        return view.Cp + p[0] * view.Up + p[1] * view.Vp - view.E;
+    }
+
+    double AngleBetween(const Vector3<double>& a, const Vector3<double>& b)
+    {
+        return atan2(Length(Cross(a, b)), Dot(a, b));
+    }
+
+    // The image conic's t where the sight line to X crosses the plane
+    double ImageParameter(const EllipseProjectionView<double>& view, const EllipseProjectionOutputs<double>& outputs, const Vector3<double>& X)
+    {
+        const Vector3<double> w = X - view.E;
+        const Vector3<double> F = view.Cp - view.E;
+        const Vector3<double> q = (Dot(F, view.Np) / Dot(w, view.Np)) * w - F;
+
+        const ConicProjection<double>& p = outputs.projection;
+        const Vector2<double> d = Vector2<double>{ Dot(q, view.Up), Dot(q, view.Vp) } - p.k;
+        const double x = Dot(d, p.u) / p.a;
+        const double y = Dot(d, p.v) / p.b;
+
+        if (outputs.projectionType == ProjectionType::Ellipse)
+        {
+            return atan2(y, x);
+        }
+
+        const double sign = outputs.projectionType == ProjectionType::NegativeHyperbola ? -1. : 1.;
+        return asinh(sign * y);
+    }
+
+    // How far (radians) the sight line is from the image conic, searching
+    // round t (golden section; it's near enough unimodal that close.)
+    double AngleToImage(const EllipseProjectionView<double>& view, const EllipseProjectionOutputs<double>& outputs, const Vector3<double>& Line, double t)
+    {
+        auto Angle = [&](double s) { return AngleBetween(Line, SightLine(view, ImagePoint(outputs.projection, outputs.projectionType, s))); };
+
+        const double Golden = 0.5 * (sqrt(5.) - 1.);
+        double Lo = t - 0.05;
+        double Hi = t + 0.05;
+        double a = Hi - Golden * (Hi - Lo);
+        double b = Lo + Golden * (Hi - Lo);
+        double fa = Angle(a);
+        double fb = Angle(b);
+
+        for (int i = 0; i < 80; ++i)
+        {
+            if (fa < fb)
+            {
+                Hi = b;
+                b = a;
+                fb = fa;
+                a = Hi - Golden * (Hi - Lo);
+                fa = Angle(a);
+            }
+            else
+            {
+                Lo = a;
+                a = b;
+                fa = fb;
+                b = Lo + Golden * (Hi - Lo);
+                fb = Angle(b);
+            }
+        }
+
+        return FMath::Min(FMath::Min(fa, fb), Angle(t));
+    }
+
+    // v turned Angle about the unit Axis
+    Vector3<double> Rotate(const Vector3<double>& v, const Vector3<double>& Axis, double Angle)
+    {
+        return cos(Angle) * v + sin(Angle) * Cross(Axis, v) + (1. - cos(Angle)) * Dot(Axis, v) * Axis;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FProjectionCacheToleranceTest, "OrbitRendering.Projection.CacheTolerance", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FProjectionCacheToleranceTest::RunTest(const FString& Parameters)
+{
+    using namespace ProjectionCacheTest;
+
+    FRandomStream Random(2357);
+
+    EllipseBatch<double> ellipses;
+    MakeEllipses(Random, Count, ellipses);
+
+    const FrustumParameters<double> Frustum(1000., pi<double> / 2., 16. / 9.);
+
+    int Hits = 0;
+    int Misses = 0;
+    int Turns = 0;
+    int Hyperbolas = 0;
+    double Worst = 0.;
+    double WorstTurned = 0.;
+
+    for (int i = 0; i < Count; ++i)
+    {
+        // The cached view, rolled any way
+        const Vector3<double> CachedEye = RandomVector(Random, 2. * AU);
+        const Vector3<double> CachedDirection = RandomDirection(Random);
+        const Vector3<double> CachedUp = UnitCross(CachedDirection, RandomDirection(Random));
+
+        EllipseProjectionView<double> cachedView;
+        SetView(CachedEye, -CachedDirection, CachedUp, Frustum.z, cachedView);
+
+        const EllipseProjectionInputs<double> cachedInputs = ellipses.getInputs(cachedView, i);
+        EllipseProjectionOutputs<double> cached;
+        ProjectEllipseToPlaneClosedForm(cachedInputs, cached);
+
+        if (cached.projectionType != ProjectionType::Ellipse && cached.projectionType != ProjectionType::PositiveHyperbola && cached.projectionType != ProjectionType::NegativeHyperbola)
+        {
+            continue;
+        }
+
+        for (int m = 0; m < Moves; ++m)
+        {
+            // Moved anywhere from not at all to a million km, and turned up to
+            // twice the guard band
+            const bool bTurnOnly = m == 0;
+            const double Distance = bTurnOnly ? 0. : FMath::Exp(Random.FRandRange(FMath::Loge(1e2f), FMath::Loge(1e6f)));
+            const Vector3<double> Eye = CachedEye + Distance * RandomDirection(Random);
+            const Vector3<double> Axis = RandomDirection(Random);
+            const double Turn = Random.FRandRange(0.f, 2.f * (float)GuardBandRadians);
+            const Vector3<double> Direction = Rotate(CachedDirection, Axis, Turn);
+            const Vector3<double> Up = Rotate(CachedUp, Axis, Turn);
+
+            const bool bHit = IsCachedProjectionCurrent(
+                CachedEye, CachedDirection, CachedUp,
+                Eye, Direction, Up,
+                Vector3<double>::Zero(), cachedInputs.Ce, cachedInputs.A * cachedInputs.Ue, cachedInputs.Ne,
+                Tolerance, GuardBandRadians);
+
+            if (!bHit)
+            {
+                ++Misses;
+                continue;
+            }
+
+            // Afresh
+            EllipseProjectionView<double> view;
+            SetView(Eye, -Direction, Up, Frustum.z, view);
+            const EllipseProjectionInputs<double> inputs = ellipses.getInputs(view, i);
+            EllipseProjectionOutputs<double> fresh;
+            ProjectEllipseToPlaneClosedForm(inputs, fresh);
+
+            // Crossing over to the other branch is a miss too (as
+            // TransformOrbitsCached has it)
+            if (fresh.projectionType != cached.projectionType)
+            {
+                ++Misses;
+                continue;
+            }
+
+            ++Hits;
+            Hyperbolas += cached.projectionType != ProjectionType::Ellipse;
+            Turns += bTurnOnly;
+
+            const EllipseProjectionView<double> carried = CarryProjectionView(cachedView, Eye);
+
+            for (int j = 0; j < Samples; ++j)
+            {
+                const double t = cached.projectionType == ProjectionType::Ellipse
+                    ? twopi<double> * (j + 0.5) / Samples
+                    : HyperbolaRange * (2. * (j + 0.5) / Samples - 1.);
+                const Vector2<double> p = ImagePoint(cached.projection, cached.projectionType, t);
+
+                // The orbit point it's the image of, which has to be in front
+                // of the eye now too
+                const Vector3<double> Cached = SightLine(cachedView, p);
+                const Vector3<double> X = CachedEye + (Dot(cachedInputs.Ce - CachedEye, cachedInputs.Ne) / Dot(Cached, cachedInputs.Ne)) * Cached;
+                if (Dot(X - Eye, view.Np) >= 0.) continue;
+
+                const Vector3<double> Carried = SightLine(carried, p);
+                const double Angle = AngleToImage(view, fresh, Carried, ImageParameter(view, fresh, X));
+
+                Worst = FMath::Max(Worst, Angle);
+                if (bTurnOnly)
+                {
+                    WorstTurned = FMath::Max(WorstTurned, AngleBetween(Carried, X - Eye));
+                }
+            }
+        }
+    }
+
+    TestTrue(TEXT("Cache hits"), Hits > Count);
+    TestTrue(TEXT("Cache misses"), Misses > Count);
+    TestTrue(TEXT("Cache hits, turning only"), Turns > 0);
+    TestTrue(TEXT("Cache hits on hyperbolas"), Hyperbolas > 0);
+    TestEqual(TEXT("Worst cache hit from the fresh image (radians)"), Worst, 0., Tolerance);
+    TestEqual(TEXT("Worst cache hit, turning only (radians)"), WorstTurned, 0., 1e-9);
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FProjectionCacheGuardBandTest, "OrbitRendering.Projection.GuardBand", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FProjectionCacheGuardBandTest::RunTest(const FString& Parameters)
+{
+    using namespace ProjectionCacheTest;
+
+    const int Frusta = 2000;
+    const int Turns = 64;
+
+    FRandomStream Random(1113);
+
+    // Right (x) and up (y), looking along z
+    const Vector3<double> Right{ 1., 0., 0. };
+    const Vector3<double> Upward{ 0., 1., 0. };
+    const Vector3<double> Forward{ 0., 0., 1. };
+
+    int Left = 0;
+    int LeftPast = 0;
+    double Worst = 0.;
+
+    for (int i = 0; i < Frusta; ++i)
+    {
+        const FrustumParameters<double> frustum(1000., Random.FRandRange(2.f, 120.f) / 180. * pi<double>, Random.FRandRange(0.5f, 2.5f));
+        const double GuardBand = Random.FRandRange(0.01f, 0.5f);
+
+        const FrustumParameters<double> band = GetGuardBandFrustum(frustum, GuardBand);
+        const double Radians = GetGuardBandRadians(frustum, GuardBand);
+
+        const double tanX = tan(0.5 * frustum.fov);
+        const double tanY = tanX / frustum.aspectRatio;
+        const double bandX = tan(0.5 * band.fov);
+        const double bandY = bandX / band.aspectRatio;
+
+        // Turned up to the band's angle (and, to see it's not far too
+        // cautious, up to twice it) about any axis
+        for (int j = 0; j < Turns; ++j)
+        {
+            const bool bPast = j >= Turns / 2;
+            const Vector3<double> Axis = RandomDirection(Random);
+            const double Angle = Radians * (bPast ? Random.FRandRange(1.f, 2.f) : Random.FRand());
+
+            const Vector3<double> x = Rotate(Right, Axis, Angle);
+            const Vector3<double> y = Rotate(Upward, Axis, Angle);
+            const Vector3<double> z = Rotate(Forward, Axis, Angle);
+
+            // How far out the worst corner ray is, 1 at the band's side
+            double Out = 0.;
+            for (const double sx : { -1., 1. })
+            {
+                for (const double sy : { -1., 1. })
+                {
+                    const Vector3<double> Corner = z + sx * tanX * x + sy * tanY * y;
+                    const double Depth = Dot(Corner, Forward);
+                    Out = Depth <= 0. ? std::numeric_limits<double>::max() : FMath::Max(Out, FMath::Max(FMath::Abs(Dot(Corner, Right)) / (bandX * Depth), FMath::Abs(Dot(Corner, Upward)) / (bandY * Depth)));
+                }
+            }
+
+            if (bPast)
+            {
+                LeftPast += Out > 1.;
+            }
+            else
+            {
+                Worst = FMath::Max(Worst, Out);
+                Left += Out > 1. + 1e-12;
+            }
+        }
+    }
+
+    TestEqual(TEXT("Turns within the band's angle that left the band"), Left, 0);
+    TestTrue(TEXT("Worst corner, within the band's angle (1 at its side)"), Worst <= 1. + 1e-12 && Worst > 0.);
+    TestTrue(TEXT("Some turns past the band's angle leave the band"), LeftPast > 0);
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,140 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+// -----------------------------------------------------------------------------
+// TrueAnomalyMappingTest.cpp
+//
+// TrueAnomalyMapping against ProjectionAngleToTrueAnomaly, at the ends of
+// every clipped segment of random (solar system scale) orbits, for wide and
+// zoomed in views, as Orbit.BenchmarkTrueAnomaly.  And against the orbit:
+// the point at the mapped true anomaly has to project back onto the segment's
+// end.
+// -----------------------------------------------------------------------------
+
+#include "Misc/AutomationTest.h"
+#include "OrbitProjectorComponent.h"
+#include "Math/RandomStream.h"
+#include "OrbitTestFixtures.h"
+#include "GTE/Mathematics/Vector2.h"
+#include "Conics/ProjectEllipsesToPlane.h"
+#include "Conics/ClipConicsToFrustum.h"
+#include "Conics/ProjectionAngleToTrueAnomaly.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TrueAnomalyMappingTest
+{
+    using namespace OrbitTestFixtures;
+
+    const int Count = 20000;
+
+    // Radians between the mapping and a ray cast.  Mostly they're a few 1e-8
+    // apart, and the worst are under 1e-6.
+    const double Tolerance = 1e-5;
+
+    // Projection plane units (about a pixel each, at 90 degrees), between the
+    // orbit point and the segment's end
+    const double PointTolerance = 1e-2;
+
+    // The orbit's point at a true anomaly (about the focus)
+    Vector3<double> OrbitPoint(const EllipseProjectionInputs<double>& inputs, double TrueAnomaly)
+    {
+        const double ae = sqrt((inputs.A - inputs.B) * (inputs.A + inputs.B));
+        const double e = ae / inputs.A;
+        const double r = inputs.B * inputs.B / inputs.A / (1. + e * cos(TrueAnomaly));
+        return inputs.Ce + ae * inputs.Ue + r * (cos(TrueAnomaly) * inputs.Ue + sin(TrueAnomaly) * inputs.Ve);
+    }
+
+    // Where a point lands on the projection plane
+    Vector2<double> ProjectPoint(const EllipseProjectionInputs<double>& inputs, const Vector3<double>& P)
+    {
+        const Vector3<double> w = P - inputs.E;
+        const Vector3<double> F = inputs.Cp - inputs.E;
+        const Vector3<double> q = (Dot(F, inputs.Np) / Dot(w, inputs.Np)) * w - F;
+        return Vector2<double>{ Dot(q, inputs.Up), Dot(q, inputs.Vp) };
+    }
+
+    Vector2<double> ImagePoint(const ConicProjection<double>& p, ProjectionType projectionType, double t)
+    {
+        if (projectionType == ProjectionType::Ellipse)
+        {
+            return p.k + p.a * cos(t) * p.u + p.b * sin(t) * p.v;
+        }
+
+        const double sign = projectionType == ProjectionType::PositiveHyperbola ? 1. : -1.;
+        return p.k + sign * p.a * cosh(t) * p.u + sign * p.b * sinh(t) * p.v;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTrueAnomalyMappingTest, "OrbitRendering.Projection.TrueAnomalyMapping", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTrueAnomalyMappingTest::RunTest(const FString& Parameters)
+{
+    using namespace TrueAnomalyMappingTest;
+
+    FRandomStream Random(1234);
+
+    EllipseBatch<double> ellipses;
+    MakeEllipses(Random, Count, ellipses);
+
+    double TrueAnomalies[2 * ConicClip<double>::MaxSegments];
+
+    for (int v = 0; v < 8; ++v)
+    {
+        const double FovDegrees = v < 4 ? 90. : 5.;
+        const FrustumParameters<double> frustum(1000., FovDegrees / 180. * pi<double>, 16. / 9.);
+
+        EllipseProjectionView<double> view;
+        MakeView(Random, frustum.z, view);
+
+        ConicProjectionBatch<double> projections;
+        ProjectEllipsesToPlane(view, ellipses, projections);
+
+        std::vector<ConicClip<double>> clips;
+        ClipConicsToFrustum(frustum, projections, clips);
+
+        int Ends = 0;
+        int Unmapped = 0;
+        double Worst = 0.;
+        double WorstPoint = 0.;
+
+        for (int i = 0; i < Count; ++i)
+        {
+            if (!clips[i].Visible || !clips[i].SegmentCount) continue;
+
+            const EllipseProjectionInputs<double> inputs = ellipses.getInputs(view, i);
+            EllipseProjectionOutputs<double> outputs;
+            projections.getOutputs(i, outputs);
+
+            TrueAnomalyMapping<double> mapping;
+            if (!GetTrueAnomalyMapping(inputs, outputs, mapping))
+            {
+                ++Unmapped;
+                continue;
+            }
+            MapToTrueAnomalies(mapping, clips[i].Segments, clips[i].SegmentCount, TrueAnomalies);
+
+            for (int j = 0; j < 2 * clips[i].SegmentCount; ++j)
+            {
+                const ConicSegment<double>& segment = clips[i].Segments[j / 2];
+                const double t = segment.SegmentStart + (j & 1) * segment.SegmentLength;
+
+                double TrueAnomaly;
+                ProjectionAngleToTrueAnomaly(inputs, outputs, t, TrueAnomaly);
+                Worst = FMath::Max(Worst, FMath::Abs(FMath::UnwindRadians(TrueAnomaly - TrueAnomalies[j])));
+
+                const Vector2<double> End = ImagePoint(outputs.projection, outputs.projectionType, t);
+                WorstPoint = FMath::Max(WorstPoint, Length(ProjectPoint(inputs, OrbitPoint(inputs, TrueAnomalies[j])) - End));
+                ++Ends;
+            }
+        }
+
+        TestTrue(FString::Printf(TEXT("Segment ends in view %d"), v), Ends > 0);
+        TestEqual(FString::Printf(TEXT("Visible orbits with no mapping in view %d"), v), Unmapped, 0);
+        TestEqual(FString::Printf(TEXT("Worst mapped true anomaly in view %d (radians)"), v), Worst, 0., Tolerance);
+        TestEqual(FString::Printf(TEXT("Worst mapped orbit point off the segment's end in view %d"), v), WorstPoint, 0., PointTolerance);
+    }
+
+    return true;
+}
+
+#endif
@@ -8,6 +8,24 @@
 #include "OrbitProjectorComponent.h"
 #include "ConicRendererComponent.generated.h"
 
+// Tessellation's working data, see ConicRendererComponent.cpp
+struct FConicSegmentTessellation;
+struct FConicTessellationScratch;
+struct FConicTessellationWorkspace;
+
+
+// Screen size LOD tuning, see UConicRendererComponent's LOD properties
+struct FConicLod
+{
+    bool bEnabled = false;
+    float MinPixels = 1.f;
+    float LoopPixels = 4.f;
+    uint32 LoopLines = 4;
+    float TolerancePixels = 0.25f;
+    bool bAdaptive = false;
+    bool bBezier = false;
+};
+
 
 /**
  * 
@@ -36,12 +54,60 @@ public:
     UPROPERTY(EditAnywhere, Category = "Conic Renderer")
     int MaxOrbits = 4;
 
+    // Screen size LOD
+    UPROPERTY(EditAnywhere, Category = "Conic Renderer|LOD", meta = (ToolTip = "Scale each ellipse's tessellation with its size on screen, and drop the ones too small to see"))
+    bool bScreenSizeLod = true;
+
+    UPROPERTY(EditAnywhere, Category = "Conic Renderer|LOD", meta = (ToolTip = "Ellipses smaller than this across aren't drawn (Pixels)"))
+    float LodMinPixels = 1.f;
+
+    UPROPERTY(EditAnywhere, Category = "Conic Renderer|LOD", meta = (ToolTip = "Ellipses smaller than this across are drawn as a tiny loop of LodLoopLines lines (Pixels)"))
+    float LodLoopPixels = 4.f;
+
+    UPROPERTY(EditAnywhere, Category = "Conic Renderer|LOD", meta = (ToolTip = "Lines in a tiny loop"))
+    uint32 LodLoopLines = 4;
+
+    UPROPERTY(EditAnywhere, Category = "Conic Renderer|LOD", meta = (ToolTip = "How far the lines may stray from the true ellipse, everything else gets just enough lines for this, up to LinesPerConicSegment (Pixels)"))
+    float LodTolerancePixels = 0.25f;
+
+    UPROPERTY(EditAnywhere, Category = "Conic Renderer|LOD", meta = (ToolTip = "Space each segment's vertices by how sharply the conic turns, so every line is within LodTolerancePixels of it, rather than evenly.  Hyperbolas too, which are otherwise always drawn with LinesPerConicSegment."))
+    bool bAdaptiveTessellation = true;
+
+    UPROPERTY(EditAnywhere, Category = "Conic Renderer|LOD", meta = (ToolTip = "Step evenly spaced lines along the conic's exact rational Bezier pieces, by forward differencing, rather than calling sin/cos (or sinh/cosh) for every vertex.  Everything but adaptive tessellation is evenly spaced."))
+    bool bBezierTessellation = true;
+
+    // Late latching
+    UPROPERTY(EditAnywhere, Category = "Conic Renderer", meta = (ToolTip = "Send only the orbits to the render thread, and project/clip/tessellate them there with the final scene view.  Split screen and stereo always do, once for each view."))
+    bool bLateLatchProjection = false;
+
+    UPROPERTY(VisibleAnywhere, Category = "Conic Renderer|Latency", meta = (ToolTip = "Time from the game thread sampling the camera (this component's tick) to drawing, with or without late latching (Milliseconds)"))
+    float CameraLatencyMs = 0.f;
+
+    UPROPERTY(VisibleAnywhere, Category = "Conic Renderer|Latency", meta = (ToolTip = "How much of CameraLatencyMs late latching takes off: from the game thread's camera sample to the render thread latching the view it projects with.  Zero without late latching (Milliseconds)"))
+    float LateLatchSavedMs = 0.f;
+
+    UPROPERTY(VisibleAnywhere, Category = "Conic Renderer|Latency", meta = (ToolTip = "Distance between the game thread's camera sample and the eye the frame's drawn from (Scene units).  Without late latching the conics are off by this much, with it they're projected from the drawn eye instead."))
+    float CameraEyeError = 0.f;
+
 public:
 	UConicRendererComponent();
 
     virtual void BeginPlay();
     virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
+    FConicLod GetLod() const;
+
+    // More than one view (split screen, stereo)?  Then the render thread projects for each.
+    bool IsMultiView() const;
+
+    // Lines to draw a conic's segment with, zero if it's too small to draw at all
+    static uint32 GetLinesPerSegment(const FConicSection& Conic, float SegmentLength, uint32 LinesPerSegment, const FConicLod& Lod);
+
+    // Where the vertices go along a conic's segment: on the unit conic (cos t,
+    // sin t) or +-(cosh t, sinh t), as X, Y, and their conic parameters t, from
+    // its start to its end.  Empty if it's too small to draw at all.
+    static void GetSegmentTessellation(const FConicSection& Conic, float SegmentStart, float SegmentLength, uint32 LinesPerSegment, const FConicLod& Lod, std::vector<float>& Params, std::vector<double>& X, std::vector<double>& Y);
+
 private:
 
     // notes:
@@ -63,30 +129,19 @@ private:
         const TArray <FConicSection>& Conics,
         float LineThickness,
         uint32 LinesPerSegment,
+        const FConicLod& Lod,
+        FConicTessellationWorkspace& Workspace,
         TArray<FDynamicMeshVertex>& LineVertices,
         TArray<uint32>& LineIndices,
         int MaxOrbits
     );
 
-    // See notes above for Tesselate
-    static void Tessellate(
-        const FMatrix& LocalToWorld,
-        const FVector& CameraPosition,
-        const FVector& CameraDirection,
-        const FConicSection& Conic,
-        float LineThickness,
-        uint32 LinesPerSegment,
-        TArray<FDynamicMeshVertex>& LineVertices,
-        TArray<uint32>& LineIndices
-    );
-
     // See notes above for Tesselate
     static void Tessellate(
         const float TrueAnomalyState,
-        const FMatrix& LocalToWorld,
+        const FMatrix& WorldToLocal,
         const FVector& CameraPosition,
         const FVector& CameraDirection,
-        ES_ConicType ConicType,
         const FColor& Color,
         const FVector& Center,
         const FVector& Axis1,
@@ -94,21 +149,19 @@ private:
         const FVector& OrbitPlaneCenter,
         const FVector& OrbitPlaneNormal,
         float LineThickness,
-        uint32 LinesPerSegment,
+        const FConicSegmentTessellation& Segment,
+        FConicTessellationScratch& Scratch,
         float SegmentStart,
         float SegmentEnd,
         float TrueAnomalyStart,
         float TrueAnomalyEnd,
-        TArray<FDynamicMeshVertex>& LineVertices,
-        TArray<uint32>& LineIndices
+        FDynamicMeshVertex* LineVertices,
+        uint32* LineIndices
     );
 
     static FVector ProjectToOrbitalPlane(const FVector& P1, const FVector& CameraPosition, const FVector& OrbitOrigin, const FVector& OrbitalNormal);
 
     // Used when tesselating segments
-    static FVector2D Ellipse(float theta);
-    static FVector2D PositiveHyperbola(float theta);
-    static FVector2D NegativeHyperbola(float theta);
     static float EllipseAdvancement(float theta, float AdvancementState, float SegmentStart, float SegmentLength, float TrueAnomalyStart, float TrueAnomalyLength);
     static float HyperbolaAdvancement(float theta, float AdvancementState, float SegmentStart, float SegmentLength, float TrueAnomalyStart, float TrueAnomalyLength);
 
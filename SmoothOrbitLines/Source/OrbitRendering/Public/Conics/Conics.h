@@ -7,6 +7,7 @@
 #pragma once
 #include "GTE/Mathematics/Vector.h"
 #include "GTE/Mathematics/Vector3.h"
+#include <cmath>
 using namespace gte;
 
 // Miscellaneous definitions used by the conic function templates
@@ -29,13 +30,28 @@ struct ConicProjection
     T b;
 };
 
+// A conic as a symmetric 3x3 matrix M over homogeneous coordinates (x, y, 1):
+//      (x, y, 1) M (x, y, 1)^T = 0
+// or, as a dual conic, over the lines (l0, l1, l2) tangent to it.  Symmetric,
+// so only the upper triangle is kept.
+template<class T>
+struct ConicMatrix
+{
+    T m00, m01, m02;
+    T      m11, m12;
+    T           m22;
+
+    ConicMatrix() : m00(T()), m01(T()), m02(T()), m11(T()), m12(T()), m22(T()) {}
+    ConicMatrix(T _m00, T _m01, T _m02, T _m11, T _m12, T _m22) : m00(_m00), m01(_m01), m02(_m02), m11(_m11), m12(_m12), m22(_m22) {}
+};
+
 template<class T>
 struct ConicSegment
 {
     T SegmentStart;
     T SegmentLength;
 
-    ConicSegment() : SegmentStart(default), SegmentLength(default) {}
+    ConicSegment() : SegmentStart(T()), SegmentLength(T()) {}
     ConicSegment(T start, T length) : SegmentStart(start), SegmentLength(length) {}
 };
 
@@ -59,3 +75,158 @@ struct FrustumParameters
     }
 };
 
+// The frustum's rectangle on the view plane, |x| <= maxX, |y| <= maxY.  For
+// clipping many conics to the same frustum without the tan() for each one.
+template<class T>
+struct ClipRectangle
+{
+    T maxX;
+    T maxY;
+
+    ClipRectangle(const FrustumParameters<T>& frustum)
+    {
+        T fov = frustum.fov;
+#if defined(REDUCE_FOV)
+        fov *= 0.75f;
+#endif
+        maxX = frustum.z * std::tan(fov / 2);
+        maxY = maxX / frustum.aspectRatio;
+    }
+};
+
+// A convex region of the view plane, as its sides' half planes: p is inside
+// when n . p <= d for every side (n, d).  For clipping to part of the
+// frustum's rectangle: a sub viewport, or what isn't under an opaque panel.
+// (Up to eight vertices, and room for the near and far planes' sides.)
+template<class T>
+struct ClipPolygon
+{
+    static constexpr int MaxVertices = 8;
+    static constexpr int MaxSides = MaxVertices + 2;
+
+    Vector<2, T> Normals[MaxSides];
+    T Distances[MaxSides];
+    int SideCount = 0;
+
+    ClipPolygon() {}
+
+    // The rectangle [minX, maxX] x [minY, maxY], which needn't be centered
+    ClipPolygon(T minX, T minY, T maxX, T maxY)
+    {
+        AddSide((T)1, (T)0, maxX);
+        AddSide((T)0, (T)-1, -minY);
+        AddSide((T)-1, (T)0, -minX);
+        AddSide((T)0, (T)1, maxY);
+    }
+
+    // All of the frustum's
+    ClipPolygon(const ClipRectangle<T>& rectangle) : ClipPolygon(-rectangle.maxX, -rectangle.maxY, rectangle.maxX, rectangle.maxY) {}
+
+    void AddSide(T nx, T ny, T d)
+    {
+        Normals[SideCount] = Vector<2, T>{ nx, ny };
+        Distances[SideCount] = d;
+        ++SideCount;
+    }
+
+    // Convex, its vertices in order, either way round.  False (and no sides)
+    // if it isn't, or has too many.  (Turning the same way at every corner
+    // isn't enough, a pentagram does that; it has to go round exactly once.)
+    bool SetVertices(const Vector<2, T>* vertices, int count)
+    {
+        SideCount = 0;
+        if (count < 3 || count > MaxVertices) return false;
+
+        // The edges, less any from repeated vertices
+        Vector<2, T> edges[MaxVertices];
+        int edgeCount = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            const Vector<2, T>& p = vertices[i];
+            const Vector<2, T>& q = vertices[(i + 1) % count];
+            const Vector<2, T> edge{ q[0] - p[0], q[1] - p[1] };
+            if (edge[0] != (T)0 || edge[1] != (T)0)
+            {
+                edges[edgeCount++] = edge;
+            }
+        }
+        if (edgeCount < 3) return false;
+
+        // The turning angles' sum, in turns
+        T turning = (T)0;
+        for (int i = 0; i < edgeCount; ++i)
+        {
+            const Vector<2, T>& e = edges[i];
+            const Vector<2, T>& f = edges[(i + 1) % edgeCount];
+            const T cross = e[0] * f[1] - e[1] * f[0];
+            const T dot = e[0] * f[0] + e[1] * f[1];
+
+            // Doubling back has no well defined way round
+            if (cross == (T)0 && dot < (T)0) return false;
+
+            turning += std::atan2(cross, dot);
+        }
+        turning /= (T)(2. * std::acos(-1.));
+
+        // Which way round: twice the signed area
+        T area = (T)0;
+        for (int i = 0; i < count; ++i)
+        {
+            const Vector<2, T>& p = vertices[i];
+            const Vector<2, T>& q = vertices[(i + 1) % count];
+            area += p[0] * q[1] - p[1] * q[0];
+        }
+        if (area == (T)0) return false;
+        const T winding = area > (T)0 ? (T)1 : (T)-1;
+        if (std::abs(turning - winding) > (T)0.5) return false;
+
+        for (int i = 0; i < count; ++i)
+        {
+            const Vector<2, T>& p = vertices[i];
+            const Vector<2, T>& q = vertices[(i + 1) % count];
+            const Vector<2, T>& r = vertices[(i + 2) % count];
+
+            // Every corner turns the same way
+            const T turn = (q[0] - p[0]) * (r[1] - q[1]) - (q[1] - p[1]) * (r[0] - q[0]);
+            if (turn * winding < (T)0)
+            {
+                SideCount = 0;
+                return false;
+            }
+
+            // The edge's outward normal (none, for a repeated vertex)
+            const T nx = winding * (q[1] - p[1]);
+            const T ny = winding * (p[0] - q[0]);
+            if (nx != (T)0 || ny != (T)0)
+            {
+                AddSide(nx, ny, nx * p[0] + ny * p[1]);
+            }
+        }
+
+        return true;
+    }
+};
+
+// A conic clipped to a ClipRectangle or ClipPolygon: its visible segments, in
+// order.  Each side cuts a conic at most twice, so there are at most as many
+// as there are sides.  (A visible ellipse with no segments is visible all the
+// way round.)
+template<class T>
+struct ConicClip
+{
+    static constexpr int MaxSegments = ClipPolygon<T>::MaxSides;
+
+    ConicSegment<T> Segments[MaxSegments];
+    int SegmentCount = 0;
+    bool Visible = false;
+};
+
+// A body the orbit lines can pass behind, as a sphere.  (Same frame and units
+// as the orbits.)
+template<class T>
+struct OccludingSphere
+{
+    Vector3<T> Center;
+    T Radius;
+};
+
@@ -18,6 +18,7 @@
 #include "CoreMinimal.h"
 #include "OrbitalMechanics.h"
 #include "Conics/Conics.h"
+#include "Tasks/Task.h"
 #include "OrbitProjectorComponent.generated.h"
 
 UENUM(BlueprintType)
@@ -46,12 +47,19 @@ struct FConicSection
     FVector OrbitalPlaneCenter;
     FVector OrbitalPlaneNormal;
     float AdvancementState; // <- the 'theta' point along conic(theta) where the body should be visualized.
+    float ScreenRadius = MAX_flt; // <- Semi-major axis on screen (pixels), for LOD.  Hyperbolas are never small.
+    float PixelsPerUnit = 0.f;    // <- Pixels per scene unit on the projection plane, for tessellation
 
     TArray<FVector2D> Segments;
     TArray<FVector2D> TrueAnomalies;
 };
 
 
+// An orbit's conic, as a (dual) conic matrix in its plane.  See
+// ProjectConicMatrixToPlane.
+typedef ConicMatrix<double> FConicMatrix;
+
+
 USTRUCT(BlueprintType)
 struct FOrbitItem
 {
@@ -65,7 +73,149 @@ struct FOrbitItem
     FFrameVector Axis2;
     FFramePosition Focus;    // <- What is being orbited (Sun, etc)
     FFrameVector Normal;     // <- Orbital Plane Normal
+    FConicMatrix PlaneConic; // <- Dual conic, perifocal (Focus, periapsis along Axis1)
     FState FrameState;
+
+    // Which body's orbit this is, for the projection cache.  Only ever
+    // compared, never dereferenced.
+    const class UOrbitingBodyComponent* Body = nullptr;
+};
+
+
+// Everything projection needs from the game thread, captured once per frame.
+// With this in hand, projection doesn't touch any UObjects and can run on any thread.
+struct ORBITRENDERING_API FOrbitProjectionView
+{
+    FrustumParameters<double> Frustum;
+    FFramePosition EyePoint;
+    FFrameVector EyeDirection;
+
+    // The camera's up, which rolls the frustum's rectangle about EyeDirection
+    FFrameVector EyeUp = FFrameVector(0., 0., 1.);
+
+    // Off axis (stereo) projections: where the rectangle's center is, in half
+    // widths and heights of it (right and up.)  Zero for a centered one.
+    FVector2D ProjectionOffset = FVector2D::ZeroVector;
+
+    // Orthographic cameras project straight along EyeDirection.  Frustum.fov
+    // is then whatever frames the ortho width at Frustum.z, so the clipping,
+    // culling and LOD see the same rectangle either way.
+    bool bOrthographic = false;
+
+    // Scene <-> Frame mapping (see UOrbitViewerControllerComponent)
+    FFramePosition SceneOrigin;
+    double SceneScale;
+
+    // Pixels across the frustum's fov
+    double ViewportWidth = 1920.;
+
+    // The bodies orbit lines can pass behind, where they are this frame.
+    // (Empty with body occlusion off.)
+    std::vector<OccludingSphere<double>> Occluders;
+
+    // Orbits are clipped where they come nearer the eye than NearDepth, or
+    // go further than FarDepth.  (Frame units, 0 for none.)
+    double NearDepth = 0.;
+    double FarDepth = 0.;
+
+    // The part of the viewport orbits are drawn in, a convex polygon in
+    // viewport coordinates (0..1, y down).  Empty for all of it.
+    TArray<FVector2D> ClipRegion;
+
+    FVector ToScenePosition(const FFramePosition& FramePosition) const;
+    FVector ToSceneVector(const FFrameVector& FrameVector) const;
+    FFramePosition ToFramePosition(const FVector& ScenePosition) const;
+    FFrameVector ToFrameVector(const FVector& SceneVector) const;
+
+    // A length on the projection plane, in pixels
+    double ToPixels(double PlaneLength) const;
+
+    // ClipRegion on the projection plane, or an off axis rectangle.  False
+    // if there isn't one (or it isn't convex), and the whole frustum's
+    // rectangle is clipped to.
+    bool GetClipPolygon(ClipPolygon<double>& Polygon) const;
+
+    // The centered frustum an off axis one fits in, for culling and anything
+    // else that takes a centered rectangle.  Frustum itself, if it's centered.
+    FrustumParameters<double> GetBoundingFrustum() const;
+};
+
+
+// One orbit's projection and clipping, as of the view it was projected for.
+// Everything but where the body is on it, which UOrbitProjectorComponent's
+// projection cache updates every frame.
+struct FOrbitProjectionCacheEntry
+{
+    bool bValid = false;
+
+    // What it was projected for
+    FFramePosition Center;
+    FFrameVector Axis1;
+    FFrameVector Axis2;
+    FOrbitProjectionView View;
+
+    // The plane it was projected onto (EllipseProjectionView: E, Cp, Np, Up, Vp)
+    Vector3<double> Eye, PlaneCenter, PlaneNormal, PlaneU, PlaneV;
+
+    // The image conic, with the body located on it
+    ConicProjection<double> Projection;
+    ProjectionType Type = ProjectionType::NotVisible;
+
+    // Clipped (to the frustum widened by the guard band), and the true
+    // anomalies at each segment's start and end
+    double GuardBand = 0.;
+    bool bVisible = false;
+    std::vector<ConicSegment<double>> Segments;
+    std::vector<double> SegmentTrueAnomalies;
+};
+
+
+// A bounding volume hierarchy over a set of orbits, for culling them to the
+// view frustum before projecting.  (Defined with the projection, see
+// CullEllipsesToFrustum.)
+struct FOrbitBoundingVolumes;
+
+// Orbits grouped by the plane they're in (moons around the same planet in its
+// equatorial plane, rings, ...), so the projection can set a plane up once for
+// all of its orbits.  (Also defined with the projection.)
+struct FOrbitPlaneFamilies;
+
+
+// A conic fitted to a sampled trajectory arc, in the form ProjectToPlane takes
+USTRUCT(BlueprintType)
+struct FConicArcFit
+{
+    GENERATED_BODY()
+
+    UPROPERTY(meta = (ToolTip = "Ellipse, PositiveHyperbola, or None if no conic fits"), BlueprintReadOnly, VisibleInstanceOnly)
+    ES_ConicType ConicType = ES_ConicType::None;
+
+    UPROPERTY(meta = (ToolTip = "Center of the conic"), BlueprintReadOnly, VisibleInstanceOnly)
+    FFramePosition Center;
+
+    UPROPERTY(meta = (ToolTip = "Semi-axis (the transverse one, for a hyperbola)"), BlueprintReadOnly, VisibleInstanceOnly)
+    FFrameVector Axis1;
+
+    UPROPERTY(meta = (ToolTip = "Other semi-axis"), BlueprintReadOnly, VisibleInstanceOnly)
+    FFrameVector Axis2;
+
+    UPROPERTY(meta = (ToolTip = "Unit normal of the conic's plane"), BlueprintReadOnly, VisibleInstanceOnly)
+    FFrameVector Normal;
+
+    UPROPERTY(meta = (ToolTip = "Conic parameter of the first sample"), BlueprintReadOnly, VisibleInstanceOnly)
+    double ArcStart = 0.;
+
+    UPROPERTY(meta = (ToolTip = "Parameter span to the last sample"), BlueprintReadOnly, VisibleInstanceOnly)
+    double ArcLength = 0.;
+
+    UPROPERTY(meta = (ToolTip = "RMS distance of the samples from the conic (kilometers)"), BlueprintReadOnly, VisibleInstanceOnly)
+    double RmsResidual = 0.;
+
+    UPROPERTY(meta = (ToolTip = "Furthest distance of a sample from the conic (kilometers)"), BlueprintReadOnly, VisibleInstanceOnly)
+    double MaxResidual = 0.;
+
+    UPROPERTY(meta = (ToolTip = "Cost of the fit (seconds)"), BlueprintReadOnly, VisibleInstanceOnly)
+    double FitSeconds = 0.;
 };
 
 
@@ -94,13 +244,64 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "View")
     class UOrbitViewerControllerComponent* OrbitViewerController;
 
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "View", meta = (ToolTip = "Clip orbits where they pass nearer the camera than this (Scene units).  Bounds the hyperbolas orbits passing behind the camera project to.  0 for none.", ClampMin = "0"))
+    float NearClipDistance = 0.f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "View", meta = (ToolTip = "Clip orbits where they're further from the camera than this (Scene units).  0 for none.", ClampMin = "0"))
+    float FarClipDistance = 0.f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "View", meta = (ToolTip = "Only draw orbits inside this convex polygon, in viewport coordinates (0..1, y down, up to 8 vertices in order).  For a sub viewport, or to keep them out from under the HUD.  Empty for the whole viewport."))
+    TArray<FVector2D> ClipRegion;
+
+    UPROPERTY(EditAnywhere, Category = "Projection", meta = (ToolTip = "Project on worker threads, launched early in the frame.  The renderer draws the last completed projection, so the orbits are a frame behind the camera."))
+    bool bAsyncProjection = false;
+
+    UPROPERTY(EditAnywhere, Category = "Projection", meta = (ToolTip = "Cull orbits to the view frustum in 3D before projecting them.  Only orbits that might be visible are projected, clipped and drawn."))
+    bool bFrustumCulling = true;
+
+    UPROPERTY(EditAnywhere, Category = "Projection", meta = (ToolTip = "Group orbits that share a plane, and set up each plane's projection once for all of its orbits rather than once per orbit"))
+    bool bCoplanarBatching = true;
+
+    UPROPERTY(EditAnywhere, Category = "Projection", meta = (ToolTip = "Orbits about the same focus whose planes are within this angle of each other are batched as one plane (Radians).  An orbit's drawn in its family's plane, so it's off by up to this angle times its size over its distance.", ClampMin = "0"))
+    float CoplanarTolerance = 1e-6f;
+
+    UPROPERTY(EditAnywhere, Category = "Projection", meta = (ToolTip = "Leave out the parts of orbits hidden behind the bodies (as spheres, see the orbiting body's occlusion radius), rather than drawing them across the body"))
+    bool bBodyOcclusion = true;
+
+    UPROPERTY(EditAnywhere, Category = "Projection|Cache", meta = (ToolTip = "Reuse each orbit's projection and clipping until the view has moved more than the tolerance.  Only the body's place on the orbit is updated in between."))
+    bool bProjectionCache = false;
+
+    UPROPERTY(EditAnywhere, Category = "Projection|Cache", meta = (ToolTip = "How far a cached projection may drift from the current view's (Pixels)", ClampMin = "0"))
+    float ProjectionCacheTolerance = 0.5f;
+
+    UPROPERTY(EditAnywhere, Category = "Projection|Cache", meta = (ToolTip = "Clip cached projections this far past the viewport's edges (as a fraction of its size), so they hold while the camera turns within the band.  They're clipped again, to a band around the new view, once it turns past it.  0 to clip to the viewport.", ClampMin = "0"))
+    float ProjectionCacheGuardBand = 0.1f;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Projection|Cache", meta = (ToolTip = "Orbits drawn from a cached projection"))
+    int64 ProjectionCacheHits = 0;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Projection|Cache", meta = (ToolTip = "Orbits projected because the cache was out of tolerance (or the orbit changed)"))
+    int64 ProjectionCacheMisses = 0;
+
 
 public:
 
     // Called every frame
     virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
-    void GetConics(TArray<FConicSection>& Conics);
+    // Projected conics, and the camera they were projected for.  With async
+    // projection that's the last completed one, a frame old: this doesn't
+    // wait for the task in flight, the next launch joins it.
+    void GetConics(TArray<FConicSection>& Conics, FVector& CameraLocation, FVector& CameraDirection, uint64& CameraSampleCycles);
+
+    // Capture the current camera and scene mapping
+    void GetProjectionView(FOrbitProjectionView& View);
+
+    // OrbitArray's bounding volumes, null if frustum culling is off
+    TSharedPtr<const FOrbitBoundingVolumes, ESPMode::ThreadSafe> GetOrbitBounds() const { return OrbitBounds; }
+
+    // OrbitArray's coplanar families, null if coplanar batching is off
+    TSharedPtr<const FOrbitPlaneFamilies, ESPMode::ThreadSafe> GetOrbitFamilies() const { return OrbitFamilies; }
 
 
 
@@ -108,11 +309,13 @@ protected:
     // Called when the game starts
     virtual void BeginPlay() override;
 
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 
         
 public:
 //    UFUNCTION(BlueprintCallable)
-    void ProjectToPlane(
+    static void ProjectToPlane(
         const FrustumParameters<double>& frustum,
         const FFramePosition& ellipseCenterPosition,
         const FFrameVector& ellipseAxis1Vector,
@@ -126,10 +329,66 @@ public:
         std::vector<ConicSegment<double>>& segmentList,
         std::vector<ConicSegment<double>>& trueAnomalies,
         double& Advancement,
-        double TestTheta
+        double TestTheta,
+        bool bOrthographic = false
     );
 
+    // Fit an ellipse or hyperbola to a sampled (ordered) 3D trajectory arc
+    bool FitTrajectoryArc(const TArray<FFramePosition>& Samples, FConicArcFit& Fit);
+
+    // Project and clip one orbit for the given view.  Threadsafe, the renderer
+    // calls this from the render thread when late latching the view.
+    static bool TransformOrbit(const FOrbitProjectionView& View, const FOrbitItem& orbit, FConicSection& conic);
+
+    // TransformOrbit for many orbits, batched.  (Also threadsafe.)  With
+    // Bounds (built for Orbits), only the orbits in the view frustum are
+    // projected, and Conics has just those.  With Families (also built for
+    // Orbits), coplanar orbits share their plane's setup.
+    static void TransformOrbits(const FOrbitProjectionView& View, const TArray<FOrbitItem>& Orbits, TArray<FConicSection>& Conics, const FOrbitBoundingVolumes* Bounds = nullptr, const FOrbitPlaneFamilies* Families = nullptr);
+
+    // TransformOrbits for each of Views, into Conics[view].  (Also threadsafe.)
+    // The per orbit work is shared, the views are projected in parallel.
+    static void TransformOrbitsForViews(const TArray<FOrbitProjectionView>& Views, const TArray<FOrbitItem>& Orbits, TArray<TArray<FConicSection>>& Conics, const FOrbitBoundingVolumes* Bounds = nullptr, const FOrbitPlaneFamilies* Families = nullptr);
+
 private:
     bool CollectOrbit(class UOrbitingBodyComponent* ActiveBody, FOrbitItem& orbit);
-    bool TransformOrbit(const FOrbitItem& orbit, FConicSection& conic);
+
+    void LaunchProjection();
+    void JoinProjection();
+
+    // TransformOrbits, through the projection cache
+    void TransformOrbitsCached(const FOrbitProjectionView& View, double ToleranceRadians, double GuardBand, const TArray<FOrbitItem>& Orbits, TArray<FConicSection>& Conics, const FOrbitBoundingVolumes* Bounds, const FOrbitPlaneFamilies* Families);
+
+    // ProjectionCacheTolerance as an angle, for View's viewport
+    double GetProjectionCacheToleranceRadians(const FOrbitProjectionView& View) const;
+
+    // Keyed by FOrbitItem::Body.  Only touched by the projection (which may
+    // be a task), so it needs no lock.
+    TMap<const class UOrbitingBodyComponent*, FOrbitProjectionCacheEntry> ProjectionCache;
+
+    // Rebuilt when OrbitArray's orbits change shape (or come and go), which
+    // is seldom.  Shared with the projection task and the renderer.
+    TSharedPtr<const FOrbitBoundingVolumes, ESPMode::ThreadSafe> OrbitBounds;
+
+    // Likewise
+    TSharedPtr<const FOrbitPlaneFamilies, ESPMode::ThreadSafe> OrbitFamilies;
+
+    // Counted by the projection, added to the UPROPERTYs once it's joined
+    int64 PendingCacheHits = 0;
+    int64 PendingCacheMisses = 0;
+
+    // Double buffered async output.  The task writes the back buffer while
+    // the game thread reads the front one.
+    struct FConicBuffer
+    {
+        TArray<FConicSection> Conics;
+
+        // The camera it was projected for
+        FVector CameraLocation = FVector::ZeroVector;
+        FVector CameraDirection = FVector::ForwardVector;
+        uint64 SampleCycles = 0;
+    };
+    FConicBuffer ConicBuffers[2];
+    int FrontBuffer = 0;
+    UE::Tasks::FTask Projection;
 };
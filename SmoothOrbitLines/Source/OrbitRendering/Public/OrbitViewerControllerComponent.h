@@ -52,6 +52,14 @@ struct FSceneOrbitGeometry
 
 
 
+UENUM(BlueprintType)
+enum class ES_ApparentObserver : uint8
+{
+    FocusBody UMETA(DisplayName = "Focus Body"),
+    Camera UMETA(DisplayName = "Camera")
+};
+
+
 UCLASS()
 class ORBITRENDERING_API UOrbitViewerControllerComponent : public UActorComponent
 {
@@ -81,6 +89,27 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Universe", meta = (ToolTip = "Centimeters Per Kilometer"))
     class UOrbitViewerControllerComponent* OrbitViewerController;
 
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Apparent Positions", meta = (ToolTip = "Where light-time and aberration are observed from"))
+    ES_ApparentObserver ApparentObserver = ES_ApparentObserver::FocusBody;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Apparent Positions", meta = (ToolTip = "Apply stellar aberration (observer velocity) after the light-time correction"))
+    bool bApplyAberration = true;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Apparent Positions", meta = (ToolTip = "Upper bound on light-time iterations per body, per call", ClampMin = "1"))
+    int LightTimeMaxIterations = 4;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Apparent Positions", meta = (ToolTip = "Light-time convergence tolerance (Seconds)"))
+    double LightTimeTolerance = 1e-6;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Apparent Positions", meta = (ToolTip = "Light-time iterations, summed over all bodies, of the last call"))
+    int LightTimeIterations;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Apparent Positions", meta = (ToolTip = "Most light-time iterations any one body needed in the last call"))
+    int LightTimePeakIterations;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Apparent Positions", meta = (ToolTip = "Bodies that hit the iteration bound without converging in the last call"))
+    int LightTimeUnconverged;
+
 public:
     UFUNCTION(BlueprintPure,
         Category = "Orbit Scene View",
@@ -180,6 +209,13 @@ public:
 
     void GetActiveBodies(TArray<class UOrbitingBodyComponent*>& ActiveBodies);
 
+    UFUNCTION(BlueprintCallable,
+        Category = "Orbit Scene View",
+        meta = (
+            ToolTip = "Light-time and aberration corrected positions of the bodies, as seen from the focus body or the camera.  Light times are warm-started from the previous call.  Null targets are skipped (left at the origin)."
+            ))
+    void GetApparentPositions(const TArray<UOrbitingBodyComponent*>& Targets, const FVector& CameraLocation, TArray<FFramePosition>& ApparentPositions);
+
     // To RHS coordinate system (used for engineering/science/math)
     static gte::Vector3<double> Swizzle(const FVector& value);
     // To LHS coordinate system (used for UE graphis/physics/etc)
@@ -202,6 +238,7 @@ private:
     TMap<FString, class UOrbitingBodyComponent*> BodyMap;
     FStateVector __internal_ScenegraphOriginState;
     double __internal_ScenegraphOriginState_timestamp;
+    TMap<TWeakObjectPtr<class UOrbitingBodyComponent>, double> LightTimes;
 
 private:
     FFramePosition GetScenegraphOrigin();
@@ -0,0 +1,186 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+
+#include "ApparentPosition.h"
+
+using namespace gte;
+
+
+// Kepler's equation, E - e sin(E) = M, for Lanes bodies at once.  E comes in
+// as each lane's starting guess.  Newton's method, in lockstep: every lane
+// takes every step (a converged lane's steps are ~0), so the loop is straight
+// line code over contiguous arrays, and vectorizes.  (Radians.)
+static void SolveKeplerLanes(const double* Ecc, const double* M, double* E, int32 Lanes, double Tolerance = 1e-12, int MaxIterations = 30)
+{
+    for (int Iteration = 0; Iteration < MaxIterations; ++Iteration)
+    {
+        double Worst = 0.;
+
+        for (int32 j = 0; j < Lanes; ++j)
+        {
+            const double F = E[j] - Ecc[j] * sin(E[j]) - M[j];
+            E[j] -= F / (1. - Ecc[j] * cos(E[j]));
+            Worst = FMath::Max(Worst, FMath::Abs(F));
+        }
+
+        if (Worst <= Tolerance)
+        {
+            break;
+        }
+    }
+}
+
+
+void ComputeApparentPositions(
+    FApparentPositionBatch& Batch,
+    double et,
+    const FFramePosition& ObserverPosition,
+    const FFrameVector& ObserverVelocity,
+    bool bAberration,
+    int MaxIterations,
+    double Tolerance
+)
+{
+    const int32 Num = Batch.Num();
+    const Vector3<double> O = ObserverPosition;
+
+    MaxIterations = FMath::Max(MaxIterations, 1);
+
+    // Structure of arrays... Positions stay in X/Y/Z lanes until the end.
+    // Per body: the orbit's rotation, semi-major and minor axes, period, and
+    // time since periapsis at et (as ComputePerifocalState has them.)
+    TArray<RotationMatrix> Q;
+    TArray<double> X, Y, Z, Tau, SemiMajor, SemiMinor, Period, SincePeriapsis, Offset;
+    TArray<int32> Active;
+
+    Q.SetNum(Num);
+    X.SetNumZeroed(Num);
+    Y.SetNumZeroed(Num);
+    Z.SetNumZeroed(Num);
+    Tau.SetNumUninitialized(Num);
+    SemiMajor.SetNumZeroed(Num);
+    SemiMinor.SetNumZeroed(Num);
+    Period.SetNumZeroed(Num);
+    SincePeriapsis.SetNumZeroed(Num);
+    Offset.SetNumZeroed(Num);
+    Active.Reserve(Num);
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        const FConicElements& Elements = Batch.Elements[i];
+
+        Batch.Iterations[i] = 0;
+        Batch.Converged[i] = false;
+        Batch.Valid[i] = true;
+        Tau[i] = FMath::Max(Batch.LightTimes[i], 0.);
+
+        if (Batch.IsInertial[i])
+        {
+            // Inertial bodies sit at the barycenter, there's nothing to iterate.
+            Tau[i] = Length(O) / SpeedOfLight;
+            Batch.Converged[i] = true;
+        }
+        else if (Elements.ecc < 0. || Elements.ecc >= 1. || Elements.rp <= 0. || Elements.mu <= 0.)
+        {
+            // No closed orbit to solve (see ComputePerifocalPosition)
+            Batch.Valid[i] = false;
+        }
+        else
+        {
+            UOrbitalMechanics::MakeQ(Elements.inc, Elements.lnode, Elements.argp, Q[i]);
+            SemiMajor[i] = Elements.rp / (1. - Elements.ecc);
+            SemiMinor[i] = SemiMajor[i] * sqrt(1. - Elements.ecc * Elements.ecc);
+            Period[i] = twopi<double> * sqrt(SemiMajor[i] * SemiMajor[i] * SemiMajor[i] / Elements.mu);
+            SincePeriapsis[i] = et - Elements.et0 + (Elements.m0 / 360.) * Period[i];
+            Active.Add(i);
+        }
+    }
+
+    // Compacted lanes of the bodies still iterating
+    TArray<double> LaneEcc, LaneM, LaneE;
+    LaneEcc.SetNumUninitialized(Active.Num());
+    LaneM.SetNumUninitialized(Active.Num());
+    LaneE.SetNumUninitialized(Active.Num());
+
+    // Each pass advances every unconverged body by one fixed point iteration.
+    for (int pass = 0; pass < MaxIterations && Active.Num() > 0; ++pass)
+    {
+        const int32 Lanes = Active.Num();
+
+        // Mean anomaly where each body was tau ago.  E - M barely changes
+        // from one pass to the next, so after the first (which starts where
+        // EccAnom does) the last pass's is the start.
+        for (int32 j = 0; j < Lanes; ++j)
+        {
+            const int32 i = Active[j];
+            double Orbits = (SincePeriapsis[i] - Tau[i]) / Period[i];
+            Orbits -= floor(Orbits);
+
+            LaneEcc[j] = Batch.Elements[i].ecc;
+            LaneM[j] = twopi<double> * Orbits;
+            LaneE[j] = pass > 0 ? LaneM[j] + Offset[i] : LaneEcc[j] < 0.8 ? LaneM[j] : pi<double>;
+        }
+
+        SolveKeplerLanes(LaneEcc.GetData(), LaneM.GetData(), LaneE.GetData(), Lanes);
+
+        for (int32 j = 0; j < Lanes; ++j)
+        {
+            const int32 i = Active[j];
+            const double E = LaneE[j];
+            Offset[i] = E - LaneM[j];
+
+            // Perifocal position, from the eccentric anomaly directly
+            // (r cos(ta), r sin(ta) without the true anomaly)
+            const double px = SemiMajor[i] * (cos(E) - LaneEcc[j]);
+            const double py = SemiMinor[i] * sin(E);
+
+            const Vector3<double> P = Q[i] * Vector3<double>{ px, py, 0. };
+            X[i] = P[0];
+            Y[i] = P[1];
+            Z[i] = P[2];
+
+            const double dx = X[i] - O[0];
+            const double dy = Y[i] - O[1];
+            const double dz = Z[i] - O[2];
+            const double NewTau = sqrt(dx * dx + dy * dy + dz * dz) / SpeedOfLight;
+
+            Batch.Converged[i] = abs(NewTau - Tau[i]) <= Tolerance;
+            Batch.Iterations[i] += 1;
+            Tau[i] = NewTau;
+        }
+
+        Active.RemoveAll([&Batch](int32 i) { return Batch.Converged[i]; });
+    }
+
+    // Bodies with nothing to solve don't feed anything forward: no light
+    // time, and they're put at the observer.
+    for (int32 i = 0; i < Num; ++i)
+    {
+        if (Batch.Valid[i]) continue;
+
+        Tau[i] = 0.;
+        X[i] = O[0];
+        Y[i] = O[1];
+        Z[i] = O[2];
+    }
+
+    // Write back, applying aberration if requested.
+    const Vector3<double> Beta = (1. / SpeedOfLight) * (Vector3<double>)ObserverVelocity;
+
+    for (int32 i = 0; i < Num; ++i)
+    {
+        Batch.LightTimes[i] = Tau[i];
+
+        Vector3<double> ToBody = Vector3<double>{ X[i], Y[i], Z[i] } - O;
+
+        if (bAberration && Batch.Valid[i])
+        {
+            double Distance = Normalize(ToBody);
+            ToBody += Beta;
+            Normalize(ToBody);
+            ToBody *= Distance;
+        }
+
+        Batch.Positions[i] = FFramePosition(O + ToBody);
+    }
+}
@@ -0,0 +1,45 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+
+#include "OrbitSimulationClock.h"
+
+
+void FOrbitSimulationClock::Reset(double et, double etScale)
+{
+    Step = 0;
+    BaseStep = 0;
+    BaseEt = et;
+    EtPerStep = etScale * StepSeconds;
+    Accumulator = 0.;
+}
+
+
+int FOrbitSimulationClock::Advance(double DeltaSeconds, double etScale)
+{
+    Accumulator += DeltaSeconds;
+
+    int StepsTaken = 0;
+    while (Accumulator >= StepSeconds && StepsTaken < MaxStepsPerAdvance)
+    {
+        Accumulator -= StepSeconds;
+        ++Step;
+        ++StepsTaken;
+    }
+
+    // Over budget, let the simulation fall behind real time.
+    if (Accumulator >= StepSeconds)
+    {
+        Accumulator = fmod(Accumulator, StepSeconds);
+    }
+
+    // Time scale changes take effect from the current step onwards
+    double NewEtPerStep = etScale * StepSeconds;
+    if (NewEtPerStep != EtPerStep)
+    {
+        BaseEt = GetStepEt(Step);
+        BaseStep = Step;
+        EtPerStep = NewEtPerStep;
+    }
+
+    return StepsTaken;
+}
@@ -2,6 +2,8 @@
 // Author: chuck@gamergenic.com
 
 #include "OrbitSystemStateComponent.h"
+#include "OrbitingBodyComponent.h"
+#include "Algo/BinarySearch.h"
 
 UOrbitSystemStateComponent::UOrbitSystemStateComponent()
 {
@@ -10,6 +12,8 @@ UOrbitSystemStateComponent::UOrbitSystemStateComponent()
 
     et = 0.;
     et_scale = 10000;
+    SimulationStep = 0;
+    PropagationStalls = 0;
 }
 
 // Called every frame
@@ -17,5 +21,218 @@ void UOrbitSystemStateComponent::TickComponent(float DeltaTime, ELevelTick TickT
 {
     Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-    et += et_scale * (double)DeltaTime;
+    if (!bFixedStep)
+    {
+        bFixedStepStarted = false;
+        et += et_scale * (double)DeltaTime;
+        return;
+    }
+
+    if (!bFixedStepStarted)
+    {
+        StartFixedStep();
+    }
+
+    Clock.MaxStepsPerAdvance = MaxStepsPerTick;
+    Clock.Advance((double)DeltaTime, et_scale);
+
+    SimulationStep = Clock.GetStep();
+    et = Clock.GetEt();
+
+    UpdatePropagation();
+}
+
+void UOrbitSystemStateComponent::RegisterBody(UOrbitingBodyComponent* Body)
+{
+    if (!Bodies.Contains(Body))
+    {
+        Bodies.Add(Body);
+        InvalidatePropagation();
+    }
+}
+
+void UOrbitSystemStateComponent::UnregisterBody(UOrbitingBodyComponent* Body)
+{
+    if (Bodies.Remove(Body))
+    {
+        InvalidatePropagation();
+    }
+}
+
+// The snapshots' States are indexed by position in Bodies, so they're no good
+// once it changes.  Tasks in flight are left to finish, and dropped when they
+// land (they only hold copies of the elements.)
+void UOrbitSystemStateComponent::InvalidatePropagation()
+{
+    Snapshots.Empty();
+    ++BodiesGeneration;
+}
+
+void UOrbitSystemStateComponent::StartFixedStep()
+{
+    for (FPropagation& InFlight : Propagations)
+    {
+        InFlight.Task.Wait();
+    }
+    Propagations.Empty();
+    Snapshots.Empty();
+
+    Clock.StepSeconds = FixedStepSeconds;
+    Clock.Reset(et, et_scale);
+
+    bFixedStepStarted = true;
+}
+
+void UOrbitSystemStateComponent::UpdatePropagation()
+{
+    // Bodies that have gone away without unregistering
+    if (Bodies.RemoveAll([](const TWeakObjectPtr<UOrbitingBodyComponent>& Body) { return !Body.IsValid(); }))
+    {
+        InvalidatePropagation();
+    }
+
+    // Collect finished work... Without ever waiting on it.
+    for (int32 i = Propagations.Num() - 1; i >= 0; --i)
+    {
+        FPropagation& InFlight = Propagations[i];
+        if (!InFlight.Task.IsCompleted()) continue;
+
+        if (InFlight.Generation == BodiesGeneration && InFlight.Step >= SimulationStep)
+        {
+            FOrbitStepSnapshot& Snapshot = InFlight.Task.GetResult();
+            const int32 Index = Algo::LowerBoundBy(Snapshots, Snapshot.Step, &FOrbitStepSnapshot::Step);
+            Snapshots.Insert(MoveTemp(Snapshot), Index);
+        }
+
+        Propagations.RemoveAtSwap(i);
+    }
+
+    // Drop anything older than the current step
+    Snapshots.RemoveAll([this](const FOrbitStepSnapshot& Snapshot) { return Snapshot.Step < SimulationStep; });
+
+    // Keep the current step and StepsAhead past it propagated, or on the way.
+    // If we've fallen behind, intermediate steps are skipped: the states are
+    // analytic, so nothing is lost by not visiting them.
+    TArray<FConicElements> Elements;
+
+    for (int64 TargetStep = SimulationStep; TargetStep <= SimulationStep + StepsAhead; ++TargetStep)
+    {
+        const bool bHave = Snapshots.ContainsByPredicate([TargetStep](const FOrbitStepSnapshot& Snapshot) { return Snapshot.Step == TargetStep; });
+        const bool bInFlight = Propagations.ContainsByPredicate([this, TargetStep](const FPropagation& InFlight) { return InFlight.Step == TargetStep && InFlight.Generation == BodiesGeneration; });
+
+        if (bHave || bInFlight) continue;
+
+        if (!Elements.Num())
+        {
+            Elements.Reserve(Bodies.Num());
+            for (const TWeakObjectPtr<UOrbitingBodyComponent>& Body : Bodies)
+            {
+                Elements.Add(Body->ConicElements);
+            }
+        }
+
+        const double StepEt = Clock.GetStepEt(TargetStep);
+
+        FPropagation& InFlight = Propagations.AddDefaulted_GetRef();
+        InFlight.Step = TargetStep;
+        InFlight.Generation = BodiesGeneration;
+        InFlight.Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Elements, TargetStep, StepEt]()
+            {
+                return PropagateStep(Elements, TargetStep, StepEt);
+            });
+    }
+
+    FState Unused;
+    if (Bodies.Num() && !InterpolateSnapshots(Snapshots, 0, et, Unused))
+    {
+        ++PropagationStalls;
+    }
+}
+
+FOrbitStepSnapshot UOrbitSystemStateComponent::PropagateStep(const TArray<FConicElements>& Elements, int64 Step, double StepEt)
+{
+    FOrbitStepSnapshot Snapshot;
+    Snapshot.Step = Step;
+    Snapshot.et = StepEt;
+    Snapshot.States.SetNum(Elements.Num());
+    Snapshot.Valid.Init(true, Elements.Num());
+
+    for (int32 i = 0; i < Elements.Num(); ++i)
+    {
+        ES_ResultCode ResultCode;
+        UOrbitalMechanics::ComputeState(Elements[i], StepEt, Snapshot.States[i], ResultCode);
+
+        // Whatever was computed on the way to failing is no state at all
+        if (ResultCode != ES_ResultCode::Success)
+        {
+            Snapshot.States[i] = FState();
+            Snapshot.Valid[i] = false;
+        }
+    }
+
+    return Snapshot;
+}
+
+bool UOrbitSystemStateComponent::GetInterpolatedState(const UOrbitingBodyComponent* Body, FState& State) const
+{
+    const int32 BodyIndex = Bodies.IndexOfByPredicate([Body](const TWeakObjectPtr<UOrbitingBodyComponent>& Registered) { return Registered.Get() == Body; });
+
+    if (!bFixedStep || BodyIndex == INDEX_NONE)
+    {
+        return false;
+    }
+
+    return InterpolateSnapshots(Snapshots, BodyIndex, et, State);
+}
+
+bool UOrbitSystemStateComponent::InterpolateSnapshots(const TArray<FOrbitStepSnapshot>& Snapshots, int32 BodyIndex, double et, FState& State)
+{
+    // Bracket et, between consecutive steps.  Anything else would be holding
+    // or extrapolating, and the caller's better off computing the state.
+    int32 Index = INDEX_NONE;
+    for (int32 i = 0; i + 1 < Snapshots.Num(); ++i)
+    {
+        if (Snapshots[i].et <= et && et <= Snapshots[i + 1].et && Snapshots[i + 1].Step == Snapshots[i].Step + 1)
+        {
+            Index = i;
+            break;
+        }
+    }
+
+    if (Index == INDEX_NONE)
+    {
+        return false;
+    }
+
+    const FOrbitStepSnapshot& A = Snapshots[Index];
+    const FOrbitStepSnapshot& B = Snapshots[Index + 1];
+
+    if (!A.States.IsValidIndex(BodyIndex) || !B.States.IsValidIndex(BodyIndex) || !A.Valid[BodyIndex])
+    {
+        return false;
+    }
+
+    // A body that failed at the later step keeps the earlier step's state
+    double Alpha = B.et > A.et && B.Valid[BodyIndex] ? FMath::Clamp((et - A.et) / (B.et - A.et), 0., 1.) : 0.;
+
+    const FState& From = A.States[BodyIndex];
+    const FState& To = B.States[BodyIndex];
+
+    // Angles are in degrees, interpolate across the wrap around
+    auto LerpDegrees = [Alpha](double a, double b)
+    {
+        double delta = fmod(b - a + 540., 360.) - 180.;
+        return fmod(a + Alpha * delta + 360., 360.);
+    };
+
+    State.Me = LerpDegrees(From.Me, To.Me);
+    State.Theta = LerpDegrees(From.Theta, To.Theta);
+    State.r = FMath::Lerp(From.r, To.r, Alpha);
+    State.StateVector.r = FFramePosition(
+        FMath::Lerp(From.StateVector.r.X, To.StateVector.r.X, Alpha),
+        FMath::Lerp(From.StateVector.r.Y, To.StateVector.r.Y, Alpha),
+        FMath::Lerp(From.StateVector.r.Z, To.StateVector.r.Z, Alpha)
+    );
+
+    return true;
 }
@@ -75,12 +75,41 @@ void UOrbitalMechanics::ComputeState(const FConicElements& ConicElements, double
     FFrameVector R;
     ComputePerifocalState(ConicElements, et, State.Me, State.Theta, State.r, R, ResultCode);
 
+    if (ResultCode != ES_ResultCode::Success)
+    {
+        return;
+    }
+
     Matrix3x3<double> Q;
     MakeQ(ConicElements.inc, ConicElements.lnode, ConicElements.argp, Q);
 
     State.StateVector.r = FFramePosition(Q * (Vector3<double>)R);
+}
 
-    ResultCode = ES_ResultCode::Success;
+void UOrbitalMechanics::ComputeVelocity(const FConicElements& ConicElements, double et, FFrameVector& V, ES_ResultCode& ResultCode)
+{
+    double M, trueAnom, r;
+    FFrameVector R;
+    ComputePerifocalState(ConicElements, et, M, trueAnom, r, R, ResultCode);
+
+    if (ResultCode != ES_ResultCode::Success)
+    {
+        return;
+    }
+
+    double ecc = ConicElements.ecc;
+    double a = ConicElements.rp / (1 - ecc);
+    double ta = trueAnom / 360 * twopi<double>;
+
+    // Perifocal velocity, v = mu/h * { -sin(ta), e + cos(ta), 0 }
+    // (mu/h = sqrt(mu / p), p = a * (1 - e^2), the semilatus rectum)
+    double muOverH = sqrt(ConicElements.mu / (a * (1 - ecc * ecc)));
+    Vector3<double> v{ -muOverH * sin(ta), muOverH * (ecc + cos(ta)), 0. };
+
+    Matrix3x3<double> Q;
+    MakeQ(ConicElements.inc, ConicElements.lnode, ConicElements.argp, Q);
+
+    V = FFrameVector(Q * v);
 }
 
 void UOrbitalMechanics::ComputeGeometry(const FConicElements& ConicElements, FOscullatingOrbitGeometry& Geometry, ES_ResultCode& ResultCode)
@@ -40,10 +40,27 @@ void UOrbitingBodyComponent::BeginPlay()
         if(!GameState) GameState = Cast<UOrbitSystemStateComponent>(Component);
     }
 
+    if (GameState)
+    {
+        GameState->RegisterBody(this);
+    }
+
     Super::BeginPlay();
 }
 
 
+// Called when the body's removed, or the game ends
+void UOrbitingBodyComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (GameState)
+    {
+        GameState->UnregisterBody(this);
+    }
+
+    Super::EndPlay(EndPlayReason);
+}
+
+
 // Called every frame
 void UOrbitingBodyComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
@@ -0,0 +1,196 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+// -----------------------------------------------------------------------------
+// ApparentPositionTest.cpp
+//
+// ComputeApparentPositions' light times against answers found without it.
+// A circular orbit seen from the barycenter is always r / c away.  Seen from
+// elsewhere, its position at any time is closed form, and the light time is
+// bisected for.  An eccentric orbit is bisected for through ComputeState,
+// the scalar Kepler solve.  And a warm start from the answer has to converge
+// in one pass.
+// -----------------------------------------------------------------------------
+
+#include "Misc/AutomationTest.h"
+#include "ApparentPosition.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ApparentPositionTest
+{
+    // The sun's, km^3/s^2
+    const double Mu = 1.3271244004193938e+11;
+
+    // Seconds of light time, and km, from the answers.  The batch stops once
+    // a pass moves tau by under 1e-6 s, and is ~1e-8 s off then; the scalar
+    // Kepler solve rounds its anomalies to 1e-8 degrees, a few 1e-2 km at
+    // Mars.
+    const double TauTolerance = 1e-6;
+    const double PositionTolerance = 0.5;
+
+    FConicElements Circular(double Radius, double m0)
+    {
+        FConicElements Elements;
+        Elements.rp = Radius;
+        Elements.ecc = 0.;
+        Elements.inc = 0.;
+        Elements.lnode = 0.;
+        Elements.argp = 0.;
+        Elements.m0 = m0;
+        Elements.mu = Mu;
+        Elements.et0 = 0.;
+        return Elements;
+    }
+
+    // Where a circular (Circular's) orbit's body is at et
+    Vector3<double> CircularPosition(const FConicElements& Elements, double et)
+    {
+        const double Period = twopi<double> * sqrt(Elements.rp * Elements.rp * Elements.rp / Elements.mu);
+        const double Angle = twopi<double> * (Elements.m0 / 360. + (et - Elements.et0) / Period);
+        return Vector3<double>{ Elements.rp * cos(Angle), Elements.rp * sin(Angle), 0. };
+    }
+
+    // The light time from Position (et - tau) to Observer, by bisection.  It's
+    // a root of |Position(et - tau) - Observer| - c tau, which only falls
+    // with tau (nothing moves at c.)
+    template<class PositionAt>
+    double BisectLightTime(PositionAt Position, double et, const Vector3<double>& Observer)
+    {
+        double Lo = 0.;
+        double Hi = 1e5;
+
+        for (int i = 0; i < 100; ++i)
+        {
+            const double Tau = 0.5 * (Lo + Hi);
+            if (Length(Position(et - Tau) - Observer) > SpeedOfLight * Tau)
+            {
+                Lo = Tau;
+            }
+            else
+            {
+                Hi = Tau;
+            }
+        }
+
+        return 0.5 * (Lo + Hi);
+    }
+
+    void SetBody(FApparentPositionBatch& Batch, int32 i, const FConicElements& Elements)
+    {
+        Batch.Elements[i] = Elements;
+        Batch.IsInertial[i] = false;
+        Batch.LightTimes[i] = 0.;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FApparentPositionLightTimeTest, "OrbitalPhysics.ApparentPosition.LightTime", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FApparentPositionLightTimeTest::RunTest(const FString& Parameters)
+{
+    using namespace ApparentPositionTest;
+
+    // Earth's distance and Mars', roughly
+    const FConicElements Near = Circular(1.496e8, 30.);
+    const FConicElements Far = Circular(2.279e8, 250.);
+
+    FConicElements Mars;
+    Mars.rp = 2.0665e+08;
+    Mars.ecc = 0.0934;
+    Mars.inc = 1.85;
+    Mars.lnode = 49.558;
+    Mars.argp = 286.502;
+    Mars.m0 = 19.412;
+    Mars.mu = Mu;
+    Mars.et0 = 0.;
+
+    const double Ets[] = { 0., 1e7, 3.3e8 };
+    const Vector3<double> Observers[] = { Vector3<double>::Zero(), Vector3<double>{ 1.47e8, -2.0e7, 1.0e6 } };
+
+    for (const double et : Ets)
+    {
+        for (const Vector3<double>& Observer : Observers)
+        {
+            FApparentPositionBatch Batch;
+            Batch.SetNum(3);
+            SetBody(Batch, 0, Near);
+            SetBody(Batch, 1, Far);
+            SetBody(Batch, 2, Mars);
+
+            ComputeApparentPositions(Batch, et, FFramePosition(Observer), FFrameVector(), false, 8, 1e-6);
+
+            auto NearAt = [&Near](double t) { return CircularPosition(Near, t); };
+            auto FarAt = [&Far](double t) { return CircularPosition(Far, t); };
+            auto MarsAt = [&Mars](double t)
+            {
+                FState State;
+                ES_ResultCode ResultCode;
+                UOrbitalMechanics::ComputeState(Mars, t, State, ResultCode);
+                return (Vector3<double>)State.StateVector.r;
+            };
+
+            double Answers[3];
+            Vector3<double> Positions[3];
+            Answers[0] = Observer == Vector3<double>::Zero() ? Near.rp / SpeedOfLight : BisectLightTime(NearAt, et, Observer);
+            Answers[1] = Observer == Vector3<double>::Zero() ? Far.rp / SpeedOfLight : BisectLightTime(FarAt, et, Observer);
+            Answers[2] = BisectLightTime(MarsAt, et, Observer);
+            Positions[0] = NearAt(et - Answers[0]);
+            Positions[1] = FarAt(et - Answers[1]);
+            Positions[2] = MarsAt(et - Answers[2]);
+
+            for (int32 i = 0; i < Batch.Num(); ++i)
+            {
+                const FString Where = FString::Printf(TEXT("body %d, et %g, observer %d"), i, et, Observer == Vector3<double>::Zero() ? 0 : 1);
+
+                TestTrue(FString::Printf(TEXT("Valid, %s"), *Where), Batch.Valid[i]);
+                TestTrue(FString::Printf(TEXT("Converged, %s"), *Where), Batch.Converged[i]);
+                TestEqual(FString::Printf(TEXT("Light time, %s"), *Where), Batch.LightTimes[i], Answers[i], TauTolerance);
+                TestEqual(FString::Printf(TEXT("Position, %s"), *Where), Length((Vector3<double>)Batch.Positions[i] - Positions[i]), 0., PositionTolerance);
+            }
+
+            // Started from the answer, the first pass is already within
+            // tolerance
+            ComputeApparentPositions(Batch, et, FFramePosition(Observer), FFrameVector(), false, 8, 1e-6);
+
+            for (int32 i = 0; i < Batch.Num(); ++i)
+            {
+                TestEqual(FString::Printf(TEXT("Warm started iterations, body %d, et %g"), i, et), Batch.Iterations[i], 1);
+            }
+        }
+    }
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FApparentPositionInvalidTest, "OrbitalPhysics.ApparentPosition.Invalid", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FApparentPositionInvalidTest::RunTest(const FString& Parameters)
+{
+    using namespace ApparentPositionTest;
+
+    const Vector3<double> Observer{ 1.47e8, -2.0e7, 1.0e6 };
+
+    FConicElements Hyperbolic = Circular(1.496e8, 0.);
+    Hyperbolic.ecc = 1.5;
+
+    FApparentPositionBatch Batch;
+    Batch.SetNum(2);
+    SetBody(Batch, 0, Hyperbolic);
+    Batch.IsInertial[1] = true;
+
+    ComputeApparentPositions(Batch, 0., FFramePosition(Observer), FFrameVector(10., 20., 0.));
+
+    // No orbit: at the observer, no light time
+    TestFalse(TEXT("Hyperbolic is invalid"), Batch.Valid[0]);
+    TestFalse(TEXT("Hyperbolic isn't converged"), Batch.Converged[0]);
+    TestEqual(TEXT("Hyperbolic light time"), Batch.LightTimes[0], 0.);
+    TestEqual(TEXT("Hyperbolic position"), Length((Vector3<double>)Batch.Positions[0] - Observer), 0., 1e-6);
+
+    // Inertial: at the barycenter, |observer| / c away
+    TestTrue(TEXT("Inertial is valid"), Batch.Valid[1]);
+    TestTrue(TEXT("Inertial is converged"), Batch.Converged[1]);
+    TestEqual(TEXT("Inertial light time"), Batch.LightTimes[1], Length(Observer) / SpeedOfLight, 1e-9);
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,233 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+// -----------------------------------------------------------------------------
+// OrbitSimulationClockTest.cpp
+//
+// The fixed step simulation has to visit the same steps, and interpolate the
+// same states, whatever the frame rate.  Runs the same simulated time at 30
+// and 144 Hz and compares them.  And a body whose elements can't be
+// propagated holds its last state, or has none, without disturbing the rest.
+// -----------------------------------------------------------------------------
+
+#include "Misc/AutomationTest.h"
+#include "OrbitSimulationClock.h"
+#include "OrbitSystemStateComponent.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace OrbitSimulationClockTest
+{
+    // Step 1/50 s never lands on a common frame time of 30 and 144 Hz (every
+    // 1/6 s) except every third one, which sits right on a step boundary.
+    // Those are skipped, rounding could put either side of it.
+    const double StepSeconds = 1. / 50.;
+    const double EtScale = 10000.;
+    const int SamplesPerSecond = 6;
+    const int Seconds = 10;
+
+    struct FSample
+    {
+        int64 Step;
+        double StepEt;
+        TArray<FState> States;
+    };
+
+    TArray<FConicElements> MakeElements()
+    {
+        TArray<FConicElements> Elements;
+
+        // Earth and Mars, roughly
+        FConicElements Earth;
+        Earth.rp = 1.47095000e+08;
+        Earth.ecc = 0.0167086;
+        Earth.inc = 0.00005;
+        Earth.lnode = -11.2604;
+        Earth.argp = 114.20783;
+        Earth.m0 = 358.617;
+        Earth.mu = 1.3271244004193938e+11;
+        Earth.et0 = 0;
+        Elements.Add(Earth);
+
+        FConicElements Mars = Earth;
+        Mars.rp = 2.0665e+08;
+        Mars.ecc = 0.0934;
+        Mars.inc = 1.85;
+        Mars.lnode = 49.558;
+        Mars.argp = 286.502;
+        Mars.m0 = 19.412;
+        Elements.Add(Mars);
+
+        return Elements;
+    }
+
+    // Steps through Seconds of real time at FramesPerSecond, sampling every
+    // 1/SamplesPerSecond s
+    TArray<FSample> Run(const TArray<FConicElements>& Elements, int FramesPerSecond)
+    {
+        FOrbitSimulationClock Clock;
+        Clock.StepSeconds = StepSeconds;
+        Clock.MaxStepsPerAdvance = 8;
+        Clock.Reset(0., EtScale);
+
+        const int FramesPerSample = FramesPerSecond / SamplesPerSecond;
+        TArray<FSample> Samples;
+
+        for (int Frame = 1; Frame <= Seconds * FramesPerSecond; ++Frame)
+        {
+            Clock.Advance(1. / (double)FramesPerSecond, EtScale);
+
+            if (Frame % FramesPerSample) continue;
+            if ((Frame / FramesPerSample) % 3 == 0) continue;
+
+            const int64 Step = Clock.GetStep();
+
+            TArray<FOrbitStepSnapshot> Snapshots;
+            Snapshots.Add(UOrbitSystemStateComponent::PropagateStep(Elements, Step, Clock.GetStepEt(Step)));
+            Snapshots.Add(UOrbitSystemStateComponent::PropagateStep(Elements, Step + 1, Clock.GetStepEt(Step + 1)));
+
+            FSample& Sample = Samples.AddDefaulted_GetRef();
+            Sample.Step = Step;
+            Sample.StepEt = Clock.GetStepEt(Step);
+            Sample.States.SetNum(Elements.Num());
+
+            for (int32 i = 0; i < Elements.Num(); ++i)
+            {
+                if (!UOrbitSystemStateComponent::InterpolateSnapshots(Snapshots, i, Clock.GetEt(), Sample.States[i]))
+                {
+                    Sample.States[i].r = -1.;
+                }
+            }
+        }
+
+        return Samples;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOrbitSimulationDeterminismTest, "OrbitalPhysics.FixedStep.Determinism", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FOrbitSimulationDeterminismTest::RunTest(const FString& Parameters)
+{
+    using namespace OrbitSimulationClockTest;
+
+    const TArray<FConicElements> Elements = MakeElements();
+    const TArray<FSample> Slow = Run(Elements, 30);
+    const TArray<FSample> Fast = Run(Elements, 144);
+
+    if (!TestEqual(TEXT("Sample count"), Slow.Num(), Fast.Num()))
+    {
+        return false;
+    }
+
+    // The steps, and their ets, are integer arithmetic on the step index, so
+    // they're identical.  The interpolation factor is the accumulated frame
+    // time, which differs by rounding, so the states are compared to a
+    // millimeter.
+    const double Tolerance = 1e-6;
+
+    for (int32 s = 0; s < Slow.Num(); ++s)
+    {
+        TestEqual(FString::Printf(TEXT("Step at sample %d"), s), Slow[s].Step, Fast[s].Step);
+        TestTrue(FString::Printf(TEXT("Step et at sample %d"), s), Slow[s].StepEt == Fast[s].StepEt);
+
+        for (int32 i = 0; i < Elements.Num(); ++i)
+        {
+            const FState& A = Slow[s].States[i];
+            const FState& B = Fast[s].States[i];
+
+            TestTrue(FString::Printf(TEXT("Body %d interpolated at sample %d"), i, s), A.r > 0. && B.r > 0.);
+            TestEqual(FString::Printf(TEXT("Body %d distance at sample %d"), i, s), A.r, B.r, Tolerance);
+            TestEqual(FString::Printf(TEXT("Body %d x at sample %d"), i, s), A.StateVector.r.X, B.StateVector.r.X, Tolerance);
+            TestEqual(FString::Printf(TEXT("Body %d y at sample %d"), i, s), A.StateVector.r.Y, B.StateVector.r.Y, Tolerance);
+            TestEqual(FString::Printf(TEXT("Body %d z at sample %d"), i, s), A.StateVector.r.Z, B.StateVector.r.Z, Tolerance);
+        }
+    }
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOrbitSimulationBracketTest, "OrbitalPhysics.FixedStep.Bracket", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FOrbitSimulationBracketTest::RunTest(const FString& Parameters)
+{
+    using namespace OrbitSimulationClockTest;
+
+    const TArray<FConicElements> Elements = MakeElements();
+    const double EtPerStep = EtScale * StepSeconds;
+
+    TArray<FOrbitStepSnapshot> Snapshots;
+    Snapshots.Add(UOrbitSystemStateComponent::PropagateStep(Elements, 10, 10. * EtPerStep));
+    Snapshots.Add(UOrbitSystemStateComponent::PropagateStep(Elements, 11, 11. * EtPerStep));
+
+    FState State;
+    TestTrue(TEXT("Between the steps"), UOrbitSystemStateComponent::InterpolateSnapshots(Snapshots, 0, 10.5 * EtPerStep, State));
+    TestFalse(TEXT("Before the first step"), UOrbitSystemStateComponent::InterpolateSnapshots(Snapshots, 0, 9.5 * EtPerStep, State));
+    TestFalse(TEXT("After the last step"), UOrbitSystemStateComponent::InterpolateSnapshots(Snapshots, 0, 11.5 * EtPerStep, State));
+    TestFalse(TEXT("No such body"), UOrbitSystemStateComponent::InterpolateSnapshots(Snapshots, Elements.Num(), 10.5 * EtPerStep, State));
+
+    // Steps that aren't consecutive don't bracket anything
+    Snapshots.RemoveAt(1);
+    Snapshots.Add(UOrbitSystemStateComponent::PropagateStep(Elements, 12, 12. * EtPerStep));
+    TestFalse(TEXT("Across a missing step"), UOrbitSystemStateComponent::InterpolateSnapshots(Snapshots, 0, 11. * EtPerStep, State));
+
+    // One step alone holds nothing
+    Snapshots.RemoveAt(1);
+    TestFalse(TEXT("A single step"), UOrbitSystemStateComponent::InterpolateSnapshots(Snapshots, 0, 10. * EtPerStep, State));
+
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FOrbitSimulationInvalidElementsTest, "OrbitalPhysics.FixedStep.InvalidElements", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FOrbitSimulationInvalidElementsTest::RunTest(const FString& Parameters)
+{
+    using namespace OrbitSimulationClockTest;
+
+    const TArray<FConicElements> Elements = MakeElements();
+    const double EtPerStep = EtScale * StepSeconds;
+
+    // Mars, on an open orbit ComputeState won't propagate
+    TArray<FConicElements> Invalid = Elements;
+    Invalid[1].ecc = 1.5;
+
+    // ComputePerifocalPosition warns every time
+    AddExpectedError(TEXT("Cannot compute state for eccentricies >= 1"), EAutomationExpectedErrorFlags::Contains, 0);
+
+    FState State;
+
+    // Failing at the later step, Mars holds its state at the earlier one.
+    // Earth doesn't notice.
+    TArray<FOrbitStepSnapshot> Snapshots;
+    Snapshots.Add(UOrbitSystemStateComponent::PropagateStep(Elements, 10, 10. * EtPerStep));
+    Snapshots.Add(UOrbitSystemStateComponent::PropagateStep(Invalid, 11, 11. * EtPerStep));
+
+    TestTrue(TEXT("Valid at the earlier step"), Snapshots[0].Valid[1]);
+    TestFalse(TEXT("Invalid at the later step"), Snapshots[1].Valid[1]);
+    TestTrue(TEXT("Earth valid at the later step"), Snapshots[1].Valid[0]);
+
+    TestTrue(TEXT("Held across the failed step"), UOrbitSystemStateComponent::InterpolateSnapshots(Snapshots, 1, 10.5 * EtPerStep, State));
+    const FState& Good = Snapshots[0].States[1];
+    TestEqual(TEXT("Held distance"), State.r, Good.r);
+    TestEqual(TEXT("Held x"), State.StateVector.r.X, Good.StateVector.r.X);
+    TestEqual(TEXT("Held y"), State.StateVector.r.Y, Good.StateVector.r.Y);
+    TestEqual(TEXT("Held z"), State.StateVector.r.Z, Good.StateVector.r.Z);
+
+    TestTrue(TEXT("Earth between the steps"), UOrbitSystemStateComponent::InterpolateSnapshots(Snapshots, 0, 10.5 * EtPerStep, State));
+    TestTrue(TEXT("Earth moves between the steps"), State.StateVector.r.X != Snapshots[0].States[0].StateVector.r.X);
+
+    // Failing at the earlier step, there's nothing to hold
+    Snapshots.Empty();
+    Snapshots.Add(UOrbitSystemStateComponent::PropagateStep(Invalid, 10, 10. * EtPerStep));
+    Snapshots.Add(UOrbitSystemStateComponent::PropagateStep(Elements, 11, 11. * EtPerStep));
+    TestFalse(TEXT("After the failed step"), UOrbitSystemStateComponent::InterpolateSnapshots(Snapshots, 1, 10.5 * EtPerStep, State));
+    TestTrue(TEXT("Earth after the failed step"), UOrbitSystemStateComponent::InterpolateSnapshots(Snapshots, 0, 10.5 * EtPerStep, State));
+
+    // Or at both
+    Snapshots.Empty();
+    Snapshots.Add(UOrbitSystemStateComponent::PropagateStep(Invalid, 10, 10. * EtPerStep));
+    Snapshots.Add(UOrbitSystemStateComponent::PropagateStep(Invalid, 11, 11. * EtPerStep));
+    TestFalse(TEXT("Between failed steps"), UOrbitSystemStateComponent::InterpolateSnapshots(Snapshots, 1, 10.5 * EtPerStep, State));
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,74 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OrbitalMechanics.h"
+
+/*
+*   Light-time and stellar aberration corrected ("apparent") positions.
+*
+*   Light leaving a body at et - tau reaches the observer at et, so the body
+*   is seen where it *was* tau seconds ago.  tau depends on where it was, so
+*   the correction is solved by fixed point iteration:
+*       tau(n+1) = |r(et - tau(n)) - observer(et)| / c
+*   The iteration contracts by roughly v/c per step, so with a warm start from
+*   the previous frame's tau a single step is almost always sufficient.
+*
+*   Bodies are processed as a batch in structure-of-arrays form.  Each pass
+*   advances every unconverged body by one iteration, so the per-pass work is
+*   a flat loop over contiguous arrays.  The orbit's rotation (Q), axes and
+*   period are set up once per body rather than once per iteration.  Kepler's
+*   equation is solved for all of a pass's bodies together, Newton's method in
+*   lockstep across the lanes, each started from its E - M of the pass before.
+*
+*   A body whose elements aren't a closed orbit (ecc outside [0, 1), or rp or
+*   mu not positive) is marked invalid, put at the observer, and gets no light
+*   time.
+*
+*   The aberration correction is the classical first order one: the apparent
+*   direction is the light-time corrected direction plus observer velocity / c.
+*/
+
+// Speed of light, km/sec
+constexpr double SpeedOfLight = 299792.458;
+
+struct FApparentPositionBatch
+{
+    // Inputs
+    TArray<FConicElements> Elements;
+    TArray<bool> IsInertial;
+
+    // In/Out: light time (seconds).  Values > 0 are used as the initial guess.
+    TArray<double> LightTimes;
+
+    // Outputs
+    TArray<FFramePosition> Positions;
+    TArray<int32> Iterations;
+    TArray<bool> Converged;
+    TArray<bool> Valid;
+
+    void SetNum(int32 Num)
+    {
+        Elements.SetNum(Num);
+        IsInertial.SetNum(Num);
+        LightTimes.SetNumZeroed(Num);
+        Positions.SetNum(Num);
+        Iterations.SetNumZeroed(Num);
+        Converged.SetNumZeroed(Num);
+        Valid.SetNumZeroed(Num);
+    }
+
+    int32 Num() const { return Elements.Num(); }
+};
+
+ORBITALPHYSICS_API void ComputeApparentPositions(
+    FApparentPositionBatch& Batch,
+    double et,
+    const FFramePosition& ObserverPosition,
+    const FFrameVector& ObserverVelocity,
+    bool bAberration = true,
+    int MaxIterations = 3,
+    double Tolerance = 1e-6
+);
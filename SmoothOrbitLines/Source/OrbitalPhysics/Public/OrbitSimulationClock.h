@@ -0,0 +1,47 @@
+// Copyright 2021 Gamergenic. All Rights Reserved.
+// Author: chuck@gamergenic.com
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+*   Fixed step simulation clock.
+*
+*   Real (frame) time is accumulated and consumed in whole steps.  The et of a
+*   step is a function of the step index alone:
+*       et(n) = BaseEt + (n - BaseStep) * EtPerStep
+*   so the simulation visits exactly the same ets no matter how the frame
+*   times partition the real time.  Frame rate only changes the interpolation
+*   factor (Alpha) between step n and n+1 used for rendering.
+*
+*   A change of et scale is applied at the step boundary, by rebasing.
+*/
+struct ORBITALPHYSICS_API FOrbitSimulationClock
+{
+    // Real time per step (Seconds)
+    double StepSeconds = 1. / 60.;
+
+    // Bounds the work per Advance.  Accumulated time beyond this is dropped
+    // (the simulation slows down rather than spiraling).
+    int MaxStepsPerAdvance = 4;
+
+    void Reset(double et, double etScale);
+
+    // Returns the number of steps taken
+    int Advance(double DeltaSeconds, double etScale);
+
+    int64 GetStep() const { return Step; }
+    double GetStepEt(int64 n) const { return BaseEt + (double)(n - BaseStep) * EtPerStep; }
+    double GetAlpha() const { return Accumulator / StepSeconds; }
+
+    // Interpolated et, between step n and n+1
+    double GetEt() const { return GetStepEt(Step) + GetAlpha() * EtPerStep; }
+
+private:
+    int64 Step = 0;
+    int64 BaseStep = 0;
+    double BaseEt = 0.;
+    double EtPerStep = 0.;
+    double Accumulator = 0.;
+};
@@ -4,11 +4,25 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Tasks/Task.h"
 #include "OrbitalMechanics.h"
+#include "OrbitSimulationClock.h"
 #include "OrbitSystemStateComponent.generated.h"
 
+// Every registered body's state at one simulation step
+struct ORBITALPHYSICS_API FOrbitStepSnapshot
+{
+    int64 Step = -1;
+    double et = 0.;
+    TArray<FState> States;
+
+    // False where a body's state couldn't be computed (elements ComputeState
+    // rejects.)  Its state is held at the previous step's instead.
+    TArray<bool> Valid;
+};
+
 /**
- * 
+ *
  */
 
 UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
@@ -22,10 +36,68 @@ public:
     // Called every frame
     virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
+    // Bodies whose states are propagated by the fixed step simulation
+    void RegisterBody(class UOrbitingBodyComponent* Body);
+    void UnregisterBody(class UOrbitingBodyComponent* Body);
+
+    // Body state at the current (interpolated) et.  False if the body's state
+    // isn't available from the fixed step simulation, in which case compute it.
+    bool GetInterpolatedState(const class UOrbitingBodyComponent* Body, FState& State) const;
+
+    // The states at a step, from the elements (what the propagation task does)
+    static FOrbitStepSnapshot PropagateStep(const TArray<FConicElements>& Elements, int64 Step, double StepEt);
+
+    // A body's state at et, interpolated between the consecutive snapshots
+    // that bracket it.  False if none do, or if the body's state failed at
+    // the earlier one (failing at the later one holds the earlier state.)
+    static bool InterpolateSnapshots(const TArray<FOrbitStepSnapshot>& Snapshots, int32 BodyIndex, double et, FState& State);
+
 public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Universe", meta = (ToolTip = "Current Ephemeris Time"))
     double et;
 
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Universe", meta = (ToolTip = "Ephemeris Time Multiplier"))
     double et_scale;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Universe|Fixed Step", meta = (ToolTip = "Advance the simulation in fixed steps, propagated on a task and interpolated for rendering"))
+    bool bFixedStep = false;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Universe|Fixed Step", meta = (ToolTip = "Real time per simulation step (Seconds).  Takes effect when the fixed step simulation starts.", ClampMin = "0.001"))
+    double FixedStepSeconds = 1. / 60.;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Universe|Fixed Step", meta = (ToolTip = "Most simulation steps taken per tick.  Time beyond this is dropped.", ClampMin = "1"))
+    int MaxStepsPerTick = 4;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Universe|Fixed Step", meta = (ToolTip = "Current simulation step"))
+    int64 SimulationStep;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Universe|Fixed Step", meta = (ToolTip = "Steps propagated ahead of the current one, so crossing a step boundary finds the next one already done", ClampMin = "1", ClampMax = "8"))
+    int StepsAhead = 2;
+
+    UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Universe|Fixed Step", meta = (ToolTip = "Ticks whose et wasn't bracketed by propagated steps, and fell back to computing states (rendering never waits for propagation)"))
+    int PropagationStalls;
+
+private:
+    struct FPropagation
+    {
+        int64 Step = -1;
+        uint32 Generation = 0;
+        UE::Tasks::TTask<FOrbitStepSnapshot> Task;
+    };
+
+    void StartFixedStep();
+    void UpdatePropagation();
+    void InvalidatePropagation();
+
+    UPROPERTY()
+    TArray<TWeakObjectPtr<class UOrbitingBodyComponent>> Bodies;
+
+    FOrbitSimulationClock Clock;
+    bool bFixedStepStarted = false;
+
+    // Step states, ordered by step.  States are indexed like Bodies, so any
+    // change to Bodies bumps the generation, and older results are dropped.
+    TArray<FOrbitStepSnapshot> Snapshots;
+    TArray<FPropagation> Propagations;
+    uint32 BodiesGeneration = 0;
 };
@@ -394,6 +394,14 @@ public:
             ))
     static void ComputeGeometry(const FConicElements& ConicElements, FOscullatingOrbitGeometry& Geometry, ES_ResultCode& ResultCode);
 
+    UFUNCTION(BlueprintCallable,
+        Category = "Orbital Mechanics",
+        meta = (
+            ExpandEnumAsExecs = "ResultCode",
+            ToolTip = "Compute the velocity (km/sec) of the body in its parent frame"
+            ))
+    static void ComputeVelocity(const FConicElements& ConicElements, double et, FFrameVector& V, ES_ResultCode& ResultCode);
+
     UFUNCTION(BlueprintCallable,
         Category = "Orbital Mechanics",
         meta = (
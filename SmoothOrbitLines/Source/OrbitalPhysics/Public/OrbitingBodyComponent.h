@@ -62,6 +62,15 @@ public:
             ))
     FColor LineColor;
 
+    UPROPERTY(EditAnywhere,
+        BlueprintReadWrite,
+        Category = "Orbiting Body|Body",
+        meta = (
+            ToolTip = "Radius of the sphere that hides orbit lines passing behind the body (Kilometers, 0 for none)",
+            ClampMin = "0"
+            ))
+    double OcclusionRadius = 0.;
+
     UPROPERTY(EditAnywhere,
         BlueprintReadWrite,
         Category = "Orbiting Body|Debug|Draw Debug Orbit",
@@ -91,6 +100,9 @@ protected:
     // Called when the game starts or when spawned
     virtual void BeginPlay() override;
 
+    // Called when the body's removed, or the game ends
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
     // Called every frame
     virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 };
@@ -32,6 +32,9 @@ void AOrbitingBody::BeginPlay()
 {
     GameState = Cast<AOrbitGameState>(GetWorld()->GetGameState());
 
+    // Orbit lines passing behind the body are hidden by its bounding sphere
+    OrbitingBody->OcclusionRadius = radii.GetMax();
+
     Super::BeginPlay();
 }
 